@@ -12,6 +12,13 @@
 
 #include <njs.h>
 
+#include "ngx_js_bytecode.h"
+#include "ngx_js_shared_dict.h"
+
+
+#define NGX_HTTP_JS_VM_POOL_SIZE    16
+#define NGX_HTTP_JS_VM_POOL_HEAP    (1024 * 1024)
+
 
 typedef struct {
     njs_vm_t              *vm;
@@ -20,12 +27,25 @@ typedef struct {
     ngx_uint_t             line;
     ngx_array_t           *imports;
     ngx_array_t           *paths;
+    ngx_flag_t             snapshot;
+    ngx_flag_t             arena;
+    ngx_str_t              bytecode_cache;
     njs_external_proto_t   req_proto;
+    ngx_js_dicts_t         dicts;
+    ngx_array_t           *funcs;
+    ngx_uint_t             nvms;
+    njs_vm_t              *vms[NGX_HTTP_JS_VM_POOL_SIZE];
 } ngx_http_js_main_conf_t;
 
 
 typedef struct {
-    ngx_str_t              content;
+    ngx_str_t              name;
+    njs_function_handle_t *handle;
+} ngx_http_js_func_t;
+
+
+typedef struct {
+    ngx_http_js_func_t     content;
 } ngx_http_js_loc_conf_t;
 
 
@@ -38,14 +58,16 @@ typedef struct {
 
 
 typedef struct {
-    njs_vm_t              *vm;
-    ngx_log_t             *log;
-    ngx_uint_t             done;
-    ngx_int_t              status;
-    njs_opaque_value_t     request;
-    njs_opaque_value_t     request_body;
-    ngx_str_t              redirect_uri;
-    njs_opaque_value_t     promise_callbacks[2];
+    njs_vm_t                 *vm;
+    ngx_http_js_main_conf_t  *main_conf;
+    ngx_log_t                *log;
+    ngx_uint_t                done;
+    ngx_int_t                 status;
+    njs_opaque_value_t        request;
+    njs_opaque_value_t        request_body;
+    njs_opaque_value_t        request_buffer;
+    ngx_str_t                 redirect_uri;
+    njs_opaque_value_t        promise_callbacks[2];
 } ngx_http_js_ctx_t;
 
 
@@ -74,6 +96,8 @@ static void ngx_http_js_content_finalize(ngx_http_request_t *r,
 static ngx_int_t ngx_http_js_variable(ngx_http_request_t *r,
     ngx_http_variable_value_t *v, uintptr_t data);
 static ngx_int_t ngx_http_js_init_vm(ngx_http_request_t *r);
+static njs_vm_t *ngx_http_js_get_vm(ngx_http_js_main_conf_t *jmcf,
+    ngx_http_request_t *r);
 static void ngx_http_js_cleanup_ctx(void *data);
 static void ngx_http_js_cleanup_vm(void *data);
 
@@ -133,6 +157,12 @@ static njs_int_t ngx_http_js_ext_get_remote_address(njs_vm_t *vm,
 static njs_int_t ngx_http_js_ext_get_request_body(njs_vm_t *vm,
     njs_object_prop_t *prop, njs_value_t *value, njs_value_t *setval,
     njs_value_t *retval);
+static njs_int_t ngx_http_js_ext_get_request_buffer(njs_vm_t *vm,
+    njs_object_prop_t *prop, njs_value_t *value, njs_value_t *setval,
+    njs_value_t *retval);
+static u_char *ngx_http_js_request_body_map(ngx_http_request_t *r,
+    ngx_buf_t *buf);
+static void ngx_http_js_request_body_unmap(void *data);
 static njs_int_t ngx_http_js_ext_get_header_in(njs_vm_t *vm,
     njs_object_prop_t *prop, njs_value_t *value, njs_value_t *setval,
     njs_value_t *retval);
@@ -174,9 +204,13 @@ static char *ngx_http_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static char *ngx_http_js_import(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_http_js_shared_dict_zone(ngx_conf_t *cf,
+    ngx_command_t *cmd, void *conf);
 static char *ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf);
 static char *ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static ngx_int_t ngx_http_js_func_add(ngx_conf_t *cf, ngx_http_js_func_t *jf,
+    ngx_str_t *name);
 static void *ngx_http_js_create_main_conf(ngx_conf_t *cf);
 static char *ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_http_js_create_loc_conf(ngx_conf_t *cf);
@@ -207,6 +241,34 @@ static ngx_command_t  ngx_http_js_commands[] = {
       offsetof(ngx_http_js_main_conf_t, paths),
       NULL },
 
+    { ngx_string("js_snapshot"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, snapshot),
+      NULL },
+
+    { ngx_string("js_arena"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, arena),
+      NULL },
+
+    { ngx_string("js_bytecode_cache"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_str_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(ngx_http_js_main_conf_t, bytecode_cache),
+      NULL },
+
+    { ngx_string("js_shared_dict_zone"),
+      NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE12,
+      ngx_http_js_shared_dict_zone,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      0,
+      NULL },
+
     { ngx_string("js_set"),
       NGX_HTTP_MAIN_CONF|NGX_CONF_TAKE2,
       ngx_http_js_set,
@@ -313,6 +375,15 @@ static njs_external_t  ngx_http_js_ext_request[] = {
         }
     },
 
+    {
+        .flags = NJS_EXTERN_PROPERTY,
+        .name.string = njs_str("requestBuffer"),
+        .enumerable = 1,
+        .u.property = {
+            .handler = ngx_http_js_ext_get_request_buffer,
+        }
+    },
+
     {
         .flags = NJS_EXTERN_PROPERTY,
         .name.string = njs_str("parent"),
@@ -489,6 +560,30 @@ static njs_external_t  ngx_http_js_ext_request[] = {
 };
 
 
+static njs_external_t  ngx_http_js_ext_ngx[] = {
+
+    {
+        .flags = NJS_EXTERN_PROPERTY | NJS_EXTERN_SYMBOL,
+        .name.symbol = NJS_SYMBOL_TO_STRING_TAG,
+        .u.property = {
+            .value = "ngx",
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_OBJECT,
+        .name.string = njs_str("shared"),
+        .enumerable = 1,
+        .u.object = {
+            .enumerable = 1,
+            .prop_handler = ngx_js_ext_shared,
+            .keys = ngx_js_ext_keys_shared,
+        }
+    },
+
+};
+
+
 static njs_vm_ops_t ngx_http_js_ops = {
     ngx_http_js_set_timer,
     ngx_http_js_clear_timer
@@ -518,7 +613,7 @@ static void
 ngx_http_js_content_event_handler(ngx_http_request_t *r)
 {
     ngx_int_t                rc;
-    njs_str_t                name, exception;
+    njs_str_t                exception;
     njs_function_t          *func;
     ngx_http_js_ctx_t       *ctx;
     ngx_http_js_loc_conf_t  *jlcf;
@@ -536,17 +631,14 @@ ngx_http_js_content_event_handler(ngx_http_request_t *r)
     jlcf = ngx_http_get_module_loc_conf(r, ngx_http_js_module);
 
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http js content call \"%V\"" , &jlcf->content);
+                   "http js content call \"%V\"" , &jlcf->content.name);
 
     ctx = ngx_http_get_module_ctx(r, ngx_http_js_module);
 
-    name.start = jlcf->content.data;
-    name.length = jlcf->content.len;
-
-    func = njs_vm_function(ctx->vm, &name);
+    func = njs_vm_handle_function(ctx->vm, jlcf->content.handle);
     if (func == NULL) {
         ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
-                      "js function \"%V\" not found", &jlcf->content);
+                      "js function \"%V\" not found", &jlcf->content.name);
         ngx_http_finalize_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
         return;
     }
@@ -654,11 +746,11 @@ static ngx_int_t
 ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
     uintptr_t data)
 {
-    ngx_str_t *fname = (ngx_str_t *) data;
+    ngx_http_js_func_t *jf = (ngx_http_js_func_t *) data;
 
     ngx_int_t           rc;
     njs_int_t           pending;
-    njs_str_t           name, value, exception;
+    njs_str_t           value, exception;
     njs_function_t     *func;
     ngx_http_js_ctx_t  *ctx;
 
@@ -674,17 +766,14 @@ ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
     }
 
     ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http js variable call \"%V\"", fname);
+                   "http js variable call \"%V\"", &jf->name);
 
     ctx = ngx_http_get_module_ctx(r, ngx_http_js_module);
 
-    name.start = fname->data;
-    name.length = fname->len;
-
-    func = njs_vm_function(ctx->vm, &name);
+    func = njs_vm_handle_function(ctx->vm, jf->handle);
     if (func == NULL) {
         ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
-                      "js function \"%V\" not found", fname);
+                      "js function \"%V\" not found", &jf->name);
         v->not_found = 1;
         return NGX_OK;
     }
@@ -707,7 +796,8 @@ ngx_http_js_variable(ngx_http_request_t *r, ngx_http_variable_value_t *v,
 
     if (!pending && njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
-                      "async operation inside \"%V\" variable handler", fname);
+                      "async operation inside \"%V\" variable handler",
+                      &jf->name);
         return NGX_ERROR;
     }
 
@@ -750,7 +840,7 @@ ngx_http_js_init_vm(ngx_http_request_t *r)
         return NGX_OK;
     }
 
-    ctx->vm = njs_vm_clone(jmcf->vm, r);
+    ctx->vm = ngx_http_js_get_vm(jmcf, r);
     if (ctx->vm == NULL) {
         return NGX_ERROR;
     }
@@ -760,6 +850,7 @@ ngx_http_js_init_vm(ngx_http_request_t *r)
         return NGX_ERROR;
     }
 
+    ctx->main_conf = jmcf;
     ctx->log = r->connection->log;
 
     cln->handler = ngx_http_js_cleanup_ctx;
@@ -784,25 +875,69 @@ ngx_http_js_init_vm(ngx_http_request_t *r)
 }
 
 
+static njs_vm_t *
+ngx_http_js_get_vm(ngx_http_js_main_conf_t *jmcf, ngx_http_request_t *r)
+{
+    njs_vm_t  *vm;
+
+    /* A VM left by a previous request is reset instead of a new clone. */
+
+    while (jmcf->nvms != 0) {
+        vm = jmcf->vms[--jmcf->nvms];
+
+        if (njs_vm_reset(vm, r) == NJS_OK) {
+            return vm;
+        }
+
+        njs_vm_destroy(vm);
+    }
+
+    return njs_vm_clone(jmcf->vm, r);
+}
+
+
 static void
 ngx_http_js_cleanup_ctx(void *data)
 {
     ngx_http_js_ctx_t *ctx = data;
 
+    njs_vm_stat_t             stat;
+    ngx_http_js_main_conf_t  *jmcf;
+
     if (njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, ctx->log, 0, "pending events");
+
+        /* The host events of the request must be released right now. */
+
+        njs_vm_destroy(ctx->vm);
+        return;
+    }
+
+    jmcf = ctx->main_conf;
+
+    njs_vm_stat(ctx->vm, &stat);
+
+    if (jmcf->nvms == NGX_HTTP_JS_VM_POOL_SIZE
+        || stat.heap_size > NGX_HTTP_JS_VM_POOL_HEAP)
+    {
+        njs_vm_destroy(ctx->vm);
+        return;
     }
 
-    njs_vm_destroy(ctx->vm);
+    jmcf->vms[jmcf->nvms++] = ctx->vm;
 }
 
 
 static void
 ngx_http_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_http_js_main_conf_t *jmcf = data;
 
-    njs_vm_destroy(vm);
+    while (jmcf->nvms != 0) {
+        njs_vm_destroy(jmcf->vms[--jmcf->nvms]);
+    }
+
+    njs_vm_destroy(jmcf->vm);
 }
 
 
@@ -1899,6 +2034,163 @@ done:
 }
 
 
+/*
+ * The request body as an ArrayBuffer.  A body in a single memory buffer
+ * is not copied, a body in a single file buffer is mapped to memory,
+ * otherwise the buffers are gathered into one memory block.
+ */
+
+static njs_int_t
+ngx_http_js_ext_get_request_buffer(njs_vm_t *vm, njs_object_prop_t *prop,
+    njs_value_t *value, njs_value_t *setval, njs_value_t *retval)
+{
+    u_char              *p, *body;
+    off_t                len;
+    ssize_t              n;
+    ngx_buf_t           *buf;
+    njs_int_t            ret;
+    njs_value_t         *request_buffer;
+    ngx_chain_t         *cl;
+    ngx_http_js_ctx_t   *ctx;
+    ngx_http_request_t  *r;
+
+    r = njs_vm_external(vm, value);
+    if (r == NULL) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    ctx = ngx_http_get_module_ctx(r, ngx_http_js_module);
+    request_buffer = (njs_value_t *) &ctx->request_buffer;
+
+    if (!njs_value_is_null(request_buffer)) {
+        njs_value_assign(retval, request_buffer);
+        return NJS_OK;
+    }
+
+    if (r->request_body == NULL || r->request_body->bufs == NULL) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    len = 0;
+
+    for (cl = r->request_body->bufs; cl; cl = cl->next) {
+        len += ngx_buf_size(cl->buf);
+    }
+
+    if (len > NGX_MAX_UINT32_VALUE) {
+        njs_vm_error(vm, "request body is too large");
+        return NJS_ERROR;
+    }
+
+    cl = r->request_body->bufs;
+    buf = cl->buf;
+
+    if (cl->next == NULL && len != 0) {
+        if (ngx_buf_in_memory(buf)) {
+            body = buf->pos;
+            goto done;
+        }
+
+        body = ngx_http_js_request_body_map(r, buf);
+        if (body != NULL) {
+            goto done;
+        }
+
+        /* Falls back to reading the file. */
+    }
+
+    p = ngx_pnalloc(r->pool, len);
+    if (p == NULL) {
+        njs_vm_memory_error(vm);
+        return NJS_ERROR;
+    }
+
+    body = p;
+
+    for ( /* void */ ; cl; cl = cl->next) {
+        buf = cl->buf;
+
+        if (ngx_buf_in_memory(buf)) {
+            p = ngx_cpymem(p, buf->pos, buf->last - buf->pos);
+            continue;
+        }
+
+        n = ngx_read_file(buf->file, p, buf->file_last - buf->file_pos,
+                          buf->file_pos);
+
+        if (n != buf->file_last - buf->file_pos) {
+            njs_vm_error(vm, "failed to read request body file");
+            return NJS_ERROR;
+        }
+
+        p += n;
+    }
+
+done:
+
+    ret = njs_vm_value_array_buffer_set(vm, request_buffer, body, len);
+    if (ret != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    njs_value_assign(retval, request_buffer);
+
+    return NJS_OK;
+}
+
+
+static u_char *
+ngx_http_js_request_body_map(ngx_http_request_t *r, ngx_buf_t *buf)
+{
+    u_char              *p;
+    off_t                offset;
+    size_t               size;
+    ngx_str_t           *map;
+    ngx_pool_cleanup_t  *cln;
+
+    cln = ngx_pool_cleanup_add(r->pool, sizeof(ngx_str_t));
+    if (cln == NULL) {
+        return NULL;
+    }
+
+    offset = buf->file_pos & ~((off_t) ngx_pagesize - 1);
+    size = buf->file_last - offset;
+
+    /* A private mapping, changes made by the script stay in memory. */
+
+    p = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, buf->file->fd,
+             offset);
+
+    if (p == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_WARN, r->connection->log, ngx_errno,
+                      "js mmap(\"%V\") failed", &buf->file->name);
+        return NULL;
+    }
+
+    map = cln->data;
+    map->data = p;
+    map->len = size;
+
+    cln->handler = ngx_http_js_request_body_unmap;
+
+    return p + (buf->file_pos - offset);
+}
+
+
+static void
+ngx_http_js_request_body_unmap(void *data)
+{
+    ngx_str_t  *map = data;
+
+    if (munmap(map->data, map->len) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      "munmap(%p, %uz) failed", map->data, map->len);
+    }
+}
+
+
 static njs_int_t
 ngx_http_js_ext_get_header_in(njs_vm_t *vm, njs_object_prop_t *prop,
     njs_value_t *value, njs_value_t *setval, njs_value_t *retval)
@@ -2773,10 +3065,12 @@ ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
     ngx_pool_cleanup_t    *cln;
     njs_opaque_value_t     lvalue, exception;
     njs_external_proto_t   proto;
+    ngx_http_js_func_t   **jf;
     ngx_http_js_import_t  *import;
 
     static const njs_str_t line_number_key = njs_str("lineNumber");
     static const njs_str_t file_name_key = njs_str("fileName");
+    static const njs_str_t ngx_name = njs_str("ngx");
 
     if (jmcf->include.len == 0 && jmcf->imports == NGX_CONF_UNSET_PTR) {
         return NGX_CONF_OK;
@@ -2869,6 +3163,9 @@ ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
     options.argv = ngx_argv;
     options.argc = ngx_argc;
 
+    /* Request VMs are short-lived, "js_arena" is on by default. */
+    options.arena = (jmcf->arena != 0);
+
     if (jmcf->include.len != 0) {
         file = jmcf->include;
 
@@ -2891,7 +3188,7 @@ ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
     }
 
     cln->handler = ngx_http_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cln->data = jmcf;
 
     path.start = ngx_cycle->conf_prefix.data;
     path.length = ngx_cycle->conf_prefix.len;
@@ -2931,9 +3228,41 @@ ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
     }
 
     jmcf->req_proto = proto;
+
+    if (jmcf->dicts.zones != NGX_CONF_UNSET_PTR) {
+        if (ngx_js_shared_dict_init(jmcf->vm, &jmcf->dicts) != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to add js shared dict proto");
+            return NGX_CONF_ERROR;
+        }
+
+        proto = njs_vm_external_prototype(jmcf->vm, ngx_http_js_ext_ngx,
+                                          njs_nitems(ngx_http_js_ext_ngx));
+        if (proto == NULL) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to add js ngx proto");
+            return NGX_CONF_ERROR;
+        }
+
+        rc = njs_vm_external_create(jmcf->vm, njs_value_arg(&lvalue), proto,
+                                    &jmcf->dicts, 1);
+        if (rc != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to create js ngx object");
+            return NGX_CONF_ERROR;
+        }
+
+        rc = njs_vm_bind(jmcf->vm, &ngx_name, njs_value_arg(&lvalue), 1);
+        if (rc != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to bind js ngx object");
+            return NGX_CONF_ERROR;
+        }
+    }
+
     end = start + size;
 
-    rc = njs_vm_compile(jmcf->vm, &start, end);
+    rc = ngx_js_compile(cf, jmcf->vm, &jmcf->bytecode_cache, &start, end);
 
     if (rc != NJS_OK) {
         njs_value_assign(&exception, njs_vm_retval(jmcf->vm));
@@ -2976,6 +3305,41 @@ ngx_http_js_init_main_conf(ngx_conf_t *cf, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (jmcf->snapshot == 1) {
+        rc = njs_vm_snapshot(jmcf->vm);
+
+        if (rc == NJS_ERROR) {
+            njs_vm_retval_string(jmcf->vm, &text);
+
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0, "js exception: %*s",
+                          text.length, text.start);
+            return NGX_CONF_ERROR;
+        }
+
+        if (rc == NJS_DECLINED) {
+            ngx_log_error(NGX_LOG_WARN, cf->log, 0,
+                          "js heap cannot be snapshotted, "
+                          "the global code will run for each request");
+        }
+    }
+
+    if (jmcf->funcs != NGX_CONF_UNSET_PTR) {
+        jf = jmcf->funcs->elts;
+
+        for (i = 0; i < jmcf->funcs->nelts; i++) {
+            path.start = jf[i]->name.data;
+            path.length = jf[i]->name.len;
+
+            jf[i]->handle = njs_vm_function_handle(jmcf->vm, &path);
+            if (jf[i]->handle == NULL) {
+                ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                              "invalid js function name \"%V\"",
+                              &jf[i]->name);
+                return NGX_CONF_ERROR;
+            }
+        }
+    }
+
     return NGX_CONF_OK;
 }
 
@@ -3106,10 +3470,21 @@ ngx_http_js_import(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 }
 
 
+static char *
+ngx_http_js_shared_dict_zone(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_js_main_conf_t *jmcf = conf;
+
+    return ngx_js_shared_dict_zone(cf, cmd, &jmcf->dicts,
+                                   &ngx_http_js_module);
+}
+
+
 static char *
 ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
-    ngx_str_t            *value, *fname;
+    ngx_str_t            *value;
+    ngx_http_js_func_t   *jf;
     ngx_http_variable_t  *v;
 
     value = cf->args->elts;
@@ -3128,15 +3503,17 @@ ngx_http_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    fname = ngx_palloc(cf->pool, sizeof(ngx_str_t));
-    if (fname == NULL) {
+    jf = ngx_pcalloc(cf->pool, sizeof(ngx_http_js_func_t));
+    if (jf == NULL) {
         return NGX_CONF_ERROR;
     }
 
-    *fname = value[2];
+    if (ngx_http_js_func_add(cf, jf, &value[2]) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
 
     v->get_handler = ngx_http_js_variable;
-    v->data = (uintptr_t) fname;
+    v->data = (uintptr_t) jf;
 
     return NGX_CONF_OK;
 }
@@ -3150,12 +3527,15 @@ ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     ngx_str_t                 *value;
     ngx_http_core_loc_conf_t  *clcf;
 
-    if (jlcf->content.data) {
+    if (jlcf->content.name.data) {
         return "is duplicate";
     }
 
     value = cf->args->elts;
-    jlcf->content = value[1];
+
+    if (ngx_http_js_func_add(cf, &jlcf->content, &value[1]) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
 
     clcf = ngx_http_conf_get_module_loc_conf(cf, ngx_http_core_module);
     clcf->handler = ngx_http_js_content_handler;
@@ -3164,6 +3544,40 @@ ngx_http_js_content(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 }
 
 
+/*
+ * The functions are resolved to handles when the script is compiled
+ * in ngx_http_js_init_main_conf(), the handles are valid in the cloned
+ * VMs and spare the lookup of the function by its name on every call.
+ */
+
+static ngx_int_t
+ngx_http_js_func_add(ngx_conf_t *cf, ngx_http_js_func_t *jf, ngx_str_t *name)
+{
+    ngx_http_js_func_t       **p;
+    ngx_http_js_main_conf_t   *jmcf;
+
+    jmcf = ngx_http_conf_get_module_main_conf(cf, ngx_http_js_module);
+
+    if (jmcf->funcs == NGX_CONF_UNSET_PTR) {
+        jmcf->funcs = ngx_array_create(cf->pool, 4,
+                                       sizeof(ngx_http_js_func_t *));
+        if (jmcf->funcs == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    p = ngx_array_push(jmcf->funcs);
+    if (p == NULL) {
+        return NGX_ERROR;
+    }
+
+    jf->name = *name;
+    *p = jf;
+
+    return NGX_OK;
+}
+
+
 static void *
 ngx_http_js_create_main_conf(ngx_conf_t *cf)
 {
@@ -3179,13 +3593,20 @@ ngx_http_js_create_main_conf(ngx_conf_t *cf)
      *
      *     conf->vm = NULL;
      *     conf->include = { 0, NULL };
+     *     conf->bytecode_cache = { 0, NULL };
      *     conf->file = NULL;
      *     conf->line = 0;
      *     conf->req_proto = NULL;
+     *     conf->dicts.proto = NULL;
+     *     conf->nvms = 0;
      */
 
     conf->paths = NGX_CONF_UNSET_PTR;
     conf->imports = NGX_CONF_UNSET_PTR;
+    conf->dicts.zones = NGX_CONF_UNSET_PTR;
+    conf->funcs = NGX_CONF_UNSET_PTR;
+    conf->snapshot = NGX_CONF_UNSET;
+    conf->arena = NGX_CONF_UNSET;
 
     return conf;
 }
@@ -3204,7 +3625,7 @@ ngx_http_js_create_loc_conf(ngx_conf_t *cf)
     /*
      * set by ngx_pcalloc():
      *
-     *     conf->content = { 0, NULL };
+     *     conf->content = { { 0, NULL }, NULL };
      */
 
     return conf;
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+
+#include <njs.h>
+
+#include "ngx_js_bytecode.h"
+
+
+static void ngx_js_bytecode_write(ngx_conf_t *cf, ngx_str_t *cache,
+    njs_str_t *bytecode);
+
+
+/*
+ * Compiles the script, the bytecode is loaded from the cache file
+ * or saved to it if the file name is not empty.
+ */
+
+njs_int_t
+ngx_js_compile(ngx_conf_t *cf, njs_vm_t *vm, ngx_str_t *cache,
+    u_char **start, u_char *end)
+{
+    u_char           *p;
+    size_t            size;
+    ssize_t           n;
+    ngx_fd_t          fd;
+    njs_int_t         rc;
+    njs_str_t         bytecode;
+    ngx_file_info_t   fi;
+
+    if (cache->len == 0) {
+        return njs_vm_compile(vm, start, end);
+    }
+
+    if (ngx_conf_full_name(cf->cycle, cache, 1) != NGX_OK) {
+        return NJS_ERROR;
+    }
+
+    fd = ngx_open_file(cache->data, NGX_FILE_RDONLY, NGX_FILE_OPEN, 0);
+
+    if (fd == NGX_INVALID_FILE) {
+        if (ngx_errno != NGX_ENOENT) {
+            ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                          ngx_open_file_n " \"%s\" failed", cache->data);
+        }
+
+        goto compile;
+    }
+
+    if (ngx_fd_info(fd, &fi) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_fd_info_n " \"%s\" failed", cache->data);
+        (void) ngx_close_file(fd);
+        goto compile;
+    }
+
+    size = ngx_file_size(&fi);
+
+    p = ngx_pnalloc(cf->temp_pool, size);
+    if (p == NULL) {
+        (void) ngx_close_file(fd);
+        return NJS_ERROR;
+    }
+
+    n = ngx_read_fd(fd, p, size);
+
+    (void) ngx_close_file(fd);
+
+    if (n == -1 || (size_t) n != size) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_read_fd_n " \"%s\" failed", cache->data);
+        goto compile;
+    }
+
+    bytecode.start = p;
+    bytecode.length = size;
+
+    rc = njs_vm_compile_load(vm, start, end, &bytecode);
+    if (rc != NJS_DECLINED) {
+        return rc;
+    }
+
+    ngx_log_error(NGX_LOG_NOTICE, cf->log, 0,
+                  "js bytecode cache \"%s\" is stale, compiling the script",
+                  cache->data);
+
+compile:
+
+    rc = njs_vm_compile_save(vm, start, end, &bytecode);
+
+    if (rc == NJS_OK) {
+        ngx_js_bytecode_write(cf, cache, &bytecode);
+    }
+
+    return (rc == NJS_DECLINED) ? NJS_OK : rc;
+}
+
+
+static void
+ngx_js_bytecode_write(ngx_conf_t *cf, ngx_str_t *cache,
+    njs_str_t *bytecode)
+{
+    u_char    *temp;
+    ssize_t    n;
+    ngx_fd_t   fd;
+
+    /* The cache is replaced atomically, a partial file is never loaded. */
+
+    temp = ngx_pnalloc(cf->temp_pool, cache->len + NGX_INT64_LEN + 2);
+    if (temp == NULL) {
+        return;
+    }
+
+    (void) ngx_sprintf(temp, "%V.%P%Z", cache, ngx_pid);
+
+    fd = ngx_open_file(temp, NGX_FILE_WRONLY, NGX_FILE_TRUNCATE,
+                       NGX_FILE_DEFAULT_ACCESS);
+    if (fd == NGX_INVALID_FILE) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_open_file_n " \"%s\" failed", temp);
+        return;
+    }
+
+    n = ngx_write_fd(fd, bytecode->start, bytecode->length);
+
+    if (n == -1 || (size_t) n != bytecode->length) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_write_fd_n " \"%s\" failed", temp);
+        goto failed;
+    }
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", temp);
+        fd = NGX_INVALID_FILE;
+        goto failed;
+    }
+
+    if (ngx_rename_file(temp, cache->data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_WARN, cf->log, ngx_errno,
+                      ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                      temp, cache->data);
+        (void) ngx_delete_file(temp);
+    }
+
+    return;
+
+failed:
+
+    if (fd != NGX_INVALID_FILE) {
+        (void) ngx_close_file(fd);
+    }
+
+    (void) ngx_delete_file(temp);
+}
@@ -0,0 +1,14 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#ifndef _NGX_JS_BYTECODE_H_INCLUDED_
+#define _NGX_JS_BYTECODE_H_INCLUDED_
+
+
+njs_int_t ngx_js_compile(ngx_conf_t *cf, njs_vm_t *vm, ngx_str_t *cache,
+    u_char **start, u_char *end);
+
+
+#endif /* _NGX_JS_BYTECODE_H_INCLUDED_ */
@@ -0,0 +1,1010 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+
+#include <njs.h>
+
+#include "ngx_js_shared_dict.h"
+
+
+#define NGX_JS_DICT_STRING     0
+#define NGX_JS_DICT_NUMBER     1
+
+#define NGX_JS_DICT_READ_TRIES 8
+#define NGX_JS_DICT_MAX_CHAIN  64
+#define NGX_JS_DICT_EXPIRE     64
+
+
+typedef struct ngx_js_dict_node_s  ngx_js_dict_node_t;
+
+struct ngx_js_dict_node_s {
+    ngx_js_dict_node_t  *next;
+    ngx_queue_t          queue;
+    ngx_msec_t           expire;
+    uint32_t             hash;
+    uint32_t             type;
+    uint32_t             key_len;
+    uint32_t             value_len;
+    u_char               data[1];
+};
+
+
+typedef struct {
+    ngx_atomic_t          seq;
+    ngx_queue_t           queue;
+    ngx_uint_t            nbuckets;
+    ngx_js_dict_node_t  **buckets;
+} ngx_js_dict_sh_t;
+
+
+typedef struct {
+    ngx_str_t          name;
+    ngx_msec_t         timeout;
+    ngx_shm_zone_t    *shm_zone;
+    ngx_js_dict_sh_t  *sh;
+    ngx_slab_pool_t   *shpool;
+} ngx_js_dict_t;
+
+
+static njs_int_t ngx_js_ext_dict_get(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+static njs_int_t ngx_js_ext_dict_set(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+static njs_int_t ngx_js_ext_dict_incr(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+static njs_int_t ngx_js_ext_dict_delete(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+static njs_int_t ngx_js_dict_key(njs_vm_t *vm, njs_value_t *value,
+    njs_str_t *key);
+static njs_int_t ngx_js_dict_timeout(njs_vm_t *vm, ngx_js_dict_t *dict,
+    njs_value_t *value, ngx_msec_t *timeout);
+static ngx_int_t ngx_js_dict_value(njs_vm_t *vm, ngx_js_dict_t *dict,
+    njs_str_t *key, uint32_t hash, ngx_uint_t locked, njs_value_t *retval);
+static ngx_js_dict_node_t *ngx_js_dict_find(ngx_js_dict_t *dict,
+    njs_str_t *key, uint32_t hash);
+static ngx_js_dict_node_t *ngx_js_dict_alloc(ngx_js_dict_t *dict,
+    size_t size);
+static void ngx_js_dict_expire(ngx_js_dict_t *dict, ngx_uint_t n);
+static void ngx_js_dict_remove(ngx_js_dict_t *dict, ngx_js_dict_node_t *node);
+static ngx_int_t ngx_js_dict_init_zone(ngx_shm_zone_t *shm_zone,
+    void *data);
+
+
+static njs_external_t  ngx_js_ext_shared_dict[] = {
+
+    {
+        .flags = NJS_EXTERN_PROPERTY | NJS_EXTERN_SYMBOL,
+        .name.symbol = NJS_SYMBOL_TO_STRING_TAG,
+        .u.property = {
+            .value = "SharedDict",
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_METHOD,
+        .name.string = njs_str("get"),
+        .writable = 1,
+        .configurable = 1,
+        .enumerable = 1,
+        .u.method = {
+            .native = ngx_js_ext_dict_get,
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_METHOD,
+        .name.string = njs_str("set"),
+        .writable = 1,
+        .configurable = 1,
+        .enumerable = 1,
+        .u.method = {
+            .native = ngx_js_ext_dict_set,
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_METHOD,
+        .name.string = njs_str("incr"),
+        .writable = 1,
+        .configurable = 1,
+        .enumerable = 1,
+        .u.method = {
+            .native = ngx_js_ext_dict_incr,
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_METHOD,
+        .name.string = njs_str("delete"),
+        .writable = 1,
+        .configurable = 1,
+        .enumerable = 1,
+        .u.method = {
+            .native = ngx_js_ext_dict_delete,
+        }
+    },
+
+};
+
+
+njs_int_t
+ngx_js_ext_shared(njs_vm_t *vm, njs_object_prop_t *prop, njs_value_t *value,
+    njs_value_t *setval, njs_value_t *retval)
+{
+    njs_int_t        rc;
+    njs_str_t        name;
+    ngx_uint_t       i;
+    ngx_js_dict_t  **dict;
+    ngx_js_dicts_t  *dicts;
+
+    dicts = njs_vm_external(vm, value);
+    if (dicts == NULL) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    rc = njs_vm_prop_name(vm, prop, &name);
+    if (rc != NJS_OK) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    dict = dicts->zones->elts;
+
+    for (i = 0; i < dicts->zones->nelts; i++) {
+        if (name.length == dict[i]->name.len
+            && ngx_strncmp(name.start, dict[i]->name.data, name.length) == 0)
+        {
+            return njs_vm_external_create(vm, retval, dicts->proto, dict[i],
+                                          0);
+        }
+    }
+
+    njs_value_undefined_set(retval);
+
+    return NJS_DECLINED;
+}
+
+
+njs_int_t
+ngx_js_ext_keys_shared(njs_vm_t *vm, njs_value_t *value, njs_value_t *keys)
+{
+    njs_int_t        rc;
+    ngx_uint_t       i;
+    njs_value_t     *name;
+    ngx_js_dict_t  **dict;
+    ngx_js_dicts_t  *dicts;
+
+    rc = njs_vm_array_alloc(vm, keys, 4);
+    if (rc != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    dicts = njs_vm_external(vm, value);
+    if (dicts == NULL) {
+        return NJS_OK;
+    }
+
+    dict = dicts->zones->elts;
+
+    for (i = 0; i < dicts->zones->nelts; i++) {
+        name = njs_vm_array_push(vm, keys);
+        if (name == NULL) {
+            return NJS_ERROR;
+        }
+
+        rc = njs_vm_value_string_set(vm, name, dict[i]->name.data,
+                                     dict[i]->name.len);
+        if (rc != NJS_OK) {
+            return NJS_ERROR;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+/*
+ * Readers do not take the zone lock.  The zone keeps a sequence counter
+ * which is odd while the table is being changed, a reader retries if
+ * the counter was odd or has changed while the value was copied.
+ * A node may be freed and reused under a reader, so the lookup validates
+ * every pointer and length against the zone bounds before using it.
+ */
+
+static njs_int_t
+ngx_js_ext_dict_get(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    uint32_t           hash;
+    njs_int_t          rc;
+    njs_str_t          key;
+    ngx_uint_t         i;
+    ngx_atomic_uint_t  seq;
+    ngx_js_dict_t     *dict;
+    ngx_js_dict_sh_t  *sh;
+
+    dict = njs_vm_external(vm, njs_arg(args, nargs, 0));
+    if (dict == NULL) {
+        njs_vm_error(vm, "\"this\" is not a shared dict");
+        return NJS_ERROR;
+    }
+
+    if (ngx_js_dict_key(vm, njs_arg(args, nargs, 1), &key) != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    sh = dict->sh;
+    hash = ngx_crc32_short(key.start, key.length);
+
+    for (i = 0; i < NGX_JS_DICT_READ_TRIES; i++) {
+        seq = sh->seq;
+        ngx_memory_barrier();
+
+        if (seq & 1) {
+            ngx_cpu_pause();
+            continue;
+        }
+
+        rc = ngx_js_dict_value(vm, dict, &key, hash, 0, njs_vm_retval(vm));
+        if (rc == NGX_ERROR) {
+            return NJS_ERROR;
+        }
+
+        ngx_memory_barrier();
+
+        if (rc == NGX_OK && sh->seq == seq) {
+            return NJS_OK;
+        }
+    }
+
+    /* the table is changed too often, read it under the lock */
+
+    ngx_shmtx_lock(&dict->shpool->mutex);
+
+    rc = ngx_js_dict_value(vm, dict, &key, hash, 1, njs_vm_retval(vm));
+
+    ngx_shmtx_unlock(&dict->shpool->mutex);
+
+    return (rc == NGX_OK) ? NJS_OK : NJS_ERROR;
+}
+
+
+static njs_int_t
+ngx_js_ext_dict_set(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    u_char              *p;
+    double               num;
+    uint32_t             hash, type;
+    njs_str_t            key, str;
+    ngx_msec_t           timeout;
+    njs_value_t         *value;
+    ngx_js_dict_t       *dict;
+    ngx_js_dict_sh_t    *sh;
+    ngx_js_dict_node_t  *node, *old;
+
+    dict = njs_vm_external(vm, njs_arg(args, nargs, 0));
+    if (dict == NULL) {
+        njs_vm_error(vm, "\"this\" is not a shared dict");
+        return NJS_ERROR;
+    }
+
+    if (ngx_js_dict_key(vm, njs_arg(args, nargs, 1), &key) != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    value = njs_arg(args, nargs, 2);
+
+    if (njs_value_is_number(value)) {
+        type = NGX_JS_DICT_NUMBER;
+        num = njs_value_number(value);
+        str.start = (u_char *) &num;
+        str.length = sizeof(double);
+
+    } else {
+        type = NGX_JS_DICT_STRING;
+
+        if (njs_vm_value_to_string(vm, &str, value) == NJS_ERROR) {
+            return NJS_ERROR;
+        }
+    }
+
+    if (ngx_js_dict_timeout(vm, dict, njs_arg(args, nargs, 3), &timeout)
+        != NJS_OK)
+    {
+        return NJS_ERROR;
+    }
+
+    sh = dict->sh;
+    hash = ngx_crc32_short(key.start, key.length);
+
+    ngx_shmtx_lock(&dict->shpool->mutex);
+
+    sh->seq++;
+    ngx_memory_barrier();
+
+    /*
+     * The old node is hidden from eviction while the new one is allocated,
+     * and is kept if the new value does not fit in the zone.
+     */
+
+    old = ngx_js_dict_find(dict, &key, hash);
+    if (old != NULL) {
+        ngx_queue_remove(&old->queue);
+    }
+
+    node = ngx_js_dict_alloc(dict, offsetof(ngx_js_dict_node_t, data)
+                                   + key.length + str.length);
+
+    if (old != NULL) {
+        ngx_queue_insert_head(&sh->queue, &old->queue);
+
+        if (node != NULL) {
+            ngx_js_dict_remove(dict, old);
+        }
+    }
+
+    if (node != NULL) {
+        node->expire = (timeout != 0) ? ngx_current_msec + timeout : 0;
+        node->hash = hash;
+        node->type = type;
+        node->key_len = key.length;
+        node->value_len = str.length;
+
+        p = ngx_cpymem(node->data, key.start, key.length);
+        ngx_memcpy(p, str.start, str.length);
+
+        node->next = sh->buckets[hash % sh->nbuckets];
+        sh->buckets[hash % sh->nbuckets] = node;
+
+        ngx_queue_insert_tail(&sh->queue, &node->queue);
+    }
+
+    ngx_memory_barrier();
+    sh->seq++;
+
+    ngx_shmtx_unlock(&dict->shpool->mutex);
+
+    if (node == NULL) {
+        njs_vm_error(vm, "no memory in js shared dict zone \"%V\"",
+                     &dict->name);
+        return NJS_ERROR;
+    }
+
+    njs_vm_retval_set(vm, njs_arg(args, nargs, 0));
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+ngx_js_ext_dict_incr(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    u_char              *p;
+    double               num, delta;
+    uint32_t             hash;
+    njs_str_t            key;
+    ngx_int_t            rc;
+    ngx_msec_t           timeout;
+    njs_value_t         *value;
+    ngx_js_dict_t       *dict;
+    ngx_js_dict_sh_t    *sh;
+    ngx_js_dict_node_t  *node;
+
+    dict = njs_vm_external(vm, njs_arg(args, nargs, 0));
+    if (dict == NULL) {
+        njs_vm_error(vm, "\"this\" is not a shared dict");
+        return NJS_ERROR;
+    }
+
+    if (ngx_js_dict_key(vm, njs_arg(args, nargs, 1), &key) != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    value = njs_arg(args, nargs, 2);
+    if (!njs_value_is_number(value)) {
+        njs_vm_error(vm, "delta is not a number");
+        return NJS_ERROR;
+    }
+
+    delta = njs_value_number(value);
+
+    value = njs_arg(args, nargs, 3);
+
+    if (njs_value_is_undefined(value)) {
+        num = 0;
+
+    } else if (njs_value_is_number(value)) {
+        num = njs_value_number(value);
+
+    } else {
+        njs_vm_error(vm, "init is not a number");
+        return NJS_ERROR;
+    }
+
+    if (ngx_js_dict_timeout(vm, dict, njs_arg(args, nargs, 4), &timeout)
+        != NJS_OK)
+    {
+        return NJS_ERROR;
+    }
+
+    sh = dict->sh;
+    hash = ngx_crc32_short(key.start, key.length);
+
+    ngx_shmtx_lock(&dict->shpool->mutex);
+
+    sh->seq++;
+    ngx_memory_barrier();
+
+    rc = NGX_OK;
+
+    node = ngx_js_dict_find(dict, &key, hash);
+
+    if (node != NULL) {
+        if (node->type != NGX_JS_DICT_NUMBER) {
+            rc = NGX_DECLINED;
+            goto done;
+        }
+
+        /* the expiration time is kept */
+
+        p = node->data + node->key_len;
+
+        ngx_memcpy(&num, p, sizeof(double));
+        num += delta;
+        ngx_memcpy(p, &num, sizeof(double));
+
+        ngx_queue_remove(&node->queue);
+        ngx_queue_insert_tail(&sh->queue, &node->queue);
+
+        goto done;
+    }
+
+    node = ngx_js_dict_alloc(dict, offsetof(ngx_js_dict_node_t, data)
+                                   + key.length + sizeof(double));
+    if (node == NULL) {
+        rc = NGX_ERROR;
+        goto done;
+    }
+
+    num += delta;
+
+    node->expire = (timeout != 0) ? ngx_current_msec + timeout : 0;
+    node->hash = hash;
+    node->type = NGX_JS_DICT_NUMBER;
+    node->key_len = key.length;
+    node->value_len = sizeof(double);
+
+    p = ngx_cpymem(node->data, key.start, key.length);
+    ngx_memcpy(p, &num, sizeof(double));
+
+    node->next = sh->buckets[hash % sh->nbuckets];
+    sh->buckets[hash % sh->nbuckets] = node;
+
+    ngx_queue_insert_tail(&sh->queue, &node->queue);
+
+done:
+
+    ngx_memory_barrier();
+    sh->seq++;
+
+    ngx_shmtx_unlock(&dict->shpool->mutex);
+
+    if (rc == NGX_DECLINED) {
+        njs_vm_error(vm, "value is not a number");
+        return NJS_ERROR;
+    }
+
+    if (rc == NGX_ERROR) {
+        njs_vm_error(vm, "no memory in js shared dict zone \"%V\"",
+                     &dict->name);
+        return NJS_ERROR;
+    }
+
+    njs_value_number_set(njs_vm_retval(vm), num);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+ngx_js_ext_dict_delete(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    uint32_t             hash;
+    njs_str_t            key;
+    ngx_js_dict_t       *dict;
+    ngx_js_dict_sh_t    *sh;
+    ngx_js_dict_node_t  *node;
+
+    dict = njs_vm_external(vm, njs_arg(args, nargs, 0));
+    if (dict == NULL) {
+        njs_vm_error(vm, "\"this\" is not a shared dict");
+        return NJS_ERROR;
+    }
+
+    if (ngx_js_dict_key(vm, njs_arg(args, nargs, 1), &key) != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    sh = dict->sh;
+    hash = ngx_crc32_short(key.start, key.length);
+
+    ngx_shmtx_lock(&dict->shpool->mutex);
+
+    sh->seq++;
+    ngx_memory_barrier();
+
+    node = ngx_js_dict_find(dict, &key, hash);
+    if (node != NULL) {
+        ngx_js_dict_remove(dict, node);
+    }
+
+    ngx_memory_barrier();
+    sh->seq++;
+
+    ngx_shmtx_unlock(&dict->shpool->mutex);
+
+    njs_value_boolean_set(njs_vm_retval(vm), node != NULL);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+ngx_js_dict_key(njs_vm_t *vm, njs_value_t *value, njs_str_t *key)
+{
+    if (njs_vm_value_to_string(vm, key, value) == NJS_ERROR) {
+        return NJS_ERROR;
+    }
+
+    if (key->length == 0) {
+        njs_vm_error(vm, "empty key");
+        return NJS_ERROR;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+ngx_js_dict_timeout(njs_vm_t *vm, ngx_js_dict_t *dict, njs_value_t *value,
+    ngx_msec_t *timeout)
+{
+    double  num;
+
+    if (njs_value_is_undefined(value)) {
+        *timeout = dict->timeout;
+        return NJS_OK;
+    }
+
+    if (!njs_value_is_number(value)) {
+        njs_vm_error(vm, "timeout is not a number");
+        return NJS_ERROR;
+    }
+
+    num = njs_value_number(value);
+
+    if (!(num >= 0 && num <= NGX_MAX_INT32_VALUE)) {
+        njs_vm_error(vm, "invalid timeout");
+        return NJS_ERROR;
+    }
+
+    *timeout = (ngx_msec_t) num;
+
+    return NJS_OK;
+}
+
+
+/*
+ * Copies the value of the key into retval, returns NGX_AGAIN if the table
+ * looked inconsistent, which is possible only when it is read unlocked.
+ */
+
+static ngx_int_t
+ngx_js_dict_value(njs_vm_t *vm, ngx_js_dict_t *dict, njs_str_t *key,
+    uint32_t hash, ngx_uint_t locked, njs_value_t *retval)
+{
+    u_char              *start, *end;
+    double               num;
+    uint32_t             key_len, value_len, type;
+    ngx_msec_t           expire;
+    ngx_uint_t           n;
+    ngx_js_dict_sh_t    *sh;
+    ngx_js_dict_node_t  *node;
+
+    sh = dict->sh;
+
+    start = dict->shm_zone->shm.addr;
+    end = start + dict->shm_zone->shm.size;
+
+    node = sh->buckets[hash % sh->nbuckets];
+
+    for (n = 0; node != NULL; n++) {
+
+        if ((u_char *) node < start
+            || (u_char *) node > end - sizeof(ngx_js_dict_node_t)
+            || (!locked && n == NGX_JS_DICT_MAX_CHAIN))
+        {
+            return NGX_AGAIN;
+        }
+
+        key_len = node->key_len;
+        value_len = node->value_len;
+
+        if ((size_t) key_len + value_len > (size_t) (end - node->data)) {
+            return NGX_AGAIN;
+        }
+
+        if (node->hash == hash
+            && key_len == key->length
+            && ngx_memcmp(node->data, key->start, key_len) == 0)
+        {
+            break;
+        }
+
+        node = node->next;
+    }
+
+    if (node == NULL) {
+        njs_value_undefined_set(retval);
+        return NGX_OK;
+    }
+
+    expire = node->expire;
+
+    if (expire != 0 && (ngx_msec_int_t) (expire - ngx_current_msec) <= 0) {
+        njs_value_undefined_set(retval);
+        return NGX_OK;
+    }
+
+    type = node->type;
+
+    if (type == NGX_JS_DICT_NUMBER) {
+        if (value_len != sizeof(double)) {
+            return NGX_AGAIN;
+        }
+
+        ngx_memcpy(&num, node->data + key_len, sizeof(double));
+        njs_value_number_set(retval, num);
+
+        return NGX_OK;
+    }
+
+    /*
+     * The string is copied, the node can be freed or reused as soon as
+     * the zone is unlocked or the sequence is changed.
+     */
+
+    if (njs_vm_value_string_create(vm, retval, node->data + key_len,
+                                   value_len)
+        != NJS_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_js_dict_node_t *
+ngx_js_dict_find(ngx_js_dict_t *dict, njs_str_t *key, uint32_t hash)
+{
+    ngx_js_dict_sh_t    *sh;
+    ngx_js_dict_node_t  *node;
+
+    sh = dict->sh;
+
+    for (node = sh->buckets[hash % sh->nbuckets];
+         node != NULL;
+         node = node->next)
+    {
+        if (node->hash == hash
+            && node->key_len == key->length
+            && ngx_memcmp(node->data, key->start, key->length) == 0)
+        {
+            break;
+        }
+    }
+
+    if (node != NULL
+        && node->expire != 0
+        && (ngx_msec_int_t) (node->expire - ngx_current_msec) <= 0)
+    {
+        ngx_js_dict_remove(dict, node);
+        return NULL;
+    }
+
+    return node;
+}
+
+
+/*
+ * When the zone is full, the expired nodes among the oldest ones
+ * are freed first, then the least recently written ones are evicted.
+ */
+
+static ngx_js_dict_node_t *
+ngx_js_dict_alloc(ngx_js_dict_t *dict, size_t size)
+{
+    ngx_queue_t         *q;
+    ngx_js_dict_node_t  *node;
+
+    node = ngx_slab_alloc_locked(dict->shpool, size);
+    if (node != NULL) {
+        return node;
+    }
+
+    ngx_js_dict_expire(dict, NGX_JS_DICT_EXPIRE);
+
+    for ( ;; ) {
+        node = ngx_slab_alloc_locked(dict->shpool, size);
+        if (node != NULL) {
+            return node;
+        }
+
+        if (ngx_queue_empty(&dict->sh->queue)) {
+            return NULL;
+        }
+
+        q = ngx_queue_head(&dict->sh->queue);
+        node = ngx_queue_data(q, ngx_js_dict_node_t, queue);
+
+        ngx_js_dict_remove(dict, node);
+    }
+}
+
+
+static void
+ngx_js_dict_expire(ngx_js_dict_t *dict, ngx_uint_t n)
+{
+    ngx_queue_t         *q;
+    ngx_js_dict_node_t  *node;
+
+    q = ngx_queue_head(&dict->sh->queue);
+
+    while (n-- != 0 && q != ngx_queue_sentinel(&dict->sh->queue)) {
+        node = ngx_queue_data(q, ngx_js_dict_node_t, queue);
+        q = ngx_queue_next(q);
+
+        if (node->expire != 0
+            && (ngx_msec_int_t) (node->expire - ngx_current_msec) <= 0)
+        {
+            ngx_js_dict_remove(dict, node);
+        }
+    }
+}
+
+
+static void
+ngx_js_dict_remove(ngx_js_dict_t *dict, ngx_js_dict_node_t *node)
+{
+    ngx_js_dict_sh_t     *sh;
+    ngx_js_dict_node_t  **p;
+
+    sh = dict->sh;
+
+    for (p = &sh->buckets[node->hash % sh->nbuckets];
+         *p != node;
+         p = &(*p)->next)
+    {
+        /* void */
+    }
+
+    *p = node->next;
+
+    ngx_queue_remove(&node->queue);
+
+    ngx_slab_free_locked(dict->shpool, node);
+}
+
+
+static ngx_int_t
+ngx_js_dict_init_zone(ngx_shm_zone_t *shm_zone, void *data)
+{
+    ngx_js_dict_t  *prev = data;
+
+    size_t          len;
+    ngx_uint_t      n;
+    ngx_js_dict_t  *dict;
+
+    dict = shm_zone->data;
+
+    if (prev) {
+        dict->sh = prev->sh;
+        dict->shpool = prev->shpool;
+        return NGX_OK;
+    }
+
+    dict->shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+    if (shm_zone->shm.exists) {
+        dict->sh = dict->shpool->data;
+        return NGX_OK;
+    }
+
+    dict->sh = ngx_slab_alloc(dict->shpool, sizeof(ngx_js_dict_sh_t));
+    if (dict->sh == NULL) {
+        return NGX_ERROR;
+    }
+
+    dict->shpool->data = dict->sh;
+
+    n = ngx_max(shm_zone->shm.size / 256, 64);
+
+    dict->sh->buckets = ngx_slab_calloc(dict->shpool,
+                                        n * sizeof(ngx_js_dict_node_t *));
+    if (dict->sh->buckets == NULL) {
+        return NGX_ERROR;
+    }
+
+    dict->sh->seq = 0;
+    dict->sh->nbuckets = n;
+    ngx_queue_init(&dict->sh->queue);
+
+    len = sizeof(" in js shared dict zone \"\"") + shm_zone->shm.name.len;
+
+    dict->shpool->log_ctx = ngx_slab_alloc(dict->shpool, len);
+    if (dict->shpool->log_ctx == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_sprintf(dict->shpool->log_ctx, " in js shared dict zone \"%V\"%Z",
+                &shm_zone->shm.name);
+
+    dict->shpool->log_nomem = 0;
+
+    return NGX_OK;
+}
+
+
+njs_int_t
+ngx_js_shared_dict_init(njs_vm_t *vm, ngx_js_dicts_t *dicts)
+{
+    njs_external_proto_t  proto;
+
+    proto = njs_vm_external_prototype(vm, ngx_js_ext_shared_dict,
+                                      njs_nitems(ngx_js_ext_shared_dict));
+    if (proto == NULL) {
+        return NJS_ERROR;
+    }
+
+    dicts->proto = proto;
+
+    return NJS_OK;
+}
+
+
+/*
+ * js_shared_dict_zone zone=name:size [timeout=time];
+ *
+ * The tag of the zone is the module the directive belongs to.
+ */
+
+char *
+ngx_js_shared_dict_zone(ngx_conf_t *cf, ngx_command_t *cmd,
+    ngx_js_dicts_t *dicts, void *tag)
+{
+    u_char          *p;
+    ssize_t          size;
+    ngx_str_t       *value, name, s;
+    ngx_int_t        timeout;
+    ngx_uint_t       i;
+    ngx_shm_zone_t  *shm_zone;
+    ngx_js_dict_t   *dict, **pdict;
+
+    value = cf->args->elts;
+
+    size = 0;
+    timeout = 0;
+    name.len = 0;
+
+    for (i = 1; i < cf->args->nelts; i++) {
+
+        if (ngx_strncmp(value[i].data, "zone=", 5) == 0) {
+
+            name.data = value[i].data + 5;
+
+            p = (u_char *) ngx_strchr(name.data, ':');
+
+            if (p == NULL) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid zone size \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            name.len = p - name.data;
+
+            s.data = p + 1;
+            s.len = value[i].data + value[i].len - s.data;
+
+            size = ngx_parse_size(&s);
+
+            if (size == NGX_ERROR) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid zone size \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            if (size < (ssize_t) (8 * ngx_pagesize)) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "zone \"%V\" is too small", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "timeout=", 8) == 0) {
+
+            s.data = value[i].data + 8;
+            s.len = value[i].len - 8;
+
+            timeout = ngx_parse_time(&s, 0);
+
+            if (timeout == NGX_ERROR) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid timeout value \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "invalid parameter \"%V\"", &value[i]);
+        return NGX_CONF_ERROR;
+    }
+
+    if (name.len == 0) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "\"%V\" must have \"zone\" parameter",
+                           &cmd->name);
+        return NGX_CONF_ERROR;
+    }
+
+    dict = ngx_pcalloc(cf->pool, sizeof(ngx_js_dict_t));
+    if (dict == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    shm_zone = ngx_shared_memory_add(cf, &name, size, tag);
+    if (shm_zone == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    if (shm_zone->data) {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0, "duplicate zone \"%V\"",
+                           &name);
+        return NGX_CONF_ERROR;
+    }
+
+    dict->name = name;
+    dict->timeout = timeout;
+    dict->shm_zone = shm_zone;
+
+    shm_zone->init = ngx_js_dict_init_zone;
+    shm_zone->data = dict;
+
+    if (dicts->zones == NGX_CONF_UNSET_PTR) {
+        dicts->zones = ngx_array_create(cf->pool, 4, sizeof(ngx_js_dict_t *));
+        if (dicts->zones == NULL) {
+            return NGX_CONF_ERROR;
+        }
+    }
+
+    pdict = ngx_array_push(dicts->zones);
+    if (pdict == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
+    *pdict = dict;
+
+    return NGX_CONF_OK;
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#ifndef _NGX_JS_SHARED_DICT_H_INCLUDED_
+#define _NGX_JS_SHARED_DICT_H_INCLUDED_
+
+
+typedef struct {
+    ngx_array_t           *zones;
+    njs_external_proto_t   proto;
+} ngx_js_dicts_t;
+
+
+char *ngx_js_shared_dict_zone(ngx_conf_t *cf, ngx_command_t *cmd,
+    ngx_js_dicts_t *dicts, void *tag);
+njs_int_t ngx_js_shared_dict_init(njs_vm_t *vm, ngx_js_dicts_t *dicts);
+
+njs_int_t ngx_js_ext_shared(njs_vm_t *vm, njs_object_prop_t *prop,
+    njs_value_t *value, njs_value_t *setval, njs_value_t *retval);
+njs_int_t ngx_js_ext_keys_shared(njs_vm_t *vm, njs_value_t *value,
+    njs_value_t *keys);
+
+
+#endif /* _NGX_JS_SHARED_DICT_H_INCLUDED_ */
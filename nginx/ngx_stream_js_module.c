@@ -12,6 +12,13 @@
 
 #include <njs.h>
 
+#include "ngx_js_bytecode.h"
+#include "ngx_js_shared_dict.h"
+
+
+#define NGX_STREAM_JS_VM_POOL_SIZE  16
+#define NGX_STREAM_JS_VM_POOL_HEAP  (1024 * 1024)
+
 
 typedef struct {
     njs_vm_t              *vm;
@@ -20,10 +27,23 @@ typedef struct {
     ngx_uint_t             line;
     ngx_array_t           *imports;
     ngx_array_t           *paths;
+    ngx_flag_t             snapshot;
+    ngx_str_t              bytecode_cache;
+    size_t                 gc_threshold;
     njs_external_proto_t   proto;
+    ngx_js_dicts_t         dicts;
+    ngx_array_t           *funcs;
+    ngx_uint_t             nvms;
+    njs_vm_t              *vms[NGX_STREAM_JS_VM_POOL_SIZE];
 } ngx_stream_js_main_conf_t;
 
 
+typedef struct {
+    ngx_str_t              name;
+    njs_function_handle_t *handle;
+} ngx_stream_js_func_t;
+
+
 typedef struct {
     ngx_str_t              name;
     ngx_str_t              path;
@@ -33,27 +53,28 @@ typedef struct {
 
 
 typedef struct {
-    ngx_str_t              access;
-    ngx_str_t              preread;
-    ngx_str_t              filter;
+    ngx_stream_js_func_t   access;
+    ngx_stream_js_func_t   preread;
+    ngx_stream_js_func_t   filter;
 } ngx_stream_js_srv_conf_t;
 
 
 typedef struct {
-    njs_vm_t               *vm;
-    ngx_log_t              *log;
-    njs_opaque_value_t      args[3];
-    ngx_buf_t              *buf;
-    ngx_chain_t           **last_out;
-    ngx_chain_t            *free;
-    ngx_chain_t            *busy;
-    ngx_stream_session_t   *session;
-    ngx_int_t               status;
-    njs_vm_event_t          upload_event;
-    njs_vm_event_t          download_event;
-    unsigned                from_upstream:1;
-    unsigned                filter:1;
-    unsigned                in_progress:1;
+    njs_vm_t                   *vm;
+    ngx_stream_js_main_conf_t  *main_conf;
+    ngx_log_t                  *log;
+    njs_opaque_value_t          args[3];
+    ngx_buf_t                  *buf;
+    ngx_chain_t               **last_out;
+    ngx_chain_t                *free;
+    ngx_chain_t                *busy;
+    ngx_stream_session_t       *session;
+    ngx_int_t                   status;
+    njs_vm_event_t              upload_event;
+    njs_vm_event_t              download_event;
+    unsigned                    from_upstream:1;
+    unsigned                    filter:1;
+    unsigned                    in_progress:1;
 } ngx_stream_js_ctx_t;
 
 
@@ -68,12 +89,14 @@ typedef struct {
 static ngx_int_t ngx_stream_js_access_handler(ngx_stream_session_t *s);
 static ngx_int_t ngx_stream_js_preread_handler(ngx_stream_session_t *s);
 static ngx_int_t ngx_stream_js_phase_handler(ngx_stream_session_t *s,
-    ngx_str_t *name);
+    ngx_stream_js_func_t *jf);
 static ngx_int_t ngx_stream_js_body_filter(ngx_stream_session_t *s,
     ngx_chain_t *in, ngx_uint_t from_upstream);
 static ngx_int_t ngx_stream_js_variable(ngx_stream_session_t *s,
     ngx_stream_variable_value_t *v, uintptr_t data);
 static ngx_int_t ngx_stream_js_init_vm(ngx_stream_session_t *s);
+static njs_vm_t *ngx_stream_js_get_vm(ngx_stream_js_main_conf_t *jmcf,
+    ngx_stream_session_t *s);
 static void ngx_stream_js_cleanup_ctx(void *data);
 static void ngx_stream_js_cleanup_vm(void *data);
 static njs_int_t ngx_stream_js_buffer_arg(ngx_stream_session_t *s,
@@ -113,12 +136,20 @@ static void ngx_stream_js_handle_event(ngx_stream_session_t *s,
 static njs_int_t ngx_stream_js_string(njs_vm_t *vm, njs_value_t *value,
     njs_str_t *str);
 
+static void ngx_stream_js_gc(ngx_stream_js_ctx_t *ctx);
+
 static char *ngx_stream_js_include(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
 static char *ngx_stream_js_import(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_stream_js_shared_dict_zone(ngx_conf_t *cf,
+    ngx_command_t *cmd, void *conf);
 static char *ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd,
     void *conf);
+static char *ngx_stream_js_func(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+static ngx_int_t ngx_stream_js_func_add(ngx_conf_t *cf,
+    ngx_stream_js_func_t *jf, ngx_str_t *name);
 static void *ngx_stream_js_create_main_conf(ngx_conf_t *cf);
 static char *ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf);
 static void *ngx_stream_js_create_srv_conf(ngx_conf_t *cf);
@@ -150,6 +181,34 @@ static ngx_command_t  ngx_stream_js_commands[] = {
       offsetof(ngx_stream_js_main_conf_t, paths),
       NULL },
 
+    { ngx_string("js_snapshot"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, snapshot),
+      NULL },
+
+    { ngx_string("js_bytecode_cache"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_str_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, bytecode_cache),
+      NULL },
+
+    { ngx_string("js_shared_dict_zone"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE12,
+      ngx_stream_js_shared_dict_zone,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("js_gc_threshold"),
+      NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_size_slot,
+      NGX_STREAM_MAIN_CONF_OFFSET,
+      offsetof(ngx_stream_js_main_conf_t, gc_threshold),
+      NULL },
+
     { ngx_string("js_set"),
       NGX_STREAM_MAIN_CONF|NGX_CONF_TAKE2,
       ngx_stream_js_set,
@@ -159,21 +218,21 @@ static ngx_command_t  ngx_stream_js_commands[] = {
 
     { ngx_string("js_access"),
       NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_TAKE1,
-      ngx_conf_set_str_slot,
+      ngx_stream_js_func,
       NGX_STREAM_SRV_CONF_OFFSET,
       offsetof(ngx_stream_js_srv_conf_t, access),
       NULL },
 
     { ngx_string("js_preread"),
       NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_TAKE1,
-      ngx_conf_set_str_slot,
+      ngx_stream_js_func,
       NGX_STREAM_SRV_CONF_OFFSET,
       offsetof(ngx_stream_js_srv_conf_t, preread),
       NULL },
 
     { ngx_string("js_filter"),
       NGX_STREAM_MAIN_CONF|NGX_STREAM_SRV_CONF|NGX_CONF_TAKE1,
-      ngx_conf_set_str_slot,
+      ngx_stream_js_func,
       NGX_STREAM_SRV_CONF_OFFSET,
       offsetof(ngx_stream_js_srv_conf_t, filter),
       NULL },
@@ -359,6 +418,30 @@ static njs_external_t  ngx_stream_js_ext_session[] = {
 };
 
 
+static njs_external_t  ngx_stream_js_ext_ngx[] = {
+
+    {
+        .flags = NJS_EXTERN_PROPERTY | NJS_EXTERN_SYMBOL,
+        .name.symbol = NJS_SYMBOL_TO_STRING_TAG,
+        .u.property = {
+            .value = "ngx",
+        }
+    },
+
+    {
+        .flags = NJS_EXTERN_OBJECT,
+        .name.string = njs_str("shared"),
+        .enumerable = 1,
+        .u.object = {
+            .enumerable = 1,
+            .prop_handler = ngx_js_ext_shared,
+            .keys = ngx_js_ext_keys_shared,
+        }
+    },
+
+};
+
+
 static njs_vm_ops_t ngx_stream_js_ops = {
     ngx_stream_js_set_timer,
     ngx_stream_js_clear_timer
@@ -397,16 +480,16 @@ ngx_stream_js_preread_handler(ngx_stream_session_t *s)
 
 
 static ngx_int_t
-ngx_stream_js_phase_handler(ngx_stream_session_t *s, ngx_str_t *name)
+ngx_stream_js_phase_handler(ngx_stream_session_t *s, ngx_stream_js_func_t *jf)
 {
-    njs_str_t             fname, exception;
+    njs_str_t             exception;
     njs_int_t             ret;
     ngx_int_t             rc;
     njs_function_t       *func;
     ngx_connection_t     *c;
     ngx_stream_js_ctx_t  *ctx;
 
-    if (name->len == 0) {
+    if (jf->name.len == 0) {
         return NGX_DECLINED;
     }
 
@@ -418,19 +501,16 @@ ngx_stream_js_phase_handler(ngx_stream_session_t *s, ngx_str_t *name)
     c = s->connection;
 
     ngx_log_debug1(NGX_LOG_DEBUG_STREAM, c->log, 0,
-                   "stream js phase call \"%V\"", name);
+                   "stream js phase call \"%V\"", &jf->name);
 
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
 
     if (!ctx->in_progress) {
-        fname.start = name->data;
-        fname.length = name->len;
-
-        func = njs_vm_function(ctx->vm, &fname);
+        func = njs_vm_handle_function(ctx->vm, jf->handle);
 
         if (func == NULL) {
             ngx_log_error(NGX_LOG_ERR, c->log, 0,
-                          "js function \"%V\" not found", name);
+                          "js function \"%V\" not found", &jf->name);
             return NGX_ERROR;
         }
 
@@ -467,6 +547,8 @@ ngx_stream_js_phase_handler(ngx_stream_session_t *s, ngx_str_t *name)
         }
     }
 
+    ngx_stream_js_gc(ctx);
+
     if (njs_vm_pending(ctx->vm)) {
         ctx->in_progress = 1;
         rc = ctx->upload_event ? NGX_AGAIN : NGX_DONE;
@@ -500,7 +582,7 @@ static ngx_int_t
 ngx_stream_js_body_filter(ngx_stream_session_t *s, ngx_chain_t *in,
     ngx_uint_t from_upstream)
 {
-    njs_str_t                  name, exception;
+    njs_str_t                  exception;
     njs_int_t                  ret;
     ngx_int_t                  rc;
     ngx_chain_t               *out, *cl;
@@ -510,7 +592,7 @@ ngx_stream_js_body_filter(ngx_stream_session_t *s, ngx_chain_t *in,
     ngx_stream_js_srv_conf_t  *jscf;
 
     jscf = ngx_stream_get_module_srv_conf(s, ngx_stream_js_module);
-    if (jscf->filter.len == 0) {
+    if (jscf->filter.name.len == 0) {
         return ngx_stream_next_filter(s, in, from_upstream);
     }
 
@@ -532,14 +614,12 @@ ngx_stream_js_body_filter(ngx_stream_session_t *s, ngx_chain_t *in,
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
 
     if (!ctx->filter) {
-        name.start = jscf->filter.data;
-        name.length = jscf->filter.len;
-
-        func = njs_vm_function(ctx->vm, &name);
+        func = njs_vm_handle_function(ctx->vm, jscf->filter.handle);
 
         if (func == NULL) {
             ngx_log_error(NGX_LOG_ERR, c->log, 0,
-                          "js function \"%V\" not found", &jscf->filter);
+                          "js function \"%V\" not found",
+                          &jscf->filter.name);
             return NGX_ERROR;
         }
 
@@ -605,6 +685,8 @@ ngx_stream_js_body_filter(ngx_stream_session_t *s, ngx_chain_t *in,
         rc = NGX_OK;
     }
 
+    ngx_stream_js_gc(ctx);
+
     return rc;
 
 exception:
@@ -622,11 +704,11 @@ static ngx_int_t
 ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
     uintptr_t data)
 {
-    ngx_str_t *fname = (ngx_str_t *) data;
+    ngx_stream_js_func_t *jf = (ngx_stream_js_func_t *) data;
 
     ngx_int_t             rc;
     njs_int_t             pending;
-    njs_str_t             name, value, exception;
+    njs_str_t             value, exception;
     njs_function_t       *func;
     ngx_stream_js_ctx_t  *ctx;
 
@@ -642,17 +724,14 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
     }
 
     ngx_log_debug1(NGX_LOG_DEBUG_STREAM, s->connection->log, 0,
-                   "stream js variable call \"%V\"", fname);
+                   "stream js variable call \"%V\"", &jf->name);
 
     ctx = ngx_stream_get_module_ctx(s, ngx_stream_js_module);
 
-    name.start = fname->data;
-    name.length = fname->len;
-
-    func = njs_vm_function(ctx->vm, &name);
+    func = njs_vm_handle_function(ctx->vm, jf->handle);
     if (func == NULL) {
         ngx_log_error(NGX_LOG_ERR, s->connection->log, 0,
-                      "js function \"%V\" not found", fname);
+                      "js function \"%V\" not found", &jf->name);
         v->not_found = 1;
         return NGX_OK;
     }
@@ -675,15 +754,24 @@ ngx_stream_js_variable(ngx_stream_session_t *s, ngx_stream_variable_value_t *v,
 
     if (!pending && njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, s->connection->log, 0,
-                      "async operation inside \"%V\" variable handler", fname);
+                      "async operation inside \"%V\" variable handler",
+                      &jf->name);
+        return NGX_ERROR;
+    }
+
+    /* The value is copied, the VM heap may be collected before it is used. */
+
+    v->data = ngx_pnalloc(s->connection->pool, value.length);
+    if (v->data == NULL) {
         return NGX_ERROR;
     }
 
+    ngx_memcpy(v->data, value.start, value.length);
+
     v->len = value.length;
     v->valid = 1;
     v->no_cacheable = 0;
     v->not_found = 0;
-    v->data = value.start;
 
     return NGX_OK;
 }
@@ -718,7 +806,7 @@ ngx_stream_js_init_vm(ngx_stream_session_t *s)
         return NGX_OK;
     }
 
-    ctx->vm = njs_vm_clone(jmcf->vm, s);
+    ctx->vm = ngx_stream_js_get_vm(jmcf, s);
     if (ctx->vm == NULL) {
         return NGX_ERROR;
     }
@@ -728,6 +816,7 @@ ngx_stream_js_init_vm(ngx_stream_session_t *s)
         return NGX_ERROR;
     }
 
+    ctx->main_conf = jmcf;
     ctx->log = s->connection->log;
 
     cln->handler = ngx_stream_js_cleanup_ctx;
@@ -752,11 +841,35 @@ ngx_stream_js_init_vm(ngx_stream_session_t *s)
 }
 
 
+static njs_vm_t *
+ngx_stream_js_get_vm(ngx_stream_js_main_conf_t *jmcf, ngx_stream_session_t *s)
+{
+    njs_vm_t  *vm;
+
+    /* A VM left by a previous session is reset instead of a new clone. */
+
+    while (jmcf->nvms != 0) {
+        vm = jmcf->vms[--jmcf->nvms];
+
+        if (njs_vm_reset(vm, s) == NJS_OK) {
+            return vm;
+        }
+
+        njs_vm_destroy(vm);
+    }
+
+    return njs_vm_clone(jmcf->vm, s);
+}
+
+
 static void
 ngx_stream_js_cleanup_ctx(void *data)
 {
     ngx_stream_js_ctx_t *ctx = data;
 
+    njs_vm_stat_t               stat;
+    ngx_stream_js_main_conf_t  *jmcf;
+
     if (ctx->upload_event != NULL) {
         njs_vm_del_event(ctx->vm, ctx->upload_event);
         ctx->upload_event = NULL;
@@ -769,18 +882,38 @@ ngx_stream_js_cleanup_ctx(void *data)
 
     if (njs_vm_pending(ctx->vm)) {
         ngx_log_error(NGX_LOG_ERR, ctx->log, 0, "pending events");
+
+        /* The host events of the session must be released right now. */
+
+        njs_vm_destroy(ctx->vm);
+        return;
     }
 
-    njs_vm_destroy(ctx->vm);
+    jmcf = ctx->main_conf;
+
+    njs_vm_stat(ctx->vm, &stat);
+
+    if (jmcf->nvms == NGX_STREAM_JS_VM_POOL_SIZE
+        || stat.heap_size > NGX_STREAM_JS_VM_POOL_HEAP)
+    {
+        njs_vm_destroy(ctx->vm);
+        return;
+    }
+
+    jmcf->vms[jmcf->nvms++] = ctx->vm;
 }
 
 
 static void
 ngx_stream_js_cleanup_vm(void *data)
 {
-    njs_vm_t *vm = data;
+    ngx_stream_js_main_conf_t *jmcf = data;
+
+    while (jmcf->nvms != 0) {
+        njs_vm_destroy(jmcf->vms[--jmcf->nvms]);
+    }
 
-    njs_vm_destroy(vm);
+    njs_vm_destroy(jmcf->vm);
 }
 
 
@@ -1332,14 +1465,32 @@ ngx_stream_js_handle_event(ngx_stream_session_t *s, njs_vm_event_t vm_event,
                       "js exception: %*s", exception.length, exception.start);
 
         ngx_stream_finalize_session(s, NGX_STREAM_INTERNAL_SERVER_ERROR);
+        return;
     }
 
+    ngx_stream_js_gc(ctx);
+
     if (rc == NJS_OK) {
         ngx_post_event(s->connection->read, &ngx_posted_events);
     }
 }
 
 
+static void
+ngx_stream_js_gc(ngx_stream_js_ctx_t *ctx)
+{
+    /* The buffers sent by s.send() point to the VM strings. */
+
+    if (ctx->busy != NULL) {
+        return;
+    }
+
+    if (njs_vm_gc(ctx->vm, njs_value_arg(&ctx->args), 3) == NJS_ERROR) {
+        ngx_log_error(NGX_LOG_ERR, ctx->log, 0, "js gc failed");
+    }
+}
+
+
 static njs_int_t
 ngx_stream_js_string(njs_vm_t *vm, njs_value_t *value, njs_str_t *str)
 {
@@ -1376,10 +1527,12 @@ ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
     ngx_pool_cleanup_t      *cln;
     njs_opaque_value_t       lvalue, exception;
     njs_external_proto_t     proto;
+    ngx_stream_js_func_t   **jf;
     ngx_stream_js_import_t  *import;
 
     static const njs_str_t line_number_key = njs_str("lineNumber");
     static const njs_str_t file_name_key = njs_str("fileName");
+    static const njs_str_t ngx_name = njs_str("ngx");
 
     if (jmcf->include.len == 0 && jmcf->imports == NGX_CONF_UNSET_PTR) {
         return NGX_CONF_OK;
@@ -1472,6 +1625,10 @@ ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
     options.argv = ngx_argv;
     options.argc = ngx_argc;
 
+    if (jmcf->gc_threshold != NGX_CONF_UNSET_SIZE) {
+        options.gc_threshold = jmcf->gc_threshold;
+    }
+
     if (jmcf->include.len != 0) {
         file = jmcf->include;
 
@@ -1494,7 +1651,7 @@ ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
     }
 
     cln->handler = ngx_stream_js_cleanup_vm;
-    cln->data = jmcf->vm;
+    cln->data = jmcf;
 
     path.start = ngx_cycle->conf_prefix.data;
     path.length = ngx_cycle->conf_prefix.len;
@@ -1534,9 +1691,41 @@ ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
     }
 
     jmcf->proto = proto;
+
+    if (jmcf->dicts.zones != NGX_CONF_UNSET_PTR) {
+        if (ngx_js_shared_dict_init(jmcf->vm, &jmcf->dicts) != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to add js shared dict proto");
+            return NGX_CONF_ERROR;
+        }
+
+        proto = njs_vm_external_prototype(jmcf->vm, ngx_stream_js_ext_ngx,
+                                          njs_nitems(ngx_stream_js_ext_ngx));
+        if (proto == NULL) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to add js ngx proto");
+            return NGX_CONF_ERROR;
+        }
+
+        rc = njs_vm_external_create(jmcf->vm, njs_value_arg(&lvalue), proto,
+                                    &jmcf->dicts, 1);
+        if (rc != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to create js ngx object");
+            return NGX_CONF_ERROR;
+        }
+
+        rc = njs_vm_bind(jmcf->vm, &ngx_name, njs_value_arg(&lvalue), 1);
+        if (rc != NJS_OK) {
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                          "failed to bind js ngx object");
+            return NGX_CONF_ERROR;
+        }
+    }
+
     end = start + size;
 
-    rc = njs_vm_compile(jmcf->vm, &start, end);
+    rc = ngx_js_compile(cf, jmcf->vm, &jmcf->bytecode_cache, &start, end);
 
     if (rc != NJS_OK) {
         njs_value_assign(&exception, njs_vm_retval(jmcf->vm));
@@ -1579,6 +1768,41 @@ ngx_stream_js_init_main_conf(ngx_conf_t *cf, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (jmcf->snapshot == 1) {
+        rc = njs_vm_snapshot(jmcf->vm);
+
+        if (rc == NJS_ERROR) {
+            njs_vm_retval_string(jmcf->vm, &text);
+
+            ngx_log_error(NGX_LOG_EMERG, cf->log, 0, "js exception: %*s",
+                          text.length, text.start);
+            return NGX_CONF_ERROR;
+        }
+
+        if (rc == NJS_DECLINED) {
+            ngx_log_error(NGX_LOG_WARN, cf->log, 0,
+                          "js heap cannot be snapshotted, "
+                          "the global code will run for each session");
+        }
+    }
+
+    if (jmcf->funcs != NGX_CONF_UNSET_PTR) {
+        jf = jmcf->funcs->elts;
+
+        for (i = 0; i < jmcf->funcs->nelts; i++) {
+            path.start = jf[i]->name.data;
+            path.length = jf[i]->name.len;
+
+            jf[i]->handle = njs_vm_function_handle(jmcf->vm, &path);
+            if (jf[i]->handle == NULL) {
+                ngx_log_error(NGX_LOG_EMERG, cf->log, 0,
+                              "invalid js function name \"%V\"",
+                              &jf[i]->name);
+                return NGX_CONF_ERROR;
+            }
+        }
+    }
+
     return NGX_CONF_OK;
 }
 
@@ -1708,10 +1932,21 @@ ngx_stream_js_import(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 }
 
 
+static char *
+ngx_stream_js_shared_dict_zone(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_stream_js_main_conf_t *jmcf = conf;
+
+    return ngx_js_shared_dict_zone(cf, cmd, &jmcf->dicts,
+                                   &ngx_stream_js_module);
+}
+
+
 static char *
 ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
-    ngx_str_t              *value, *fname;
+    ngx_str_t              *value;
+    ngx_stream_js_func_t   *jf;
     ngx_stream_variable_t  *v;
 
     value = cf->args->elts;
@@ -1730,20 +1965,81 @@ ngx_stream_js_set(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
-    fname = ngx_palloc(cf->pool, sizeof(ngx_str_t));
-    if (fname == NULL) {
+    jf = ngx_pcalloc(cf->pool, sizeof(ngx_stream_js_func_t));
+    if (jf == NULL) {
         return NGX_CONF_ERROR;
     }
 
-    *fname = value[2];
+    if (ngx_stream_js_func_add(cf, jf, &value[2]) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
 
     v->get_handler = ngx_stream_js_variable;
-    v->data = (uintptr_t) fname;
+    v->data = (uintptr_t) jf;
+
+    return NGX_CONF_OK;
+}
+
+
+static char *
+ngx_stream_js_func(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    char  *p = conf;
+
+    ngx_str_t             *value;
+    ngx_stream_js_func_t  *jf;
+
+    jf = (ngx_stream_js_func_t *) (p + cmd->offset);
+
+    if (jf->name.data) {
+        return "is duplicate";
+    }
+
+    value = cf->args->elts;
+
+    if (ngx_stream_js_func_add(cf, jf, &value[1]) != NGX_OK) {
+        return NGX_CONF_ERROR;
+    }
 
     return NGX_CONF_OK;
 }
 
 
+/*
+ * The functions are resolved to handles when the script is compiled
+ * in ngx_stream_js_init_main_conf(), the handles are valid in the cloned
+ * VMs and spare the lookup of the function by its name on every call.
+ */
+
+static ngx_int_t
+ngx_stream_js_func_add(ngx_conf_t *cf, ngx_stream_js_func_t *jf,
+    ngx_str_t *name)
+{
+    ngx_stream_js_func_t       **p;
+    ngx_stream_js_main_conf_t   *jmcf;
+
+    jmcf = ngx_stream_conf_get_module_main_conf(cf, ngx_stream_js_module);
+
+    if (jmcf->funcs == NGX_CONF_UNSET_PTR) {
+        jmcf->funcs = ngx_array_create(cf->pool, 4,
+                                       sizeof(ngx_stream_js_func_t *));
+        if (jmcf->funcs == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    p = ngx_array_push(jmcf->funcs);
+    if (p == NULL) {
+        return NGX_ERROR;
+    }
+
+    jf->name = *name;
+    *p = jf;
+
+    return NGX_OK;
+}
+
+
 static void *
 ngx_stream_js_create_main_conf(ngx_conf_t *cf)
 {
@@ -1759,13 +2055,20 @@ ngx_stream_js_create_main_conf(ngx_conf_t *cf)
      *
      *     conf->vm = NULL;
      *     conf->include = { 0, NULL };
+     *     conf->bytecode_cache = { 0, NULL };
      *     conf->file = NULL;
      *     conf->line = 0;
      *     conf->proto = NULL;
+     *     conf->dicts.proto = NULL;
+     *     conf->nvms = 0;
      */
 
     conf->paths = NGX_CONF_UNSET_PTR;
     conf->imports = NGX_CONF_UNSET_PTR;
+    conf->dicts.zones = NGX_CONF_UNSET_PTR;
+    conf->funcs = NGX_CONF_UNSET_PTR;
+    conf->snapshot = NGX_CONF_UNSET;
+    conf->gc_threshold = NGX_CONF_UNSET_SIZE;
 
     return conf;
 }
@@ -1784,9 +2087,9 @@ ngx_stream_js_create_srv_conf(ngx_conf_t *cf)
     /*
      * set by ngx_pcalloc():
      *
-     *     conf->access = { 0, NULL };
-     *     conf->preread = { 0, NULL };
-     *     conf->filter = { 0, NULL };
+     *     conf->access = { { 0, NULL }, NULL };
+     *     conf->preread = { { 0, NULL }, NULL };
+     *     conf->filter = { { 0, NULL }, NULL };
      */
 
     return conf;
@@ -1799,9 +2102,19 @@ ngx_stream_js_merge_srv_conf(ngx_conf_t *cf, void *parent, void *child)
     ngx_stream_js_srv_conf_t *prev = parent;
     ngx_stream_js_srv_conf_t *conf = child;
 
-    ngx_conf_merge_str_value(conf->access, prev->access, "");
-    ngx_conf_merge_str_value(conf->preread, prev->preread, "");
-    ngx_conf_merge_str_value(conf->filter, prev->filter, "");
+    /* the handles are already resolved, they are merged with the names */
+
+    if (conf->access.name.data == NULL) {
+        conf->access = prev->access;
+    }
+
+    if (conf->preread.name.data == NULL) {
+        conf->preread = prev->preread;
+    }
+
+    if (conf->filter.name.data == NULL) {
+        conf->filter = prev->filter;
+    }
 
     return NGX_CONF_OK;
 }
@@ -29,6 +29,8 @@ typedef struct njs_function_s       njs_function_t;
 typedef struct njs_vm_shared_s      njs_vm_shared_t;
 typedef struct njs_object_prop_s    njs_object_prop_t;
 typedef struct njs_external_s       njs_external_t;
+typedef struct njs_profiler_s       njs_profiler_t;
+typedef struct njs_function_handle_s njs_function_handle_t;
 typedef void *                      njs_external_proto_t;
 
 /*
@@ -195,6 +197,13 @@ typedef struct {
     char                            **argv;
     njs_uint_t                      argc;
 
+    /*
+     * The heap size in bytes which enables njs_vm_gc().  The next
+     * collection happens when the heap doubles or reaches the threshold.
+     * Zero disables the garbage collector.
+     */
+    size_t                          gc_threshold;
+
 /*
  * accumulative - enables "accumulative" mode to support incremental compiling.
  *  (REPL). Allows starting parent VM without cloning.
@@ -206,6 +215,9 @@ typedef struct {
  * unsafe       - enables unsafe language features:
  *   - Function constructors.
  * module       - ES6 "module" mode. Script mode is default.
+ * arena        - clones allocate memory by bumping a pointer and free it
+ *   only when destroyed or reset. Suits short-lived clones, the garbage
+ *   collector is disabled for them.
  */
 
     uint8_t                         trailer;         /* 1 bit */
@@ -217,15 +229,68 @@ typedef struct {
     uint8_t                         sandbox;         /* 1 bit */
     uint8_t                         unsafe;          /* 1 bit */
     uint8_t                         module;          /* 1 bit */
+    uint8_t                         arena;           /* 1 bit */
 } njs_vm_opt_t;
 
 
+typedef struct {
+    uint64_t                        property_cache_hits;
+    uint64_t                        property_cache_misses;
+    uint64_t                        heap_size;
+    uint64_t                        gc_runs;
+    uint64_t                        gc_freed;
+} njs_vm_stat_t;
+
+
 NJS_EXPORT void njs_vm_opt_init(njs_vm_opt_t *options);
 NJS_EXPORT njs_vm_t *njs_vm_create(njs_vm_opt_t *options);
 NJS_EXPORT void njs_vm_destroy(njs_vm_t *vm);
 
 NJS_EXPORT njs_int_t njs_vm_compile(njs_vm_t *vm, u_char **start, u_char *end);
+
+/*
+ * Compiles the script and saves the generated code into bytecode allocated
+ * from the VM memory pool.
+ *   NJS_OK the script is compiled and the bytecode is saved.
+ *   NJS_DECLINED the script is compiled, but its code cannot be saved.
+ *   NJS_ERROR the script is not compiled as in njs_vm_compile().
+ */
+NJS_EXPORT njs_int_t njs_vm_compile_save(njs_vm_t *vm, u_char **start,
+    u_char *end, njs_str_t *bytecode);
+
+/*
+ * Loads the code of the script from the bytecode saved by
+ * njs_vm_compile_save() instead of compiling the script.
+ *   NJS_OK the code is loaded, *start is set to end.
+ *   NJS_DECLINED the bytecode does not match the script, the njs build,
+ *     the VM options or imported modules, the VM is not changed and
+ *     the script should be compiled with njs_vm_compile().
+ *   NJS_ERROR memory error.
+ */
+NJS_EXPORT njs_int_t njs_vm_compile_load(njs_vm_t *vm, u_char **start,
+    u_char *end, const njs_str_t *bytecode);
 NJS_EXPORT njs_vm_t *njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external);
+/*
+ * Returns a clone to the state njs_vm_clone() has left it in, so that
+ * the clone can be reused instead of being destroyed and cloned again.
+ * The memory of the clone is kept for the next use.
+ *   NJS_OK the clone is reset.
+ *   NJS_ERROR the VM is not a clone or memory error, the VM should
+ *     be destroyed.
+ */
+NJS_EXPORT njs_int_t njs_vm_reset(njs_vm_t *vm, njs_external_ptr_t external);
+
+/*
+ * Runs the global code once and keeps the resulting heap, so that clones
+ * of the VM start with initialized global variables and do not run
+ * the global code again in njs_vm_start().
+ *   NJS_OK the snapshot is taken.
+ *   NJS_DECLINED the heap cannot be copied to clones, clones run
+ *     the global code as usual.
+ *   NJS_ERROR some exception or internal error happens.
+ *     njs_vm_retval(vm) can be used to get the exception value.
+ */
+NJS_EXPORT njs_int_t njs_vm_snapshot(njs_vm_t *vm);
 
 NJS_EXPORT njs_vm_event_t njs_vm_add_event(njs_vm_t *vm,
     njs_function_t *function, njs_uint_t once, njs_host_event_t host_ev,
@@ -246,6 +311,45 @@ NJS_EXPORT njs_int_t njs_vm_posted(njs_vm_t *vm);
 
 #define njs_vm_pending(vm)  (njs_vm_waiting(vm) || njs_vm_posted(vm))
 
+/*
+ * Returns the VM runtime statistics: inline property cache hits and misses,
+ * the heap size, the number of garbage collections and the freed size.
+ */
+NJS_EXPORT void njs_vm_stat(njs_vm_t *vm, njs_vm_stat_t *stat);
+
+/*
+ * Frees the VM heap memory which is not reachable from the VM and from
+ * the provided values held by the host.  Must be called between events,
+ * when no njs code is running.  Any other pointers to the VM heap kept
+ * by the host, except njs_vm_event_t, are invalidated.
+ *   NJS_OK the heap is collected.
+ *   NJS_DECLINED the heap is below the gc_threshold option.
+ *   NJS_ERROR memory error, nothing is freed.
+ */
+NJS_EXPORT njs_int_t njs_vm_gc(njs_vm_t *vm, const njs_value_t *roots,
+    njs_uint_t nroots);
+
+/*
+ * The sampling profiler collects the stacks of JavaScript functions run
+ * by the VMs it is set to, clones inherit the profiler of the parent VM.
+ * The host calls njs_profiler_tick() periodically, e.g. from a SIGPROF
+ * handler, the function is async-signal-safe.  Functions are named and
+ * located only if the VMs are created with the backtrace option.
+ */
+NJS_EXPORT njs_profiler_t *njs_profiler_create(void);
+NJS_EXPORT void njs_profiler_destroy(njs_profiler_t *profiler);
+NJS_EXPORT void njs_vm_set_profiler(njs_vm_t *vm, njs_profiler_t *profiler);
+NJS_EXPORT void njs_profiler_tick(void);
+
+/*
+ * Returns the collected samples in the collapsed stacks format, a line
+ * for each stack from the outermost function with its number of ticks:
+ *   main;handler (main.js:10);parse (main.js:3) 42
+ * The report is allocated from the profiler memory.
+ */
+NJS_EXPORT njs_int_t njs_profiler_report(njs_profiler_t *profiler,
+    njs_str_t *report);
+
 
 /*
  * Runs the specified function with provided arguments.
@@ -291,7 +395,7 @@ NJS_EXPORT njs_function_t *njs_vm_function_alloc(njs_vm_t *vm,
     njs_function_native_t native);
 
 NJS_EXPORT void njs_disassembler(njs_vm_t *vm);
-NJS_EXPORT void njs_disassemble(u_char *start, u_char *end);
+NJS_EXPORT njs_uint_t njs_disassemble(u_char *start, u_char *end);
 
 NJS_EXPORT njs_int_t njs_vm_bind(njs_vm_t *vm, const njs_str_t *var_name,
     const njs_value_t *value, njs_bool_t shared);
@@ -299,6 +403,19 @@ NJS_EXPORT njs_int_t njs_vm_value(njs_vm_t *vm, const njs_str_t *path,
     njs_value_t *retval);
 NJS_EXPORT njs_function_t *njs_vm_function(njs_vm_t *vm, const njs_str_t *name);
 
+/*
+ * A function handle keeps a path like the one njs_vm_function() takes
+ * with the name of the global variable resolved to its scope index.
+ * The handle is created once for a compiled VM and is valid for the VM
+ * and its clones, the lookup by the handle avoids parsing the path and
+ * searching the variable by the name.  The handle is allocated from
+ * the VM memory, the VM must not be garbage collected.
+ */
+NJS_EXPORT njs_function_handle_t *njs_vm_function_handle(njs_vm_t *vm,
+    const njs_str_t *path);
+NJS_EXPORT njs_function_t *njs_vm_handle_function(njs_vm_t *vm,
+    const njs_function_handle_t *handle);
+
 NJS_EXPORT njs_value_t *njs_vm_retval(njs_vm_t *vm);
 NJS_EXPORT void njs_vm_retval_set(njs_vm_t *vm, const njs_value_t *value);
 
@@ -312,6 +429,20 @@ NJS_EXPORT njs_int_t njs_vm_value_string_set(njs_vm_t *vm, njs_value_t *value,
     const u_char *start, uint32_t size);
 NJS_EXPORT u_char *njs_vm_value_string_alloc(njs_vm_t *vm, njs_value_t *value,
     uint32_t size);
+/*
+ * Sets a string value.
+ *   start data is copied, the string is a byte string if the data
+ *   is not valid UTF-8.
+ */
+NJS_EXPORT njs_int_t njs_vm_value_string_create(njs_vm_t *vm,
+    njs_value_t *value, const u_char *start, uint32_t size);
+/*
+ * Sets an ArrayBuffer value.
+ *   start data is not copied and should not be freed while the value
+ *   is in use, the script may modify the data.
+ */
+NJS_EXPORT njs_int_t njs_vm_value_array_buffer_set(njs_vm_t *vm,
+    njs_value_t *value, const u_char *start, uint32_t size);
 NJS_EXPORT njs_int_t njs_vm_value_string_copy(njs_vm_t *vm, njs_str_t *retval,
     njs_value_t *value, uintptr_t *next);
 
@@ -66,6 +66,7 @@ njs_array_alloc(njs_vm_t *vm, njs_bool_t flat, uint64_t length, uint32_t spare)
     array->object.shared_hash = vm->shared->array_instance_hash;
     array->object.__proto__ = &vm->prototypes[NJS_OBJ_TYPE_ARRAY].object;
     array->object.slots = NULL;
+    array->object.shape = NULL;
     array->object.type = NJS_ARRAY;
     array->object.shared = 0;
     array->object.extensible = 1;
@@ -3044,50 +3045,212 @@ unexpected_args:
 }
 
 
+typedef struct {
+    njs_value_t     value;
+    njs_value_t     str;
+} njs_array_sort_slot_t;
+
+
+typedef struct {
+    njs_vm_t        *vm;
+    njs_function_t  *function;
+} njs_array_sort_ctx_t;
+
+
+#define NJS_ARRAY_SORT_RUN  8
+
+
+/*
+ * Sets "gt" if the slot "a" must be placed after the slot "b".
+ * The comparison function may be called reentrantly, because
+ * the slots are sorted in a private copy of the array.
+ */
+
 static njs_int_t
-njs_array_string_sort(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
-    njs_index_t unused)
+njs_array_sort_gt(njs_array_sort_ctx_t *ctx, njs_array_sort_slot_t *a,
+    njs_array_sort_slot_t *b, njs_bool_t *gt)
 {
-    njs_int_t   ret;
-    njs_uint_t  i;
+    double       num;
+    njs_int_t    ret;
+    njs_value_t  retval, arguments[3];
 
-    for (i = 1; i < nargs; i++) {
-        if (!njs_is_string(&args[i])) {
-            ret = njs_value_to_string(vm, &args[i], &args[i]);
-            if (ret != NJS_OK) {
+    if (ctx->function == NULL) {
+        *gt = (njs_string_cmp(&a->str, &b->str) > 0);
+        return NJS_OK;
+    }
+
+    njs_set_undefined(&arguments[0]);
+    arguments[1] = a->value;
+    arguments[2] = b->value;
+
+    ret = njs_function_apply(ctx->vm, ctx->function, arguments, 3, &retval);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    ret = njs_value_to_number(ctx->vm, &retval, &num);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    *gt = (num > 0);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_array_sort_run(njs_array_sort_ctx_t *ctx, njs_array_sort_slot_t *slots,
+    int64_t n)
+{
+    int64_t                i, j;
+    njs_int_t              ret;
+    njs_bool_t             gt;
+    njs_array_sort_slot_t  slot;
+
+    for (i = 1; i < n; i++) {
+        slot = slots[i];
+
+        for (j = i; j > 0; j--) {
+            ret = njs_array_sort_gt(ctx, &slots[j - 1], &slot, &gt);
+            if (njs_slow_path(ret != NJS_OK)) {
                 return ret;
             }
+
+            if (!gt) {
+                break;
+            }
+
+            slots[j] = slots[j - 1];
         }
+
+        slots[j] = slot;
     }
 
-    ret = njs_string_cmp(&args[1], &args[2]);
+    return NJS_OK;
+}
 
-    njs_set_number(&vm->retval, ret);
+
+static njs_int_t
+njs_array_sort_merge(njs_array_sort_ctx_t *ctx, njs_array_sort_slot_t *dst,
+    njs_array_sort_slot_t *src, int64_t mid, int64_t end)
+{
+    int64_t     i, j, k;
+    njs_int_t   ret;
+    njs_bool_t  gt;
+
+    ret = njs_array_sort_gt(ctx, &src[mid - 1], &src[mid], &gt);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    if (!gt) {
+        /* The runs are already in order. */
+        memcpy(dst, src, end * sizeof(njs_array_sort_slot_t));
+        return NJS_OK;
+    }
+
+    i = 0;
+    j = mid;
+    k = 0;
+
+    while (i < mid && j < end) {
+        ret = njs_array_sort_gt(ctx, &src[i], &src[j], &gt);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        /* The left slot goes first if equal, the sort is stable. */
+        dst[k++] = gt ? src[j++] : src[i++];
+    }
+
+    while (i < mid) {
+        dst[k++] = src[i++];
+    }
+
+    while (j < end) {
+        dst[k++] = src[j++];
+    }
 
     return NJS_OK;
 }
 
 
-static const njs_function_t  njs_array_string_sort_function = {
-    .object = { .type = NJS_FUNCTION, .shared = 1, .extensible = 1 },
-    .native = 1,
-    .args_offset = 1,
-    .u.native = njs_array_string_sort,
-};
+/*
+ * A bottom-up merge sort: short runs are sorted by insertion and then
+ * merged pairwise between the slots and the temporary buffer.
+ * Returns the array holding the result.
+ */
+
+static njs_array_sort_slot_t *
+njs_array_sort_slots(njs_array_sort_ctx_t *ctx, njs_array_sort_slot_t *slots,
+    njs_array_sort_slot_t *tmp, int64_t n)
+{
+    int64_t                i, width, mid, end;
+    njs_int_t              ret;
+    njs_array_sort_slot_t  *src, *dst, *t;
+
+    for (i = 0; i < n; i += NJS_ARRAY_SORT_RUN) {
+        ret = njs_array_sort_run(ctx, &slots[i],
+                                 njs_min(NJS_ARRAY_SORT_RUN, n - i));
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NULL;
+        }
+    }
+
+    src = slots;
+    dst = tmp;
+
+    for (width = NJS_ARRAY_SORT_RUN; width < n; width *= 2) {
+
+        for (i = 0; i < n; i += 2 * width) {
+            mid = njs_min(i + width, n);
+            end = njs_min(i + 2 * width, n);
+
+            if (mid == end) {
+                memcpy(&dst[i], &src[i],
+                       (end - i) * sizeof(njs_array_sort_slot_t));
+                continue;
+            }
+
+            ret = njs_array_sort_merge(ctx, &dst[i], &src[i], mid - i,
+                                       end - i);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return NULL;
+            }
+        }
+
+        t = src;
+        src = dst;
+        dst = t;
+    }
+
+    return src;
+}
 
 
 static njs_int_t
 njs_array_prototype_sort(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     njs_index_t unused)
 {
-    int64_t         n, index, length, current;
-    njs_int_t       ret;
-    njs_array_t     *array;
-    njs_value_t     retval, value, *this, *start, arguments[3];
-    njs_function_t  *function;
+    int64_t                i, n, und, length;
+    njs_int_t              ret;
+    njs_value_t            value, *this, *comparefn;
+    njs_array_t            *array;
+    njs_array_sort_ctx_t   ctx;
+    njs_array_sort_slot_t  *slots, *sorted;
 
     this = njs_argument(args, 0);
 
+    comparefn = njs_arg(args, nargs, 1);
+
+    if (njs_slow_path(!njs_is_undefined(comparefn)
+                      && !njs_is_function(comparefn)))
+    {
+        njs_type_error(vm, "comparefn must be callable or undefined");
+        return NJS_ERROR;
+    }
+
     ret = njs_value_to_object(vm, this);
     if (njs_slow_path(ret != NJS_OK)) {
         return ret;
@@ -3098,93 +3261,121 @@ njs_array_prototype_sort(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
         return ret;
     }
 
-    if (njs_slow_path(length == 0)) {
+    if (njs_slow_path(length < 2)) {
         vm->retval = *this;
         return NJS_OK;
     }
 
-    if (nargs > 1 && njs_is_function(&args[1])) {
-        function = njs_function(&args[1]);
+    ctx.vm = vm;
+    ctx.function = njs_is_function(comparefn) ? njs_function(comparefn) : NULL;
 
-    } else {
-        function = (njs_function_t *) &njs_array_string_sort_function;
+    if (njs_slow_path(length > UINT32_MAX)) {
+        njs_range_error(vm, "Invalid array length");
+        return NJS_ERROR;
     }
 
-    if (njs_slow_path(!njs_is_fast_array(this))) {
-        njs_internal_error(vm, "sort() is not implemented yet for objects");
+    slots = njs_mp_alloc(vm->mem_pool,
+                         2 * length * sizeof(njs_array_sort_slot_t));
+    if (njs_slow_path(slots == NULL)) {
+        njs_memory_error(vm);
         return NJS_ERROR;
     }
 
-    index = 0;
-    current = 0;
-    retval = njs_value_zero;
-    array = njs_array(&args[0]);
-    start = array->start;
+    /*
+     * The values are collected before sorting, undefined values and holes
+     * are not passed to the comparison function and go to the end.
+     */
 
-start:
+    n = 0;
+    und = 0;
 
-    if (njs_is_number(&retval)) {
+    for (i = 0; i < length; i++) {
+        if (njs_is_fast_array(this)
+            && i < njs_array_len(this)
+            && njs_is_valid(&njs_array_start(this)[i]))
+        {
+            value = njs_array_start(this)[i];
 
-        /*
-         * The sort function is implemented with the insertion sort algorithm.
-         * Its worst and average computational complexity is O^2.  This point
-         * should be considered as return point from comparison function so
-         * "goto next" moves control to the appropriate step of the algorithm.
-         * The first iteration also goes there because sort->retval is zero.
-         */
-        if (njs_number(&retval) <= 0) {
-            goto next;
-        }
+        } else {
+            ret = njs_value_property_i64(vm, this, i, &value);
+            if (njs_slow_path(ret == NJS_ERROR)) {
+                goto fail;
+            }
 
-        n = index;
+            if (ret != NJS_OK) {
+                continue;
+            }
+        }
 
-    swap:
+        if (njs_is_undefined(&value)) {
+            und++;
+            continue;
+        }
 
-        value = start[n];
-        start[n] = start[n - 1];
-        n--;
-        start[n] = value;
+        slots[n].value = value;
 
-        do {
-            if (n > 0) {
+        if (ctx.function == NULL) {
+            if (njs_is_string(&value)) {
+                slots[n].str = value;
 
-                if (njs_is_valid(&start[n])) {
+            } else {
+                ret = njs_value_to_string(vm, &slots[n].str, &value);
+                if (njs_slow_path(ret != NJS_OK)) {
+                    goto fail;
+                }
+            }
+        }
 
-                    if (njs_is_valid(&start[n - 1])) {
-                        njs_set_undefined(&arguments[0]);
+        n++;
+    }
 
-                        /* GC: array elt, array */
-                        arguments[1] = start[n - 1];
-                        arguments[2] = start[n];
+    sorted = njs_array_sort_slots(&ctx, slots, &slots[length], n);
+    if (njs_slow_path(sorted == NULL)) {
+        ret = NJS_ERROR;
+        goto fail;
+    }
 
-                        index = n;
+    array = njs_is_fast_array(this) ? njs_array(this) : NULL;
 
-                        ret = njs_function_apply(vm, function, arguments, 3,
-                                                 &retval);
+    for (i = 0; i < length; i++) {
+        if (i < n) {
+            value = sorted[i].value;
 
-                        if (njs_slow_path(ret != NJS_OK)) {
-                            return ret;
-                        }
+        } else if (i < n + und) {
+            njs_set_undefined(&value);
 
-                        goto start;
-                    }
+        } else {
+            njs_set_invalid(&value);
+        }
 
-                    /* Move invalid values to the end of array. */
-                    goto swap;
-                }
-            }
+        if (array != NULL && njs_is_fast_array(this) && i < array->length) {
+            array->start[i] = value;
+            continue;
+        }
 
-        next:
+        if (njs_is_valid(&value)) {
+            ret = njs_value_property_i64_set(vm, this, i, &value);
 
-            current++;
-            n = current;
+        } else {
+            ret = njs_value_property_i64_delete(vm, this, i, NULL);
+        }
 
-        } while (n < array->length);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto fail;
+        }
     }
 
-    vm->retval = args[0];
+    njs_mp_free(vm->mem_pool, slots);
+
+    vm->retval = *this;
 
     return NJS_OK;
+
+fail:
+
+    njs_mp_free(vm->mem_pool, slots);
+
+    return ret;
 }
 
 
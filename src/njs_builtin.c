@@ -70,9 +70,13 @@ static const njs_object_type_init_t *const
     &njs_date_type_init,
     &njs_promise_type_init,
     &njs_array_buffer_type_init,
+    &njs_map_type_init,
+    &njs_set_type_init,
 
     /* Hidden types. */
 
+    &njs_map_iterator_type_init,
+    &njs_set_iterator_type_init,
     &njs_hash_type_init,
     &njs_hmac_type_init,
     &njs_typed_array_type_init,
@@ -617,18 +621,27 @@ njs_vm_expression_completions(njs_vm_t *vm, njs_str_t *expression)
         lhq.key.length = p - lhq.key.start;
         lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
 
-        ret = njs_lvlhsh_find(njs_object_hash(value), &lhq);
-        if (njs_slow_path(ret != NJS_OK)) {
-            return NULL;
-        }
+        if (njs_object(value)->shape != NULL) {
+            ret = njs_shape_find(njs_object(value)->shape, &lhq);
+            if (njs_slow_path(ret == NJS_DECLINED)) {
+                return NULL;
+            }
 
-        prop = lhq.value;
+            value = &njs_object(value)->values[ret];
 
-        if (!njs_is_object(&prop->value)) {
-            return NULL;
+        } else {
+            ret = njs_lvlhsh_find(njs_object_hash(value), &lhq);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return NULL;
+            }
+
+            prop = lhq.value;
+            value = &prop->value;
         }
 
-        value = &prop->value;
+        if (!njs_is_object(value)) {
+            return NULL;
+        }
     }
 
     return njs_object_completions(vm, value);
@@ -1372,6 +1385,25 @@ static const njs_object_prop_t  njs_global_this_object_properties[] =
         .configurable = 1,
     },
 
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("Map"),
+        .value = njs_prop_handler2(njs_top_level_constructor,
+                                   NJS_OBJ_TYPE_MAP, NJS_MAP_HASH),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("Set"),
+        .value = njs_prop_handler2(njs_top_level_constructor,
+                                   NJS_OBJ_TYPE_SET,
+                                   NJS_SET_CONSTRUCTOR_HASH),
+        .writable = 1,
+        .configurable = 1,
+    },
+
     {
         .type = NJS_PROPERTY_HANDLER,
         .name = njs_string("Error"),
@@ -0,0 +1,2299 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+/* Field types of instructions. */
+
+#define NJS_BYTECODE_INDEX       1
+#define NJS_BYTECODE_LAMBDA      2
+#define NJS_BYTECODE_PATTERN     3
+#define NJS_BYTECODE_CACHE       4
+#define NJS_BYTECODE_STR         5
+
+/* Value tags. */
+
+#define NJS_BYTECODE_VALUE       0
+#define NJS_BYTECODE_STRING      1
+#define NJS_BYTECODE_FUNCTION    2
+
+/* Header flags. */
+
+#define NJS_BYTECODE_MODULE      1
+#define NJS_BYTECODE_SANDBOX     2
+#define NJS_BYTECODE_BACKTRACE   4
+#define NJS_BYTECODE_QUIET       8
+
+#define NJS_BYTECODE_FIELDS      4
+#define NJS_BYTECODE_HASH_SIZE   20
+
+
+typedef struct {
+    uint8_t                    type;
+    uint8_t                    offset;
+} njs_bytecode_field_t;
+
+
+typedef struct {
+    njs_vmcode_operation_t     operation;
+    uint8_t                    size;
+    njs_bytecode_field_t       fields[NJS_BYTECODE_FIELDS];
+} njs_bytecode_op_t;
+
+
+typedef struct {
+    u_char                     magic[4];
+    uint32_t                   version;
+    uint8_t                    pointer_size;
+    uint8_t                    value_size;
+    uint8_t                    flags;
+    uint8_t                    reserved;
+    u_char                     hash[NJS_BYTECODE_HASH_SIZE];
+} njs_bytecode_header_t;
+
+
+typedef struct {
+    uint32_t                   nargs;
+    uint32_t                   local_size;
+    uint32_t                   closure_size;
+    uint32_t                   code;
+    uint8_t                    nesting;
+    uint8_t                    block_closures;
+    uint8_t                    ctor;
+    uint8_t                    rest_parameters;
+} njs_bytecode_lambda_t;
+
+
+typedef struct {
+    void                       *pointer;
+    uint32_t                   id;
+} njs_bytecode_ref_t;
+
+
+/* A pointer to id map, the ids are indexes of the items array. */
+
+typedef struct {
+    njs_lvlhsh_t               hash;
+    njs_arr_t                  *items;     /* of void * */
+} njs_bytecode_table_t;
+
+
+typedef struct {
+    uint8_t                    type;
+    void                       *field;
+} njs_bytecode_extra_t;
+
+
+typedef struct {
+    njs_vm_t                   *vm;
+    njs_mp_t                   *pool;
+
+    njs_bytecode_table_t       constants;
+    njs_bytecode_table_t       lambdas;
+    njs_bytecode_table_t       codes;
+
+    njs_chb_t                  modules_chain;
+    njs_chb_t                  constants_chain;
+    njs_chb_t                  lambdas_chain;
+    njs_chb_t                  values_chain;
+    njs_chb_t                  codes_chain;
+    njs_chb_t                  scope_chain;
+    njs_chb_t                  debug_chain;
+
+    const njs_bytecode_op_t    *ops[256];
+} njs_bytecode_save_t;
+
+
+typedef struct {
+    njs_str_t                  name;
+    njs_index_t                index;
+    njs_module_t               *native;
+    uint32_t                   lambda;
+} njs_bytecode_module_t;
+
+
+typedef struct {
+    njs_vm_t                   *vm;
+    njs_mp_t                   *pool;
+
+    u_char                     *pos;
+    u_char                     *end;
+
+    njs_arr_t                  *modules;   /* of njs_bytecode_module_t */
+
+    uint32_t                   nconstants;
+    njs_value_t                **constants;
+
+    uint32_t                   nlambdas;
+    njs_function_lambda_t      **lambdas;
+    njs_function_t             **functions;
+    uint32_t                   *lambda_codes;
+
+    njs_arr_t                  *codes;     /* of njs_vm_code_t */
+
+    u_char                     *start;
+    njs_value_t                *global_scope;
+    size_t                     scope_size;
+    njs_rbtree_t               *variables;
+
+    njs_arr_t                  *debug;     /* of njs_function_debug_t */
+
+    const njs_bytecode_op_t    *ops[256];
+} njs_bytecode_load_t;
+
+
+static void njs_bytecode_ops(const njs_bytecode_op_t **ops);
+static const njs_bytecode_op_t *njs_bytecode_op(const njs_bytecode_op_t **ops,
+    u_char *p, u_char *end);
+static uint8_t njs_bytecode_flags(njs_vm_t *vm);
+static void njs_bytecode_hash(njs_vm_t *vm, const njs_str_t *source,
+    u_char *hash);
+static njs_int_t njs_bytecode_file_hash(const njs_str_t *file, u_char *hash);
+
+static njs_int_t njs_bytecode_table_init(njs_bytecode_save_t *save,
+    njs_bytecode_table_t *table);
+static njs_int_t njs_bytecode_table_id(njs_bytecode_save_t *save,
+    njs_bytecode_table_t *table, void *pointer, njs_bool_t insert,
+    uint32_t *id);
+static njs_int_t njs_bytecode_save_codes(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_code(njs_bytecode_save_t *save,
+    njs_vm_code_t *code);
+static njs_int_t njs_bytecode_save_modules(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_scope(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_debug(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_lambdas(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_constants(njs_bytecode_save_t *save);
+static njs_int_t njs_bytecode_save_values(njs_bytecode_save_t *save,
+    njs_chb_t *chain, const njs_value_t *values, size_t size);
+static njs_int_t njs_bytecode_save_value(njs_bytecode_save_t *save,
+    njs_chb_t *chain, const njs_value_t *value);
+
+static njs_int_t njs_bytecode_load_header(njs_bytecode_load_t *load,
+    const njs_str_t *source);
+static njs_int_t njs_bytecode_load_modules(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_constants(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_lambdas(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_codes(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_code(njs_bytecode_load_t *load,
+    u_char *start, u_char *end);
+static njs_int_t njs_bytecode_load_scope(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_debug(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_commit(njs_bytecode_load_t *load);
+static njs_int_t njs_bytecode_load_values(njs_bytecode_load_t *load,
+    njs_value_t *values, size_t size);
+static njs_int_t njs_bytecode_load_value(njs_bytecode_load_t *load,
+    njs_value_t *value);
+static njs_int_t njs_bytecode_load_primitive(njs_bytecode_load_t *load,
+    njs_value_t *value);
+static njs_int_t njs_bytecode_read(njs_bytecode_load_t *load, void *dst,
+    size_t size);
+static njs_int_t njs_bytecode_read_ref(njs_bytecode_load_t *load,
+    njs_str_t *str);
+static njs_int_t njs_bytecode_read_str(njs_bytecode_load_t *load,
+    njs_str_t *str);
+
+
+#define njs_bytecode_field(type, code, field)                                 \
+    { NJS_BYTECODE_ ## type, offsetof(code, field) }
+
+
+#define njs_bytecode_3addr(operation)                                         \
+    { operation, sizeof(njs_vmcode_3addr_t),                                  \
+      { njs_bytecode_field(INDEX, njs_vmcode_3addr_t, dst),                   \
+        njs_bytecode_field(INDEX, njs_vmcode_3addr_t, src1),                  \
+        njs_bytecode_field(INDEX, njs_vmcode_3addr_t, src2) } }
+
+
+#define njs_bytecode_2addr(operation)                                         \
+    { operation, sizeof(njs_vmcode_2addr_t),                                  \
+      { njs_bytecode_field(INDEX, njs_vmcode_2addr_t, dst),                   \
+        njs_bytecode_field(INDEX, njs_vmcode_2addr_t, src) } }
+
+
+#define njs_bytecode_1addr(operation, code, field)                            \
+    { operation, sizeof(code),                                                \
+      { njs_bytecode_field(INDEX, code, field) } }
+
+
+#define njs_bytecode_prop(operation, code)                                    \
+    { operation, sizeof(code),                                                \
+      { njs_bytecode_field(INDEX, code, value),                               \
+        njs_bytecode_field(INDEX, code, object),                              \
+        njs_bytecode_field(INDEX, code, property),                            \
+        njs_bytecode_field(CACHE, code, cache) } }
+
+
+/*
+ * The instructions layout, the fields which are not listed are stored
+ * as is: jump offsets, counters and flags.
+ */
+
+static const njs_bytecode_op_t  njs_bytecode_ops_table[] = {
+
+    { NJS_VMCODE_STOP, sizeof(njs_vmcode_stop_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_stop_t, retval) } },
+
+    { NJS_VMCODE_JUMP, sizeof(njs_vmcode_jump_t), { { 0, 0 } } },
+
+    { NJS_VMCODE_IF_TRUE_JUMP, sizeof(njs_vmcode_cond_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_cond_jump_t, cond) } },
+
+    { NJS_VMCODE_IF_FALSE_JUMP, sizeof(njs_vmcode_cond_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_cond_jump_t, cond) } },
+
+    { NJS_VMCODE_IF_EQUAL_JUMP, sizeof(njs_vmcode_equal_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_equal_jump_t, value1),
+        njs_bytecode_field(INDEX, njs_vmcode_equal_jump_t, value2) } },
+
+    njs_bytecode_prop(NJS_VMCODE_PROPERTY_GET, njs_vmcode_prop_get_t),
+    njs_bytecode_prop(NJS_VMCODE_GLOBAL_GET, njs_vmcode_prop_get_t),
+    njs_bytecode_prop(NJS_VMCODE_PROPERTY_SET, njs_vmcode_prop_set_t),
+    njs_bytecode_prop(NJS_VMCODE_PROPERTY_INIT, njs_vmcode_prop_set_t),
+    njs_bytecode_prop(NJS_VMCODE_PROTO_INIT, njs_vmcode_prop_set_t),
+
+    { NJS_VMCODE_PROPERTY_ACCESSOR, sizeof(njs_vmcode_prop_accessor_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_prop_accessor_t, value),
+        njs_bytecode_field(INDEX, njs_vmcode_prop_accessor_t, object),
+        njs_bytecode_field(INDEX, njs_vmcode_prop_accessor_t, property) } },
+
+    { NJS_VMCODE_PROPERTY_FOREACH, sizeof(njs_vmcode_prop_foreach_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_prop_foreach_t, next),
+        njs_bytecode_field(INDEX, njs_vmcode_prop_foreach_t, object) } },
+
+    { NJS_VMCODE_PROPERTY_NEXT, sizeof(njs_vmcode_prop_next_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_prop_next_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_prop_next_t, object),
+        njs_bytecode_field(INDEX, njs_vmcode_prop_next_t, next) } },
+
+    { NJS_VMCODE_INSTANCE_OF, sizeof(njs_vmcode_instance_of_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_instance_of_t, value),
+        njs_bytecode_field(INDEX, njs_vmcode_instance_of_t, constructor),
+        njs_bytecode_field(INDEX, njs_vmcode_instance_of_t, object) } },
+
+    { NJS_VMCODE_FUNCTION_FRAME, sizeof(njs_vmcode_function_frame_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_function_frame_t, name) } },
+
+    { NJS_VMCODE_METHOD_FRAME, sizeof(njs_vmcode_method_frame_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_method_frame_t, object),
+        njs_bytecode_field(INDEX, njs_vmcode_method_frame_t, method) } },
+
+    njs_bytecode_1addr(NJS_VMCODE_FUNCTION_CALL, njs_vmcode_function_call_t,
+                       retval),
+    njs_bytecode_1addr(NJS_VMCODE_RETURN, njs_vmcode_return_t, retval),
+    njs_bytecode_1addr(NJS_VMCODE_THIS, njs_vmcode_this_t, dst),
+    njs_bytecode_1addr(NJS_VMCODE_ARGUMENTS, njs_vmcode_arguments_t, dst),
+    njs_bytecode_1addr(NJS_VMCODE_OBJECT, njs_vmcode_object_t, retval),
+    njs_bytecode_1addr(NJS_VMCODE_ARRAY, njs_vmcode_array_t, retval),
+    njs_bytecode_1addr(NJS_VMCODE_TEMPLATE_LITERAL,
+                       njs_vmcode_template_literal_t, retval),
+    njs_bytecode_1addr(NJS_VMCODE_THROW, njs_vmcode_throw_t, retval),
+
+    { NJS_VMCODE_FUNCTION, sizeof(njs_vmcode_function_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_function_t, retval),
+        njs_bytecode_field(LAMBDA, njs_vmcode_function_t, lambda) } },
+
+    { NJS_VMCODE_REGEXP, sizeof(njs_vmcode_regexp_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_regexp_t, retval),
+        njs_bytecode_field(PATTERN, njs_vmcode_regexp_t, pattern) } },
+
+    { NJS_VMCODE_OBJECT_COPY, sizeof(njs_vmcode_object_copy_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_object_copy_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_object_copy_t, object) } },
+
+    { NJS_VMCODE_TRY_START, sizeof(njs_vmcode_try_start_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_try_start_t, exception_value),
+        njs_bytecode_field(INDEX, njs_vmcode_try_start_t, exit_value) } },
+
+    njs_bytecode_1addr(NJS_VMCODE_TRY_BREAK, njs_vmcode_try_trampoline_t,
+                       exit_value),
+    njs_bytecode_1addr(NJS_VMCODE_TRY_CONTINUE, njs_vmcode_try_trampoline_t,
+                       exit_value),
+
+    { NJS_VMCODE_TRY_END, sizeof(njs_vmcode_try_end_t), { { 0, 0 } } },
+
+    { NJS_VMCODE_TRY_RETURN, sizeof(njs_vmcode_try_return_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_try_return_t, save),
+        njs_bytecode_field(INDEX, njs_vmcode_try_return_t, retval) } },
+
+    njs_bytecode_1addr(NJS_VMCODE_CATCH, njs_vmcode_catch_t, exception),
+
+    { NJS_VMCODE_FINALLY, sizeof(njs_vmcode_finally_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_finally_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_finally_t, exit_value) } },
+
+    { NJS_VMCODE_REFERENCE_ERROR, sizeof(njs_vmcode_reference_error_t),
+      { njs_bytecode_field(STR, njs_vmcode_reference_error_t, name),
+        njs_bytecode_field(STR, njs_vmcode_reference_error_t, file) } },
+
+    { NJS_VMCODE_MOVE, sizeof(njs_vmcode_move_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_move_t, dst),
+        njs_bytecode_field(INDEX, njs_vmcode_move_t, src) } },
+
+    njs_bytecode_3addr(NJS_VMCODE_INCREMENT),
+    njs_bytecode_3addr(NJS_VMCODE_POST_INCREMENT),
+    njs_bytecode_3addr(NJS_VMCODE_DECREMENT),
+    njs_bytecode_3addr(NJS_VMCODE_POST_DECREMENT),
+    njs_bytecode_3addr(NJS_VMCODE_LESS),
+    njs_bytecode_3addr(NJS_VMCODE_GREATER),
+    njs_bytecode_3addr(NJS_VMCODE_LESS_OR_EQUAL),
+    njs_bytecode_3addr(NJS_VMCODE_GREATER_OR_EQUAL),
+    njs_bytecode_3addr(NJS_VMCODE_ADDITION),
+    njs_bytecode_3addr(NJS_VMCODE_EQUAL),
+    njs_bytecode_3addr(NJS_VMCODE_NOT_EQUAL),
+    njs_bytecode_3addr(NJS_VMCODE_SUBSTRACTION),
+    njs_bytecode_3addr(NJS_VMCODE_MULTIPLICATION),
+    njs_bytecode_3addr(NJS_VMCODE_EXPONENTIATION),
+    njs_bytecode_3addr(NJS_VMCODE_DIVISION),
+    njs_bytecode_3addr(NJS_VMCODE_REMAINDER),
+    njs_bytecode_3addr(NJS_VMCODE_BITWISE_AND),
+    njs_bytecode_3addr(NJS_VMCODE_BITWISE_OR),
+    njs_bytecode_3addr(NJS_VMCODE_BITWISE_XOR),
+    njs_bytecode_3addr(NJS_VMCODE_LEFT_SHIFT),
+    njs_bytecode_3addr(NJS_VMCODE_RIGHT_SHIFT),
+    njs_bytecode_3addr(NJS_VMCODE_UNSIGNED_RIGHT_SHIFT),
+    njs_bytecode_3addr(NJS_VMCODE_PROPERTY_IN),
+    njs_bytecode_3addr(NJS_VMCODE_PROPERTY_DELETE),
+    njs_bytecode_3addr(NJS_VMCODE_STRICT_EQUAL),
+    njs_bytecode_3addr(NJS_VMCODE_STRICT_NOT_EQUAL),
+
+    { NJS_VMCODE_TEST_IF_TRUE, sizeof(njs_vmcode_test_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, value) } },
+
+    { NJS_VMCODE_TEST_IF_FALSE, sizeof(njs_vmcode_test_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, value) } },
+
+    { NJS_VMCODE_COALESCE, sizeof(njs_vmcode_test_jump_t),
+      { njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, retval),
+        njs_bytecode_field(INDEX, njs_vmcode_test_jump_t, value) } },
+
+    njs_bytecode_2addr(NJS_VMCODE_UNARY_PLUS),
+    njs_bytecode_2addr(NJS_VMCODE_UNARY_NEGATION),
+    njs_bytecode_2addr(NJS_VMCODE_BITWISE_NOT),
+    njs_bytecode_2addr(NJS_VMCODE_LOGICAL_NOT),
+    njs_bytecode_2addr(NJS_VMCODE_TYPEOF),
+    njs_bytecode_2addr(NJS_VMCODE_VOID),
+    njs_bytecode_2addr(NJS_VMCODE_DELETE),
+
+    njs_bytecode_3addr(NJS_VMCODE_LESS_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_GREATER_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_LESS_OR_EQUAL_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_GREATER_OR_EQUAL_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_EQUAL_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_NOT_EQUAL_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_STRICT_EQUAL_JUMP),
+    njs_bytecode_3addr(NJS_VMCODE_STRICT_NOT_EQUAL_JUMP),
+};
+
+
+static const njs_lvlhsh_proto_t  njs_bytecode_ref_proto;
+
+
+njs_int_t
+njs_bytecode_save(njs_vm_t *vm, const njs_str_t *source, njs_str_t *bytecode)
+{
+    u_char                 *p;
+    size_t                 size;
+    int64_t                n;
+    njs_int_t              ret;
+    njs_uint_t             i;
+    njs_chb_t              *chain;
+    njs_bytecode_save_t    save;
+    njs_bytecode_header_t  header;
+
+    /* The sections in the order of loading. */
+
+    njs_chb_t  *chains[] = {
+        &save.modules_chain,
+        &save.constants_chain,
+        &save.lambdas_chain,
+        &save.values_chain,
+        &save.codes_chain,
+        &save.scope_chain,
+        &save.debug_chain,
+    };
+
+    if (vm->options.accumulative || vm->codes == NULL || vm->start == NULL) {
+        return NJS_DECLINED;
+    }
+
+    njs_memzero(&save, sizeof(njs_bytecode_save_t));
+
+    save.vm = vm;
+
+    save.pool = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (njs_slow_path(save.pool == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (i = 0; i < njs_nitems(chains); i++) {
+        njs_chb_init(chains[i], save.pool);
+    }
+
+    ret = njs_bytecode_table_init(&save, &save.constants);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    ret = njs_bytecode_table_init(&save, &save.lambdas);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    ret = njs_bytecode_table_init(&save, &save.codes);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    njs_bytecode_ops(save.ops);
+
+    /*
+     * The lambdas are collected from the code and from the scopes,
+     * so they are saved after everything else but loaded before the code.
+     */
+
+    ret = njs_bytecode_save_codes(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_save_modules(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_save_scope(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_save_debug(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_save_lambdas(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_save_constants(&save);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    njs_memzero(&header, sizeof(njs_bytecode_header_t));
+
+    memcpy(header.magic, "NJSB", 4);
+    header.version = NJS_BYTECODE_VERSION;
+    header.pointer_size = sizeof(void *);
+    header.value_size = sizeof(njs_value_t);
+    header.flags = njs_bytecode_flags(vm);
+
+    njs_bytecode_hash(vm, source, header.hash);
+
+    size = sizeof(njs_bytecode_header_t);
+
+    for (i = 0; i < njs_nitems(chains); i++) {
+        n = njs_chb_size(chains[i]);
+        if (njs_slow_path(n < 0)) {
+            ret = NJS_ERROR;
+            goto done;
+        }
+
+        size += n;
+    }
+
+    p = njs_mp_alloc(vm->mem_pool, size);
+    if (njs_slow_path(p == NULL)) {
+        ret = NJS_ERROR;
+        goto done;
+    }
+
+    bytecode->start = p;
+    bytecode->length = size;
+
+    p = njs_cpymem(p, &header, sizeof(njs_bytecode_header_t));
+
+    for (i = 0; i < njs_nitems(chains); i++) {
+        chain = chains[i];
+
+        njs_chb_join_to(chain, p);
+        p += njs_chb_size(chain);
+    }
+
+    ret = NJS_OK;
+
+done:
+
+    njs_mp_destroy(save.pool);
+
+    if (ret == NJS_ERROR) {
+        njs_memory_error(vm);
+    }
+
+    return ret;
+}
+
+
+njs_int_t
+njs_bytecode_load(njs_vm_t *vm, const njs_str_t *source,
+    const njs_str_t *bytecode)
+{
+    njs_int_t            ret;
+    njs_bytecode_load_t  load;
+
+    if (vm->options.accumulative) {
+        return NJS_DECLINED;
+    }
+
+    njs_memzero(&load, sizeof(njs_bytecode_load_t));
+
+    load.vm = vm;
+    load.pos = bytecode->start;
+    load.end = bytecode->start + bytecode->length;
+
+    load.pool = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (njs_slow_path(load.pool == NULL)) {
+        return NJS_ERROR;
+    }
+
+    njs_bytecode_ops(load.ops);
+
+    /* The VM is changed only when the whole bytecode has been read. */
+
+    ret = njs_bytecode_load_header(&load, source);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_modules(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_constants(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_lambdas(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_codes(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_scope(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    ret = njs_bytecode_load_debug(&load);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    if (load.pos != load.end) {
+        ret = NJS_DECLINED;
+        goto done;
+    }
+
+    ret = njs_bytecode_load_commit(&load);
+
+done:
+
+    njs_mp_destroy(load.pool);
+
+    if (ret == NJS_ERROR) {
+        njs_memory_error(vm);
+    }
+
+    return ret;
+}
+
+
+static void
+njs_bytecode_ops(const njs_bytecode_op_t **ops)
+{
+    njs_uint_t  i;
+
+    njs_memzero(ops, 256 * sizeof(njs_bytecode_op_t *));
+
+    for (i = 0; i < njs_nitems(njs_bytecode_ops_table); i++) {
+        ops[njs_bytecode_ops_table[i].operation] = &njs_bytecode_ops_table[i];
+    }
+}
+
+
+njs_inline const njs_bytecode_op_t *
+njs_bytecode_op(const njs_bytecode_op_t **ops, u_char *p, u_char *end)
+{
+    const njs_bytecode_op_t  *op;
+
+    op = ops[((njs_vmcode_t *) p)->operation];
+
+    if (njs_slow_path(op == NULL || (size_t) (end - p) < op->size)) {
+        return NULL;
+    }
+
+    return op;
+}
+
+
+static uint8_t
+njs_bytecode_flags(njs_vm_t *vm)
+{
+    uint8_t  flags;
+
+    flags = 0;
+
+    if (vm->options.module) {
+        flags |= NJS_BYTECODE_MODULE;
+    }
+
+    if (vm->options.sandbox) {
+        flags |= NJS_BYTECODE_SANDBOX;
+    }
+
+    if (vm->debug != NULL) {
+        flags |= NJS_BYTECODE_BACKTRACE;
+    }
+
+    if (vm->options.quiet) {
+        flags |= NJS_BYTECODE_QUIET;
+    }
+
+    return flags;
+}
+
+
+static void
+njs_bytecode_hash(njs_vm_t *vm, const njs_str_t *source, u_char *hash)
+{
+    njs_sha1_t  ctx;
+
+    njs_sha1_init(&ctx);
+
+    njs_sha1_update(&ctx, NJS_VERSION, sizeof(NJS_VERSION));
+    njs_sha1_update(&ctx, vm->options.file.start, vm->options.file.length);
+    njs_sha1_update(&ctx, "", 1);
+    njs_sha1_update(&ctx, source->start, source->length);
+
+    njs_sha1_final(hash, &ctx);
+}
+
+
+static njs_int_t
+njs_bytecode_file_hash(const njs_str_t *file, u_char *hash)
+{
+    int         fd;
+    char        path[MAXPATHLEN];
+    u_char      buf[4096];
+    ssize_t     n;
+    njs_sha1_t  ctx;
+
+    if (file->length >= MAXPATHLEN) {
+        return NJS_DECLINED;
+    }
+
+    memcpy(path, file->start, file->length);
+    path[file->length] = '\0';
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NJS_DECLINED;
+    }
+
+    njs_sha1_init(&ctx);
+
+    for ( ;; ) {
+        n = read(fd, buf, sizeof(buf));
+
+        if (n <= 0) {
+            break;
+        }
+
+        njs_sha1_update(&ctx, buf, n);
+    }
+
+    (void) close(fd);
+
+    if (n < 0) {
+        return NJS_DECLINED;
+    }
+
+    njs_sha1_final(hash, &ctx);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_ref_test(njs_lvlhsh_query_t *lhq, void *data)
+{
+    njs_bytecode_ref_t  *ref;
+
+    ref = data;
+
+    if (*(void **) lhq->key.start == ref->pointer) {
+        return NJS_OK;
+    }
+
+    return NJS_DECLINED;
+}
+
+
+static const njs_lvlhsh_proto_t  njs_bytecode_ref_proto
+    njs_aligned(64) =
+{
+    NJS_LVLHSH_DEFAULT,
+    njs_bytecode_ref_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+static njs_int_t
+njs_bytecode_table_init(njs_bytecode_save_t *save, njs_bytecode_table_t *table)
+{
+    njs_lvlhsh_init(&table->hash);
+
+    table->items = njs_arr_create(save->pool, 16, sizeof(void *));
+    if (njs_slow_path(table->items == NULL)) {
+        return NJS_ERROR;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_table_id(njs_bytecode_save_t *save, njs_bytecode_table_t *table,
+    void *pointer, njs_bool_t insert, uint32_t *id)
+{
+    void                **item;
+    njs_int_t           ret;
+    njs_bytecode_ref_t  *ref;
+    njs_lvlhsh_query_t  lhq;
+
+    lhq.key.start = (u_char *) &pointer;
+    lhq.key.length = sizeof(void *);
+    lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &njs_bytecode_ref_proto;
+
+    if (njs_lvlhsh_find(&table->hash, &lhq) == NJS_OK) {
+        ref = lhq.value;
+        *id = ref->id;
+        return NJS_OK;
+    }
+
+    if (!insert) {
+        return NJS_DECLINED;
+    }
+
+    ref = njs_mp_alloc(save->pool, sizeof(njs_bytecode_ref_t));
+    if (njs_slow_path(ref == NULL)) {
+        return NJS_ERROR;
+    }
+
+    item = njs_arr_add(table->items);
+    if (njs_slow_path(item == NULL)) {
+        return NJS_ERROR;
+    }
+
+    *item = pointer;
+
+    ref->pointer = pointer;
+    ref->id = table->items->items - 1;
+
+    lhq.replace = 0;
+    lhq.value = ref;
+    lhq.pool = save->pool;
+
+    ret = njs_lvlhsh_insert(&table->hash, &lhq);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return NJS_ERROR;
+    }
+
+    *id = ref->id;
+
+    return NJS_OK;
+}
+
+
+njs_inline void
+njs_bytecode_put_u32(njs_chb_t *chain, uint32_t n)
+{
+    njs_chb_append(chain, &n, sizeof(uint32_t));
+}
+
+
+njs_inline void
+njs_bytecode_put_str(njs_chb_t *chain, const njs_str_t *str)
+{
+    njs_bytecode_put_u32(chain, str->length);
+    njs_chb_append(chain, str->start, str->length);
+}
+
+
+static njs_int_t
+njs_bytecode_save_codes(njs_bytecode_save_t *save)
+{
+    uint32_t       id;
+    njs_int_t      ret;
+    njs_uint_t     i, n;
+    njs_vm_code_t  *code;
+
+    code = save->vm->codes->start;
+    n = save->vm->codes->items;
+
+    for (i = 0; i < n; i++) {
+        ret = njs_bytecode_table_id(save, &save->codes, code[i].start, 1, &id);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    njs_bytecode_put_u32(&save->codes_chain, n);
+
+    for (i = 0; i < n; i++) {
+        ret = njs_bytecode_save_code(save, &code[i]);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_code(njs_bytecode_save_t *save, njs_vm_code_t *code)
+{
+    u_char                      *p, *fp, *start, *end, flags;
+    size_t                      size;
+    uint32_t                    id;
+    njs_int_t                   ret;
+    njs_str_t                   str;
+    njs_arr_t                   *extras;
+    njs_uint_t                  i;
+    njs_index_t                 index;
+    njs_regexp_pattern_t        *pattern;
+    njs_bytecode_extra_t        *extra;
+    const njs_bytecode_op_t     *op;
+    const njs_bytecode_field_t  *field;
+
+    size = code->end - code->start;
+
+    start = njs_mp_alloc(save->pool, size);
+    if (njs_slow_path(start == NULL)) {
+        return NJS_ERROR;
+    }
+
+    memcpy(start, code->start, size);
+    end = start + size;
+
+    extras = njs_arr_create(save->pool, 4, sizeof(njs_bytecode_extra_t));
+    if (njs_slow_path(extras == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (p = start; p < end; p += op->size) {
+        op = njs_bytecode_op(save->ops, p, end);
+        if (njs_slow_path(op == NULL)) {
+            return NJS_DECLINED;
+        }
+
+        for (i = 0; i < NJS_BYTECODE_FIELDS; i++) {
+            field = &op->fields[i];
+            fp = p + field->offset;
+
+            switch (field->type) {
+
+            case NJS_BYTECODE_INDEX:
+                index = *(njs_index_t *) fp;
+
+                if (index == NJS_INDEX_NONE
+                    || njs_scope_type(index) != NJS_SCOPE_ABSOLUTE)
+                {
+                    break;
+                }
+
+                ret = njs_bytecode_table_id(save, &save->constants,
+                                            (void *) index, 1, &id);
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return ret;
+                }
+
+                *(njs_index_t *) fp = njs_scope_index(id + 1,
+                                                      NJS_SCOPE_ABSOLUTE);
+                break;
+
+            case NJS_BYTECODE_LAMBDA:
+                ret = njs_bytecode_table_id(save, &save->lambdas,
+                                            *(void **) fp, 1, &id);
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return ret;
+                }
+
+                *(uintptr_t *) fp = id;
+                break;
+
+            case NJS_BYTECODE_CACHE:
+                njs_memzero(fp, NJS_PROPERTY_CACHE_SIZE
+                                * sizeof(njs_property_cache_t));
+                break;
+
+            case NJS_BYTECODE_PATTERN:
+            case NJS_BYTECODE_STR:
+                extra = njs_arr_add(extras);
+                if (njs_slow_path(extra == NULL)) {
+                    return NJS_ERROR;
+                }
+
+                extra->type = field->type;
+                extra->field = code->start + (fp - start);
+
+                if (field->type == NJS_BYTECODE_PATTERN) {
+                    *(void **) fp = NULL;
+
+                } else {
+                    ((njs_str_t *) fp)->start = NULL;
+                }
+
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    njs_bytecode_put_str(&save->codes_chain, &code->file);
+    njs_bytecode_put_str(&save->codes_chain, &code->name);
+    njs_bytecode_put_u32(&save->codes_chain, size);
+    njs_chb_append(&save->codes_chain, start, size);
+
+    extra = extras->start;
+
+    for (i = 0; i < extras->items; i++) {
+
+        if (extra[i].type == NJS_BYTECODE_PATTERN) {
+            pattern = *(njs_regexp_pattern_t **) extra[i].field;
+
+            flags = 0;
+
+            if (pattern->global) {
+                flags |= NJS_REGEXP_GLOBAL;
+            }
+
+            if (pattern->ignore_case) {
+                flags |= NJS_REGEXP_IGNORE_CASE;
+            }
+
+            if (pattern->multiline) {
+                flags |= NJS_REGEXP_MULTILINE;
+            }
+
+            /* The source is stored as "/pattern/flags". */
+
+            str.start = &pattern->source[1];
+            str.length = njs_strlen(pattern->source) - 1 - pattern->flags;
+
+            njs_chb_append(&save->codes_chain, &flags, 1);
+            njs_bytecode_put_str(&save->codes_chain, &str);
+
+        } else {
+            njs_bytecode_put_str(&save->codes_chain,
+                                 (njs_str_t *) extra[i].field);
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_modules(njs_bytecode_save_t *save)
+{
+    u_char        native, hash[NJS_BYTECODE_HASH_SIZE];
+    uint32_t      id;
+    njs_int_t     ret;
+    njs_uint_t    i, n;
+    njs_chb_t     *chain;
+    njs_module_t  **item, *module;
+
+    chain = &save->modules_chain;
+
+    n = (save->vm->modules != NULL) ? save->vm->modules->items : 0;
+
+    njs_bytecode_put_u32(chain, n);
+
+    if (n == 0) {
+        return NJS_OK;
+    }
+
+    item = save->vm->modules->start;
+
+    for (i = 0; i < n; i++) {
+        module = item[i];
+        native = module->function.native;
+
+        njs_bytecode_put_str(chain, &module->name);
+        njs_chb_append(chain, &module->index, sizeof(njs_index_t));
+        njs_chb_append(chain, &native, 1);
+
+        if (native) {
+            continue;
+        }
+
+        ret = njs_bytecode_table_id(save, &save->lambdas,
+                                    module->function.u.lambda, 1, &id);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_bytecode_file_hash(&module->name, hash);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_bytecode_put_u32(chain, id);
+        njs_chb_append(chain, hash, NJS_BYTECODE_HASH_SIZE);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_scope(njs_bytecode_save_t *save)
+{
+    uint8_t                  type;
+    uint32_t                 id, n;
+    njs_vm_t                 *vm;
+    njs_int_t                ret;
+    njs_chb_t                *chain;
+    njs_str_t                name;
+    njs_rbtree_t             *variables;
+    njs_variable_t           *var;
+    njs_rbtree_node_t        *node;
+    njs_variable_node_t      *var_node;
+    const njs_lexer_entry_t  *entry;
+
+    vm = save->vm;
+    chain = &save->scope_chain;
+
+    ret = njs_bytecode_table_id(save, &save->codes, vm->start, 0, &id);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    njs_bytecode_put_u32(chain, id);
+    njs_bytecode_put_u32(chain, vm->scope_size);
+
+    ret = njs_bytecode_save_values(save, chain, vm->global_scope,
+                                   vm->scope_size);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    /* The global variables are looked up by globalThis and Function(). */
+
+    variables = vm->variables_hash;
+
+    n = 0;
+    node = njs_rbtree_min(variables);
+
+    while (njs_rbtree_is_there_successor(variables, node)) {
+        var_node = (njs_variable_node_t *) node;
+
+        if (var_node->variable != NULL) {
+            n++;
+        }
+
+        node = njs_rbtree_node_successor(variables, node);
+    }
+
+    njs_bytecode_put_u32(chain, n);
+
+    node = njs_rbtree_min(variables);
+
+    while (njs_rbtree_is_there_successor(variables, node)) {
+        var_node = (njs_variable_node_t *) node;
+        var = var_node->variable;
+
+        if (var != NULL) {
+            entry = njs_lexer_entry(var_node->key);
+            name = entry->name;
+            type = var->type;
+
+            njs_bytecode_put_str(chain, &name);
+            njs_chb_append(chain, &type, 1);
+            njs_chb_append(chain, &var->index, sizeof(njs_index_t));
+        }
+
+        node = njs_rbtree_node_successor(variables, node);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_debug(njs_bytecode_save_t *save)
+{
+    uint32_t              id;
+    njs_int_t             ret;
+    njs_arr_t             *debug;
+    njs_uint_t            i, n;
+    njs_chb_t             *chain;
+    njs_function_debug_t  *entry;
+
+    chain = &save->debug_chain;
+    debug = save->vm->debug;
+
+    n = (debug != NULL) ? debug->items : 0;
+
+    njs_bytecode_put_u32(chain, n);
+
+    for (i = 0; i < n; i++) {
+        entry = njs_arr_item(debug, i);
+
+        ret = njs_bytecode_table_id(save, &save->lambdas, entry->lambda, 1,
+                                    &id);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_bytecode_put_u32(chain, entry->line);
+        njs_bytecode_put_str(chain, &entry->file);
+        njs_bytecode_put_str(chain, &entry->name);
+        njs_bytecode_put_u32(chain, id);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_lambdas(njs_bytecode_save_t *save)
+{
+    uint32_t                id;
+    njs_int_t               ret;
+    njs_uint_t              i;
+    njs_function_lambda_t   *lambda;
+    njs_bytecode_lambda_t   header;
+
+    /* The values may add the lambdas of nested function declarations. */
+
+    for (i = 0; i < save->lambdas.items->items; i++) {
+        lambda = ((njs_function_lambda_t **) save->lambdas.items->start)[i];
+
+        ret = njs_bytecode_save_values(save, &save->values_chain,
+                                       lambda->local_scope,
+                                       lambda->local_size);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        if (lambda->closure_size != 0) {
+            ret = njs_bytecode_save_values(save, &save->values_chain,
+                                           lambda->closure_scope,
+                                           lambda->closure_size
+                                           - sizeof(njs_value_t));
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+        }
+    }
+
+    njs_bytecode_put_u32(&save->lambdas_chain, save->lambdas.items->items);
+
+    for (i = 0; i < save->lambdas.items->items; i++) {
+        lambda = ((njs_function_lambda_t **) save->lambdas.items->start)[i];
+
+        ret = njs_bytecode_table_id(save, &save->codes, lambda->start, 0, &id);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_memzero(&header, sizeof(njs_bytecode_lambda_t));
+
+        header.nargs = lambda->nargs;
+        header.local_size = lambda->local_size;
+        header.closure_size = lambda->closure_size;
+        header.code = id;
+        header.nesting = lambda->nesting;
+        header.block_closures = lambda->block_closures;
+        header.ctor = lambda->ctor;
+        header.rest_parameters = lambda->rest_parameters;
+
+        njs_chb_append(&save->lambdas_chain, &header,
+                       sizeof(njs_bytecode_lambda_t));
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_constants(njs_bytecode_save_t *save)
+{
+    njs_int_t    ret;
+    njs_uint_t   i, n;
+    njs_value_t  **constants;
+
+    constants = save->constants.items->start;
+    n = save->constants.items->items;
+
+    njs_bytecode_put_u32(&save->constants_chain, n);
+
+    for (i = 0; i < n; i++) {
+        if (njs_slow_path(njs_is_function(constants[i]))) {
+            return NJS_DECLINED;
+        }
+
+        ret = njs_bytecode_save_value(save, &save->constants_chain,
+                                      constants[i]);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_values(njs_bytecode_save_t *save, njs_chb_t *chain,
+    const njs_value_t *values, size_t size)
+{
+    njs_int_t  ret;
+
+    while (size >= sizeof(njs_value_t)) {
+        ret = njs_bytecode_save_value(save, chain, values++);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        size -= sizeof(njs_value_t);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_save_value(njs_bytecode_save_t *save, njs_chb_t *chain,
+    const njs_value_t *value)
+{
+    u_char             tag;
+    uint32_t           id;
+    njs_int_t          ret;
+    njs_function_t     *function;
+    njs_string_prop_t  string;
+
+    switch (value->type) {
+
+    case NJS_NULL:
+    case NJS_UNDEFINED:
+    case NJS_BOOLEAN:
+    case NJS_NUMBER:
+    case NJS_INVALID:
+        tag = NJS_BYTECODE_VALUE;
+
+        njs_chb_append(chain, &tag, 1);
+        njs_chb_append(chain, value, sizeof(njs_value_t));
+        break;
+
+    case NJS_STRING:
+        tag = NJS_BYTECODE_STRING;
+
+        (void) njs_string_prop(&string, value);
+
+        njs_chb_append(chain, &tag, 1);
+        njs_bytecode_put_u32(chain, string.size);
+        njs_bytecode_put_u32(chain, string.length);
+        njs_chb_append(chain, string.start, string.size);
+        break;
+
+    case NJS_FUNCTION:
+        function = njs_function(value);
+
+        /* The function declarations created by the parser. */
+
+        if (function->native || function->closure) {
+            return NJS_DECLINED;
+        }
+
+        ret = njs_bytecode_table_id(save, &save->lambdas, function->u.lambda,
+                                    1, &id);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        tag = NJS_BYTECODE_FUNCTION;
+
+        njs_chb_append(chain, &tag, 1);
+        njs_bytecode_put_u32(chain, id);
+        break;
+
+    default:
+        return NJS_DECLINED;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_header(njs_bytecode_load_t *load, const njs_str_t *source)
+{
+    u_char                 hash[NJS_BYTECODE_HASH_SIZE];
+    njs_int_t              ret;
+    njs_bytecode_header_t  header;
+
+    ret = njs_bytecode_read(load, &header, sizeof(njs_bytecode_header_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if (memcmp(header.magic, "NJSB", 4) != 0
+        || header.version != NJS_BYTECODE_VERSION
+        || header.pointer_size != sizeof(void *)
+        || header.value_size != sizeof(njs_value_t)
+        || header.flags != njs_bytecode_flags(load->vm))
+    {
+        return NJS_DECLINED;
+    }
+
+    njs_bytecode_hash(load->vm, source, hash);
+
+    if (memcmp(header.hash, hash, NJS_BYTECODE_HASH_SIZE) != 0) {
+        return NJS_DECLINED;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_modules(njs_bytecode_load_t *load)
+{
+    u_char                 native, hash[NJS_BYTECODE_HASH_SIZE],
+                           file_hash[NJS_BYTECODE_HASH_SIZE];
+    uint32_t               i, n;
+    njs_int_t              ret;
+    njs_bytecode_module_t  *module;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    load->modules = njs_arr_create(load->pool, njs_max(n, 1),
+                                   sizeof(njs_bytecode_module_t));
+    if (njs_slow_path(load->modules == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (i = 0; i < n; i++) {
+        module = njs_arr_add(load->modules);
+        if (njs_slow_path(module == NULL)) {
+            return NJS_ERROR;
+        }
+
+        ret = njs_bytecode_read_str(load, &module->name);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &module->index, sizeof(njs_index_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &native, 1);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (native) {
+            module->native = njs_module_find(load->vm, &module->name, 0);
+
+            if (module->native == NULL
+                || !module->native->function.native
+                || (module->native->index != 0
+                    && module->native->index != module->index))
+            {
+                return NJS_DECLINED;
+            }
+
+            continue;
+        }
+
+        module->native = NULL;
+
+        ret = njs_bytecode_read(load, &module->lambda, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, hash, NJS_BYTECODE_HASH_SIZE);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        /* The imported module file has been changed. */
+
+        ret = njs_bytecode_file_hash(&module->name, file_hash);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (memcmp(hash, file_hash, NJS_BYTECODE_HASH_SIZE) != 0) {
+            return NJS_DECLINED;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_constants(njs_bytecode_load_t *load)
+{
+    u_char        tag;
+    size_t        map;
+    uint32_t      i, size, length;
+    njs_int_t     ret;
+    njs_str_t     str;
+    njs_value_t   value;
+    njs_index_t   index;
+    njs_string_t  string;
+
+    ret = njs_bytecode_read(load, &load->nconstants, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    load->constants = njs_mp_alloc(load->pool, (load->nconstants + 1)
+                                               * sizeof(njs_value_t *));
+    if (njs_slow_path(load->constants == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (i = 0; i < load->nconstants; i++) {
+        ret = njs_bytecode_read(load, &tag, 1);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (tag == NJS_BYTECODE_STRING) {
+            ret = njs_bytecode_read(load, &size, sizeof(uint32_t));
+            if (ret != NJS_OK) {
+                return ret;
+            }
+
+            ret = njs_bytecode_read(load, &length, sizeof(uint32_t));
+            if (ret != NJS_OK) {
+                return ret;
+            }
+
+            str.length = size;
+            str.start = load->pos;
+
+            if ((size_t) (load->end - load->pos) < size || length > size) {
+                return NJS_DECLINED;
+            }
+
+            load->pos += size;
+
+            if (size <= NJS_STRING_SHORT) {
+                ret = njs_string_new(load->vm, &value, str.start, size,
+                                     length);
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return NJS_ERROR;
+                }
+
+            } else {
+                value.type = NJS_STRING;
+                njs_string_truth(&value, size);
+
+                value.short_string.size = NJS_STRING_LONG;
+                value.short_string.length = 0;
+                value.long_string.external = 0;
+                value.long_string.size = size;
+                value.long_string.data = &string;
+
+                /*
+                 * njs_value_index() copies the long string together with
+                 * the offset map which follows the string data, the map
+                 * must be empty to be filled in on demand.
+                 */
+
+                map = size;
+
+                if (size != length && length > NJS_STRING_MAP_STRIDE) {
+                    map = njs_string_map_offset(size)
+                          + njs_string_map_size(length);
+                }
+
+                string.start = njs_mp_zalloc(load->pool, map);
+                if (njs_slow_path(string.start == NULL)) {
+                    return NJS_ERROR;
+                }
+
+                memcpy(string.start, str.start, size);
+                string.length = length;
+            }
+
+        } else if (tag == NJS_BYTECODE_VALUE) {
+            ret = njs_bytecode_load_primitive(load, &value);
+            if (ret != NJS_OK) {
+                return ret;
+            }
+
+        } else {
+            return NJS_DECLINED;
+        }
+
+        index = njs_value_index(load->vm, &value, 0);
+        if (njs_slow_path(index == NJS_INDEX_NONE)) {
+            return NJS_ERROR;
+        }
+
+        load->constants[i] = (njs_value_t *) index;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_lambdas(njs_bytecode_load_t *load)
+{
+    size_t                 size;
+    uint32_t               i, n;
+    njs_int_t              ret;
+    njs_value_t            *values;
+    njs_function_lambda_t  *lambda;
+    njs_bytecode_lambda_t  header;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if ((size_t) (load->end - load->pos) / sizeof(njs_bytecode_lambda_t) < n) {
+        return NJS_DECLINED;
+    }
+
+    load->nlambdas = n;
+
+    size = (n + 1) * sizeof(void *);
+
+    load->lambdas = njs_mp_zalloc(load->pool, size);
+    load->functions = njs_mp_zalloc(load->pool, size);
+    load->lambda_codes = njs_mp_zalloc(load->pool, (n + 1) * sizeof(uint32_t));
+
+    if (njs_slow_path(load->lambdas == NULL
+                      || load->functions == NULL
+                      || load->lambda_codes == NULL))
+    {
+        return NJS_ERROR;
+    }
+
+    /* The headers go first, the values refer to the following lambdas. */
+
+    for (i = 0; i < n; i++) {
+        (void) njs_bytecode_read(load, &header, sizeof(njs_bytecode_lambda_t));
+
+        if (header.local_size % sizeof(njs_value_t) != 0
+            || header.closure_size % sizeof(njs_value_t) != 0
+            || header.nesting > NJS_MAX_NESTING)
+        {
+            return NJS_DECLINED;
+        }
+
+        lambda = njs_function_lambda_alloc(load->vm, header.ctor);
+        if (njs_slow_path(lambda == NULL)) {
+            return NJS_ERROR;
+        }
+
+        lambda->nargs = header.nargs;
+        lambda->local_size = header.local_size;
+        lambda->closure_size = header.closure_size;
+        lambda->nesting = header.nesting;
+        lambda->block_closures = header.block_closures;
+        lambda->rest_parameters = header.rest_parameters;
+
+        load->lambdas[i] = lambda;
+        load->lambda_codes[i] = header.code;
+    }
+
+    for (i = 0; i < n; i++) {
+        lambda = load->lambdas[i];
+
+        size = lambda->local_size;
+
+        if (size != 0) {
+            values = njs_mp_align(load->vm->mem_pool, sizeof(njs_value_t),
+                                  size);
+            if (njs_slow_path(values == NULL)) {
+                return NJS_ERROR;
+            }
+
+            ret = njs_bytecode_load_values(load, values, size);
+            if (ret != NJS_OK) {
+                return ret;
+            }
+
+            lambda->local_scope = values;
+        }
+
+        size = lambda->closure_size;
+
+        if (size > sizeof(njs_value_t)) {
+            size -= sizeof(njs_value_t);
+
+            values = njs_mp_align(load->vm->mem_pool, sizeof(njs_value_t),
+                                  size);
+            if (njs_slow_path(values == NULL)) {
+                return NJS_ERROR;
+            }
+
+            ret = njs_bytecode_load_values(load, values, size);
+            if (ret != NJS_OK) {
+                return ret;
+            }
+
+            lambda->closure_scope = values;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_codes(njs_bytecode_load_t *load)
+{
+    u_char         *start;
+    uint32_t       i, n, size;
+    njs_int_t      ret;
+    njs_vm_code_t  *code;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if (n == 0) {
+        return NJS_DECLINED;
+    }
+
+    load->codes = njs_arr_create(load->vm->mem_pool, n, sizeof(njs_vm_code_t));
+    if (njs_slow_path(load->codes == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (i = 0; i < n; i++) {
+        code = njs_arr_add(load->codes);
+        if (njs_slow_path(code == NULL)) {
+            return NJS_ERROR;
+        }
+
+        ret = njs_bytecode_read_str(load, &code->file);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read_str(load, &code->name);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &size, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (size == 0 || (size_t) (load->end - load->pos) < size) {
+            return NJS_DECLINED;
+        }
+
+        start = njs_mp_alloc(load->vm->mem_pool, size);
+        if (njs_slow_path(start == NULL)) {
+            return NJS_ERROR;
+        }
+
+        memcpy(start, load->pos, size);
+        load->pos += size;
+
+        code->start = start;
+        code->end = start + size;
+        code->generated = 0;
+
+        ret = njs_bytecode_load_code(load, code->start, code->end);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+    }
+
+    code = load->codes->start;
+
+    for (i = 0; i < load->nlambdas; i++) {
+        if (load->lambda_codes[i] >= n) {
+            return NJS_DECLINED;
+        }
+
+        load->lambdas[i]->start = code[load->lambda_codes[i]].start;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_code(njs_bytecode_load_t *load, u_char *start, u_char *end)
+{
+    u_char                      *p, *fp, flags;
+    uintptr_t                   id;
+    njs_int_t                   ret;
+    njs_str_t                   str;
+    njs_uint_t                  i;
+    njs_index_t                 index;
+    njs_regexp_pattern_t        *pattern;
+    const njs_bytecode_op_t     *op, *next;
+    const njs_bytecode_field_t  *field;
+
+    for (p = start; p < end; p += op->size) {
+        op = njs_bytecode_op(load->ops, p, end);
+        if (njs_slow_path(op == NULL)) {
+            return NJS_DECLINED;
+        }
+
+        if (op->operation >= NJS_VMCODE_LESS_JUMP
+            && op->operation <= NJS_VMCODE_STRICT_NOT_EQUAL_JUMP)
+        {
+            /* A compare-and-branch superinstruction makes the next jump. */
+
+            if ((size_t) (end - p) <= op->size) {
+                return NJS_DECLINED;
+            }
+
+            next = njs_bytecode_op(load->ops, p + op->size, end);
+
+            if (next == NULL
+                || (next->operation != NJS_VMCODE_IF_TRUE_JUMP
+                    && next->operation != NJS_VMCODE_IF_FALSE_JUMP))
+            {
+                return NJS_DECLINED;
+            }
+        }
+
+        for (i = 0; i < NJS_BYTECODE_FIELDS; i++) {
+            field = &op->fields[i];
+            fp = p + field->offset;
+
+            switch (field->type) {
+
+            case NJS_BYTECODE_INDEX:
+                index = *(njs_index_t *) fp;
+
+                if (njs_scope_type(index) >= NJS_SCOPES) {
+                    return NJS_DECLINED;
+                }
+
+                if (index == NJS_INDEX_NONE
+                    || njs_scope_type(index) != NJS_SCOPE_ABSOLUTE)
+                {
+                    break;
+                }
+
+                id = (index >> NJS_SCOPE_SHIFT) - 1;
+
+                if (id >= load->nconstants) {
+                    return NJS_DECLINED;
+                }
+
+                *(njs_index_t *) fp = (njs_index_t) load->constants[id];
+                break;
+
+            case NJS_BYTECODE_LAMBDA:
+                id = *(uintptr_t *) fp;
+
+                if (id >= load->nlambdas) {
+                    return NJS_DECLINED;
+                }
+
+                *(njs_function_lambda_t **) fp = load->lambdas[id];
+                break;
+
+            case NJS_BYTECODE_PATTERN:
+                ret = njs_bytecode_read(load, &flags, 1);
+                if (ret != NJS_OK) {
+                    return ret;
+                }
+
+                ret = njs_bytecode_read_ref(load, &str);
+                if (ret != NJS_OK) {
+                    return ret;
+                }
+
+                pattern = njs_regexp_pattern_create(load->vm, str.start,
+                                                    str.length, flags);
+                if (njs_slow_path(pattern == NULL)) {
+                    return NJS_DECLINED;
+                }
+
+                *(njs_regexp_pattern_t **) fp = pattern;
+                break;
+
+            case NJS_BYTECODE_STR:
+                ret = njs_bytecode_read_str(load, (njs_str_t *) fp);
+                if (ret != NJS_OK) {
+                    return ret;
+                }
+
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_scope(njs_bytecode_load_t *load)
+{
+    uint8_t              type;
+    uint32_t             i, n;
+    njs_vm_t             *vm;
+    uintptr_t            unique_id;
+    njs_int_t            ret;
+    njs_str_t            name;
+    njs_index_t          index;
+    njs_variable_t       *var;
+    njs_vm_code_t        *code;
+    njs_variable_node_t  *node;
+
+    vm = load->vm;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if (n >= load->codes->items) {
+        return NJS_DECLINED;
+    }
+
+    code = load->codes->start;
+    load->start = code[n].start;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if (n % sizeof(njs_value_t) != 0) {
+        return NJS_DECLINED;
+    }
+
+    load->scope_size = n;
+
+    load->global_scope = njs_mp_align(vm->mem_pool, sizeof(njs_value_t),
+                                      njs_max(n, sizeof(njs_value_t)));
+    if (njs_slow_path(load->global_scope == NULL)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_bytecode_load_values(load, load->global_scope, n);
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    load->variables = njs_mp_alloc(vm->mem_pool, sizeof(njs_rbtree_t));
+    if (njs_slow_path(load->variables == NULL)) {
+        return NJS_ERROR;
+    }
+
+    njs_rbtree_init(load->variables, njs_parser_scope_rbtree_compare);
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    for (i = 0; i < n; i++) {
+        ret = njs_bytecode_read_ref(load, &name);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &type, 1);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &index, sizeof(njs_index_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (type > NJS_VARIABLE_FUNCTION
+            || njs_scope_type(index) == NJS_SCOPE_ABSOLUTE
+            || njs_scope_type(index) >= NJS_SCOPES)
+        {
+            return NJS_DECLINED;
+        }
+
+        unique_id = njs_lexer_unique_id(vm, name.start, name.length);
+        if (njs_slow_path(unique_id == 0)) {
+            return NJS_ERROR;
+        }
+
+        var = njs_mp_zalloc(vm->mem_pool, sizeof(njs_variable_t));
+        if (njs_slow_path(var == NULL)) {
+            return NJS_ERROR;
+        }
+
+        var->unique_id = unique_id;
+        var->type = type;
+        var->index = index;
+        njs_set_undefined(&var->value);
+
+        node = njs_variable_node_alloc(vm, var, unique_id);
+        if (njs_slow_path(node == NULL)) {
+            return NJS_ERROR;
+        }
+
+        njs_rbtree_insert(load->variables, &node->node);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_debug(njs_bytecode_load_t *load)
+{
+    uint32_t              i, n, id;
+    njs_int_t             ret;
+    njs_function_debug_t  *entry;
+
+    ret = njs_bytecode_read(load, &n, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    load->debug = njs_arr_create(load->pool, njs_max(n, 1),
+                                 sizeof(njs_function_debug_t));
+    if (njs_slow_path(load->debug == NULL)) {
+        return NJS_ERROR;
+    }
+
+    for (i = 0; i < n; i++) {
+        entry = njs_arr_add(load->debug);
+        if (njs_slow_path(entry == NULL)) {
+            return NJS_ERROR;
+        }
+
+        ret = njs_bytecode_read(load, &entry->line, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read_str(load, &entry->file);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read_str(load, &entry->name);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &id, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (id >= load->nlambdas) {
+            return NJS_DECLINED;
+        }
+
+        entry->lambda = load->lambdas[id];
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_commit(njs_bytecode_load_t *load)
+{
+    void                   *p;
+    njs_vm_t               *vm;
+    njs_uint_t             i;
+    njs_module_t           *module, **item;
+    njs_bytecode_module_t  *m;
+
+    vm = load->vm;
+    m = load->modules->start;
+
+    for (i = 0; i < load->modules->items; i++) {
+        if (m[i].native == NULL && m[i].lambda >= load->nlambdas) {
+            return NJS_DECLINED;
+        }
+    }
+
+    if (vm->debug != NULL && load->debug->items != 0) {
+        p = njs_arr_add_multiple(vm->debug, load->debug->items);
+        if (njs_slow_path(p == NULL)) {
+            return NJS_ERROR;
+        }
+
+        memcpy(p, load->debug->start,
+               load->debug->items * sizeof(njs_function_debug_t));
+    }
+
+    for (i = 0; i < load->modules->items; i++) {
+        module = m[i].native;
+
+        if (module == NULL) {
+            module = njs_module_add(vm, &m[i].name);
+            if (njs_slow_path(module == NULL)) {
+                return NJS_ERROR;
+            }
+
+            module->function.args_offset = 1;
+            module->function.u.lambda = load->lambdas[m[i].lambda];
+        }
+
+        module->index = m[i].index;
+
+        if (vm->modules == NULL) {
+            vm->modules = njs_arr_create(vm->mem_pool, 4,
+                                         sizeof(njs_module_t *));
+            if (njs_slow_path(vm->modules == NULL)) {
+                return NJS_ERROR;
+            }
+        }
+
+        item = njs_arr_add(vm->modules);
+        if (njs_slow_path(item == NULL)) {
+            return NJS_ERROR;
+        }
+
+        *item = module;
+    }
+
+    vm->codes = load->codes;
+    vm->start = load->start;
+    vm->global_scope = load->global_scope;
+    vm->scope_size = load->scope_size;
+    vm->variables_hash = load->variables;
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_values(njs_bytecode_load_t *load, njs_value_t *values,
+    size_t size)
+{
+    njs_int_t  ret;
+
+    while (size >= sizeof(njs_value_t)) {
+        ret = njs_bytecode_load_value(load, values++);
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        size -= sizeof(njs_value_t);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_load_value(njs_bytecode_load_t *load, njs_value_t *value)
+{
+    u_char          tag;
+    uint32_t        id, size, length;
+    njs_int_t       ret;
+    njs_function_t  *function;
+
+    ret = njs_bytecode_read(load, &tag, 1);
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    switch (tag) {
+
+    case NJS_BYTECODE_VALUE:
+        return njs_bytecode_load_primitive(load, value);
+
+    case NJS_BYTECODE_STRING:
+        ret = njs_bytecode_read(load, &size, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        ret = njs_bytecode_read(load, &length, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if ((size_t) (load->end - load->pos) < size || length > size) {
+            return NJS_DECLINED;
+        }
+
+        ret = njs_string_new(load->vm, value, load->pos, size, length);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NJS_ERROR;
+        }
+
+        load->pos += size;
+
+        return NJS_OK;
+
+    case NJS_BYTECODE_FUNCTION:
+        ret = njs_bytecode_read(load, &id, sizeof(uint32_t));
+        if (ret != NJS_OK) {
+            return ret;
+        }
+
+        if (id >= load->nlambdas) {
+            return NJS_DECLINED;
+        }
+
+        function = load->functions[id];
+
+        if (function == NULL) {
+            function = njs_function_alloc(load->vm, load->lambdas[id], NULL, 1);
+            if (njs_slow_path(function == NULL)) {
+                return NJS_ERROR;
+            }
+
+            function->args_count = function->u.lambda->nargs
+                                   - function->u.lambda->rest_parameters;
+
+            load->functions[id] = function;
+        }
+
+        njs_set_function(value, function);
+
+        return NJS_OK;
+
+    default:
+        return NJS_DECLINED;
+    }
+}
+
+
+static njs_int_t
+njs_bytecode_load_primitive(njs_bytecode_load_t *load, njs_value_t *value)
+{
+    njs_int_t  ret;
+
+    ret = njs_bytecode_read(load, value, sizeof(njs_value_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    switch (value->type) {
+    case NJS_NULL:
+    case NJS_UNDEFINED:
+    case NJS_BOOLEAN:
+    case NJS_NUMBER:
+    case NJS_INVALID:
+        return NJS_OK;
+
+    default:
+        return NJS_DECLINED;
+    }
+}
+
+
+static njs_int_t
+njs_bytecode_read(njs_bytecode_load_t *load, void *dst, size_t size)
+{
+    if (njs_slow_path((size_t) (load->end - load->pos) < size)) {
+        return NJS_DECLINED;
+    }
+
+    memcpy(dst, load->pos, size);
+    load->pos += size;
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_read_ref(njs_bytecode_load_t *load, njs_str_t *str)
+{
+    uint32_t   length;
+    njs_int_t  ret;
+
+    ret = njs_bytecode_read(load, &length, sizeof(uint32_t));
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    if ((size_t) (load->end - load->pos) < length) {
+        return NJS_DECLINED;
+    }
+
+    str->start = load->pos;
+    str->length = length;
+
+    load->pos += length;
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_bytecode_read_str(njs_bytecode_load_t *load, njs_str_t *str)
+{
+    u_char     *p;
+    njs_int_t  ret;
+    njs_str_t  ref;
+
+    ret = njs_bytecode_read_ref(load, &ref);
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    p = njs_mp_alloc(load->vm->mem_pool, ref.length + 1);
+    if (njs_slow_path(p == NULL)) {
+        return NJS_ERROR;
+    }
+
+    memcpy(p, ref.start, ref.length);
+    p[ref.length] = '\0';
+
+    str->start = p;
+    str->length = ref.length;
+
+    return NJS_OK;
+}
@@ -0,0 +1,31 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_BYTECODE_H_INCLUDED_
+#define _NJS_BYTECODE_H_INCLUDED_
+
+
+/*
+ * The bytecode is a binary image of the code generated for a script:
+ * the code blocks, the function lambdas, the constants, the global scope,
+ * the global variables, the modules and the debug info.
+ *
+ * The image is valid only for the same njs version and build, the same
+ * script and file name, and the same VM options affecting the generated
+ * code.  Imported modules are checked by their file content hashes.
+ * Pointers in the code are stored as table indexes and are relocated
+ * on load, the inline property caches are stored empty.
+ */
+
+#define NJS_BYTECODE_VERSION  2
+
+
+njs_int_t njs_bytecode_save(njs_vm_t *vm, const njs_str_t *source,
+    njs_str_t *bytecode);
+njs_int_t njs_bytecode_load(njs_vm_t *vm, const njs_str_t *source,
+    const njs_str_t *bytecode);
+
+
+#endif /* _NJS_BYTECODE_H_INCLUDED_ */
@@ -139,6 +139,7 @@ njs_crypto_object_value_alloc(njs_vm_t *vm, njs_object_type_t type)
 
         ov->object.__proto__ = &vm->prototypes[type].object;
         ov->object.slots = NULL;
+        ov->object.shape = NULL;
         return ov;
     }
 
@@ -394,6 +394,7 @@ done:
     date->object.fast_array = 0;
     date->object.__proto__ = &vm->prototypes[NJS_OBJ_TYPE_DATE].object;
     date->object.slots = NULL;
+    date->object.shape = NULL;
 
     date->time = time;
 
@@ -136,10 +136,32 @@ static njs_code_name_t  code_names[] = {
 };
 
 
+static njs_code_name_t  compare_jump_names[] = {
+
+    { NJS_VMCODE_LESS_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("LESS") },
+    { NJS_VMCODE_GREATER_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("GREATER") },
+    { NJS_VMCODE_LESS_OR_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("LESS OR EQUAL") },
+    { NJS_VMCODE_GREATER_OR_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("GREATER OR EQUAL") },
+    { NJS_VMCODE_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("EQUAL") },
+    { NJS_VMCODE_NOT_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("NOT EQUAL") },
+    { NJS_VMCODE_STRICT_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("STRICT EQUAL") },
+    { NJS_VMCODE_STRICT_NOT_EQUAL_JUMP, sizeof(njs_vmcode_3addr_t),
+          njs_str("STRICT NOT EQUAL") },
+
+};
+
+
 void
 njs_disassembler(njs_vm_t *vm)
 {
-    njs_uint_t     n;
+    njs_uint_t     n, count;
     njs_vm_code_t  *code;
 
     code = vm->codes->start;
@@ -147,7 +169,13 @@ njs_disassembler(njs_vm_t *vm)
 
     while (n != 0) {
         njs_printf("%V:%V\n", &code->file, &code->name);
-        njs_disassemble(code->start, code->end);
+        count = njs_disassemble(code->start, code->end);
+
+        if (code->generated != 0) {
+            njs_printf("INSTRUCTIONS: %ui, GENERATED: %ui\n", count,
+                       code->generated);
+        }
+
         code++;
         n--;
     }
@@ -156,12 +184,12 @@ njs_disassembler(njs_vm_t *vm)
 }
 
 
-void
+njs_uint_t
 njs_disassemble(u_char *start, u_char *end)
 {
     u_char                       *p;
     njs_str_t                    *name;
-    njs_uint_t                   n;
+    njs_uint_t                   n, count;
     njs_code_name_t              *code_name;
     njs_vmcode_jump_t            *jump;
     njs_vmcode_1addr_t           *code1;
@@ -175,6 +203,7 @@ njs_disassemble(u_char *start, u_char *end)
     njs_vmcode_operation_t       operation;
     njs_vmcode_cond_jump_t       *cond_jump;
     njs_vmcode_test_jump_t       *test_jump;
+    njs_vmcode_prop_get_t        *prop_get;
     njs_vmcode_prop_next_t       *prop_next;
     njs_vmcode_try_return_t      *try_return;
     njs_vmcode_equal_jump_t      *equal;
@@ -185,6 +214,7 @@ njs_disassemble(u_char *start, u_char *end)
     njs_vmcode_function_frame_t  *function;
 
     p = start;
+    count = 0;
 
     /*
      * On some 32-bit platform uintptr_t is int and compilers warn
@@ -194,6 +224,7 @@ njs_disassemble(u_char *start, u_char *end)
 
     while (p < end) {
         operation = *(njs_vmcode_operation_t *) p;
+        count++;
 
         if (operation == NJS_VMCODE_ARRAY) {
             array = (njs_vmcode_array_t *) p;
@@ -442,6 +473,38 @@ njs_disassemble(u_char *start, u_char *end)
             continue;
         }
 
+        code_name = compare_jump_names;
+        n = njs_nitems(compare_jump_names);
+
+        do {
+            if (operation == code_name->operation) {
+                code3 = (njs_vmcode_3addr_t *) p;
+                cond_jump = (njs_vmcode_cond_jump_t *) (p + code_name->size);
+
+                njs_printf("%05uz %V JUMP IF %s  %04Xz %04Xz %04Xz %z\n",
+                           p - start, &code_name->name,
+                           (cond_jump->code.operation
+                            == NJS_VMCODE_IF_TRUE_JUMP) ? "TRUE" : "FALSE",
+                           (size_t) code3->dst, (size_t) code3->src1,
+                           (size_t) code3->src2,
+                           (size_t) (cond_jump->offset + code_name->size));
+
+                p += code_name->size + sizeof(njs_vmcode_cond_jump_t);
+
+                /*
+                 * The pair is printed on one line, but occupies the slots
+                 * of two instructions, as counted by the generator.
+                 */
+                count++;
+
+                goto next;
+            }
+
+            code_name++;
+            n--;
+
+        } while (n != 0);
+
         if (operation == NJS_VMCODE_REFERENCE_ERROR) {
             njs_printf("%05uz REFERENCE ERROR\n", p - start);
 
@@ -472,6 +535,15 @@ njs_disassemble(u_char *start, u_char *end)
                                p - start, name->length, name->start,
                                (size_t) code2->dst, (size_t) code2->src);
 
+                } else if (code_name->size == sizeof(njs_vmcode_prop_get_t)) {
+                    prop_get = (njs_vmcode_prop_get_t *) p;
+
+                    njs_printf("%05uz %*s  %04Xz %04Xz %04Xz\n",
+                               p - start, name->length, name->start,
+                               (size_t) prop_get->value,
+                               (size_t) prop_get->object,
+                               (size_t) prop_get->property);
+
                 } else if (code_name->size == sizeof(njs_vmcode_1addr_t)) {
                     code1 = (njs_vmcode_1addr_t *) p;
 
@@ -499,4 +571,6 @@ njs_disassemble(u_char *start, u_char *end)
 
         continue;
     }
+
+    return count;
 }
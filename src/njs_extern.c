@@ -201,6 +201,7 @@ njs_external_prop_handler(njs_vm_t *vm, njs_object_prop_t *self,
         ov->object.fast_array = 0;
         ov->object.__proto__ = &vm->prototypes[NJS_OBJ_TYPE_OBJECT].object;
         ov->object.slots = slots;
+        ov->object.shape = NULL;
 
         njs_set_data(&ov->value, external);
         njs_set_object_value(retval, ov);
@@ -311,6 +312,7 @@ njs_vm_external_create(njs_vm_t *vm, njs_value_t *value,
     ov->object.fast_array = 0;
     ov->object.__proto__ = &vm->prototypes[NJS_OBJ_TYPE_OBJECT].object;
     ov->object.slots = slots;
+    ov->object.shape = NULL;
 
     njs_set_object_value(value, ov);
     njs_set_data(&ov->value, external);
@@ -644,7 +644,9 @@ njs_function_lambda_call(njs_vm_t *vm)
             }
 
             size -= sizeof(njs_value_t);
-            closure->u.count = 0;
+
+            /* The number of values, see njs_snapshot_closure(). */
+            closure->u.count = size / sizeof(njs_value_t);
             dst = closure->values;
 
             src = lambda->closure_scope;
@@ -798,6 +800,7 @@ njs_int_t
 njs_function_prototype_create(njs_vm_t *vm, njs_object_prop_t *prop,
     njs_value_t *value, njs_value_t *setval, njs_value_t *retval)
 {
+    njs_int_t       ret;
     njs_value_t     *proto, proto_value, *cons;
     njs_object_t    *prototype;
     njs_function_t  *function;
@@ -825,6 +828,13 @@ njs_function_prototype_create(njs_vm_t *vm, njs_object_prop_t *prop,
     }
 
     if (njs_is_object(proto)) {
+        if (njs_object(proto)->shape != NULL) {
+            ret = njs_shape_dictionary(vm, njs_object(proto));
+            if (njs_slow_path(ret != NJS_OK)) {
+                return NJS_ERROR;
+            }
+        }
+
         cons = njs_property_constructor_create(vm, njs_object_hash(proto),
                                                value);
         if (njs_slow_path(cons == NULL)) {
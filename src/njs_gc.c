@@ -0,0 +1,128 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+/*
+ * The njs_lvlhsh entries keep 64-bit pointers as two 32-bit words,
+ * so the heap is scanned with 4-byte step.
+ */
+#define NJS_GC_SCAN_STEP  sizeof(uint32_t)
+
+
+typedef struct {
+    u_char      *start;
+    size_t      size;
+} njs_gc_region_t;
+
+
+static njs_int_t njs_gc_scan(njs_mp_t *heap, njs_arr_t *stack, u_char *p,
+    size_t size);
+
+
+njs_int_t
+njs_gc(njs_vm_t *vm, const njs_value_t *roots, njs_uint_t nroots,
+    size_t *freed)
+{
+    njs_mp_t         *mp;
+    njs_int_t        ret;
+    njs_arr_t        *stack;
+    njs_uint_t       i;
+    njs_gc_region_t  region, *last;
+
+    /* The mark stack must not be allocated from the swept pool. */
+
+    mp = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (njs_slow_path(mp == NULL)) {
+        return NJS_ERROR;
+    }
+
+    stack = njs_arr_create(mp, 64, sizeof(njs_gc_region_t));
+    if (njs_slow_path(stack == NULL)) {
+        ret = NJS_ERROR;
+        goto done;
+    }
+
+    /*
+     * The spare space of the top frame keeps the values of returned
+     * functions, they are cleared not to be taken as roots.
+     */
+
+    njs_memzero(vm->top_frame->free, vm->top_frame->free_size);
+
+    /* The VM structure is allocated from its own pool. */
+
+    ret = njs_gc_scan(vm->mem_pool, stack, (u_char *) &vm, sizeof(njs_vm_t *));
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    for (i = 0; i < nroots; i++) {
+        ret = njs_gc_scan(vm->mem_pool, stack, (u_char *) &roots[i],
+                          sizeof(njs_value_t));
+        if (njs_slow_path(ret != NJS_OK)) {
+            goto done;
+        }
+    }
+
+    while (!njs_arr_is_empty(stack)) {
+        last = njs_arr_last(stack);
+        region = *last;
+        njs_arr_remove_last(stack);
+
+        ret = njs_gc_scan(vm->mem_pool, stack, region.start, region.size);
+        if (njs_slow_path(ret != NJS_OK)) {
+            goto done;
+        }
+    }
+
+    *freed = njs_mp_sweep(vm->mem_pool);
+
+done:
+
+    if (njs_slow_path(ret != NJS_OK)) {
+        njs_mp_unmark(vm->mem_pool);
+    }
+
+    njs_mp_destroy(mp);
+
+    return ret;
+}
+
+
+static njs_int_t
+njs_gc_scan(njs_mp_t *heap, njs_arr_t *stack, u_char *p, size_t size)
+{
+    void             *addr, *start;
+    size_t           n;
+    u_char           *end;
+    njs_gc_region_t  *region;
+
+    if (size < sizeof(void *)) {
+        return NJS_OK;
+    }
+
+    end = p + size - sizeof(void *);
+
+    for ( /* void */ ; p <= end; p += NJS_GC_SCAN_STEP) {
+        memcpy(&addr, p, sizeof(void *));
+
+        start = njs_mp_mark(heap, addr, &n);
+
+        if (start != NULL) {
+            region = njs_arr_add(stack);
+            if (njs_slow_path(region == NULL)) {
+                return NJS_ERROR;
+            }
+
+            region->start = start;
+            region->size = n;
+        }
+    }
+
+    return NJS_OK;
+}
@@ -0,0 +1,28 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_GC_H_INCLUDED_
+#define _NJS_GC_H_INCLUDED_
+
+
+/*
+ * A conservative mark-and-sweep collector over the VM memory pool.
+ *
+ * The VM structure and the host roots are scanned for words which point
+ * into the pool, every allocation found this way is marked and scanned in
+ * turn.  Unmarked allocations are freed.  Interior pointers keep the whole
+ * allocation alive, so the collector does not need to know the layout of
+ * njs objects, strings, hashes or frames.
+ *
+ * The collector must not run while njs code is executed, because values
+ * on the C stack are not scanned.  Memory allocated from other pools, e.g.
+ * the parent VM heap shared by clones, is neither scanned nor freed.
+ */
+
+njs_int_t njs_gc(njs_vm_t *vm, const njs_value_t *roots, njs_uint_t nroots,
+    size_t *freed);
+
+
+#endif /* _NJS_GC_H_INCLUDED_ */
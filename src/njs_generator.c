@@ -647,22 +647,43 @@ njs_generate_if_statement(njs_vm_t *vm, njs_generator_t *generator,
 
     /* The condition expression. */
 
-    ret = njs_generator(vm, generator, node->left);
-    if (njs_slow_path(ret != NJS_OK)) {
-        return ret;
-    }
+    if (njs_parser_is_constant(node->left)) {
 
-    njs_generate_code(generator, njs_vmcode_cond_jump_t, cond_jump,
-                      NJS_VMCODE_IF_FALSE_JUMP, 2);
-    cond_jump->cond = node->left->index;
+        /*
+         * A literal condition is not tested.  The branch which is not
+         * taken is still generated for its declarations and is removed
+         * as unreachable by njs_optimizer().
+         */
 
-    ret = njs_generate_node_index_release(vm, generator, node->left);
-    if (njs_slow_path(ret != NJS_OK)) {
-        return ret;
-    }
+        if (njs_is_true(&node->left->u.value)) {
+            jump_offset = 0;
+            label_offset = 0;
+
+        } else {
+            njs_generate_code_jump(generator, jump, 0);
+
+            jump_offset = njs_code_offset(generator, jump);
+            label_offset = jump_offset + offsetof(njs_vmcode_jump_t, offset);
+        }
+
+    } else {
+        ret = njs_generator(vm, generator, node->left);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_generate_code(generator, njs_vmcode_cond_jump_t, cond_jump,
+                          NJS_VMCODE_IF_FALSE_JUMP, 2);
+        cond_jump->cond = node->left->index;
+
+        ret = njs_generate_node_index_release(vm, generator, node->left);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
 
-    jump_offset = njs_code_offset(generator, cond_jump);
-    label_offset = jump_offset + offsetof(njs_vmcode_cond_jump_t, offset);
+        jump_offset = njs_code_offset(generator, cond_jump);
+        label_offset = jump_offset + offsetof(njs_vmcode_cond_jump_t, offset);
+    }
 
     if (node->right != NULL && node->right->token_type == NJS_TOKEN_BRANCHING) {
 
@@ -682,7 +703,9 @@ njs_generate_if_statement(njs_vm_t *vm, njs_generator_t *generator,
 
         njs_generate_code_jump(generator, jump, 0);
 
-        njs_code_set_offset(generator, label_offset, jump_offset);
+        if (label_offset != 0) {
+            njs_code_set_offset(generator, label_offset, jump_offset);
+        }
 
         jump_offset = njs_code_offset(generator, jump);
         label_offset = jump_offset + offsetof(njs_vmcode_jump_t, offset);
@@ -703,7 +726,9 @@ njs_generate_if_statement(njs_vm_t *vm, njs_generator_t *generator,
         return ret;
     }
 
-    njs_code_set_offset(generator, label_offset, jump_offset);
+    if (label_offset != 0) {
+        njs_code_set_offset(generator, label_offset, jump_offset);
+    }
 
     return NJS_OK;
 }
@@ -1727,6 +1752,7 @@ njs_generate_assignment(njs_vm_t *vm, njs_generator_t *generator,
     prop_set->value = expr->index;
     prop_set->object = object->index;
     prop_set->property = property->index;
+    njs_memzero(prop_set->cache, sizeof(prop_set->cache));
 
     node->index = expr->index;
     node->temporary = expr->temporary;
@@ -1827,6 +1853,7 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_generator_t *generator,
     prop_get->value = index;
     prop_get->object = object->index;
     prop_get->property = property->index;
+    njs_memzero(prop_get->cache, sizeof(prop_get->cache));
 
     expr = node->right;
 
@@ -1846,6 +1873,7 @@ njs_generate_operation_assignment(njs_vm_t *vm, njs_generator_t *generator,
     prop_set->value = node->index;
     prop_set->object = object->index;
     prop_set->property = property->index;
+    njs_memzero(prop_set->cache, sizeof(prop_set->cache));
 
     ret = njs_generate_children_indexes_release(vm, generator, lvalue);
     if (njs_slow_path(ret != NJS_OK)) {
@@ -2079,11 +2107,12 @@ static njs_int_t
 njs_generate_3addr_operation(njs_vm_t *vm, njs_generator_t *generator,
     njs_parser_node_t *node, njs_bool_t swap)
 {
-    njs_int_t           ret;
-    njs_index_t         index;
-    njs_parser_node_t   *left, *right;
-    njs_vmcode_move_t   *move;
-    njs_vmcode_3addr_t  *code;
+    njs_int_t              ret;
+    njs_index_t            index;
+    njs_parser_node_t      *left, *right;
+    njs_vmcode_move_t      *move;
+    njs_vmcode_3addr_t     *code;
+    njs_vmcode_prop_get_t  *prop_get;
 
     left = node->left;
 
@@ -2115,8 +2144,17 @@ njs_generate_3addr_operation(njs_vm_t *vm, njs_generator_t *generator,
         return ret;
     }
 
-    njs_generate_code(generator, njs_vmcode_3addr_t, code,
-                      node->u.operation, 3);
+    if (node->u.operation == NJS_VMCODE_PROPERTY_GET) {
+        njs_generate_code(generator, njs_vmcode_prop_get_t, prop_get,
+                          NJS_VMCODE_PROPERTY_GET, 3);
+        njs_memzero(prop_get->cache, sizeof(prop_get->cache));
+
+        code = (njs_vmcode_3addr_t *) prop_get;
+
+    } else {
+        njs_generate_code(generator, njs_vmcode_3addr_t, code,
+                          node->u.operation, 3);
+    }
 
     if (!swap) {
         code->src1 = left->index;
@@ -2294,6 +2332,7 @@ found:
     prop_get->value = index;
     prop_get->object = lvalue->left->index;
     prop_get->property = lvalue->right->index;
+    njs_memzero(prop_get->cache, sizeof(prop_get->cache));
 
     njs_generate_code(generator, njs_vmcode_3addr_t, code,
                       node->u.operation, 3);
@@ -2306,6 +2345,7 @@ found:
     prop_set->value = index;
     prop_set->object = lvalue->left->index;
     prop_set->property = lvalue->right->index;
+    njs_memzero(prop_set->cache, sizeof(prop_set->cache));
 
     if (post) {
         ret = njs_generate_index_release(vm, generator, index);
@@ -2426,6 +2466,10 @@ njs_generate_scope(njs_vm_t *vm, njs_generator_t *generator,
         return NJS_ERROR;
     }
 
+    if (njs_slow_path(njs_optimizer(vm, generator) != NJS_OK)) {
+        return NJS_ERROR;
+    }
+
     generator->code_size = generator->code_end - generator->code_start;
 
     scope_size = njs_scope_offset(scope->next_index[0]);
@@ -2468,6 +2512,7 @@ njs_generate_scope(njs_vm_t *vm, njs_generator_t *generator,
     code->end = generator->code_end;
     code->file = scope->file;
     code->name = *name;
+    code->generated = generator->generated;
 
     return NJS_OK;
 }
@@ -3323,6 +3368,7 @@ njs_generate_global_reference(njs_vm_t *vm, njs_generator_t *generator,
 
     prop_get->value = index;
     prop_get->object = NJS_INDEX_GLOBAL_OBJECT;
+    njs_memzero(prop_get->cache, sizeof(prop_get->cache));
 
     lex_entry = njs_lexer_entry(node->u.reference.unique_id);
     if (njs_slow_path(lex_entry == NULL)) {
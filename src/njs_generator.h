@@ -22,6 +22,9 @@ struct njs_generator_s {
     u_char                          *code_start;
     u_char                          *code_end;
 
+    /* The number of instructions before njs_optimizer(). */
+    njs_uint_t                      generated;
+
     /* Parsing Function() or eval(). */
     uint8_t                         runtime;           /* 1 bit */
 
@@ -14,6 +14,14 @@ typedef struct {
     njs_uint_t                 depth;
     const u_char               *start;
     const u_char               *end;
+
+    /*
+     * The elements of the arrays being parsed are collected here,
+     * so an array gets its storage of the exact size at once.
+     */
+    njs_value_t                *elements;
+    uint32_t                   nelements;
+    uint32_t                   elements_size;
 } njs_json_parse_ctx_t;
 
 
@@ -68,6 +76,8 @@ static const u_char *njs_json_parse_object(njs_json_parse_ctx_t *ctx,
     njs_value_t *value, const u_char *p);
 static const u_char *njs_json_parse_array(njs_json_parse_ctx_t *ctx,
     njs_value_t *value, const u_char *p);
+static njs_int_t njs_json_parse_element_add(njs_json_parse_ctx_t *ctx,
+    const njs_value_t *element);
 static const u_char *njs_json_parse_string(njs_json_parse_ctx_t *ctx,
     njs_value_t *value, const u_char *p);
 static const u_char *njs_json_parse_number(njs_json_parse_ctx_t *ctx,
@@ -140,6 +150,9 @@ njs_json_parse(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     ctx.depth = NJS_JSON_MAX_DEPTH;
     ctx.start = string.start;
     ctx.end = end;
+    ctx.elements = NULL;
+    ctx.nelements = 0;
+    ctx.elements_size = 0;
 
     p = njs_json_skip_space(p, end);
     if (njs_slow_path(p == end)) {
@@ -148,6 +161,11 @@ njs_json_parse(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     }
 
     p = njs_json_parse_value(&ctx, &value, p);
+
+    if (ctx.elements != NULL) {
+        njs_mp_free(vm->mem_pool, ctx.elements);
+    }
+
     if (njs_slow_path(p == NULL)) {
         return NJS_ERROR;
     }
@@ -360,6 +378,7 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
     const u_char *p)
 {
     njs_int_t           ret;
+    njs_uint_t          members;
     njs_object_t        *object;
     njs_value_t         prop_name, prop_value;
     njs_object_prop_t   *prop;
@@ -370,12 +389,12 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
         return NULL;
     }
 
-    object = njs_object_alloc(ctx->vm);
+    object = njs_object_shaped_alloc(ctx->vm);
     if (njs_slow_path(object == NULL)) {
         goto memory_error;
     }
 
-    prop = NULL;
+    members = 0;
 
     for ( ;; ) {
         p = njs_json_skip_space(p + 1, ctx->end);
@@ -385,7 +404,7 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
 
         if (*p != '"') {
             if (njs_fast_path(*p == '}')) {
-                if (njs_slow_path(prop != NULL)) {
+                if (njs_slow_path(members != 0)) {
                     njs_json_parse_exception(ctx, "Trailing comma", p - 1);
                     return NULL;
                 }
@@ -418,13 +437,28 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
             return NULL;
         }
 
+        members = 1;
+
+        njs_string_get(&prop_name, &lhq.key);
+        lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
+
+        if (object->shape != NULL) {
+            ret = njs_shape_property_init(ctx->vm, object, &lhq, &prop_name,
+                                          &prop_value);
+            if (ret != NJS_DECLINED) {
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return NULL;
+                }
+
+                goto next;
+            }
+        }
+
         prop = njs_object_prop_alloc(ctx->vm, &prop_name, &prop_value, 1);
         if (njs_slow_path(prop == NULL)) {
             goto memory_error;
         }
 
-        njs_string_get(&prop_name, &lhq.key);
-        lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
         lhq.value = prop;
         lhq.replace = 1;
         lhq.pool = ctx->pool;
@@ -436,6 +470,8 @@ njs_json_parse_object(njs_json_parse_ctx_t *ctx, njs_value_t *value,
             return NULL;
         }
 
+next:
+
         p = njs_json_skip_space(p, ctx->end);
         if (njs_slow_path(p == ctx->end)) {
             goto error_end;
@@ -480,6 +516,7 @@ static const u_char *
 njs_json_parse_array(njs_json_parse_ctx_t *ctx, njs_value_t *value,
     const u_char *p)
 {
+    uint32_t     base, length;
     njs_int_t    ret;
     njs_bool_t   empty;
     njs_array_t  *array;
@@ -490,11 +527,7 @@ njs_json_parse_array(njs_json_parse_ctx_t *ctx, njs_value_t *value,
         return NULL;
     }
 
-    array = njs_array_alloc(ctx->vm, 0, 0, NJS_ARRAY_SPARE);
-    if (njs_slow_path(array == NULL)) {
-        return NULL;
-    }
-
+    base = ctx->nelements;
     empty = 1;
 
     for ( ;; ) {
@@ -517,7 +550,7 @@ njs_json_parse_array(njs_json_parse_ctx_t *ctx, njs_value_t *value,
             return NULL;
         }
 
-        ret = njs_array_add(ctx->vm, array, &element);
+        ret = njs_json_parse_element_add(ctx, &element);
         if (njs_slow_path(ret != NJS_OK)) {
             return NULL;
         }
@@ -538,6 +571,20 @@ njs_json_parse_array(njs_json_parse_ctx_t *ctx, njs_value_t *value,
         }
     }
 
+    length = ctx->nelements - base;
+
+    array = njs_array_alloc(ctx->vm, 1, length, 0);
+    if (njs_slow_path(array == NULL)) {
+        return NULL;
+    }
+
+    if (length != 0) {
+        memcpy(array->start, &ctx->elements[base],
+               length * sizeof(njs_value_t));
+    }
+
+    ctx->nelements = base;
+
     njs_set_array(value, array);
 
     ctx->depth++;
@@ -558,6 +605,44 @@ error_end:
 }
 
 
+static njs_int_t
+njs_json_parse_element_add(njs_json_parse_ctx_t *ctx,
+    const njs_value_t *element)
+{
+    uint64_t     size;
+    njs_value_t  *elements;
+
+    if (njs_slow_path(ctx->nelements == ctx->elements_size)) {
+        size = njs_max((uint64_t) ctx->elements_size * 2, 64);
+
+        if (njs_slow_path(size > (UINT32_MAX / sizeof(njs_value_t)))) {
+            njs_memory_error(ctx->vm);
+            return NJS_ERROR;
+        }
+
+        elements = njs_mp_align(ctx->pool, sizeof(njs_value_t),
+                                size * sizeof(njs_value_t));
+        if (njs_slow_path(elements == NULL)) {
+            njs_memory_error(ctx->vm);
+            return NJS_ERROR;
+        }
+
+        if (ctx->elements != NULL) {
+            memcpy(elements, ctx->elements,
+                   ctx->nelements * sizeof(njs_value_t));
+            njs_mp_free(ctx->pool, ctx->elements);
+        }
+
+        ctx->elements = elements;
+        ctx->elements_size = size;
+    }
+
+    ctx->elements[ctx->nelements++] = *element;
+
+    return NJS_OK;
+}
+
+
 static const u_char *
 njs_json_parse_string(njs_json_parse_ctx_t *ctx, njs_value_t *value,
     const u_char *p)
@@ -860,6 +945,7 @@ static njs_json_state_t *
 njs_json_push_parse_state(njs_vm_t *vm, njs_json_parse_t *parse,
     njs_value_t *value)
 {
+    njs_int_t         ret;
     njs_json_state_t  *state;
 
     if (njs_slow_path(parse->depth >= NJS_JSON_MAX_DEPTH)) {
@@ -867,6 +953,14 @@ njs_json_push_parse_state(njs_vm_t *vm, njs_json_parse_t *parse,
         return NULL;
     }
 
+    if (njs_object(value)->shape != NULL) {
+        /* The reviver removes properties and keeps references to them. */
+        ret = njs_shape_dictionary(vm, njs_object(value));
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NULL;
+        }
+    }
+
     state = &parse->states[parse->depth++];
     state->value = *value;
     state->index = 0;
@@ -638,6 +638,31 @@ njs_lexer_keyword_find(njs_lexer_t *lexer, u_char *key, size_t length,
 }
 
 
+/*
+ * Returns the unique id of a name as the lexer assigns it to the name
+ * token, the name is added to the keywords hash if it is absent.
+ */
+
+uintptr_t
+njs_lexer_unique_id(njs_vm_t *vm, const u_char *key, size_t length)
+{
+    njs_lexer_t                      lexer;
+    const njs_lexer_keyword_entry_t  *key_entry;
+
+    key_entry = njs_lexer_keyword(key, length);
+
+    if (key_entry != NULL) {
+        return (uintptr_t) &key_entry->value->entry;
+    }
+
+    lexer.keywords_hash = &vm->shared->keywords_hash;
+    lexer.mem_pool = vm->mem_pool;
+
+    return (uintptr_t) njs_lexer_keyword_find(&lexer, (u_char *) key, length,
+                                              njs_djb_hash(key, length));
+}
+
+
 static njs_int_t
 njs_lexer_word(njs_lexer_t *lexer, njs_lexer_token_t *token)
 {
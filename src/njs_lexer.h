@@ -261,6 +261,8 @@ njs_int_t njs_lexer_next_token(njs_lexer_t *lexer, njs_lexer_token_t *token);
 const njs_lexer_keyword_entry_t *njs_lexer_keyword(const u_char *key,
     size_t length);
 njs_int_t njs_lexer_keywords(njs_arr_t *array);
+uintptr_t njs_lexer_unique_id(njs_vm_t *vm, const u_char *key,
+    size_t length);
 
 
 njs_inline const njs_lexer_entry_t *
@@ -53,12 +53,18 @@
 #include <njs_lexer.h>
 #include <njs_parser.h>
 #include <njs_generator.h>
+#include <njs_optimizer.h>
+#include <njs_profiler.h>
 
 #include <njs_boolean.h>
 #include <njs_symbol.h>
 #include <njs_string.h>
 #include <njs_object.h>
 #include <njs_object_hash.h>
+#include <njs_shape.h>
+#include <njs_snapshot.h>
+#include <njs_gc.h>
+#include <njs_bytecode.h>
 #include <njs_array.h>
 #include <njs_array_buffer.h>
 #include <njs_typed_array.h>
@@ -67,6 +73,7 @@
 #include <njs_regexp_pattern.h>
 #include <njs_date.h>
 #include <njs_promise.h>
+#include <njs_map.h>
 
 #include <njs_math.h>
 #include <njs_json.h>
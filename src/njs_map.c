@@ -0,0 +1,1587 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+#define NJS_MAP_TABLE_MIN   8
+#define NJS_MAP_TABLE_MAX   (1 << 26)
+
+
+static njs_int_t njs_map_rebuild(njs_vm_t *vm, njs_map_t *map);
+static void njs_map_table_retire(njs_vm_t *vm, njs_map_t *map,
+    njs_map_table_t *table, njs_map_table_t *next);
+static njs_int_t njs_map_prototype_set(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+static njs_int_t njs_set_prototype_add(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused);
+
+
+static const njs_value_t  njs_map_string_set = njs_string("set");
+static const njs_value_t  njs_map_string_add = njs_string("add");
+static const njs_value_t  njs_map_string_next = njs_string("next");
+static const njs_value_t  njs_map_string_done = njs_string("done");
+static const njs_value_t  njs_map_string_value = njs_string("value");
+static const njs_value_t  njs_map_string_return = njs_string("return");
+static const njs_value_t  njs_map_symbol_iterator =
+                                njs_wellknown_symbol(NJS_SYMBOL_ITERATOR);
+
+
+njs_inline const char *
+njs_map_type_name(njs_value_type_t type)
+{
+    return (type == NJS_MAP) ? "Map" : "Set";
+}
+
+
+static uint32_t
+njs_map_hash(const njs_value_t *key)
+{
+    double     num;
+    uint64_t   u;
+    njs_str_t  str;
+
+    switch (key->type) {
+    case NJS_STRING:
+        njs_string_get(key, &str);
+        return njs_djb_hash(str.start, str.length);
+
+    case NJS_NUMBER:
+        num = njs_number(key);
+
+        /* SameValueZero: -0 equals +0 and NaN equals NaN. */
+
+        if (num == 0) {
+            u = 0;
+
+        } else if (isnan(num)) {
+            u = 0x7ff8000000000000ULL;
+
+        } else {
+            memcpy(&u, &num, sizeof(uint64_t));
+        }
+
+        break;
+
+    case NJS_SYMBOL:
+        u = njs_symbol_key(key);
+        break;
+
+    case NJS_NULL:
+    case NJS_UNDEFINED:
+    case NJS_BOOLEAN:
+        u = njs_bool(key);
+        break;
+
+    default:
+        u = (uintptr_t) njs_object(key);
+        break;
+    }
+
+    /* MurmurHash3 64-bit finalizer. */
+
+    u ^= (uint64_t) key->type << 56;
+
+    u ^= u >> 33;
+    u *= 0xff51afd7ed558ccdULL;
+    u ^= u >> 33;
+    u *= 0xc4ceb9fe1a85ec53ULL;
+    u ^= u >> 33;
+
+    return (uint32_t) u;
+}
+
+
+njs_map_t *
+njs_map_alloc(njs_vm_t *vm, njs_value_type_t type)
+{
+    njs_map_t  *map;
+
+    map = njs_mp_alloc(vm->mem_pool, sizeof(njs_map_t));
+    if (njs_slow_path(map == NULL)) {
+        njs_memory_error(vm);
+        return NULL;
+    }
+
+    njs_lvlhsh_init(&map->object.hash);
+    njs_lvlhsh_init(&map->object.shared_hash);
+    map->object.__proto__ = &vm->prototypes[(type == NJS_MAP)
+                                            ? NJS_OBJ_TYPE_MAP
+                                            : NJS_OBJ_TYPE_SET].object;
+    map->object.slots = NULL;
+    map->object.shape = NULL;
+    map->object.type = type;
+    map->object.shared = 0;
+    map->object.extensible = 1;
+    map->object.error_data = 0;
+    map->object.fast_array = 0;
+
+    map->table = NULL;
+    map->walkers = 0;
+    map->iterated = 0;
+
+    return map;
+}
+
+
+static njs_map_table_t *
+njs_map_table_alloc(njs_vm_t *vm, uint32_t size)
+{
+    njs_map_table_t  *table;
+
+    table = njs_mp_align(vm->mem_pool, sizeof(njs_value_t),
+                         sizeof(njs_map_table_t)
+                         + size * sizeof(njs_map_entry_t)
+                         + 3 * size * sizeof(uint32_t));
+    if (njs_slow_path(table == NULL)) {
+        njs_memory_error(vm);
+        return NULL;
+    }
+
+    table->next = NULL;
+    table->size = size;
+    table->used = 0;
+    table->deleted = 0;
+    table->obsolete = 0;
+    table->hashes = (uint32_t *) &table->entries[size];
+    table->index = table->hashes + size;
+
+    njs_memzero(table->index, 2 * size * sizeof(uint32_t));
+
+    return table;
+}
+
+
+njs_inline void
+njs_map_index_add(njs_map_table_t *table, uint32_t hash, uint32_t n)
+{
+    uint32_t  i, mask;
+
+    mask = 2 * table->size - 1;
+
+    for (i = hash & mask; table->index[i] != 0; i = (i + 1) & mask) {
+        /* void */
+    }
+
+    table->index[i] = n + 1;
+}
+
+
+static njs_int_t
+njs_map_table_find(njs_map_table_t *table, const njs_value_t *key,
+    uint32_t hash)
+{
+    uint32_t  i, n, mask;
+
+    mask = 2 * table->size - 1;
+
+    for (i = hash & mask; table->index[i] != 0; i = (i + 1) & mask) {
+        n = table->index[i] - 1;
+
+        if (table->hashes[n] == hash
+            && njs_values_same_zero(&table->entries[n].key, key))
+        {
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+
+njs_map_entry_t *
+njs_map_find(njs_map_t *map, const njs_value_t *key)
+{
+    njs_int_t  n;
+
+    if (map->table == NULL) {
+        return NULL;
+    }
+
+    n = njs_map_table_find(map->table, key, njs_map_hash(key));
+
+    return (n >= 0) ? &map->table->entries[n] : NULL;
+}
+
+
+njs_int_t
+njs_map_insert(njs_vm_t *vm, njs_map_t *map, const njs_value_t *key,
+    const njs_value_t *value)
+{
+    uint32_t         n, hash;
+    njs_int_t        ret;
+    njs_map_entry_t  *entry;
+    njs_map_table_t  *table;
+
+    hash = njs_map_hash(key);
+    table = map->table;
+
+    if (table != NULL) {
+        ret = njs_map_table_find(table, key, hash);
+
+        if (ret >= 0) {
+            table->entries[ret].value = *value;
+            return NJS_OK;
+        }
+    }
+
+    if (table == NULL || table->used == table->size) {
+        ret = njs_map_rebuild(vm, map);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        table = map->table;
+    }
+
+    n = table->used++;
+
+    entry = &table->entries[n];
+
+    if (njs_is_number(key) && njs_number(key) == 0) {
+        /* -0 is stored as +0. */
+        njs_set_number(&entry->key, 0);
+
+    } else {
+        entry->key = *key;
+    }
+
+    entry->value = *value;
+    table->hashes[n] = hash;
+
+    njs_map_index_add(table, hash, n);
+
+    return NJS_OK;
+}
+
+
+njs_int_t
+njs_map_remove(njs_vm_t *vm, njs_map_t *map, const njs_value_t *key)
+{
+    njs_int_t        n;
+    njs_map_table_t  *table;
+
+    table = map->table;
+
+    if (table == NULL) {
+        return NJS_DECLINED;
+    }
+
+    n = njs_map_table_find(table, key, njs_map_hash(key));
+
+    if (n < 0) {
+        return NJS_DECLINED;
+    }
+
+    /* The index slot is kept to not break the probe sequences. */
+
+    njs_set_invalid(&table->entries[n].key);
+    njs_set_undefined(&table->entries[n].value);
+    table->deleted++;
+
+    if (table->size > NJS_MAP_TABLE_MIN
+        && (table->used - table->deleted) * 8 < table->size)
+    {
+        return njs_map_rebuild(vm, map);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_rebuild(njs_vm_t *vm, njs_map_t *map)
+{
+    uint32_t         i, n, size, live;
+    njs_map_table_t  *table, *old;
+
+    old = map->table;
+    live = (old != NULL) ? old->used - old->deleted : 0;
+
+    size = NJS_MAP_TABLE_MIN;
+
+    while (size < live * 2) {
+        size *= 2;
+    }
+
+    if (njs_slow_path(size > NJS_MAP_TABLE_MAX)) {
+        njs_range_error(vm, "Map maximum size exceeded");
+        return NJS_ERROR;
+    }
+
+    table = njs_map_table_alloc(vm, size);
+    if (njs_slow_path(table == NULL)) {
+        return NJS_ERROR;
+    }
+
+    if (old != NULL) {
+        n = 0;
+
+        for (i = 0; i < old->used; i++) {
+            if (!njs_is_valid(&old->entries[i].key)) {
+                continue;
+            }
+
+            table->entries[n] = old->entries[i];
+            table->hashes[n] = old->hashes[i];
+            njs_map_index_add(table, old->hashes[i], n);
+            n++;
+        }
+
+        table->used = n;
+
+        njs_map_table_retire(vm, map, old, table);
+    }
+
+    map->table = table;
+
+    return NJS_OK;
+}
+
+
+static void
+njs_map_table_retire(njs_vm_t *vm, njs_map_t *map, njs_map_table_t *table,
+    njs_map_table_t *next)
+{
+    if (map->walkers == 0 && !map->iterated) {
+        njs_mp_free(vm->mem_pool, table);
+        return;
+    }
+
+    table->next = next;
+    table->obsolete = 1;
+}
+
+
+static void
+njs_map_clear(njs_vm_t *vm, njs_map_t *map)
+{
+    uint32_t         i;
+    njs_map_table_t  *table;
+
+    table = map->table;
+
+    if (table == NULL) {
+        return;
+    }
+
+    map->table = NULL;
+
+    for (i = 0; i < table->used; i++) {
+        njs_set_invalid(&table->entries[i].key);
+        njs_set_undefined(&table->entries[i].value);
+    }
+
+    table->deleted = table->used;
+
+    njs_map_table_retire(vm, map, table, NULL);
+}
+
+
+/*
+ * Moves an iteration position from replaced tables to the current one,
+ * the deleted entries before the position are not copied to a new table.
+ */
+
+static njs_map_table_t *
+njs_map_position(njs_map_t *map, njs_map_table_t *table, uint32_t *index)
+{
+    uint32_t  i, n;
+
+    while (table != NULL && table->obsolete) {
+        n = njs_min(*index, table->used);
+
+        for (i = 0; i < n; i++) {
+            if (!njs_is_valid(&table->entries[i].key)) {
+                (*index)--;
+            }
+        }
+
+        table = table->next;
+    }
+
+    return (table != NULL) ? table : map->table;
+}
+
+
+static njs_map_t *
+njs_map_this(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_value_type_t type, const char *method)
+{
+    njs_value_t  *value;
+
+    value = njs_arg(args, nargs, 0);
+
+    if (njs_slow_path(value->type != type)) {
+        njs_type_error(vm, "Method %s.prototype.%s called on incompatible "
+                       "receiver", njs_map_type_name(type), method);
+        return NULL;
+    }
+
+    return njs_map(value);
+}
+
+
+static njs_int_t
+njs_map_iterator_close(njs_vm_t *vm, njs_value_t *iterator)
+{
+    njs_int_t    ret;
+    njs_value_t  method, retval;
+
+    ret = njs_value_property(vm, iterator,
+                             njs_value_arg(&njs_map_string_return), &method);
+    if (ret != NJS_OK || !njs_is_function(&method)) {
+        return NJS_OK;
+    }
+
+    return njs_function_call(vm, njs_function(&method), iterator, NULL, 0,
+                             &retval);
+}
+
+
+static njs_int_t
+njs_map_add_item(njs_vm_t *vm, njs_value_t *map, njs_value_t *adder,
+    njs_bool_t fast, njs_value_t *item)
+{
+    njs_int_t    ret;
+    njs_value_t  args[2], retval;
+
+    if (map->type == NJS_MAP) {
+        if (njs_slow_path(!njs_is_object(item))) {
+            njs_type_error(vm, "Iterator value %s is not an entry object",
+                           njs_type_string(item->type));
+            return NJS_ERROR;
+        }
+
+        ret = njs_value_property_i64(vm, item, 0, &args[0]);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            return ret;
+        }
+
+        ret = njs_value_property_i64(vm, item, 1, &args[1]);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            return ret;
+        }
+
+    } else {
+        args[0] = *item;
+        njs_set_undefined(&args[1]);
+    }
+
+    if (fast) {
+        return njs_map_insert(vm, njs_map(map), &args[0], &args[1]);
+    }
+
+    return njs_function_call(vm, njs_function(adder), map, args,
+                             (map->type == NJS_MAP) ? 2 : 1, &retval);
+}
+
+
+static njs_int_t
+njs_map_fill(njs_vm_t *vm, njs_value_t *map, njs_value_t *iterable)
+{
+    int64_t            i, length;
+    uint32_t           n;
+    njs_int_t          ret;
+    njs_bool_t         fast;
+    njs_value_t        adder, method, iterator, next, result, item;
+    njs_map_table_t    *table;
+    njs_function_t     *function;
+    const njs_value_t  *name;
+
+    name = (map->type == NJS_MAP) ? &njs_map_string_set : &njs_map_string_add;
+
+    ret = njs_value_property(vm, map, njs_value_arg(name), &adder);
+    if (njs_slow_path(ret == NJS_ERROR)) {
+        return ret;
+    }
+
+    if (njs_slow_path(!njs_is_function(&adder))) {
+        njs_type_error(vm, "%s.prototype.%s is not a function",
+                       njs_map_type_name(map->type),
+                       (map->type == NJS_MAP) ? "set" : "add");
+        return NJS_ERROR;
+    }
+
+    function = njs_function(&adder);
+
+    fast = function->native
+           && function->u.native == ((map->type == NJS_MAP)
+                                     ? njs_map_prototype_set
+                                     : njs_set_prototype_add);
+
+    if (fast && iterable->type == map->type) {
+        /* new Map(map), new Set(set). */
+
+        table = njs_map(iterable)->table;
+
+        if (table != NULL) {
+            for (n = 0; n < table->used; n++) {
+                if (!njs_is_valid(&table->entries[n].key)) {
+                    continue;
+                }
+
+                ret = njs_map_insert(vm, njs_map(map),
+                                     &table->entries[n].key,
+                                     &table->entries[n].value);
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return ret;
+                }
+            }
+        }
+
+        return NJS_OK;
+    }
+
+    if (njs_is_array(iterable) || njs_is_string(iterable)) {
+        for (i = 0; ; i++) {
+            ret = njs_value_length(vm, iterable, &length);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+
+            if (i >= length) {
+                return NJS_OK;
+            }
+
+            ret = njs_value_property_i64(vm, iterable, i, &item);
+            if (njs_slow_path(ret == NJS_ERROR)) {
+                return ret;
+            }
+
+            ret = njs_map_add_item(vm, map, &adder, fast, &item);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+        }
+    }
+
+    ret = njs_value_property(vm, iterable,
+                             njs_value_arg(&njs_map_symbol_iterator), &method);
+    if (njs_slow_path(ret == NJS_ERROR)) {
+        return ret;
+    }
+
+    if (njs_slow_path(!njs_is_function(&method))) {
+        njs_type_error(vm, "%s is not iterable",
+                       njs_type_string(iterable->type));
+        return NJS_ERROR;
+    }
+
+    ret = njs_function_call(vm, njs_function(&method), iterable, NULL, 0,
+                            &iterator);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    if (njs_slow_path(!njs_is_object(&iterator))) {
+        njs_type_error(vm, "Result of the Symbol.iterator method "
+                       "is not an object");
+        return NJS_ERROR;
+    }
+
+    ret = njs_value_property(vm, &iterator,
+                             njs_value_arg(&njs_map_string_next), &next);
+    if (njs_slow_path(ret == NJS_ERROR)) {
+        return ret;
+    }
+
+    if (njs_slow_path(!njs_is_function(&next))) {
+        njs_type_error(vm, "iterator.next is not a function");
+        return NJS_ERROR;
+    }
+
+    for ( ;; ) {
+        ret = njs_function_call(vm, njs_function(&next), &iterator, NULL, 0,
+                                &result);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        if (njs_slow_path(!njs_is_object(&result))) {
+            njs_type_error(vm, "Iterator result %s is not an object",
+                           njs_type_string(result.type));
+            return NJS_ERROR;
+        }
+
+        ret = njs_value_property(vm, &result,
+                                 njs_value_arg(&njs_map_string_done), &item);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            return ret;
+        }
+
+        if (njs_is_true(&item)) {
+            return NJS_OK;
+        }
+
+        ret = njs_value_property(vm, &result,
+                                 njs_value_arg(&njs_map_string_value), &item);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            return ret;
+        }
+
+        ret = njs_map_add_item(vm, map, &adder, fast, &item);
+        if (njs_slow_path(ret != NJS_OK)) {
+            result = vm->retval;
+            (void) njs_map_iterator_close(vm, &iterator);
+            vm->retval = result;
+
+            return ret;
+        }
+    }
+}
+
+
+static njs_int_t
+njs_map_constructor(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    njs_int_t    ret;
+    njs_map_t    *map;
+    njs_value_t  value, *iterable;
+
+    if (!vm->top_frame->ctor) {
+        njs_type_error(vm, "Constructor %s requires 'new'",
+                       njs_map_type_name(type));
+        return NJS_ERROR;
+    }
+
+    map = njs_map_alloc(vm, type);
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    njs_set_map(&value, map);
+
+    iterable = njs_arg(args, nargs, 1);
+
+    if (!njs_is_null_or_undefined(iterable)) {
+        ret = njs_map_fill(vm, &value, iterable);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    vm->retval = value;
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_get_species(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    vm->retval = args[0];
+
+    return NJS_OK;
+}
+
+
+static const njs_object_prop_t  njs_map_constructor_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Map"),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 0, 0.0),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_SPECIES),
+        .value = njs_value(NJS_INVALID, 1, NAN),
+        .getter = njs_native_function(njs_map_get_species, 0),
+        .setter = njs_value(NJS_UNDEFINED, 0, NAN),
+        .writable = NJS_ATTRIBUTE_UNSET,
+        .configurable = 1,
+        .enumerable = 0,
+    },
+};
+
+
+const njs_object_init_t  njs_map_constructor_init = {
+    njs_map_constructor_properties,
+    njs_nitems(njs_map_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_set_constructor_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("Set"),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 0, 0.0),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_SPECIES),
+        .value = njs_value(NJS_INVALID, 1, NAN),
+        .getter = njs_native_function(njs_map_get_species, 0),
+        .setter = njs_value(NJS_UNDEFINED, 0, NAN),
+        .writable = NJS_ATTRIBUTE_UNSET,
+        .configurable = 1,
+        .enumerable = 0,
+    },
+};
+
+
+const njs_object_init_t  njs_set_constructor_init = {
+    njs_set_constructor_properties,
+    njs_nitems(njs_set_constructor_properties),
+};
+
+
+static njs_int_t
+njs_map_prototype_get(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    njs_map_t        *map;
+    njs_map_entry_t  *entry;
+
+    map = njs_map_this(vm, args, nargs, NJS_MAP, "get");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    entry = njs_map_find(map, njs_arg(args, nargs, 1));
+
+    if (entry != NULL) {
+        vm->retval = entry->value;
+
+    } else {
+        njs_set_undefined(&vm->retval);
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_set(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    njs_int_t  ret;
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, NJS_MAP, "set");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_map_insert(vm, map, njs_arg(args, nargs, 1),
+                         njs_arg(args, nargs, 2));
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    vm->retval = args[0];
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_set_prototype_add(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t unused)
+{
+    njs_int_t  ret;
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, NJS_SET, "add");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_map_insert(vm, map, njs_arg(args, nargs, 1),
+                         &njs_value_undefined);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    vm->retval = args[0];
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_has(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, type, "has");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    njs_set_boolean(&vm->retval,
+                    njs_map_find(map, njs_arg(args, nargs, 1)) != NULL);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_delete(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    njs_int_t  ret;
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, type, "delete");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_map_remove(vm, map, njs_arg(args, nargs, 1));
+    if (njs_slow_path(ret == NJS_ERROR)) {
+        return ret;
+    }
+
+    njs_set_boolean(&vm->retval, ret == NJS_OK);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_clear(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, type, "clear");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    njs_map_clear(vm, map);
+
+    njs_set_undefined(&vm->retval);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_size(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    njs_map_t        *map;
+    njs_map_table_t  *table;
+
+    map = njs_map_this(vm, args, nargs, type, "size");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    table = map->table;
+
+    njs_set_number(&vm->retval,
+                   (table != NULL) ? table->used - table->deleted : 0);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_for_each(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t type)
+{
+    uint32_t         index;
+    njs_int_t        ret;
+    njs_map_t        *map;
+    njs_value_t      *callback, arguments[3], retval;
+    njs_map_entry_t  *entry;
+    njs_map_table_t  *table;
+
+    map = njs_map_this(vm, args, nargs, type, "forEach");
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    callback = njs_arg(args, nargs, 1);
+
+    if (njs_slow_path(!njs_is_function(callback))) {
+        njs_type_error(vm, "callback argument is not callable");
+        return NJS_ERROR;
+    }
+
+    /* Entries added during the iteration are visited as well. */
+
+    map->walkers++;
+
+    ret = NJS_OK;
+    index = 0;
+    table = map->table;
+
+    for ( ;; ) {
+        table = njs_map_position(map, table, &index);
+
+        if (table == NULL || index >= table->used) {
+            break;
+        }
+
+        entry = &table->entries[index++];
+
+        if (!njs_is_valid(&entry->key)) {
+            continue;
+        }
+
+        arguments[0] = (type == NJS_MAP) ? entry->value : entry->key;
+        arguments[1] = entry->key;
+        arguments[2] = args[0];
+
+        ret = njs_function_call(vm, njs_function(callback),
+                                njs_arg(args, nargs, 2), arguments, 3,
+                                &retval);
+        if (njs_slow_path(ret != NJS_OK)) {
+            break;
+        }
+    }
+
+    map->walkers--;
+
+    if (njs_fast_path(ret == NJS_OK)) {
+        njs_set_undefined(&vm->retval);
+    }
+
+    return ret;
+}
+
+
+static njs_int_t
+njs_map_iterator_create(njs_vm_t *vm, njs_map_t *map, njs_map_iterate_t kind)
+{
+    njs_map_iterator_t  *iterator;
+
+    iterator = njs_mp_alloc(vm->mem_pool, sizeof(njs_map_iterator_t));
+    if (njs_slow_path(iterator == NULL)) {
+        njs_memory_error(vm);
+        return NJS_ERROR;
+    }
+
+    njs_lvlhsh_init(&iterator->object.hash);
+    njs_lvlhsh_init(&iterator->object.shared_hash);
+    iterator->object.__proto__ =
+                    &vm->prototypes[(map->object.type == NJS_MAP)
+                                    ? NJS_OBJ_TYPE_MAP_ITERATOR
+                                    : NJS_OBJ_TYPE_SET_ITERATOR].object;
+    iterator->object.slots = NULL;
+    iterator->object.shape = NULL;
+    iterator->object.type = NJS_MAP_ITERATOR;
+    iterator->object.shared = 0;
+    iterator->object.extensible = 1;
+    iterator->object.error_data = 0;
+    iterator->object.fast_array = 0;
+
+    /* Replaced tables are not freed anymore. */
+    map->iterated = 1;
+
+    iterator->map = map;
+    iterator->table = map->table;
+    iterator->index = 0;
+    iterator->kind = kind;
+
+    njs_set_map_iterator(&vm->retval, iterator);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_prototype_iterator(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t kind)
+{
+    static const char  *names[] = { "keys", "values", "entries" };
+
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, NJS_MAP, names[kind]);
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    return njs_map_iterator_create(vm, map, kind);
+}
+
+
+static njs_int_t
+njs_set_prototype_iterator(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
+    njs_index_t kind)
+{
+    static const char  *names[] = { "keys", "values", "entries" };
+
+    njs_map_t  *map;
+
+    map = njs_map_this(vm, args, nargs, NJS_SET, names[kind]);
+    if (njs_slow_path(map == NULL)) {
+        return NJS_ERROR;
+    }
+
+    return njs_map_iterator_create(vm, map, kind);
+}
+
+
+static njs_function_t  njs_map_prototype_entries =
+    _njs_function(njs_map_prototype_iterator, 0, 0, NJS_MAP_ITERATE_ENTRIES);
+
+
+static const njs_object_prop_t  njs_map_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("constructor"),
+        .value = njs_prop_handler(njs_object_prototype_create_constructor),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("get"),
+        .value = njs_native_function(njs_map_prototype_get, 1),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("set"),
+        .value = njs_native_function(njs_map_prototype_set, 2),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("has"),
+        .value = njs_native_function2(njs_map_prototype_has, 1, NJS_MAP),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("delete"),
+        .value = njs_native_function2(njs_map_prototype_delete, 1, NJS_MAP),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("clear"),
+        .value = njs_native_function2(njs_map_prototype_clear, 0, NJS_MAP),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("forEach"),
+        .value = njs_native_function2(njs_map_prototype_for_each, 1, NJS_MAP),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("size"),
+        .value = njs_value(NJS_INVALID, 1, NAN),
+        .getter = njs_native_function2(njs_map_prototype_size, 0, NJS_MAP),
+        .setter = njs_value(NJS_UNDEFINED, 0, NAN),
+        .writable = NJS_ATTRIBUTE_UNSET,
+        .configurable = 1,
+        .enumerable = 0,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("keys"),
+        .value = njs_native_function2(njs_map_prototype_iterator, 0,
+                                      NJS_MAP_ITERATE_KEYS),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("values"),
+        .value = njs_native_function2(njs_map_prototype_iterator, 0,
+                                      NJS_MAP_ITERATE_VALUES),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("entries"),
+        .value = njs_shared_function(&njs_map_prototype_entries),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_ITERATOR),
+        .value = njs_shared_function(&njs_map_prototype_entries),
+        .writable = 1,
+        .configurable = 1,
+        .alias = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_TO_STRING_TAG),
+        .value = njs_string("Map"),
+        .configurable = 1,
+    },
+};
+
+
+const njs_object_init_t  njs_map_prototype_init = {
+    njs_map_prototype_properties,
+    njs_nitems(njs_map_prototype_properties),
+};
+
+
+const njs_object_type_init_t  njs_map_type_init = {
+    .constructor = njs_native_ctor(njs_map_constructor, 0, NJS_MAP),
+    .prototype_props = &njs_map_prototype_init,
+    .constructor_props = &njs_map_constructor_init,
+    .prototype_value = { .object = { .type = NJS_OBJECT } },
+};
+
+
+static njs_function_t  njs_set_prototype_values =
+    _njs_function(njs_set_prototype_iterator, 0, 0, NJS_MAP_ITERATE_VALUES);
+
+
+static const njs_object_prop_t  njs_set_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("constructor"),
+        .value = njs_prop_handler(njs_object_prototype_create_constructor),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("add"),
+        .value = njs_native_function(njs_set_prototype_add, 1),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("has"),
+        .value = njs_native_function2(njs_map_prototype_has, 1, NJS_SET),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("delete"),
+        .value = njs_native_function2(njs_map_prototype_delete, 1, NJS_SET),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("clear"),
+        .value = njs_native_function2(njs_map_prototype_clear, 0, NJS_SET),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("forEach"),
+        .value = njs_native_function2(njs_map_prototype_for_each, 1, NJS_SET),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("size"),
+        .value = njs_value(NJS_INVALID, 1, NAN),
+        .getter = njs_native_function2(njs_map_prototype_size, 0, NJS_SET),
+        .setter = njs_value(NJS_UNDEFINED, 0, NAN),
+        .writable = NJS_ATTRIBUTE_UNSET,
+        .configurable = 1,
+        .enumerable = 0,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("keys"),
+        .value = njs_shared_function(&njs_set_prototype_values),
+        .writable = 1,
+        .configurable = 1,
+        .alias = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("values"),
+        .value = njs_shared_function(&njs_set_prototype_values),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("entries"),
+        .value = njs_native_function2(njs_set_prototype_iterator, 0,
+                                      NJS_MAP_ITERATE_ENTRIES),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_ITERATOR),
+        .value = njs_shared_function(&njs_set_prototype_values),
+        .writable = 1,
+        .configurable = 1,
+        .alias = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_TO_STRING_TAG),
+        .value = njs_string("Set"),
+        .configurable = 1,
+    },
+};
+
+
+const njs_object_init_t  njs_set_prototype_init = {
+    njs_set_prototype_properties,
+    njs_nitems(njs_set_prototype_properties),
+};
+
+
+const njs_object_type_init_t  njs_set_type_init = {
+    .constructor = njs_native_ctor(njs_map_constructor, 0, NJS_SET),
+    .prototype_props = &njs_set_prototype_init,
+    .constructor_props = &njs_set_constructor_init,
+    .prototype_value = { .object = { .type = NJS_OBJECT } },
+};
+
+
+static njs_int_t
+njs_map_iterator_result(njs_vm_t *vm, const njs_value_t *value,
+    njs_bool_t done)
+{
+    njs_int_t           ret;
+    njs_value_t         boolean;
+    njs_object_t        *object;
+    njs_lvlhsh_query_t  lhq;
+
+    object = njs_object_shaped_alloc(vm);
+    if (njs_slow_path(object == NULL)) {
+        return NJS_ERROR;
+    }
+
+    lhq.key = njs_str_value("value");
+    lhq.key_hash = NJS_VALUE_HASH;
+
+    ret = njs_shape_add(vm, object, &lhq, &njs_map_string_value, value);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return NJS_ERROR;
+    }
+
+    njs_set_boolean(&boolean, done);
+
+    lhq.key = njs_str_value("done");
+    lhq.key_hash = NJS_DONE_HASH;
+
+    ret = njs_shape_add(vm, object, &lhq, &njs_map_string_done, &boolean);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return NJS_ERROR;
+    }
+
+    njs_set_object(&vm->retval, object);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_iterator_prototype_next(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t type)
+{
+    njs_value_t         *value, pair;
+    njs_array_t         *array;
+    njs_uint_t          index;
+    njs_map_entry_t     *entry;
+    njs_map_table_t     *table;
+    njs_map_iterator_t  *iterator;
+
+    value = njs_arg(args, nargs, 0);
+
+    index = (type == NJS_MAP) ? NJS_OBJ_TYPE_MAP_ITERATOR
+                              : NJS_OBJ_TYPE_SET_ITERATOR;
+
+    if (njs_slow_path(!njs_is_map_iterator(value)
+                      || njs_object(value)->__proto__
+                         != &vm->prototypes[index].object))
+    {
+        njs_type_error(vm, "Method %s Iterator.prototype.next called on "
+                       "incompatible receiver", njs_map_type_name(type));
+        return NJS_ERROR;
+    }
+
+    iterator = njs_map_iterator(value);
+
+    if (iterator->map == NULL) {
+        return njs_map_iterator_result(vm, &njs_value_undefined, 1);
+    }
+
+    table = njs_map_position(iterator->map, iterator->table,
+                             &iterator->index);
+
+    while (table != NULL && iterator->index < table->used) {
+        entry = &table->entries[iterator->index++];
+
+        if (!njs_is_valid(&entry->key)) {
+            continue;
+        }
+
+        iterator->table = table;
+
+        switch (iterator->kind) {
+        case NJS_MAP_ITERATE_KEYS:
+            return njs_map_iterator_result(vm, &entry->key, 0);
+
+        case NJS_MAP_ITERATE_VALUES:
+            return njs_map_iterator_result(vm, (type == NJS_MAP)
+                                               ? &entry->value : &entry->key,
+                                           0);
+
+        case NJS_MAP_ITERATE_ENTRIES:
+        default:
+            array = njs_array_alloc(vm, 1, 2, 0);
+            if (njs_slow_path(array == NULL)) {
+                return NJS_ERROR;
+            }
+
+            array->start[0] = entry->key;
+            array->start[1] = (type == NJS_MAP) ? entry->value : entry->key;
+
+            njs_set_array(&pair, array);
+
+            return njs_map_iterator_result(vm, &pair, 0);
+        }
+    }
+
+    iterator->map = NULL;
+    iterator->table = NULL;
+
+    return njs_map_iterator_result(vm, &njs_value_undefined, 1);
+}
+
+
+static njs_int_t
+njs_map_iterator_prototype_iterator(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused)
+{
+    vm->retval = *njs_arg(args, nargs, 0);
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_map_iterator_constructor(njs_vm_t *vm, njs_value_t *args,
+    njs_uint_t nargs, njs_index_t unused)
+{
+    njs_type_error(vm, "Illegal constructor");
+
+    return NJS_ERROR;
+}
+
+
+static const njs_object_prop_t  njs_map_iterator_constructor_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("MapIterator"),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 0, 0.0),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+};
+
+
+const njs_object_init_t  njs_map_iterator_constructor_init = {
+    njs_map_iterator_constructor_properties,
+    njs_nitems(njs_map_iterator_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_map_iterator_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("next"),
+        .value = njs_native_function2(njs_map_iterator_prototype_next, 0,
+                                      NJS_MAP),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_ITERATOR),
+        .value = njs_native_function(njs_map_iterator_prototype_iterator, 0),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_TO_STRING_TAG),
+        .value = njs_string("Map Iterator"),
+        .configurable = 1,
+    },
+};
+
+
+const njs_object_init_t  njs_map_iterator_prototype_init = {
+    njs_map_iterator_prototype_properties,
+    njs_nitems(njs_map_iterator_prototype_properties),
+};
+
+
+const njs_object_type_init_t  njs_map_iterator_type_init = {
+    .constructor = njs_native_ctor(njs_map_iterator_constructor, 0, 0),
+    .constructor_props = &njs_map_iterator_constructor_init,
+    .prototype_props = &njs_map_iterator_prototype_init,
+    .prototype_value = { .object = { .type = NJS_OBJECT } },
+};
+
+
+static const njs_object_prop_t  njs_set_iterator_constructor_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("name"),
+        .value = njs_string("SetIterator"),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("length"),
+        .value = njs_value(NJS_NUMBER, 0, 0.0),
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY_HANDLER,
+        .name = njs_string("prototype"),
+        .value = njs_prop_handler(njs_object_prototype_create),
+    },
+};
+
+
+const njs_object_init_t  njs_set_iterator_constructor_init = {
+    njs_set_iterator_constructor_properties,
+    njs_nitems(njs_set_iterator_constructor_properties),
+};
+
+
+static const njs_object_prop_t  njs_set_iterator_prototype_properties[] =
+{
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_string("next"),
+        .value = njs_native_function2(njs_map_iterator_prototype_next, 0,
+                                      NJS_SET),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_ITERATOR),
+        .value = njs_native_function(njs_map_iterator_prototype_iterator, 0),
+        .writable = 1,
+        .configurable = 1,
+    },
+
+    {
+        .type = NJS_PROPERTY,
+        .name = njs_wellknown_symbol(NJS_SYMBOL_TO_STRING_TAG),
+        .value = njs_string("Set Iterator"),
+        .configurable = 1,
+    },
+};
+
+
+const njs_object_init_t  njs_set_iterator_prototype_init = {
+    njs_set_iterator_prototype_properties,
+    njs_nitems(njs_set_iterator_prototype_properties),
+};
+
+
+const njs_object_type_init_t  njs_set_iterator_type_init = {
+    .constructor = njs_native_ctor(njs_map_iterator_constructor, 0, 0),
+    .constructor_props = &njs_set_iterator_constructor_init,
+    .prototype_props = &njs_set_iterator_prototype_init,
+    .prototype_value = { .object = { .type = NJS_OBJECT } },
+};
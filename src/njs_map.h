@@ -0,0 +1,107 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_MAP_H_INCLUDED_
+#define _NJS_MAP_H_INCLUDED_
+
+
+/*
+ * Map and Set entries are stored in a table in the insertion order
+ * and are found through an open addressing index of entry numbers.
+ * Keys are compared with SameValueZero and are never converted to
+ * strings.  A deleted entry gets the invalid key and stays in the table
+ * until the table is rebuilt.  A rebuilt table replaces the old one,
+ * iterators pointing to the old table move to the new one skipping
+ * the deleted entries.
+ */
+
+typedef struct {
+    njs_value_t                key;
+    njs_value_t                value;
+} njs_map_entry_t;
+
+
+typedef struct njs_map_table_s  njs_map_table_t;
+
+struct njs_map_table_s {
+    /* The table which replaced this one, NULL after clear(). */
+    njs_map_table_t            *next;
+
+    uint32_t                   size;
+    uint32_t                   used;
+    uint32_t                   deleted;
+    uint8_t                    obsolete;
+
+    uint32_t                   *hashes;
+    /* 2 * size slots of entry numbers plus one, 0 is an empty slot. */
+    uint32_t                   *index;
+
+    njs_map_entry_t            entries[];
+};
+
+
+struct njs_map_s {
+    njs_object_t               object;
+    njs_map_table_t            *table;
+
+    /*
+     * Replaced tables are kept for forEach() calls in progress and,
+     * once an iterator has been created, for iterators.
+     */
+    uint32_t                   walkers;
+    uint8_t                    iterated;
+};
+
+
+typedef enum {
+    NJS_MAP_ITERATE_KEYS = 0,
+    NJS_MAP_ITERATE_VALUES,
+    NJS_MAP_ITERATE_ENTRIES,
+} njs_map_iterate_t;
+
+
+struct njs_map_iterator_s {
+    njs_object_t               object;
+    /* NULL when the iteration is done. */
+    njs_map_t                  *map;
+    njs_map_table_t            *table;
+    uint32_t                   index;
+    njs_map_iterate_t          kind:8;
+};
+
+
+njs_inline void
+njs_set_map(njs_value_t *value, njs_map_t *map)
+{
+    value->data.u.map = map;
+    value->type = map->object.type;
+    value->data.truth = 1;
+}
+
+
+njs_inline void
+njs_set_map_iterator(njs_value_t *value, njs_map_iterator_t *iterator)
+{
+    value->data.u.map_iterator = iterator;
+    value->type = NJS_MAP_ITERATOR;
+    value->data.truth = 1;
+}
+
+
+njs_map_t *njs_map_alloc(njs_vm_t *vm, njs_value_type_t type);
+njs_map_entry_t *njs_map_find(njs_map_t *map, const njs_value_t *key);
+njs_int_t njs_map_insert(njs_vm_t *vm, njs_map_t *map, const njs_value_t *key,
+    const njs_value_t *value);
+njs_int_t njs_map_remove(njs_vm_t *vm, njs_map_t *map,
+    const njs_value_t *key);
+
+
+extern const njs_object_type_init_t  njs_map_type_init;
+extern const njs_object_type_init_t  njs_set_type_init;
+extern const njs_object_type_init_t  njs_map_iterator_type_init;
+extern const njs_object_type_init_t  njs_set_iterator_type_init;
+
+
+#endif /* _NJS_MAP_H_INCLUDED_ */
@@ -24,9 +24,6 @@ static njs_int_t njs_module_absolute_path(njs_vm_t *vm,
 static njs_bool_t njs_module_realpath_equal(const njs_str_t *path1,
     const njs_str_t *path2);
 static njs_int_t njs_module_read(njs_vm_t *vm, int fd, njs_str_t *body);
-static njs_module_t *njs_module_find(njs_vm_t *vm, njs_str_t *name,
-    njs_bool_t local);
-static njs_module_t *njs_module_add(njs_vm_t *vm, njs_str_t *name);
 static njs_int_t njs_module_insert(njs_vm_t *vm, njs_module_t *module);
 
 
@@ -421,7 +418,7 @@ const njs_lvlhsh_proto_t  njs_modules_hash_proto
 };
 
 
-static njs_module_t *
+njs_module_t *
 njs_module_find(njs_vm_t *vm, njs_str_t *name, njs_bool_t local)
 {
     njs_int_t           ret;
@@ -455,6 +452,7 @@ njs_module_find(njs_vm_t *vm, njs_str_t *name, njs_bool_t local)
 
         object->__proto__ = &vm->prototypes[NJS_OBJ_TYPE_OBJECT].object;
         object->slots = NULL;
+        object->shape = NULL;
         object->shared = 0;
         object->extensible = 1;
         object->error_data = 0;
@@ -474,7 +472,7 @@ njs_module_find(njs_vm_t *vm, njs_str_t *name, njs_bool_t local)
 }
 
 
-static njs_module_t *
+njs_module_t *
 njs_module_add(njs_vm_t *vm, njs_str_t *name)
 {
     njs_int_t           ret;
@@ -19,6 +19,9 @@ typedef struct {
 njs_int_t njs_module_load(njs_vm_t *vm);
 void njs_module_reset(njs_vm_t *vm);
 njs_int_t njs_parser_module(njs_vm_t *vm, njs_parser_t *parser);
+njs_module_t *njs_module_find(njs_vm_t *vm, njs_str_t *name,
+    njs_bool_t local);
+njs_module_t *njs_module_add(njs_vm_t *vm, njs_str_t *name);
 njs_int_t njs_module_require(njs_vm_t *vm, njs_value_t *args,
     njs_uint_t nargs, njs_index_t unused);
 
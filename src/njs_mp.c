@@ -14,11 +14,17 @@
  * size.  Page size must be a power of 2.  A page can be used entirely or
  * can be divided on chunks of equal size.  Chunk size must be a power of 2.
  * A cluster can contains pages with different chunk sizes.  Cluster size
- * must be a multiple of page size and may be not a power of 2.  Allocations
- * greater than page are allocated outside clusters.  Start addresses and
- * sizes of the clusters and large allocations are stored in rbtree blocks
- * to find them on free operations.  The rbtree nodes are sorted by start
- * addresses.
+ * must be a multiple of page size and a power of 2.  Allocations greater
+ * than page are allocated outside clusters.  Start addresses and sizes of
+ * the clusters and large allocations are stored in rbtree blocks to find
+ * them on free operations.  The rbtree nodes are sorted by start addresses.
+ * Clusters are aligned to their size and are also stored in a hash indexed
+ * by the aligned address, so a chunk is found without the rbtree search.
+ *
+ * An arena pool allocates memory by bumping a pointer in regions of
+ * the cluster size, the memory is not freed until the pool is rewound
+ * or destroyed.  Allocations greater than a quarter of region are
+ * allocated apart.
  */
 
 
@@ -48,6 +54,9 @@ typedef struct {
 
     /* Chunk bitmap.  There can be no more than 32 chunks in a page. */
     uint8_t                     map[4];
+
+    /* Bitmap of chunks marked by the garbage collector. */
+    uint8_t                     mark[4];
 } njs_mp_page_t;
 
 
@@ -71,6 +80,9 @@ typedef struct {
     NJS_RBTREE_NODE             (node);
     njs_mp_block_type_t         type:8;
 
+    /* A large allocation is marked by the garbage collector. */
+    uint8_t                     mark;
+
     /* Block size must be less than 4G. */
     uint32_t                    size;
 
@@ -79,6 +91,14 @@ typedef struct {
 } njs_mp_block_t;
 
 
+typedef struct njs_mp_region_s  njs_mp_region_t;
+
+struct njs_mp_region_s {
+    njs_mp_region_t             *next;
+    u_char                      *end;
+};
+
+
 typedef struct {
     njs_queue_t                 pages;
 
@@ -106,6 +126,26 @@ struct njs_mp_s {
     uint32_t                    page_alignment;
     uint32_t                    cluster_size;
 
+    /* Size of the clusters and the large allocations. */
+    size_t                      size;
+
+    /* New clusters are zeroed, see njs_mp_gc_enable(). */
+    uint8_t                     gc;
+
+    /* Open addressing hash of clusters, see njs_mp_find_cluster(). */
+    njs_mp_block_t              **clusters;
+    uint32_t                    clusters_mask;
+    uint32_t                    nclusters;
+    uint8_t                     cluster_size_shift;
+
+    uint8_t                     arena;
+
+    /* The regions of an arena pool and the current one. */
+    njs_mp_region_t             *regions;
+    njs_mp_region_t             *region;
+    njs_mp_region_t             *large;
+    u_char                      *free;
+
     njs_mp_slot_t               slots[];
 };
 
@@ -118,6 +158,10 @@ struct njs_mp_s {
     map[chunk / 8] &= ~(0x80 >> (chunk & 7))
 
 
+#define njs_mp_chunk_set_busy(map, chunk)                                     \
+    map[chunk / 8] |= (0x80 >> (chunk & 7))
+
+
 #define njs_mp_free_junk(p, size)                                             \
     njs_memset((p), 0x5A, size)
 
@@ -132,14 +176,20 @@ static void *njs_mp_alloc_small(njs_mp_t *mp, size_t size);
 static njs_uint_t njs_mp_alloc_chunk(u_char *map, njs_uint_t size);
 static njs_mp_page_t *njs_mp_alloc_page(njs_mp_t *mp);
 static njs_mp_block_t *njs_mp_alloc_cluster(njs_mp_t *mp);
+static njs_int_t njs_mp_cluster_insert(njs_mp_t *mp, njs_mp_block_t *cluster);
 #endif
 static void *njs_mp_alloc_large(njs_mp_t *mp, size_t alignment, size_t size);
 static intptr_t njs_mp_rbtree_compare(njs_rbtree_node_t *node1,
     njs_rbtree_node_t *node2);
-static njs_mp_block_t *njs_mp_find_block(njs_rbtree_t *tree,
-    u_char *p);
+static njs_mp_block_t *njs_mp_find_block(njs_mp_t *mp, u_char *p);
+static njs_mp_block_t *njs_mp_find_cluster(njs_mp_t *mp, u_char *p);
+static void njs_mp_cluster_delete(njs_mp_t *mp, njs_mp_block_t *cluster);
 static const char *njs_mp_chunk_free(njs_mp_t *mp, njs_mp_block_t *cluster,
     u_char *p);
+static size_t njs_mp_sweep_cluster(njs_mp_t *mp, njs_mp_block_t *cluster);
+static void njs_mp_reset_cluster(njs_mp_t *mp, njs_mp_block_t *cluster);
+static void *njs_mp_arena_alloc(njs_mp_t *mp, size_t alignment, size_t size);
+static njs_mp_region_t *njs_mp_region_alloc(njs_mp_t *mp, size_t size);
 
 
 njs_mp_t *
@@ -163,7 +213,7 @@ njs_mp_create(size_t cluster_size, size_t page_alignment, size_t page_size,
                      || min_chunk_size * 32 < page_size
                      || cluster_size < page_size
                      || cluster_size / page_size > 256
-                     || cluster_size % page_size != 0))
+                     || !njs_is_power_of_two(cluster_size)))
     {
         return NULL;
     }
@@ -211,6 +261,7 @@ njs_mp_fast_create(size_t cluster_size, size_t page_alignment, size_t page_size,
 
         mp->chunk_size_shift = njs_mp_shift(min_chunk_size);
         mp->page_size_shift = njs_mp_shift(page_size);
+        mp->cluster_size_shift = njs_mp_shift(cluster_size);
 
         njs_rbtree_init(&mp->blocks, njs_mp_rbtree_compare);
 
@@ -221,6 +272,35 @@ njs_mp_fast_create(size_t cluster_size, size_t page_alignment, size_t page_size,
 }
 
 
+njs_mp_t *
+njs_mp_arena_create(size_t region_size)
+{
+    njs_mp_t  *mp;
+
+    mp = njs_zalloc(sizeof(njs_mp_t));
+    if (njs_slow_path(mp == NULL)) {
+        return NULL;
+    }
+
+    mp->arena = 1;
+    mp->cluster_size = region_size;
+
+    njs_rbtree_init(&mp->blocks, njs_mp_rbtree_compare);
+    njs_queue_init(&mp->free_pages);
+
+    mp->regions = njs_mp_region_alloc(mp, region_size);
+    if (njs_slow_path(mp->regions == NULL)) {
+        njs_free(mp);
+        return NULL;
+    }
+
+    mp->region = mp->regions;
+    mp->free = (u_char *) mp->region + sizeof(njs_mp_region_t);
+
+    return mp;
+}
+
+
 static njs_uint_t
 njs_mp_shift(njs_uint_t n)
 {
@@ -241,6 +321,12 @@ njs_mp_shift(njs_uint_t n)
 njs_bool_t
 njs_mp_is_empty(njs_mp_t *mp)
 {
+    if (mp->arena) {
+        return (mp->large == NULL && mp->region == mp->regions
+                && mp->free == (u_char *) mp->regions
+                               + sizeof(njs_mp_region_t));
+    }
+
     return (njs_rbtree_is_empty(&mp->blocks)
             && njs_queue_is_empty(&mp->free_pages));
 }
@@ -251,10 +337,23 @@ njs_mp_destroy(njs_mp_t *mp)
 {
     void               *p;
     njs_mp_block_t     *block;
+    njs_mp_region_t    *region;
     njs_rbtree_node_t  *node, *next;
 
     njs_debug_alloc("mp destroy\n");
 
+    while (mp->regions != NULL) {
+        region = mp->regions;
+        mp->regions = region->next;
+        njs_free(region);
+    }
+
+    while (mp->large != NULL) {
+        region = mp->large;
+        mp->large = region->next;
+        njs_free(region);
+    }
+
     next = njs_rbtree_root(&mp->blocks);
 
     while (next != njs_rbtree_sentinel(&mp->blocks)) {
@@ -271,6 +370,10 @@ njs_mp_destroy(njs_mp_t *mp)
         njs_free(p);
     }
 
+    if (mp->clusters != NULL) {
+        njs_free(mp->clusters);
+    }
+
     njs_free(mp);
 }
 
@@ -280,6 +383,10 @@ njs_mp_alloc(njs_mp_t *mp, size_t size)
 {
     njs_debug_alloc("mp alloc: %uz\n", size);
 
+    if (mp->arena) {
+        return njs_mp_arena_alloc(mp, NJS_MAX_ALIGNMENT, size);
+    }
+
 #if !(NJS_DEBUG_MEMORY)
 
     if (size <= mp->page_size) {
@@ -316,6 +423,10 @@ njs_mp_align(njs_mp_t *mp, size_t alignment, size_t size)
 
     if (njs_fast_path(njs_is_power_of_two(alignment))) {
 
+        if (mp->arena) {
+            return njs_mp_arena_alloc(mp, alignment, size);
+        }
+
 #if !(NJS_DEBUG_MEMORY)
 
         if (size <= mp->page_size && alignment <= mp->page_alignment) {
@@ -520,12 +631,22 @@ njs_mp_alloc_cluster(njs_mp_t *mp)
 
     cluster->size = mp->cluster_size;
 
-    cluster->start = njs_memalign(mp->page_alignment, mp->cluster_size);
+    cluster->start = njs_memalign(mp->cluster_size, mp->cluster_size);
     if (njs_slow_path(cluster->start == NULL)) {
         njs_free(cluster);
         return NULL;
     }
 
+    if (njs_slow_path(njs_mp_cluster_insert(mp, cluster) != NJS_OK)) {
+        njs_free(cluster->start);
+        njs_free(cluster);
+        return NULL;
+    }
+
+    if (mp->gc) {
+        njs_memzero(cluster->start, mp->cluster_size);
+    }
+
     n--;
     cluster->pages[n].number = n;
     njs_queue_insert_head(&mp->free_pages, &cluster->pages[n].link);
@@ -539,9 +660,65 @@ njs_mp_alloc_cluster(njs_mp_t *mp)
 
     njs_rbtree_insert(&mp->blocks, &cluster->node);
 
+    mp->size += mp->cluster_size;
+
     return cluster;
 }
 
+
+static njs_int_t
+njs_mp_cluster_insert(njs_mp_t *mp, njs_mp_block_t *cluster)
+{
+    uintptr_t       key;
+    njs_uint_t      n, size;
+    njs_mp_block_t  *block, **clusters;
+
+    /* The hash is kept at most half full. */
+
+    if ((mp->nclusters + 1) * 2 > mp->clusters_mask + 1
+        || mp->clusters == NULL)
+    {
+        size = (mp->clusters != NULL) ? (mp->clusters_mask + 1) * 2 : 16;
+
+        clusters = njs_zalloc(size * sizeof(njs_mp_block_t *));
+        if (njs_slow_path(clusters == NULL)) {
+            return NJS_ERROR;
+        }
+
+        if (mp->clusters != NULL) {
+            for (n = 0; n <= mp->clusters_mask; n++) {
+                block = mp->clusters[n];
+
+                if (block != NULL) {
+                    key = (uintptr_t) block->start >> mp->cluster_size_shift;
+
+                    while (clusters[key & (size - 1)] != NULL) {
+                        key++;
+                    }
+
+                    clusters[key & (size - 1)] = block;
+                }
+            }
+
+            njs_free(mp->clusters);
+        }
+
+        mp->clusters = clusters;
+        mp->clusters_mask = size - 1;
+    }
+
+    key = (uintptr_t) cluster->start >> mp->cluster_size_shift;
+
+    while (mp->clusters[key & mp->clusters_mask] != NULL) {
+        key++;
+    }
+
+    mp->clusters[key & mp->clusters_mask] = cluster;
+    mp->nclusters++;
+
+    return NJS_OK;
+}
+
 #endif
 
 
@@ -585,11 +762,14 @@ njs_mp_alloc_large(njs_mp_t *mp, size_t alignment, size_t size)
     }
 
     block->type = type;
+    block->mark = 0;
     block->size = size;
     block->start = p;
 
     njs_rbtree_insert(&mp->blocks, &block->node);
 
+    mp->size += size;
+
     return p;
 }
 
@@ -614,7 +794,11 @@ njs_mp_free(njs_mp_t *mp, void *p)
 
     njs_debug_alloc("mp free: @%p\n", p);
 
-    block = njs_mp_find_block(&mp->blocks, p);
+    if (mp->arena) {
+        return;
+    }
+
+    block = njs_mp_find_block(mp, p);
 
     if (njs_fast_path(block != NULL)) {
 
@@ -628,6 +812,8 @@ njs_mp_free(njs_mp_t *mp, void *p)
         } else if (njs_fast_path(p == block->start)) {
             njs_rbtree_delete(&mp->blocks, &block->node);
 
+            mp->size -= block->size;
+
             if (block->type == NJS_MP_DISCRETE_BLOCK) {
                 njs_free(block);
             }
@@ -649,13 +835,19 @@ njs_mp_free(njs_mp_t *mp, void *p)
 
 
 static njs_mp_block_t *
-njs_mp_find_block(njs_rbtree_t *tree, u_char *p)
+njs_mp_find_block(njs_mp_t *mp, u_char *p)
 {
     njs_mp_block_t     *block;
     njs_rbtree_node_t  *node, *sentinel;
 
-    node = njs_rbtree_root(tree);
-    sentinel = njs_rbtree_sentinel(tree);
+    block = njs_mp_find_cluster(mp, p);
+
+    if (block != NULL) {
+        return block;
+    }
+
+    node = njs_rbtree_root(&mp->blocks);
+    sentinel = njs_rbtree_sentinel(&mp->blocks);
 
     while (node != sentinel) {
 
@@ -676,6 +868,76 @@ njs_mp_find_block(njs_rbtree_t *tree, u_char *p)
 }
 
 
+static njs_mp_block_t *
+njs_mp_find_cluster(njs_mp_t *mp, u_char *p)
+{
+    uintptr_t       key;
+    njs_uint_t      n;
+    njs_mp_block_t  *cluster;
+
+    if (mp->clusters == NULL) {
+        return NULL;
+    }
+
+    key = (uintptr_t) p >> mp->cluster_size_shift;
+    n = key;
+
+    for ( ;; ) {
+        cluster = mp->clusters[n & mp->clusters_mask];
+
+        if (cluster == NULL
+            || ((uintptr_t) cluster->start >> mp->cluster_size_shift) == key)
+        {
+            return cluster;
+        }
+
+        n++;
+    }
+}
+
+
+static void
+njs_mp_cluster_delete(njs_mp_t *mp, njs_mp_block_t *cluster)
+{
+    njs_uint_t      n, next, home, mask;
+    njs_mp_block_t  *block;
+
+    mask = mp->clusters_mask;
+    n = ((uintptr_t) cluster->start >> mp->cluster_size_shift) & mask;
+
+    while (mp->clusters[n] != cluster) {
+        n = (n + 1) & mask;
+    }
+
+    /*
+     * The following clusters of the probe sequence are moved back,
+     * so that a search does not stop at the deleted cluster.
+     */
+
+    next = n;
+
+    for ( ;; ) {
+        mp->clusters[n] = NULL;
+
+        do {
+            next = (next + 1) & mask;
+            block = mp->clusters[next];
+
+            if (block == NULL) {
+                mp->nclusters--;
+                return;
+            }
+
+            home = ((uintptr_t) block->start >> mp->cluster_size_shift) & mask;
+
+        } while (((next - home) & mask) < ((next - n) & mask));
+
+        mp->clusters[n] = block;
+        n = next;
+    }
+}
+
+
 static const char *
 njs_mp_chunk_free(njs_mp_t *mp, njs_mp_block_t *cluster,
     u_char *p)
@@ -775,6 +1037,9 @@ njs_mp_chunk_free(njs_mp_t *mp, njs_mp_block_t *cluster,
     } while (n != 0);
 
     njs_rbtree_delete(&mp->blocks, &cluster->node);
+    njs_mp_cluster_delete(mp, cluster);
+
+    mp->size -= mp->cluster_size;
 
     p = cluster->start;
 
@@ -783,3 +1048,409 @@ njs_mp_chunk_free(njs_mp_t *mp, njs_mp_block_t *cluster,
 
     return NULL;
 }
+
+
+size_t
+njs_mp_size(njs_mp_t *mp)
+{
+    return mp->size;
+}
+
+
+/*
+ * njs_gc() scans whole chunks, stale pointers left in the memory
+ * by its previous owner would retain garbage.  So the clusters are
+ * zeroed, but only for the pools which are collected.  The function
+ * must be called before the first allocation.
+ */
+
+void
+njs_mp_gc_enable(njs_mp_t *mp)
+{
+    mp->gc = 1;
+}
+
+
+/*
+ * Marks the allocation which contains the address p.  The start and
+ * the size of the allocation are returned if it has not been marked yet.
+ */
+
+void *
+njs_mp_mark(njs_mp_t *mp, void *p, size_t *size)
+{
+    u_char          *start;
+    njs_uint_t      n, chunk, chunk_size;
+    njs_mp_page_t   *page;
+    njs_mp_block_t  *block;
+
+    block = njs_mp_find_block(mp, p);
+
+    if (block == NULL) {
+        return NULL;
+    }
+
+    if (block->type != NJS_MP_CLUSTER_BLOCK) {
+        if (block->mark) {
+            return NULL;
+        }
+
+        block->mark = 1;
+        *size = block->size;
+
+        return block->start;
+    }
+
+    n = ((u_char *) p - block->start) >> mp->page_size_shift;
+    page = &block->pages[n];
+
+    if (page->size == 0) {
+        return NULL;
+    }
+
+    start = block->start + (n << mp->page_size_shift);
+    chunk_size = page->size << mp->chunk_size_shift;
+    chunk = ((u_char *) p - start) / chunk_size;
+
+    if (chunk_size != mp->page_size
+        && njs_mp_chunk_is_free(page->map, chunk))
+    {
+        return NULL;
+    }
+
+    if (!njs_mp_chunk_is_free(page->mark, chunk)) {
+        return NULL;
+    }
+
+    njs_mp_chunk_set_busy(page->mark, chunk);
+    *size = chunk_size;
+
+    return start + chunk * chunk_size;
+}
+
+
+/*
+ * Frees all allocations which have not been marked by njs_mp_mark()
+ * and clears the marks.  Returns the size of the freed allocations.
+ */
+
+size_t
+njs_mp_sweep(njs_mp_t *mp)
+{
+    size_t             freed;
+    njs_mp_block_t     *block;
+    njs_rbtree_node_t  *node, *next;
+
+    freed = 0;
+    node = njs_rbtree_min(&mp->blocks);
+
+    while (njs_rbtree_is_there_successor(&mp->blocks, node)) {
+        next = njs_rbtree_node_successor(&mp->blocks, node);
+        block = (njs_mp_block_t *) node;
+
+        if (block->type == NJS_MP_CLUSTER_BLOCK) {
+            freed += njs_mp_sweep_cluster(mp, block);
+
+        } else if (block->mark) {
+            block->mark = 0;
+
+        } else {
+            freed += block->size;
+            njs_mp_free(mp, block->start);
+        }
+
+        node = next;
+    }
+
+    return freed;
+}
+
+
+/*
+ * Frees all allocations which have not been marked by njs_mp_mark()
+ * and clears the marks like njs_mp_sweep() does, but keeps the clusters
+ * to be reused by the next allocations.
+ */
+
+void
+njs_mp_reset(njs_mp_t *mp)
+{
+    njs_mp_block_t     *block;
+    njs_rbtree_node_t  *node, *next;
+
+    node = njs_rbtree_min(&mp->blocks);
+
+    while (njs_rbtree_is_there_successor(&mp->blocks, node)) {
+        next = njs_rbtree_node_successor(&mp->blocks, node);
+        block = (njs_mp_block_t *) node;
+
+        if (block->type == NJS_MP_CLUSTER_BLOCK) {
+            njs_mp_reset_cluster(mp, block);
+
+        } else if (block->mark) {
+            block->mark = 0;
+
+        } else {
+            njs_mp_free(mp, block->start);
+        }
+
+        node = next;
+    }
+}
+
+
+/*
+ * Frees the arena allocations made after the address p which points
+ * to the first region of the arena pool.  The regions are kept to be
+ * reused by the next allocations.
+ */
+
+void
+njs_mp_rewind(njs_mp_t *mp, void *p)
+{
+    njs_mp_region_t  *region;
+
+    while (mp->large != NULL) {
+        region = mp->large;
+        mp->large = region->next;
+
+        mp->size -= region->end - (u_char *) region;
+
+        njs_free(region);
+    }
+
+    mp->region = mp->regions;
+    mp->free = p;
+}
+
+
+void
+njs_mp_unmark(njs_mp_t *mp)
+{
+    njs_uint_t         n;
+    njs_mp_block_t     *block;
+    njs_rbtree_node_t  *node;
+
+    node = njs_rbtree_min(&mp->blocks);
+
+    while (njs_rbtree_is_there_successor(&mp->blocks, node)) {
+        block = (njs_mp_block_t *) node;
+
+        if (block->type == NJS_MP_CLUSTER_BLOCK) {
+            n = mp->cluster_size >> mp->page_size_shift;
+
+            while (n != 0) {
+                n--;
+                njs_memzero(block->pages[n].mark, sizeof(block->pages[n].mark));
+            }
+
+        } else {
+            block->mark = 0;
+        }
+
+        node = njs_rbtree_node_successor(&mp->blocks, node);
+    }
+}
+
+
+static size_t
+njs_mp_sweep_cluster(njs_mp_t *mp, njs_mp_block_t *cluster)
+{
+    u_char         *start;
+    size_t         freed;
+    njs_uint_t     n, npages, chunk, nchunks, size, busy;
+    njs_mp_page_t  *page;
+
+    npages = mp->cluster_size >> mp->page_size_shift;
+
+    /* The cluster is freed together with its last busy chunk. */
+
+    busy = 0;
+
+    for (n = 0; n < npages; n++) {
+        page = &cluster->pages[n];
+
+        if (page->size != 0) {
+            size = page->size << mp->chunk_size_shift;
+            busy += (size == mp->page_size) ? 1
+                                            : mp->page_size / size
+                                              - page->chunks;
+        }
+    }
+
+    freed = 0;
+
+    for (n = 0; n < npages; n++) {
+        page = &cluster->pages[n];
+
+        if (page->size == 0) {
+            continue;
+        }
+
+        size = page->size << mp->chunk_size_shift;
+        nchunks = mp->page_size / size;
+        start = cluster->start + (n << mp->page_size_shift);
+
+        for (chunk = 0; chunk < nchunks; chunk++) {
+            if ((size != mp->page_size
+                 && njs_mp_chunk_is_free(page->map, chunk))
+                || !njs_mp_chunk_is_free(page->mark, chunk))
+            {
+                continue;
+            }
+
+            freed += size;
+
+            (void) njs_mp_chunk_free(mp, cluster, start + chunk * size);
+
+            if (--busy == 0) {
+                return freed;
+            }
+
+            if (page->size == 0) {
+                break;
+            }
+        }
+
+        njs_memzero(page->mark, sizeof(page->mark));
+    }
+
+    return freed;
+}
+
+
+static void
+njs_mp_reset_cluster(njs_mp_t *mp, njs_mp_block_t *cluster)
+{
+    u_char         *start;
+    njs_uint_t     n, npages, chunk, nchunks, size;
+    njs_mp_page_t  *page;
+
+    npages = mp->cluster_size >> mp->page_size_shift;
+
+    for (n = 0; n < npages; n++) {
+        page = &cluster->pages[n];
+
+        if (page->size == 0) {
+            continue;
+        }
+
+        size = page->size << mp->chunk_size_shift;
+        start = cluster->start + (n << mp->page_size_shift);
+
+        if ((page->mark[0] | page->mark[1] | page->mark[2] | page->mark[3])
+            != 0)
+        {
+
+            if (size != mp->page_size) {
+                nchunks = mp->page_size / size;
+
+                for (chunk = 0; chunk < nchunks; chunk++) {
+                    if (!njs_mp_chunk_is_free(page->map, chunk)
+                        && njs_mp_chunk_is_free(page->mark, chunk))
+                    {
+                        (void) njs_mp_chunk_free(mp, cluster,
+                                                 start + chunk * size);
+                    }
+                }
+            }
+
+            njs_memzero(page->mark, sizeof(page->mark));
+
+            continue;
+        }
+
+        /*
+         * The whole page is freed at once.  It is zeroed if new clusters
+         * are, see njs_mp_alloc_cluster().
+         */
+
+        if (size != mp->page_size && page->chunks != 0) {
+            /* Remove the page from mp chunk slot list. */
+            njs_queue_remove(&page->link);
+        }
+
+        page->size = 0;
+        njs_memzero(page->map, sizeof(page->map));
+        njs_queue_insert_head(&mp->free_pages, &page->link);
+
+        if (mp->gc) {
+            njs_memzero(start, mp->page_size);
+        }
+    }
+}
+
+
+static void *
+njs_mp_arena_alloc(njs_mp_t *mp, size_t alignment, size_t size)
+{
+    u_char           *p;
+    njs_mp_region_t  *region;
+
+    p = njs_align_ptr(mp->free, alignment);
+
+    if (njs_fast_path(p <= mp->region->end
+                      && size <= (size_t) (mp->region->end - p)))
+    {
+        mp->free = p + size;
+        return p;
+    }
+
+    /* Allocation must be less than 4G. */
+    if (njs_slow_path(size >= UINT32_MAX)) {
+        return NULL;
+    }
+
+    if (size + alignment > mp->cluster_size / 4) {
+        region = njs_mp_region_alloc(mp, sizeof(njs_mp_region_t)
+                                         + alignment + size);
+        if (njs_slow_path(region == NULL)) {
+            return NULL;
+        }
+
+        region->next = mp->large;
+        mp->large = region;
+
+        return njs_align_ptr((u_char *) region + sizeof(njs_mp_region_t),
+                             alignment);
+    }
+
+    /* The regions kept by njs_mp_rewind() are reused first. */
+
+    region = mp->region->next;
+
+    if (region == NULL) {
+        region = njs_mp_region_alloc(mp, mp->cluster_size);
+        if (njs_slow_path(region == NULL)) {
+            return NULL;
+        }
+
+        mp->region->next = region;
+    }
+
+    mp->region = region;
+
+    p = njs_align_ptr((u_char *) region + sizeof(njs_mp_region_t), alignment);
+    mp->free = p + size;
+
+    return p;
+}
+
+
+static njs_mp_region_t *
+njs_mp_region_alloc(njs_mp_t *mp, size_t size)
+{
+    njs_mp_region_t  *region;
+
+    region = njs_malloc(size);
+    if (njs_slow_path(region == NULL)) {
+        return NULL;
+    }
+
+    region->next = NULL;
+    region->end = (u_char *) region + size;
+
+    mp->size += size;
+
+    return region;
+}
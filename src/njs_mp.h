@@ -16,6 +16,7 @@ NJS_EXPORT njs_mp_t *njs_mp_create(size_t cluster_size, size_t page_alignment,
 NJS_EXPORT njs_mp_t * njs_mp_fast_create(size_t cluster_size,
     size_t page_alignment, size_t page_size, size_t min_chunk_size)
     NJS_MALLOC_LIKE;
+NJS_EXPORT njs_mp_t *njs_mp_arena_create(size_t region_size) NJS_MALLOC_LIKE;
 NJS_EXPORT njs_bool_t njs_mp_is_empty(njs_mp_t *mp);
 NJS_EXPORT void njs_mp_destroy(njs_mp_t *mp);
 
@@ -30,6 +31,14 @@ NJS_EXPORT void *njs_mp_zalign(njs_mp_t *mp,
     NJS_MALLOC_LIKE;
 NJS_EXPORT void njs_mp_free(njs_mp_t *mp, void *p);
 
+NJS_EXPORT size_t njs_mp_size(njs_mp_t *mp);
+NJS_EXPORT void njs_mp_gc_enable(njs_mp_t *mp);
+NJS_EXPORT void *njs_mp_mark(njs_mp_t *mp, void *p, size_t *size);
+NJS_EXPORT size_t njs_mp_sweep(njs_mp_t *mp);
+NJS_EXPORT void njs_mp_reset(njs_mp_t *mp);
+NJS_EXPORT void njs_mp_rewind(njs_mp_t *mp, void *p);
+NJS_EXPORT void njs_mp_unmark(njs_mp_t *mp);
+
 
 #if (NJS_ALLOC_DEBUG)
 #define njs_debug_alloc(...)                                                  \
@@ -9,7 +9,7 @@
 
 
 static njs_int_t njs_object_hash_test(njs_lvlhsh_query_t *lhq, void *data);
-static njs_object_prop_t *njs_object_exist_in_proto(const njs_object_t *begin,
+static njs_bool_t njs_object_exist_in_proto(const njs_object_t *begin,
     const njs_object_t *end, njs_lvlhsh_query_t *lhq);
 static njs_int_t njs_object_enumerate_array(njs_vm_t *vm,
     const njs_array_t *array, njs_array_t *items, njs_object_enum_t kind);
@@ -20,6 +20,9 @@ static njs_int_t njs_object_enumerate_string(njs_vm_t *vm,
 static njs_int_t njs_object_enumerate_object(njs_vm_t *vm,
     const njs_object_t *object, njs_array_t *items, njs_object_enum_t kind,
     njs_object_enum_type_t type, njs_bool_t all);
+static njs_int_t njs_object_own_enumerate_shape(njs_vm_t *vm,
+    const njs_object_t *object, const njs_object_t *parent,
+    njs_array_t *items, njs_object_enum_t kind, njs_object_enum_type_t type);
 static njs_int_t njs_object_own_enumerate_object(njs_vm_t *vm,
     const njs_object_t *object, const njs_object_t *parent, njs_array_t *items,
     njs_object_enum_t kind, njs_object_enum_type_t type, njs_bool_t all);
@@ -41,6 +44,7 @@ njs_object_alloc(njs_vm_t *vm)
         njs_lvlhsh_init(&object->shared_hash);
         object->__proto__ = &vm->prototypes[NJS_OBJ_TYPE_OBJECT].object;
         object->slots = NULL;
+        object->shape = NULL;
         object->type = NJS_OBJECT;
         object->shared = 0;
         object->extensible = 1;
@@ -56,6 +60,21 @@ njs_object_alloc(njs_vm_t *vm)
 }
 
 
+njs_object_t *
+njs_object_shaped_alloc(njs_vm_t *vm)
+{
+    njs_object_t  *object;
+
+    object = njs_object_alloc(vm);
+
+    if (njs_fast_path(object != NULL)) {
+        object->shape = vm->shape_root;
+    }
+
+    return object;
+}
+
+
 njs_object_t *
 njs_object_value_copy(njs_vm_t *vm, njs_value_t *value)
 {
@@ -113,6 +132,7 @@ njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value, njs_uint_t type)
         index = njs_primitive_prototype_index(type);
         ov->object.__proto__ = &vm->prototypes[index].object;
         ov->object.slots = NULL;
+        ov->object.shape = NULL;
 
         ov->value = *value;
 
@@ -199,6 +219,11 @@ njs_object_hash_test(njs_lvlhsh_query_t *lhq, void *data)
         }
 
         start = name->long_string.data->start;
+
+        if (start == lhq->key.start) {
+            /* An atom. */
+            return NJS_OK;
+        }
     }
 
     if (memcmp(start, lhq->key.start, lhq->key.length) == 0) {
@@ -222,7 +247,7 @@ njs_object_constructor(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 
     if (njs_is_null_or_undefined(value)) {
 
-        object = njs_object_alloc(vm);
+        object = njs_object_shaped_alloc(vm);
         if (njs_slow_path(object == NULL)) {
             return NJS_ERROR;
         }
@@ -388,7 +413,7 @@ njs_object_entries(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 }
 
 
-static njs_object_prop_t *
+static njs_bool_t
 njs_object_exist_in_proto(const njs_object_t *object, const njs_object_t *end,
     njs_lvlhsh_query_t *lhq)
 {
@@ -396,6 +421,12 @@ njs_object_exist_in_proto(const njs_object_t *object, const njs_object_t *end,
     njs_object_prop_t  *prop;
 
     while (object != end) {
+        if (object->shape != NULL
+            && njs_shape_find(object->shape, lhq) != NJS_DECLINED)
+        {
+            return 1;
+        }
+
         ret = njs_lvlhsh_find(&object->hash, lhq);
 
         if (njs_fast_path(ret == NJS_OK)) {
@@ -405,13 +436,13 @@ njs_object_exist_in_proto(const njs_object_t *object, const njs_object_t *end,
                 goto next;
             }
 
-            return lhq->value;
+            return 1;
         }
 
         ret = njs_lvlhsh_find(&object->shared_hash, lhq);
 
         if (njs_fast_path(ret == NJS_OK)) {
-            return lhq->value;
+            return 1;
         }
 
 next:
@@ -419,7 +450,7 @@ next:
         object = object->__proto__;
     }
 
-    return NULL;
+    return 0;
 }
 
 
@@ -857,13 +888,19 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
     njs_object_enum_type_t type, njs_bool_t all)
 {
     njs_int_t           ret;
+    njs_bool_t          exist;
     njs_value_t         value;
     njs_array_t         *entry;
     njs_lvlhsh_each_t   lhe;
-    njs_object_prop_t   *prop, *ext_prop;
+    njs_object_prop_t   *prop;
     njs_lvlhsh_query_t  lhq;
     const njs_lvlhsh_t  *hash;
 
+    if (object->shape != NULL) {
+        return njs_object_own_enumerate_shape(vm, object, parent, items, kind,
+                                              type);
+    }
+
     lhq.proto = &njs_object_hash_proto;
 
     njs_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
@@ -884,9 +921,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
 
             njs_object_property_key_set(&lhq, &prop->name, lhe.key_hash);
 
-            ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+            exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-            if (ext_prop == NULL && prop->type != NJS_WHITEOUT
+            if (!exist && prop->type != NJS_WHITEOUT
                 && (prop->enumerable || all))
             {
                 ret = njs_array_add(vm, items, &prop->name);
@@ -915,9 +952,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
             ret = njs_lvlhsh_find(&object->hash, &lhq);
 
             if (ret != NJS_OK) {
-                ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+                exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-                if (ext_prop == NULL && (prop->enumerable || all)) {
+                if (!exist && (prop->enumerable || all)) {
                     ret = njs_array_add(vm, items, &prop->name);
                     if (njs_slow_path(ret != NJS_OK)) {
                         return NJS_ERROR;
@@ -942,9 +979,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
 
             njs_object_property_key_set(&lhq, &prop->name, lhe.key_hash);
 
-            ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+            exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-            if (ext_prop == NULL && prop->type != NJS_WHITEOUT
+            if (!exist && prop->type != NJS_WHITEOUT
                 && (prop->enumerable || all))
             {
                 ret = njs_array_add(vm, items, &prop->value);
@@ -973,9 +1010,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
             ret = njs_lvlhsh_find(&object->hash, &lhq);
 
             if (ret != NJS_OK) {
-                ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+                exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-                if (ext_prop == NULL && (prop->enumerable || all)) {
+                if (!exist && (prop->enumerable || all)) {
                     ret = njs_array_add(vm, items, &prop->value);
                     if (njs_slow_path(ret != NJS_OK)) {
                         return NJS_ERROR;
@@ -1000,9 +1037,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
 
             njs_object_property_key_set(&lhq, &prop->name, lhe.key_hash);
 
-            ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+            exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-            if (ext_prop == NULL && prop->type != NJS_WHITEOUT
+            if (!exist && prop->type != NJS_WHITEOUT
                 && (prop->enumerable || all))
             {
                 entry = njs_array_alloc(vm, 0, 2, 0);
@@ -1041,9 +1078,9 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
             ret = njs_lvlhsh_find(&object->hash, &lhq);
 
             if (ret != NJS_OK && (prop->enumerable || all)) {
-                ext_prop = njs_object_exist_in_proto(parent, object, &lhq);
+                exist = njs_object_exist_in_proto(parent, object, &lhq);
 
-                if (ext_prop == NULL) {
+                if (!exist) {
                     entry = njs_array_alloc(vm, 0, 2, 0);
                     if (njs_slow_path(entry == NULL)) {
                         return NJS_ERROR;
@@ -1069,6 +1106,70 @@ njs_object_own_enumerate_object(njs_vm_t *vm, const njs_object_t *object,
 }
 
 
+static njs_int_t
+njs_object_own_enumerate_shape(njs_vm_t *vm, const njs_object_t *object,
+    const njs_object_t *parent, njs_array_t *items, njs_object_enum_t kind,
+    njs_object_enum_type_t type)
+{
+    uint32_t            n;
+    njs_int_t           ret;
+    njs_value_t         value;
+    njs_array_t         *entry;
+    njs_shape_key_t     *key;
+    njs_lvlhsh_query_t  lhq;
+
+    if (!(type & NJS_ENUM_STRING)) {
+        return NJS_OK;
+    }
+
+    lhq.proto = &njs_object_hash_proto;
+
+    /* Shape slots are in the order of property additions. */
+
+    for (n = 0; n < object->shape->nslots; n++) {
+        key = njs_shape_slot_key(object->shape, n);
+
+        njs_object_property_key_set(&lhq, &key->name, key->key_hash);
+
+        if (njs_object_exist_in_proto(parent, object, &lhq)) {
+            continue;
+        }
+
+        switch (kind) {
+        case NJS_ENUM_KEYS:
+            ret = njs_array_add(vm, items, &key->name);
+            break;
+
+        case NJS_ENUM_VALUES:
+            ret = njs_array_add(vm, items, &object->values[n]);
+            break;
+
+        default:
+            /* NJS_ENUM_BOTH. */
+
+            entry = njs_array_alloc(vm, 0, 2, 0);
+            if (njs_slow_path(entry == NULL)) {
+                return NJS_ERROR;
+            }
+
+            njs_string_copy(&entry->start[0], &key->name);
+            entry->start[1] = object->values[n];
+
+            njs_set_array(&value, entry);
+
+            ret = njs_array_add(vm, items, &value);
+            break;
+        }
+
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NJS_ERROR;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
 njs_inline njs_int_t
 njs_traverse_visit(njs_arr_t *list, const njs_value_t *value)
 {
@@ -1511,6 +1612,7 @@ static njs_int_t
 njs_object_freeze(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     njs_index_t unused)
 {
+    njs_int_t          ret;
     njs_value_t        *value;
     njs_lvlhsh_t       *hash;
     njs_object_t       *object;
@@ -1525,6 +1627,14 @@ njs_object_freeze(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     }
 
     object = njs_object(value);
+
+    if (object->shape != NULL) {
+        ret = njs_shape_dictionary(vm, object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
     object->extensible = 0;
 
     njs_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
@@ -1580,6 +1690,11 @@ njs_object_is_frozen(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
         goto done;
     }
 
+    if (object->shape != NULL && object->shape->nslots != 0) {
+        /* Shape properties are writable and configurable. */
+        goto done;
+    }
+
     for ( ;; ) {
         prop = njs_lvlhsh_each(hash, &lhe);
 
@@ -1610,6 +1725,7 @@ static njs_int_t
 njs_object_seal(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     njs_index_t unused)
 {
+    njs_int_t          ret;
     njs_value_t        *value;
     njs_lvlhsh_t       *hash;
     njs_object_t       *object;
@@ -1624,6 +1740,14 @@ njs_object_seal(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     }
 
     object = njs_object(value);
+
+    if (object->shape != NULL) {
+        ret = njs_shape_dictionary(vm, object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
     object->extensible = 0;
 
     njs_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
@@ -1675,6 +1799,11 @@ njs_object_is_sealed(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
         goto done;
     }
 
+    if (object->shape != NULL && object->shape->nslots != 0) {
+        /* Shape properties are writable and configurable. */
+        goto done;
+    }
+
     for ( ;; ) {
         prop = njs_lvlhsh_each(hash, &lhe);
 
@@ -2384,6 +2513,9 @@ njs_object_prototype_to_string(njs_vm_t *vm, njs_value_t *args,
         &njs_object_object_string,
         &njs_object_object_string,
         &njs_object_object_string,
+        &njs_object_object_string,
+        &njs_object_object_string,
+        &njs_object_object_string,
     };
 
     value = njs_argument(args, 0);
@@ -40,6 +40,7 @@ typedef njs_int_t (*njs_object_traverse_cb_t)(njs_vm_t *vm,
 
 
 njs_object_t *njs_object_alloc(njs_vm_t *vm);
+njs_object_t *njs_object_shaped_alloc(njs_vm_t *vm);
 njs_object_t *njs_object_value_copy(njs_vm_t *vm, njs_value_t *value);
 njs_object_t *njs_object_value_alloc(njs_vm_t *vm, const njs_value_t *value,
     njs_uint_t type);
@@ -88,6 +88,14 @@
         'D'), 'a'), 't'), 'e')
 
 
+#define NJS_DONE_HASH                                                         \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(NJS_DJB_HASH_INIT,                                       \
+        'd'), 'o'), 'n'), 'e')
+
+
 #define NJS_PROMISE_HASH                                                      \
     njs_djb_hash_add(                                                         \
     njs_djb_hash_add(                                                         \
@@ -311,6 +319,13 @@
         'N'), 'u'), 'm'), 'b'), 'e'), 'r')
 
 
+#define NJS_MAP_HASH                                                          \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(NJS_DJB_HASH_INIT,                                       \
+        'M'), 'a'), 'p')
+
+
 #define NJS_MATH_HASH                                                         \
     njs_djb_hash_add(                                                         \
     njs_djb_hash_add(                                                         \
@@ -446,6 +461,13 @@
         's'), 'e'), 't')
 
 
+#define NJS_SET_CONSTRUCTOR_HASH                                              \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(                                                         \
+    njs_djb_hash_add(NJS_DJB_HASH_INIT,                                       \
+        'S'), 'e'), 't')
+
+
 #define NJS_STACK_HASH                                                        \
     njs_djb_hash_add(                                                         \
     njs_djb_hash_add(                                                         \
@@ -8,6 +8,8 @@
 #include <njs_main.h>
 
 
+static njs_int_t njs_prop_private_alias(njs_vm_t *vm, njs_object_t *proto,
+    njs_object_prop_t *prop);
 static njs_int_t njs_descriptor_prop(njs_vm_t *vm,
     njs_object_prop_t *prop, const njs_value_t *desc);
 
@@ -28,10 +30,13 @@ njs_object_prop_alloc(njs_vm_t *vm, const njs_value_t *name,
         /* GC: retain. */
         prop->name = *name;
 
+        njs_string_atom(vm, &prop->name);
+
         prop->type = NJS_PROPERTY;
         prop->writable = attributes;
         prop->enumerable = attributes;
         prop->configurable = attributes;
+        prop->alias = 0;
 
         njs_set_invalid(&prop->getter);
         njs_set_invalid(&prop->setter);
@@ -49,13 +54,22 @@ njs_int_t
 njs_object_property(njs_vm_t *vm, const njs_value_t *value,
     njs_lvlhsh_query_t *lhq, njs_value_t *retval)
 {
-    njs_int_t          ret;
+    njs_int_t          ret, slot;
     njs_object_t       *object;
     njs_object_prop_t  *prop;
 
     object = njs_object(value);
 
     do {
+        if (object->shape != NULL) {
+            slot = njs_shape_find(object->shape, lhq);
+
+            if (slot != NJS_DECLINED) {
+                *retval = object->values[slot];
+                return NJS_OK;
+            }
+        }
+
         ret = njs_lvlhsh_find(&object->hash, lhq);
 
         if (njs_fast_path(ret == NJS_OK)) {
@@ -115,8 +129,7 @@ njs_object_property_add(njs_vm_t *vm, njs_value_t *object, njs_value_t *key,
     }
 
     lhq.proto = &njs_object_hash_proto;
-    njs_string_get(&key_value, &lhq.key);
-    lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.key_hash = njs_string_key_hash(&key_value, &lhq.key);
     lhq.value = prop;
     lhq.replace = replace;
     lhq.pool = vm->mem_pool;
@@ -153,6 +166,14 @@ njs_object_prop_define(njs_vm_t *vm, njs_value_t *object,
         }
     }
 
+    if (njs_is_object(object) && njs_object(object)->shape != NULL) {
+        /* Shapes describe only properties with default attributes. */
+        ret = njs_shape_dictionary(vm, njs_object(object));
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
 again:
 
     njs_property_query_init(&pq, NJS_PROPERTY_QUERY_SET, 1);
@@ -549,6 +570,10 @@ njs_prop_private_copy(njs_vm_t *vm, njs_property_query_t *pq)
         return NJS_OK;
 
     case NJS_FUNCTION:
+        if (prop->alias) {
+            return njs_prop_private_alias(vm, pq->prototype, prop);
+        }
+
         function = njs_function_value_copy(vm, &prop->value);
         if (njs_slow_path(function == NULL)) {
             return NJS_ERROR;
@@ -564,6 +589,88 @@ njs_prop_private_copy(njs_vm_t *vm, njs_property_query_t *pq)
 }
 
 
+/*
+ * An alias property, like Map.prototype[Symbol.iterator], gets the same
+ * function object as the property declared with the same shared function,
+ * Map.prototype.entries.  The function is named after the latter.
+ */
+
+static njs_int_t
+njs_prop_private_alias(njs_vm_t *vm, njs_object_t *proto,
+    njs_object_prop_t *prop)
+{
+    njs_int_t             ret;
+    njs_function_t        *function, *copy;
+    njs_object_prop_t     *shared, *private;
+    njs_lvlhsh_each_t     lhe;
+    njs_property_query_t  pq;
+
+    function = njs_function(&prop->value);
+
+    njs_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+
+    for ( ;; ) {
+        shared = njs_lvlhsh_each(&proto->shared_hash, &lhe);
+
+        if (njs_slow_path(shared == NULL)) {
+            njs_internal_error(vm, "alias property without a function");
+            return NJS_ERROR;
+        }
+
+        if (!shared->alias
+            && njs_is_function(&shared->value)
+            && njs_function(&shared->value) == function)
+        {
+            break;
+        }
+    }
+
+    njs_object_property_key_set(&pq.lhq, &shared->name, 0);
+    pq.lhq.proto = &njs_object_hash_proto;
+
+    ret = njs_lvlhsh_find(&proto->hash, &pq.lhq);
+
+    if (ret != NJS_OK) {
+        pq.lhq.value = shared;
+        pq.prototype = proto;
+
+        ret = njs_prop_private_copy(vm, &pq);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        private = pq.lhq.value;
+        prop->value = private->value;
+
+        return NJS_OK;
+    }
+
+    private = pq.lhq.value;
+
+    if (private->type == NJS_PROPERTY && njs_is_function(&private->value)) {
+        copy = njs_function(&private->value);
+
+        if (copy->native
+            && copy->u.native == function->u.native
+            && copy->magic8 == function->magic8
+            && copy->bound == NULL)
+        {
+            prop->value = private->value;
+            return NJS_OK;
+        }
+    }
+
+    /* The property has been redefined. */
+
+    copy = njs_function_value_copy(vm, &prop->value);
+    if (njs_slow_path(copy == NULL)) {
+        return NJS_ERROR;
+    }
+
+    return njs_function_name_set(vm, copy, &shared->name, 0);
+}
+
+
 static njs_int_t
 njs_descriptor_prop(njs_vm_t *vm, njs_object_prop_t *prop,
     const njs_value_t *desc)
@@ -0,0 +1,988 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+/* The next instruction is not executed after the instruction. */
+#define NJS_OPTIMIZER_NO_NEXT    1
+/* The first index is the result written after the operands are read. */
+#define NJS_OPTIMIZER_PURE       2
+/* The instruction can be fused with the following conditional jump. */
+#define NJS_OPTIMIZER_COMPARE    4
+/* The jump can be threaded through unconditional jumps. */
+#define NJS_OPTIMIZER_THREAD     8
+
+#define NJS_OPTIMIZER_INDEXES    4
+#define NJS_OPTIMIZER_JUMPS      2
+#define NJS_OPTIMIZER_HOPS       16
+
+#define NJS_OPTIMIZER_NONE       ((uint32_t) -1)
+
+
+typedef struct {
+    njs_vmcode_operation_t     operation;
+    uint8_t                    size;
+    uint8_t                    flags;
+
+    /* Offsets of the operand indexes and jump offsets, zero terminated. */
+    uint8_t                    indexes[NJS_OPTIMIZER_INDEXES];
+    uint8_t                    jumps[NJS_OPTIMIZER_JUMPS];
+} njs_optimizer_op_t;
+
+
+typedef struct {
+    const njs_optimizer_op_t   *op;
+    uint32_t                   offset;
+    /* The offset in the compacted code. */
+    uint32_t                   position;
+
+    uint8_t                    reachable;  /* 1 bit */
+    uint8_t                    target;     /* 1 bit */
+    uint8_t                    pinned;     /* 1 bit */
+    uint8_t                    removed;    /* 1 bit */
+} njs_optimizer_insn_t;
+
+
+typedef struct {
+    njs_vm_t                   *vm;
+    u_char                     *start;
+    size_t                     size;
+
+    /* The instructions in the code order and the end of the code. */
+    njs_uint_t                 n;
+    njs_optimizer_insn_t       *insns;
+
+    const njs_optimizer_op_t   *ops[256];
+} njs_optimizer_t;
+
+
+static njs_int_t njs_optimizer_decode(njs_optimizer_t *opt);
+static njs_uint_t njs_optimizer_find(njs_optimizer_t *opt, size_t offset);
+static uint32_t njs_optimizer_target(njs_optimizer_t *opt, njs_uint_t i,
+    njs_uint_t j);
+static void njs_optimizer_set_target(njs_optimizer_t *opt, njs_uint_t i,
+    njs_uint_t j, njs_uint_t target);
+static njs_uint_t njs_optimizer_kept(njs_optimizer_t *opt, njs_uint_t i);
+static void njs_optimizer_thread_jumps(njs_optimizer_t *opt);
+static njs_int_t njs_optimizer_reachable(njs_optimizer_t *opt);
+static void njs_optimizer_targets(njs_optimizer_t *opt);
+static void njs_optimizer_jumps(njs_optimizer_t *opt);
+static njs_int_t njs_optimizer_moves(njs_optimizer_t *opt);
+static void njs_optimizer_compact(njs_optimizer_t *opt);
+static njs_uint_t njs_optimizer_fuse(njs_optimizer_t *opt);
+
+
+#define njs_optimizer_insn_code(opt, i)                                       \
+    ((njs_vmcode_generic_t *) ((opt)->start + (opt)->insns[i].offset))
+
+
+#define njs_optimizer_insn_index(opt, i, j)                                   \
+    ((njs_index_t *) ((opt)->start + (opt)->insns[i].offset                   \
+                      + (opt)->insns[i].op->indexes[j]))
+
+
+#define njs_optimizer_insn_jump(opt, i, j)                                    \
+    ((njs_jump_off_t *) ((opt)->start + (opt)->insns[i].offset                \
+                         + (opt)->insns[i].op->jumps[j]))
+
+
+#define njs_optimizer_is(opt, i, _operation)                                  \
+    ((i) < (opt)->n && (opt)->insns[i].op->operation == (_operation))
+
+
+#define njs_optimizer_3addr(operation, flags)                                 \
+    { operation, sizeof(njs_vmcode_3addr_t), flags,                           \
+      { offsetof(njs_vmcode_3addr_t, dst),                                    \
+        offsetof(njs_vmcode_3addr_t, src1),                                   \
+        offsetof(njs_vmcode_3addr_t, src2) }, { 0 } }
+
+
+#define njs_optimizer_2addr(operation, flags)                                 \
+    { operation, sizeof(njs_vmcode_2addr_t), flags,                           \
+      { offsetof(njs_vmcode_2addr_t, dst),                                    \
+        offsetof(njs_vmcode_2addr_t, src) }, { 0 } }
+
+
+#define njs_optimizer_1addr(operation, code, field, flags)                    \
+    { operation, sizeof(code), flags,                                         \
+      { offsetof(code, field) }, { 0 } }
+
+
+#define njs_optimizer_prop(operation, code)                                   \
+    { operation, sizeof(code), 0,                                             \
+      { offsetof(code, value), offsetof(code, object),                        \
+        offsetof(code, property) }, { 0 } }
+
+
+static const njs_optimizer_op_t  njs_optimizer_ops[] = {
+
+    njs_optimizer_1addr(NJS_VMCODE_STOP, njs_vmcode_stop_t, retval,
+                        NJS_OPTIMIZER_NO_NEXT),
+
+    { NJS_VMCODE_JUMP, sizeof(njs_vmcode_jump_t),
+      NJS_OPTIMIZER_NO_NEXT | NJS_OPTIMIZER_THREAD,
+      { 0 }, { offsetof(njs_vmcode_jump_t, offset) } },
+
+    { NJS_VMCODE_IF_TRUE_JUMP, sizeof(njs_vmcode_cond_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_cond_jump_t, cond) },
+      { offsetof(njs_vmcode_cond_jump_t, offset) } },
+
+    { NJS_VMCODE_IF_FALSE_JUMP, sizeof(njs_vmcode_cond_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_cond_jump_t, cond) },
+      { offsetof(njs_vmcode_cond_jump_t, offset) } },
+
+    { NJS_VMCODE_IF_EQUAL_JUMP, sizeof(njs_vmcode_equal_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_equal_jump_t, value1),
+        offsetof(njs_vmcode_equal_jump_t, value2) },
+      { offsetof(njs_vmcode_equal_jump_t, offset) } },
+
+    njs_optimizer_prop(NJS_VMCODE_PROPERTY_GET, njs_vmcode_prop_get_t),
+    njs_optimizer_prop(NJS_VMCODE_GLOBAL_GET, njs_vmcode_prop_get_t),
+    njs_optimizer_prop(NJS_VMCODE_PROPERTY_SET, njs_vmcode_prop_set_t),
+    njs_optimizer_prop(NJS_VMCODE_PROPERTY_INIT, njs_vmcode_prop_set_t),
+    njs_optimizer_prop(NJS_VMCODE_PROTO_INIT, njs_vmcode_prop_set_t),
+    njs_optimizer_prop(NJS_VMCODE_PROPERTY_ACCESSOR,
+                       njs_vmcode_prop_accessor_t),
+
+    { NJS_VMCODE_PROPERTY_FOREACH, sizeof(njs_vmcode_prop_foreach_t), 0,
+      { offsetof(njs_vmcode_prop_foreach_t, next),
+        offsetof(njs_vmcode_prop_foreach_t, object) },
+      { offsetof(njs_vmcode_prop_foreach_t, offset) } },
+
+    { NJS_VMCODE_PROPERTY_NEXT, sizeof(njs_vmcode_prop_next_t), 0,
+      { offsetof(njs_vmcode_prop_next_t, retval),
+        offsetof(njs_vmcode_prop_next_t, object),
+        offsetof(njs_vmcode_prop_next_t, next) },
+      { offsetof(njs_vmcode_prop_next_t, offset) } },
+
+    { NJS_VMCODE_INSTANCE_OF, sizeof(njs_vmcode_instance_of_t), 0,
+      { offsetof(njs_vmcode_instance_of_t, value),
+        offsetof(njs_vmcode_instance_of_t, constructor),
+        offsetof(njs_vmcode_instance_of_t, object) }, { 0 } },
+
+    njs_optimizer_1addr(NJS_VMCODE_FUNCTION_FRAME,
+                        njs_vmcode_function_frame_t, name, 0),
+
+    { NJS_VMCODE_METHOD_FRAME, sizeof(njs_vmcode_method_frame_t), 0,
+      { offsetof(njs_vmcode_method_frame_t, object),
+        offsetof(njs_vmcode_method_frame_t, method) }, { 0 } },
+
+    njs_optimizer_1addr(NJS_VMCODE_FUNCTION_CALL, njs_vmcode_function_call_t,
+                        retval, 0),
+    njs_optimizer_1addr(NJS_VMCODE_RETURN, njs_vmcode_return_t, retval,
+                        NJS_OPTIMIZER_NO_NEXT),
+    njs_optimizer_1addr(NJS_VMCODE_THIS, njs_vmcode_this_t, dst, 0),
+    njs_optimizer_1addr(NJS_VMCODE_ARGUMENTS, njs_vmcode_arguments_t, dst, 0),
+    njs_optimizer_1addr(NJS_VMCODE_OBJECT, njs_vmcode_object_t, retval, 0),
+    njs_optimizer_1addr(NJS_VMCODE_ARRAY, njs_vmcode_array_t, retval, 0),
+    njs_optimizer_1addr(NJS_VMCODE_TEMPLATE_LITERAL,
+                        njs_vmcode_template_literal_t, retval, 0),
+    njs_optimizer_1addr(NJS_VMCODE_THROW, njs_vmcode_throw_t, retval,
+                        NJS_OPTIMIZER_NO_NEXT),
+    njs_optimizer_1addr(NJS_VMCODE_FUNCTION, njs_vmcode_function_t, retval, 0),
+    njs_optimizer_1addr(NJS_VMCODE_REGEXP, njs_vmcode_regexp_t, retval, 0),
+
+    { NJS_VMCODE_OBJECT_COPY, sizeof(njs_vmcode_object_copy_t), 0,
+      { offsetof(njs_vmcode_object_copy_t, retval),
+        offsetof(njs_vmcode_object_copy_t, object) }, { 0 } },
+
+    { NJS_VMCODE_TRY_START, sizeof(njs_vmcode_try_start_t), 0,
+      { offsetof(njs_vmcode_try_start_t, exception_value),
+        offsetof(njs_vmcode_try_start_t, exit_value) },
+      { offsetof(njs_vmcode_try_start_t, offset) } },
+
+    { NJS_VMCODE_TRY_BREAK, sizeof(njs_vmcode_try_trampoline_t),
+      NJS_OPTIMIZER_NO_NEXT,
+      { offsetof(njs_vmcode_try_trampoline_t, exit_value) },
+      { offsetof(njs_vmcode_try_trampoline_t, offset) } },
+
+    { NJS_VMCODE_TRY_CONTINUE, sizeof(njs_vmcode_try_trampoline_t),
+      NJS_OPTIMIZER_NO_NEXT,
+      { offsetof(njs_vmcode_try_trampoline_t, exit_value) },
+      { offsetof(njs_vmcode_try_trampoline_t, offset) } },
+
+    { NJS_VMCODE_TRY_END, sizeof(njs_vmcode_try_end_t),
+      NJS_OPTIMIZER_NO_NEXT,
+      { 0 }, { offsetof(njs_vmcode_try_end_t, offset) } },
+
+    { NJS_VMCODE_TRY_RETURN, sizeof(njs_vmcode_try_return_t),
+      NJS_OPTIMIZER_NO_NEXT,
+      { offsetof(njs_vmcode_try_return_t, save),
+        offsetof(njs_vmcode_try_return_t, retval) },
+      { offsetof(njs_vmcode_try_return_t, offset) } },
+
+    { NJS_VMCODE_CATCH, sizeof(njs_vmcode_catch_t), 0,
+      { offsetof(njs_vmcode_catch_t, exception) },
+      { offsetof(njs_vmcode_catch_t, offset) } },
+
+    { NJS_VMCODE_FINALLY, sizeof(njs_vmcode_finally_t), 0,
+      { offsetof(njs_vmcode_finally_t, retval),
+        offsetof(njs_vmcode_finally_t, exit_value) },
+      { offsetof(njs_vmcode_finally_t, continue_offset),
+        offsetof(njs_vmcode_finally_t, break_offset) } },
+
+    { NJS_VMCODE_REFERENCE_ERROR, sizeof(njs_vmcode_reference_error_t),
+      NJS_OPTIMIZER_NO_NEXT, { 0 }, { 0 } },
+
+    njs_optimizer_2addr(NJS_VMCODE_MOVE, 0),
+
+    njs_optimizer_3addr(NJS_VMCODE_INCREMENT, 0),
+    njs_optimizer_3addr(NJS_VMCODE_POST_INCREMENT, 0),
+    njs_optimizer_3addr(NJS_VMCODE_DECREMENT, 0),
+    njs_optimizer_3addr(NJS_VMCODE_POST_DECREMENT, 0),
+    njs_optimizer_3addr(NJS_VMCODE_LESS,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_GREATER,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_LESS_OR_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_GREATER_OR_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_ADDITION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_NOT_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_SUBSTRACTION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_MULTIPLICATION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_EXPONENTIATION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_DIVISION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_REMAINDER, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_BITWISE_AND, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_BITWISE_OR, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_BITWISE_XOR, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_LEFT_SHIFT, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_RIGHT_SHIFT, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_UNSIGNED_RIGHT_SHIFT, NJS_OPTIMIZER_PURE),
+    njs_optimizer_3addr(NJS_VMCODE_PROPERTY_IN, 0),
+    njs_optimizer_3addr(NJS_VMCODE_PROPERTY_DELETE, 0),
+    njs_optimizer_3addr(NJS_VMCODE_STRICT_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+    njs_optimizer_3addr(NJS_VMCODE_STRICT_NOT_EQUAL,
+                        NJS_OPTIMIZER_PURE | NJS_OPTIMIZER_COMPARE),
+
+    { NJS_VMCODE_TEST_IF_TRUE, sizeof(njs_vmcode_test_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_test_jump_t, retval),
+        offsetof(njs_vmcode_test_jump_t, value) },
+      { offsetof(njs_vmcode_test_jump_t, offset) } },
+
+    { NJS_VMCODE_TEST_IF_FALSE, sizeof(njs_vmcode_test_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_test_jump_t, retval),
+        offsetof(njs_vmcode_test_jump_t, value) },
+      { offsetof(njs_vmcode_test_jump_t, offset) } },
+
+    { NJS_VMCODE_COALESCE, sizeof(njs_vmcode_test_jump_t),
+      NJS_OPTIMIZER_THREAD,
+      { offsetof(njs_vmcode_test_jump_t, retval),
+        offsetof(njs_vmcode_test_jump_t, value) },
+      { offsetof(njs_vmcode_test_jump_t, offset) } },
+
+    njs_optimizer_2addr(NJS_VMCODE_UNARY_PLUS, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_UNARY_NEGATION, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_BITWISE_NOT, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_LOGICAL_NOT, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_TYPEOF, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_VOID, NJS_OPTIMIZER_PURE),
+    njs_optimizer_2addr(NJS_VMCODE_DELETE, 0),
+
+    njs_optimizer_3addr(NJS_VMCODE_LESS_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_GREATER_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_LESS_OR_EQUAL_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_GREATER_OR_EQUAL_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_EQUAL_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_NOT_EQUAL_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_STRICT_EQUAL_JUMP, 0),
+    njs_optimizer_3addr(NJS_VMCODE_STRICT_NOT_EQUAL_JUMP, 0),
+};
+
+
+njs_int_t
+njs_optimizer(njs_vm_t *vm, njs_generator_t *generator)
+{
+    njs_int_t        ret;
+    njs_uint_t       i;
+    njs_optimizer_t  opt;
+
+    opt.vm = vm;
+    opt.start = generator->code_start;
+    opt.size = generator->code_end - generator->code_start;
+    opt.insns = NULL;
+
+    njs_memzero(opt.ops, sizeof(opt.ops));
+
+    for (i = 0; i < njs_nitems(njs_optimizer_ops); i++) {
+        opt.ops[njs_optimizer_ops[i].operation] = &njs_optimizer_ops[i];
+    }
+
+    ret = njs_optimizer_decode(&opt);
+    if (ret != NJS_OK) {
+        goto done;
+    }
+
+    njs_optimizer_thread_jumps(&opt);
+
+    ret = njs_optimizer_reachable(&opt);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    njs_optimizer_targets(&opt);
+    njs_optimizer_jumps(&opt);
+
+    ret = njs_optimizer_moves(&opt);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto done;
+    }
+
+    njs_optimizer_compact(&opt);
+
+    (void) njs_optimizer_fuse(&opt);
+
+    generator->code_end = opt.start + opt.size;
+    generator->generated = opt.n;
+
+done:
+
+    if (opt.insns != NULL) {
+        njs_mp_free(vm->mem_pool, opt.insns);
+    }
+
+    return (ret == NJS_ERROR) ? NJS_ERROR : NJS_OK;
+}
+
+
+static njs_int_t
+njs_optimizer_decode(njs_optimizer_t *opt)
+{
+    u_char                    *p, *end;
+    njs_uint_t                n;
+    njs_optimizer_insn_t      *insn;
+    const njs_optimizer_op_t  *op;
+
+    end = opt->start + opt->size;
+    n = 0;
+
+    for (p = opt->start; p < end; p += op->size) {
+        op = opt->ops[*(njs_vmcode_operation_t *) p];
+
+        if (njs_slow_path(op == NULL || (size_t) (end - p) < op->size)) {
+            return NJS_DECLINED;
+        }
+
+        n++;
+    }
+
+    if (n == 0) {
+        return NJS_DECLINED;
+    }
+
+    /* The last item is the end of the code. */
+
+    opt->insns = njs_mp_zalloc(opt->vm->mem_pool,
+                               (n + 1) * sizeof(njs_optimizer_insn_t));
+    if (njs_slow_path(opt->insns == NULL)) {
+        njs_memory_error(opt->vm);
+        return NJS_ERROR;
+    }
+
+    opt->n = n;
+    insn = opt->insns;
+
+    for (p = opt->start; p < end; p += op->size) {
+        op = opt->ops[*(njs_vmcode_operation_t *) p];
+
+        insn->op = op;
+        insn->offset = p - opt->start;
+        insn++;
+    }
+
+    insn->offset = opt->size;
+
+    return NJS_OK;
+}
+
+
+static njs_uint_t
+njs_optimizer_find(njs_optimizer_t *opt, size_t offset)
+{
+    njs_uint_t  left, right, middle;
+
+    left = 0;
+    right = opt->n;
+
+    while (left <= right) {
+        middle = left + (right - left) / 2;
+
+        if (opt->insns[middle].offset == offset) {
+            return middle;
+        }
+
+        if (opt->insns[middle].offset < offset) {
+            left = middle + 1;
+
+        } else {
+            if (middle == 0) {
+                break;
+            }
+
+            right = middle - 1;
+        }
+    }
+
+    return NJS_OPTIMIZER_NONE;
+}
+
+
+/*
+ * The instruction a jump offset points to, or NJS_OPTIMIZER_NONE if the
+ * offset is not a jump target.  The generator leaves unused offsets of
+ * "finally" pointing into the instruction itself.
+ */
+
+static uint32_t
+njs_optimizer_target(njs_optimizer_t *opt, njs_uint_t i, njs_uint_t j)
+{
+    njs_jump_off_t  target;
+
+    target = (njs_jump_off_t) opt->insns[i].offset
+             + *njs_optimizer_insn_jump(opt, i, j);
+
+    if (target < 0 || (size_t) target > opt->size) {
+        return NJS_OPTIMIZER_NONE;
+    }
+
+    return njs_optimizer_find(opt, target);
+}
+
+
+static void
+njs_optimizer_set_target(njs_optimizer_t *opt, njs_uint_t i, njs_uint_t j,
+    njs_uint_t target)
+{
+    *njs_optimizer_insn_jump(opt, i, j) = (njs_jump_off_t)
+                                          opt->insns[target].offset
+                                          - (njs_jump_off_t)
+                                            opt->insns[i].offset;
+}
+
+
+/* The instruction or the first instruction after it which is kept. */
+
+static njs_uint_t
+njs_optimizer_kept(njs_optimizer_t *opt, njs_uint_t i)
+{
+    while (i < opt->n && opt->insns[i].removed) {
+        i++;
+    }
+
+    return i;
+}
+
+
+/*
+ * A jump to an unconditional jump is replaced with a jump to
+ * the final target.
+ */
+
+static void
+njs_optimizer_thread_jumps(njs_optimizer_t *opt)
+{
+    uint32_t    target, next;
+    njs_uint_t  i, hops;
+
+    for (i = 0; i < opt->n; i++) {
+        if (!(opt->insns[i].op->flags & NJS_OPTIMIZER_THREAD)) {
+            continue;
+        }
+
+        target = njs_optimizer_target(opt, i, 0);
+
+        for (hops = 0; hops < NJS_OPTIMIZER_HOPS; hops++) {
+            if (target == NJS_OPTIMIZER_NONE
+                || target == i
+                || !njs_optimizer_is(opt, target, NJS_VMCODE_JUMP))
+            {
+                break;
+            }
+
+            next = njs_optimizer_target(opt, target, 0);
+            if (next == NJS_OPTIMIZER_NONE || next == target) {
+                break;
+            }
+
+            njs_optimizer_set_target(opt, i, 0, next);
+
+            target = next;
+        }
+    }
+}
+
+
+/*
+ * Instructions which are not reachable from the start of the code are
+ * removed.  Exception handlers are reachable through the jump offsets of
+ * "try" and "catch" instructions, the instruction after "reference error"
+ * is reachable from the global variable lookup before it.
+ */
+
+static njs_int_t
+njs_optimizer_reachable(njs_optimizer_t *opt)
+{
+    uint32_t              *stack, target;
+    njs_uint_t            i, j, n;
+    njs_optimizer_insn_t  *insn;
+
+    stack = njs_mp_alloc(opt->vm->mem_pool, opt->n * sizeof(uint32_t));
+    if (njs_slow_path(stack == NULL)) {
+        njs_memory_error(opt->vm);
+        return NJS_ERROR;
+    }
+
+    n = 0;
+    stack[n++] = 0;
+    opt->insns[0].reachable = 1;
+
+#define njs_optimizer_push(t)                                                 \
+    do {                                                                      \
+        if ((t) < opt->n && !opt->insns[t].reachable) {                       \
+            opt->insns[t].reachable = 1;                                      \
+            stack[n++] = (t);                                                 \
+        }                                                                     \
+    } while (0)
+
+    while (n != 0) {
+        i = stack[--n];
+        insn = &opt->insns[i];
+
+        if (!(insn->op->flags & NJS_OPTIMIZER_NO_NEXT)) {
+            njs_optimizer_push(i + 1);
+        }
+
+        if (insn->op->operation == NJS_VMCODE_GLOBAL_GET) {
+            njs_optimizer_push(i + 2);
+        }
+
+        for (j = 0; j < NJS_OPTIMIZER_JUMPS && insn->op->jumps[j] != 0; j++) {
+            target = njs_optimizer_target(opt, i, j);
+
+            if (target != NJS_OPTIMIZER_NONE) {
+                njs_optimizer_push(target);
+            }
+        }
+    }
+
+#undef njs_optimizer_push
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+        insn->removed = !insn->reachable;
+
+        /*
+         * "catch" without "finally" is recognized by the offset to the next
+         * instruction, so the instruction after "catch" with "finally" must
+         * stay between them.
+         */
+
+        if (insn->reachable
+            && i + 1 < opt->n
+            && insn->op->operation == NJS_VMCODE_CATCH
+            && *njs_optimizer_insn_jump(opt, i, 0)
+               != sizeof(njs_vmcode_catch_t))
+        {
+            opt->insns[i + 1].pinned = 1;
+        }
+    }
+
+    njs_mp_free(opt->vm->mem_pool, stack);
+
+    return NJS_OK;
+}
+
+
+static void
+njs_optimizer_targets(njs_optimizer_t *opt)
+{
+    uint32_t              target;
+    njs_uint_t            i, j;
+    njs_optimizer_insn_t  *insn;
+
+    for (i = 0; i < opt->n; i++) {
+        opt->insns[i].target = 0;
+    }
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+
+        if (insn->removed) {
+            continue;
+        }
+
+        if (insn->op->operation == NJS_VMCODE_GLOBAL_GET && i + 2 < opt->n) {
+            opt->insns[i + 2].target = 1;
+        }
+
+        for (j = 0; j < NJS_OPTIMIZER_JUMPS && insn->op->jumps[j] != 0; j++) {
+            target = njs_optimizer_target(opt, i, j);
+
+            if (target != NJS_OPTIMIZER_NONE) {
+                opt->insns[target].target = 1;
+            }
+        }
+    }
+}
+
+
+/*
+ * A conditional jump over an unconditional jump is inverted:
+ *
+ *     IF FALSE c, L1; JUMP L2; L1:   ->   IF TRUE c, L2; L1:
+ *
+ * An unconditional jump to the next instruction is removed.
+ */
+
+static void
+njs_optimizer_jumps(njs_optimizer_t *opt)
+{
+    uint32_t                t1, t2;
+    njs_uint_t              i, j, next;
+    njs_vmcode_operation_t  operation;
+
+    for (i = 0; i < opt->n; i++) {
+        if (opt->insns[i].removed) {
+            continue;
+        }
+
+        operation = opt->insns[i].op->operation;
+
+        if (operation == NJS_VMCODE_JUMP) {
+            t1 = njs_optimizer_target(opt, i, 0);
+
+            if (t1 != NJS_OPTIMIZER_NONE && t1 > i
+                && njs_optimizer_kept(opt, t1)
+                   == njs_optimizer_kept(opt, i + 1)
+                && !opt->insns[i].pinned)
+            {
+                opt->insns[i].removed = 1;
+            }
+
+            continue;
+        }
+
+        if (operation != NJS_VMCODE_IF_TRUE_JUMP
+            && operation != NJS_VMCODE_IF_FALSE_JUMP)
+        {
+            continue;
+        }
+
+        j = njs_optimizer_kept(opt, i + 1);
+
+        if (!njs_optimizer_is(opt, j, NJS_VMCODE_JUMP)
+            || opt->insns[j].target
+            || opt->insns[j].pinned)
+        {
+            continue;
+        }
+
+        next = njs_optimizer_kept(opt, j + 1);
+
+        t1 = njs_optimizer_target(opt, i, 0);
+        t2 = njs_optimizer_target(opt, j, 0);
+
+        if (t1 == NJS_OPTIMIZER_NONE || t2 == NJS_OPTIMIZER_NONE
+            || njs_optimizer_kept(opt, t1) != next
+            || njs_optimizer_kept(opt, t2) == j)
+        {
+            continue;
+        }
+
+        operation = (operation == NJS_VMCODE_IF_TRUE_JUMP)
+                    ? NJS_VMCODE_IF_FALSE_JUMP
+                    : NJS_VMCODE_IF_TRUE_JUMP;
+
+        njs_optimizer_insn_code(opt, i)->code.operation = operation;
+        opt->insns[i].op = opt->ops[operation];
+
+        njs_optimizer_set_target(opt, i, 0, t2);
+
+        opt->insns[j].removed = 1;
+    }
+}
+
+
+/*
+ * A move of a value to itself is removed, a move overwritten by the next
+ * move is removed.  A local variable or a temporary which is written by
+ * an instruction and is only read by the move after it is replaced with
+ * the move destination:
+ *
+ *     ADD t, a, b; MOVE x, t   ->   ADD x, a, b
+ *
+ * Local indexes are not visible to the other code blocks, closures use
+ * their own indexes.
+ */
+
+static njs_int_t
+njs_optimizer_moves(njs_optimizer_t *opt)
+{
+    size_t                offset, nlocals;
+    uint32_t              *refs;
+    njs_uint_t            i, j, k;
+    njs_index_t           index, *dst;
+    njs_vmcode_move_t     *move, *next;
+    njs_optimizer_insn_t  *insn;
+
+    nlocals = 0;
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+
+        for (k = 0; k < NJS_OPTIMIZER_INDEXES && insn->op->indexes[k] != 0;
+             k++)
+        {
+            index = *njs_optimizer_insn_index(opt, i, k);
+
+            if (njs_scope_type(index) == NJS_SCOPE_LOCAL) {
+                offset = njs_scope_offset(index) / sizeof(njs_value_t);
+                nlocals = njs_max(nlocals, offset + 1);
+            }
+        }
+    }
+
+    refs = NULL;
+
+    if (nlocals != 0) {
+        refs = njs_mp_zalloc(opt->vm->mem_pool, nlocals * sizeof(uint32_t));
+        if (njs_slow_path(refs == NULL)) {
+            njs_memory_error(opt->vm);
+            return NJS_ERROR;
+        }
+
+        for (i = 0; i < opt->n; i++) {
+            insn = &opt->insns[i];
+
+            if (insn->removed) {
+                continue;
+            }
+
+            for (k = 0;
+                 k < NJS_OPTIMIZER_INDEXES && insn->op->indexes[k] != 0;
+                 k++)
+            {
+                index = *njs_optimizer_insn_index(opt, i, k);
+
+                if (njs_scope_type(index) == NJS_SCOPE_LOCAL) {
+                    refs[njs_scope_offset(index) / sizeof(njs_value_t)]++;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+
+        if (insn->removed) {
+            continue;
+        }
+
+        j = njs_optimizer_kept(opt, i + 1);
+
+        if (!njs_optimizer_is(opt, j, NJS_VMCODE_MOVE)) {
+            j = NJS_OPTIMIZER_NONE;
+        }
+
+        if (insn->op->operation == NJS_VMCODE_MOVE) {
+            if (insn->pinned) {
+                continue;
+            }
+
+            move = (njs_vmcode_move_t *) njs_optimizer_insn_code(opt, i);
+
+            if (move->dst == move->src) {
+                insn->removed = 1;
+                continue;
+            }
+
+            if (j != NJS_OPTIMIZER_NONE && !opt->insns[j].target) {
+                next = (njs_vmcode_move_t *) njs_optimizer_insn_code(opt, j);
+
+                if (next->dst == move->dst && next->src != move->dst) {
+                    insn->removed = 1;
+                }
+            }
+
+            continue;
+        }
+
+        if (!(insn->op->flags & NJS_OPTIMIZER_PURE)
+            || j == NJS_OPTIMIZER_NONE
+            || opt->insns[j].target
+            || opt->insns[j].pinned)
+        {
+            continue;
+        }
+
+        dst = njs_optimizer_insn_index(opt, i, 0);
+        next = (njs_vmcode_move_t *) njs_optimizer_insn_code(opt, j);
+
+        if (next->src != *dst
+            || njs_scope_type(*dst) != NJS_SCOPE_LOCAL
+            || refs[njs_scope_offset(*dst) / sizeof(njs_value_t)] != 2)
+        {
+            continue;
+        }
+
+        refs[njs_scope_offset(*dst) / sizeof(njs_value_t)] = 0;
+
+        *dst = next->dst;
+        opt->insns[j].removed = 1;
+    }
+
+    if (refs != NULL) {
+        njs_mp_free(opt->vm->mem_pool, refs);
+    }
+
+    return NJS_OK;
+}
+
+
+/*
+ * The removed instructions are squeezed out and the jump offsets are
+ * relocated.  A jump to a removed instruction continues with the next
+ * instruction which is kept.
+ */
+
+static void
+njs_optimizer_compact(njs_optimizer_t *opt)
+{
+    u_char                *p;
+    uint32_t              target, position;
+    njs_uint_t            i, j, kept;
+    njs_optimizer_insn_t  *insn;
+
+    position = 0;
+    kept = 0;
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+        insn->position = position;
+
+        if (!insn->removed) {
+            position += insn->op->size;
+            kept++;
+        }
+    }
+
+    opt->insns[opt->n].position = position;
+
+    if (kept == opt->n) {
+        return;
+    }
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+
+        if (insn->removed) {
+            continue;
+        }
+
+        for (j = 0; j < NJS_OPTIMIZER_JUMPS && insn->op->jumps[j] != 0; j++) {
+            target = njs_optimizer_target(opt, i, j);
+
+            if (target != NJS_OPTIMIZER_NONE) {
+                *njs_optimizer_insn_jump(opt, i, j) =
+                                   (njs_jump_off_t) opt->insns[target].position
+                                   - (njs_jump_off_t) insn->position;
+            }
+        }
+    }
+
+    /* The instructions only move to lower offsets. */
+
+    for (i = 0; i < opt->n; i++) {
+        insn = &opt->insns[i];
+
+        if (!insn->removed) {
+            p = opt->start + insn->position;
+
+            if (insn->position != insn->offset) {
+                memmove(p, opt->start + insn->offset, insn->op->size);
+            }
+
+            insn->offset = insn->position;
+        }
+    }
+
+    opt->size = position;
+}
+
+
+/*
+ * A compare instruction followed by a conditional jump on its result
+ * becomes a compare-and-branch superinstruction.  Returns the number of
+ * fused pairs.
+ */
+
+static njs_uint_t
+njs_optimizer_fuse(njs_optimizer_t *opt)
+{
+    u_char                    *p, *end;
+    njs_uint_t                i, fused;
+    njs_vmcode_3addr_t        *code;
+    njs_vmcode_cond_jump_t    *cond_jump;
+    njs_vmcode_operation_t    operation;
+    const njs_optimizer_op_t  *op;
+
+    static const njs_vmcode_operation_t  superinstructions[][2] = {
+        { NJS_VMCODE_LESS, NJS_VMCODE_LESS_JUMP },
+        { NJS_VMCODE_GREATER, NJS_VMCODE_GREATER_JUMP },
+        { NJS_VMCODE_LESS_OR_EQUAL, NJS_VMCODE_LESS_OR_EQUAL_JUMP },
+        { NJS_VMCODE_GREATER_OR_EQUAL, NJS_VMCODE_GREATER_OR_EQUAL_JUMP },
+        { NJS_VMCODE_EQUAL, NJS_VMCODE_EQUAL_JUMP },
+        { NJS_VMCODE_NOT_EQUAL, NJS_VMCODE_NOT_EQUAL_JUMP },
+        { NJS_VMCODE_STRICT_EQUAL, NJS_VMCODE_STRICT_EQUAL_JUMP },
+        { NJS_VMCODE_STRICT_NOT_EQUAL, NJS_VMCODE_STRICT_NOT_EQUAL_JUMP },
+    };
+
+    fused = 0;
+    end = opt->start + opt->size;
+
+    for (p = opt->start; p < end; p += op->size) {
+        operation = *(njs_vmcode_operation_t *) p;
+        op = opt->ops[operation];
+
+        if (!(op->flags & NJS_OPTIMIZER_COMPARE)
+            || (size_t) (end - p) < op->size + sizeof(njs_vmcode_cond_jump_t))
+        {
+            continue;
+        }
+
+        code = (njs_vmcode_3addr_t *) p;
+        cond_jump = (njs_vmcode_cond_jump_t *) (p + op->size);
+
+        if ((cond_jump->code.operation != NJS_VMCODE_IF_TRUE_JUMP
+             && cond_jump->code.operation != NJS_VMCODE_IF_FALSE_JUMP)
+            || cond_jump->cond != code->dst)
+        {
+            continue;
+        }
+
+        for (i = 0; i < njs_nitems(superinstructions); i++) {
+            if (superinstructions[i][0] == operation) {
+                code->code.operation = superinstructions[i][1];
+                fused++;
+                break;
+            }
+        }
+    }
+
+    return fused;
+}
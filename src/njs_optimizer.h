@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_OPTIMIZER_H_INCLUDED_
+#define _NJS_OPTIMIZER_H_INCLUDED_
+
+
+/*
+ * A peephole pass over the code of a function or a script generated by
+ * njs_generator().  The pass threads jumps to jumps, removes unreachable
+ * code and redundant moves, compacts the code relocating jump offsets and
+ * marks compare instructions followed by a conditional jump on their
+ * result as compare-and-branch superinstructions.
+ *
+ * The code is changed in place, the code start is not changed.  The pass
+ * keeps the code as it is if it finds an unknown instruction.
+ */
+
+njs_int_t njs_optimizer(njs_vm_t *vm, njs_generator_t *generator);
+
+
+#endif /* _NJS_OPTIMIZER_H_INCLUDED_ */
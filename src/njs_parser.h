@@ -105,6 +105,7 @@ njs_token_type_t njs_parser_template_literal(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *parent);
 njs_parser_node_t *njs_parser_argument(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *expr, njs_index_t index);
+njs_parser_node_t *njs_parser_fold(njs_vm_t *vm, njs_parser_node_t *node);
 njs_int_t njs_parser_string_create(njs_vm_t *vm, njs_value_t *value);
 njs_token_type_t njs_parser_function_lambda(njs_vm_t *vm, njs_parser_t *parser,
     njs_function_lambda_t *lambda, njs_token_type_t type);
@@ -145,6 +146,11 @@ void njs_parser_node_error(njs_vm_t *vm, njs_parser_node_t *node,
      || (node)->token_type == NJS_TOKEN_PROPERTY)
 
 
+#define njs_parser_is_constant(node)                                          \
+    ((node)->token_type >= NJS_TOKEN_FIRST_CONST                              \
+     && (node)->token_type <= NJS_TOKEN_LAST_CONST)
+
+
 #define njs_scope_accumulative(vm, scope)                                     \
     ((vm)->options.accumulative && (scope)->type == NJS_SCOPE_GLOBAL)
 
@@ -68,6 +68,7 @@ static njs_token_type_t njs_parser_call(njs_vm_t *vm, njs_parser_t *parser,
     njs_token_type_t type, uint8_t ctor);
 static njs_token_type_t njs_parser_arguments(njs_vm_t *vm, njs_parser_t *parser,
     njs_parser_node_t *parent);
+static njs_parser_node_t *njs_parser_fold_branch(njs_parser_node_t *node);
 
 
 static const njs_parser_expression_t
@@ -415,7 +416,7 @@ njs_parser_conditional_expression(njs_vm_t *vm, njs_parser_t *parser,
         node->right = parser->node;
         node->right->dest = cond;
 
-        parser->node = cond;
+        parser->node = njs_parser_fold_branch(cond);
     }
 }
 
@@ -436,6 +437,12 @@ njs_parser_coalesce_expression(njs_vm_t *vm, njs_parser_t *parser,
 
     for ( ;; ) {
         if (type != NJS_TOKEN_COALESCE) {
+            /*
+             * Logical and coalesce operations are folded here after
+             * the check of mixing them without parentheses.
+             */
+            parser->node = njs_parser_fold_branch(parser->node);
+
             return type;
         }
 
@@ -547,7 +554,11 @@ njs_parser_binary_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         node->right = parser->node;
         node->right->dest = node;
-        parser->node = node;
+
+        parser->node = njs_parser_fold(vm, node);
+        if (njs_slow_path(parser->node == NULL)) {
+            return NJS_TOKEN_ERROR;
+        }
     }
 }
 
@@ -591,7 +602,11 @@ njs_parser_exponential_expression(njs_vm_t *vm, njs_parser_t *parser,
 
         node->right = parser->node;
         node->right->dest = node;
-        parser->node = node;
+
+        parser->node = njs_parser_fold(vm, node);
+        if (njs_slow_path(parser->node == NULL)) {
+            return NJS_TOKEN_ERROR;
+        }
     }
 
     return type;
@@ -602,7 +617,6 @@ static njs_token_type_t
 njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
     const njs_parser_expression_t *expr, njs_token_type_t type)
 {
-    double                  num;
     njs_token_type_t        next;
     njs_parser_node_t       *node;
     njs_vmcode_operation_t  operation;
@@ -667,21 +681,6 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
 
     node = parser->node;
 
-    if (type == NJS_TOKEN_UNARY_PLUS && node->token_type == NJS_TOKEN_NUMBER) {
-        /* Skip the unary plus of number. */
-        return next;
-    }
-
-    if (type == NJS_TOKEN_UNARY_NEGATION
-        && node->token_type == NJS_TOKEN_NUMBER)
-    {
-        /* Optimization of common negative number. */
-        num = -njs_number(&node->u.value);
-        njs_set_number(&node->u.value, num);
-
-        return next;
-    }
-
     if (type == NJS_TOKEN_DELETE) {
 
         switch (node->token_type) {
@@ -715,7 +714,11 @@ njs_parser_unary_expression(njs_vm_t *vm, njs_parser_t *parser,
     node->u.operation = operation;
     node->left = parser->node;
     node->left->dest = node;
-    parser->node = node;
+
+    parser->node = njs_parser_fold(vm, node);
+    if (njs_slow_path(parser->node == NULL)) {
+        return NJS_TOKEN_ERROR;
+    }
 
     return next;
 }
@@ -1119,3 +1122,149 @@ njs_parser_argument(njs_vm_t *vm, njs_parser_t *parser,
 
     return node;
 }
+
+
+/*
+ * An operation on literals is folded to a literal, a template literal
+ * with literal substitutions is folded to a string.  The result is
+ * evaluated by njs_vmcode_fold() as the interpreter does it.
+ */
+
+njs_parser_node_t *
+njs_parser_fold(njs_vm_t *vm, njs_parser_node_t *node)
+{
+    njs_int_t          ret;
+    njs_value_t        value;
+    njs_parser_node_t  *left, *right, *stmt;
+
+    left = node->left;
+    right = node->right;
+
+    njs_memzero(&value, sizeof(njs_value_t));
+
+    if (node->token_type == NJS_TOKEN_TEMPLATE_LITERAL) {
+
+        /* The array items are linked in the reverse order. */
+
+        for (stmt = left->left; stmt != NULL; stmt = stmt->left) {
+            if (!njs_parser_is_constant(stmt->right->right)) {
+                return node;
+            }
+        }
+
+        value = njs_string_empty;
+
+        for (stmt = left->left; stmt != NULL; stmt = stmt->left) {
+            ret = njs_vmcode_fold(vm, NJS_VMCODE_ADDITION, &value,
+                                  &stmt->right->right->u.value, &value);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return NULL;
+            }
+        }
+
+        goto done;
+    }
+
+    if (!njs_parser_is_constant(left)
+        || (right != NULL && !njs_parser_is_constant(right)))
+    {
+        return node;
+    }
+
+    ret = njs_vmcode_fold(vm, node->u.operation, &value, &left->u.value,
+                          (right != NULL) ? &right->u.value : NULL);
+    if (ret != NJS_OK) {
+        return (ret == NJS_DECLINED) ? node : NULL;
+    }
+
+done:
+
+    switch (value.type) {
+    case NJS_BOOLEAN:
+        node->token_type = njs_is_true(&value) ? NJS_TOKEN_TRUE
+                                               : NJS_TOKEN_FALSE;
+        break;
+
+    case NJS_NUMBER:
+        node->token_type = NJS_TOKEN_NUMBER;
+        break;
+
+    default: /* NJS_STRING */
+        node->token_type = NJS_TOKEN_STRING;
+    }
+
+    node->u.value = value;
+    node->left = NULL;
+    node->right = NULL;
+
+    return node;
+}
+
+
+/*
+ * A conditional expression, a logical or coalesce operation with a literal
+ * test is replaced with the taken branch unless the branch is a reference,
+ * the operation keeps the branch value then, not the reference.
+ */
+
+static njs_parser_node_t *
+njs_parser_fold_branch(njs_parser_node_t *node)
+{
+    njs_parser_node_t  *left, *branch;
+
+    switch (node->token_type) {
+    case NJS_TOKEN_LOGICAL_OR:
+    case NJS_TOKEN_LOGICAL_AND:
+    case NJS_TOKEN_COALESCE:
+        node->left = njs_parser_fold_branch(node->left);
+        node->left->dest = node;
+
+        node->right = njs_parser_fold_branch(node->right);
+        node->right->dest = node;
+        break;
+
+    case NJS_TOKEN_CONDITIONAL:
+        break;
+
+    default:
+        return node;
+    }
+
+    left = node->left;
+
+    if (!njs_parser_is_constant(left)) {
+        return node;
+    }
+
+    switch (node->token_type) {
+    case NJS_TOKEN_LOGICAL_OR:
+        branch = njs_is_true(&left->u.value) ? left : node->right;
+        break;
+
+    case NJS_TOKEN_LOGICAL_AND:
+        branch = njs_is_true(&left->u.value) ? node->right : left;
+        break;
+
+    case NJS_TOKEN_COALESCE:
+        branch = njs_is_null_or_undefined(&left->u.value) ? node->right
+                                                           : left;
+        break;
+
+    default: /* NJS_TOKEN_CONDITIONAL */
+        branch = njs_is_true(&left->u.value) ? node->right->left
+                                             : node->right->right;
+    }
+
+    if (njs_parser_is_lvalue(branch)
+        || (branch->token_type >= NJS_TOKEN_ASSIGNMENT
+            && branch->token_type <= NJS_TOKEN_LAST_ASSIGNMENT)
+        || branch->token_type == NJS_TOKEN_INCREMENT
+        || branch->token_type == NJS_TOKEN_DECREMENT)
+    {
+        return node;
+    }
+
+    branch->dest = NULL;
+
+    return branch;
+}
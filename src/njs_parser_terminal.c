@@ -798,6 +798,13 @@ njs_parser_template_literal(njs_vm_t *vm, njs_parser_t *parser,
                 return NJS_TOKEN_ERROR;
             }
 
+            if (!tagged_template) {
+                parent = njs_parser_fold(vm, parent);
+                if (njs_slow_path(parent == NULL)) {
+                    return NJS_TOKEN_ERROR;
+                }
+            }
+
             parser->node = parent;
 
             return njs_parser_token(vm, parser);
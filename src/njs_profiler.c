@@ -0,0 +1,351 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+#define NJS_PROFILER_MAX_DEPTH  64
+
+
+struct njs_profiler_s {
+    njs_mp_t                *mem_pool;
+    njs_lvlhsh_t            hash;
+    njs_arr_t               *stacks;  /* of njs_profiler_stack_t * */
+};
+
+
+typedef struct {
+    uint64_t                count;
+    njs_str_t               name;
+    njs_uint_t              depth;
+    njs_function_lambda_t   *frames[];
+} njs_profiler_stack_t;
+
+
+static njs_profiler_stack_t *njs_profiler_stack_add(njs_vm_t *vm,
+    njs_profiler_t *profiler, njs_lvlhsh_query_t *lhq);
+static njs_int_t njs_profiler_stack_name(njs_vm_t *vm,
+    njs_profiler_t *profiler, njs_profiler_stack_t *stack);
+static njs_int_t njs_profiler_stack_test(njs_lvlhsh_query_t *lhq, void *data);
+static int njs_profiler_stack_compare(const void *a, const void *b);
+
+
+volatile sig_atomic_t  njs_profiler_ticks;
+
+
+static const njs_lvlhsh_proto_t  njs_profiler_hash_proto
+    njs_aligned(64) =
+{
+    NJS_LVLHSH_DEFAULT,
+    njs_profiler_stack_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+njs_profiler_t *
+njs_profiler_create(void)
+{
+    njs_mp_t        *mp;
+    njs_profiler_t  *profiler;
+
+    mp = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (njs_slow_path(mp == NULL)) {
+        return NULL;
+    }
+
+    profiler = njs_mp_zalloc(mp, sizeof(njs_profiler_t));
+    if (njs_slow_path(profiler == NULL)) {
+        goto fail;
+    }
+
+    profiler->mem_pool = mp;
+
+    profiler->stacks = njs_arr_create(mp, 16, sizeof(njs_profiler_stack_t *));
+    if (njs_slow_path(profiler->stacks == NULL)) {
+        goto fail;
+    }
+
+    return profiler;
+
+fail:
+
+    njs_mp_destroy(mp);
+
+    return NULL;
+}
+
+
+void
+njs_profiler_destroy(njs_profiler_t *profiler)
+{
+    njs_mp_destroy(profiler->mem_pool);
+}
+
+
+void
+njs_vm_set_profiler(njs_vm_t *vm, njs_profiler_t *profiler)
+{
+    vm->profiler = profiler;
+}
+
+
+void
+njs_profiler_tick(void)
+{
+    njs_profiler_ticks++;
+}
+
+
+/*
+ * The stack is identified by the lambdas of the active frames up to
+ * the global frame, the global code has no lambda.  The name of the stack
+ * is resolved once when the stack is sampled the first time.
+ */
+
+void
+njs_profiler_sample(njs_vm_t *vm)
+{
+    njs_uint_t             n, ticks;
+    njs_frame_t            *frame;
+    njs_function_t         *function;
+    njs_profiler_t         *profiler;
+    njs_lvlhsh_query_t     lhq;
+    njs_profiler_stack_t   *stack;
+    njs_function_lambda_t  *frames[NJS_PROFILER_MAX_DEPTH];
+
+    ticks = njs_profiler_ticks;
+    njs_profiler_ticks = 0;
+
+    profiler = vm->profiler;
+
+    if (profiler == NULL) {
+        return;
+    }
+
+    n = 0;
+    frame = vm->active_frame;
+
+    do {
+        function = frame->native.function;
+
+        if (function == NULL) {
+            /* The global frame has no previous_active_frame field. */
+            frames[n++] = NULL;
+            break;
+        }
+
+        frames[n++] = function->u.lambda;
+        frame = frame->previous_active_frame;
+
+    } while (n < NJS_PROFILER_MAX_DEPTH);
+
+    lhq.key.start = (u_char *) frames;
+    lhq.key.length = n * sizeof(njs_function_lambda_t *);
+    lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &njs_profiler_hash_proto;
+
+    if (njs_lvlhsh_find(&profiler->hash, &lhq) == NJS_OK) {
+        stack = lhq.value;
+
+    } else {
+        stack = njs_profiler_stack_add(vm, profiler, &lhq);
+        if (njs_slow_path(stack == NULL)) {
+            return;
+        }
+    }
+
+    stack->count += ticks;
+}
+
+
+static njs_profiler_stack_t *
+njs_profiler_stack_add(njs_vm_t *vm, njs_profiler_t *profiler,
+    njs_lvlhsh_query_t *lhq)
+{
+    njs_int_t             ret;
+    njs_profiler_stack_t  *stack, **p;
+
+    stack = njs_mp_zalloc(profiler->mem_pool,
+                          sizeof(njs_profiler_stack_t) + lhq->key.length);
+    if (njs_slow_path(stack == NULL)) {
+        return NULL;
+    }
+
+    stack->depth = lhq->key.length / sizeof(njs_function_lambda_t *);
+    memcpy(stack->frames, lhq->key.start, lhq->key.length);
+
+    ret = njs_profiler_stack_name(vm, profiler, stack);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return NULL;
+    }
+
+    p = njs_arr_add(profiler->stacks);
+    if (njs_slow_path(p == NULL)) {
+        return NULL;
+    }
+
+    *p = stack;
+
+    lhq->value = stack;
+    lhq->replace = 0;
+    lhq->pool = profiler->mem_pool;
+
+    ret = njs_lvlhsh_insert(&profiler->hash, lhq);
+    if (njs_slow_path(ret != NJS_OK)) {
+        profiler->stacks->items--;
+        return NULL;
+    }
+
+    return stack;
+}
+
+
+/*
+ * The name is the list of functions from the outermost one separated
+ * by ";", a function defined in a script is followed by its location.
+ */
+
+static njs_int_t
+njs_profiler_stack_name(njs_vm_t *vm, njs_profiler_t *profiler,
+    njs_profiler_stack_t *stack)
+{
+    njs_int_t              ret;
+    njs_arr_t              *backtrace;
+    njs_uint_t             i;
+    njs_chb_t              chain;
+    njs_frame_t            *frame;
+    njs_backtrace_entry_t  *be;
+
+    backtrace = njs_arr_create(profiler->mem_pool, stack->depth,
+                               sizeof(njs_backtrace_entry_t));
+    if (njs_slow_path(backtrace == NULL)) {
+        return NJS_ERROR;
+    }
+
+    frame = vm->active_frame;
+
+    for (i = 0; i < stack->depth; i++) {
+        if (vm->debug != NULL || frame->native.function == NULL) {
+            ret = njs_vm_add_backtrace_entry(vm, backtrace, &frame->native);
+            if (njs_slow_path(ret != NJS_OK)) {
+                goto done;
+            }
+
+        } else {
+            be = njs_arr_add(backtrace);
+            if (njs_slow_path(be == NULL)) {
+                ret = NJS_ERROR;
+                goto done;
+            }
+
+            be->name = njs_entry_unknown;
+            be->line = 0;
+        }
+
+        frame = frame->previous_active_frame;
+    }
+
+    njs_chb_init(&chain, profiler->mem_pool);
+
+    be = backtrace->start;
+
+    for (i = backtrace->items; i != 0; i--) {
+        njs_chb_append_str(&chain, &be[i - 1].name);
+
+        if (be[i - 1].line != 0) {
+            njs_chb_sprintf(&chain, 16 + be[i - 1].file.length, " (%V:%uD)",
+                            &be[i - 1].file, be[i - 1].line);
+        }
+
+        if (i != 1) {
+            njs_chb_append_literal(&chain, ";");
+        }
+    }
+
+    ret = njs_chb_join(&chain, &stack->name);
+
+    njs_chb_destroy(&chain);
+
+done:
+
+    njs_arr_destroy(backtrace);
+
+    return ret;
+}
+
+
+static njs_int_t
+njs_profiler_stack_test(njs_lvlhsh_query_t *lhq, void *data)
+{
+    njs_profiler_stack_t  *stack;
+
+    stack = data;
+
+    if (lhq->key.length == stack->depth * sizeof(njs_function_lambda_t *)
+        && memcmp(lhq->key.start, stack->frames, lhq->key.length) == 0)
+    {
+        return NJS_OK;
+    }
+
+    return NJS_DECLINED;
+}
+
+
+njs_int_t
+njs_profiler_report(njs_profiler_t *profiler, njs_str_t *report)
+{
+    njs_int_t             ret;
+    njs_chb_t             chain;
+    njs_uint_t            i;
+    njs_profiler_stack_t  **stacks;
+
+    stacks = profiler->stacks->start;
+
+    qsort(stacks, profiler->stacks->items, sizeof(njs_profiler_stack_t *),
+          njs_profiler_stack_compare);
+
+    njs_chb_init(&chain, profiler->mem_pool);
+
+    for (i = 0; i < profiler->stacks->items; i++) {
+        if (stacks[i]->count == 0) {
+            continue;
+        }
+
+        njs_chb_sprintf(&chain, 32 + stacks[i]->name.length, "%V %uL\n",
+                        &stacks[i]->name, stacks[i]->count);
+    }
+
+    ret = njs_chb_join(&chain, report);
+
+    njs_chb_destroy(&chain);
+
+    return ret;
+}
+
+
+static int
+njs_profiler_stack_compare(const void *a, const void *b)
+{
+    int                         ret;
+    const njs_profiler_stack_t  *sa, *sb;
+
+    sa = *(const njs_profiler_stack_t **) a;
+    sb = *(const njs_profiler_stack_t **) b;
+
+    if (sa->count != sb->count) {
+        return (sa->count < sb->count) ? 1 : -1;
+    }
+
+    ret = memcmp(sa->name.start, sb->name.start,
+                 njs_min(sa->name.length, sb->name.length));
+
+    if (ret == 0) {
+        ret = (int) sa->name.length - (int) sb->name.length;
+    }
+
+    return ret;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_PROFILER_H_INCLUDED_
+#define _NJS_PROFILER_H_INCLUDED_
+
+
+/*
+ * A signal may interrupt any code, so njs_profiler_tick() only counts
+ * ticks.  The interpreter checks the counter on function calls, returns
+ * and backward jumps of loops, so straight-line code does not pay for it,
+ * and accounts the ticks to the stack of the active frames.  The ticks
+ * spent in native functions are accounted to the calling function.
+ */
+
+#define njs_profiler_poll(vm)                                                 \
+    do {                                                                      \
+        if (njs_slow_path(njs_profiler_ticks != 0)) {                         \
+            njs_profiler_sample(vm);                                          \
+        }                                                                     \
+    } while (0)
+
+
+#define njs_profiler_poll_jump(vm, offset)                                    \
+    do {                                                                      \
+        if ((njs_jump_off_t) (offset) < 0) {                                  \
+            njs_profiler_poll(vm);                                            \
+        }                                                                     \
+    } while (0)
+
+
+void njs_profiler_sample(njs_vm_t *vm);
+
+
+extern volatile sig_atomic_t  njs_profiler_ticks;
+
+
+#endif /* _NJS_PROFILER_H_INCLUDED_ */
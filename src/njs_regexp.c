@@ -701,6 +701,7 @@ njs_regexp_alloc(njs_vm_t *vm, njs_regexp_pattern_t *pattern)
         regexp->object.shared_hash = vm->shared->regexp_instance_hash;
         regexp->object.__proto__ = &vm->prototypes[NJS_OBJ_TYPE_REGEXP].object;
         regexp->object.slots = NULL;
+        regexp->object.shape = NULL;
         regexp->object.type = NJS_REGEXP;
         regexp->object.shared = 0;
         regexp->object.extensible = 1;
@@ -1078,9 +1079,10 @@ njs_regexp_exec_result(njs_vm_t *vm, njs_regexp_t *regexp, njs_utf8_t utf8,
             size = captures[n + 1] - captures[n];
 
             length = njs_string_calc_length(utf8, start, size);
+            length = (length >= 0) ? length : 0;
 
-            ret = njs_regexp_string_create(vm, &array->start[i], start, size,
-                                           length);
+            ret = njs_string_view(vm, &array->start[i], &regexp->string,
+                                  start, size, length);
             if (njs_slow_path(ret != NJS_OK)) {
                 goto fail;
             }
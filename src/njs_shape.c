@@ -0,0 +1,274 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+#define NJS_SHAPE_KEYS_MIN    8
+#define NJS_SHAPE_VALUES_MIN  4
+
+
+static njs_object_shape_t *njs_shape_transition(njs_vm_t *vm,
+    njs_object_shape_t *shape, const njs_lvlhsh_query_t *lhq,
+    const njs_value_t *name);
+
+
+njs_inline njs_bool_t
+njs_shape_key_eq(const njs_shape_key_t *key, const njs_lvlhsh_query_t *lhq)
+{
+    njs_str_t  str;
+
+    if (key->key_hash != lhq->key_hash) {
+        return 0;
+    }
+
+    njs_string_get(&key->name, &str);
+
+    return (str.length == lhq->key.length
+            && (str.start == lhq->key.start
+                || memcmp(str.start, lhq->key.start, str.length) == 0));
+}
+
+
+njs_inline njs_bool_t
+njs_shape_index_like(const njs_lvlhsh_query_t *lhq)
+{
+    /* Array-like objects are left to the dictionary mode. */
+
+    return (lhq->key.length != 0
+            && lhq->key.start[0] >= '0' && lhq->key.start[0] <= '9');
+}
+
+
+njs_inline uint32_t
+njs_shape_values_size(uint32_t nslots)
+{
+    uint32_t  size;
+
+    size = NJS_SHAPE_VALUES_MIN;
+
+    while (size < nslots) {
+        size *= 2;
+    }
+
+    return size;
+}
+
+
+njs_int_t
+njs_shape_find(const njs_object_shape_t *shape, const njs_lvlhsh_query_t *lhq)
+{
+    uint32_t               n;
+    const njs_shape_key_t  *keys;
+
+    n = shape->nslots;
+
+    if (n == 0 || lhq->key.start == NULL) {
+        /* Symbol keys are stored only in the dictionary mode. */
+        return NJS_DECLINED;
+    }
+
+    keys = shape->keys->start;
+
+    while (n != 0) {
+        n--;
+
+        if (njs_shape_key_eq(&keys[n], lhq)) {
+            return n;
+        }
+    }
+
+    return NJS_DECLINED;
+}
+
+
+/*
+ * The property must be absent in the object.  NJS_DECLINED is returned
+ * if the object has been switched to the dictionary mode and the property
+ * should be added to the object hash.
+ */
+
+njs_int_t
+njs_shape_add(njs_vm_t *vm, njs_object_t *object, njs_lvlhsh_query_t *lhq,
+    const njs_value_t *name, const njs_value_t *value)
+{
+    uint32_t            n;
+    njs_int_t           ret;
+    njs_value_t         *values;
+    njs_object_shape_t  *shape;
+
+    n = object->shape->nslots;
+
+    if (njs_slow_path(!njs_is_string(name)
+                      || n == NJS_SHAPE_MAX_SLOTS
+                      || njs_shape_index_like(lhq)))
+    {
+        ret = njs_shape_dictionary(vm, object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        return NJS_DECLINED;
+    }
+
+    shape = njs_shape_transition(vm, object->shape, lhq, name);
+    if (njs_slow_path(shape == NULL)) {
+        return NJS_ERROR;
+    }
+
+    if (n == 0 || n == njs_shape_values_size(n)) {
+        values = njs_mp_align(vm->mem_pool, sizeof(njs_value_t),
+                              njs_shape_values_size(n + 1)
+                              * sizeof(njs_value_t));
+        if (njs_slow_path(values == NULL)) {
+            njs_memory_error(vm);
+            return NJS_ERROR;
+        }
+
+        if (n != 0) {
+            memcpy(values, object->values, n * sizeof(njs_value_t));
+            njs_mp_free(vm->mem_pool, object->values);
+        }
+
+        object->values = values;
+    }
+
+    /* GC: retain. */
+    object->values[n] = *value;
+    object->shape = shape;
+
+    return NJS_OK;
+}
+
+
+njs_int_t
+njs_shape_property_init(njs_vm_t *vm, njs_object_t *object,
+    njs_lvlhsh_query_t *lhq, const njs_value_t *name, const njs_value_t *value)
+{
+    njs_int_t  slot;
+
+    slot = njs_shape_find(object->shape, lhq);
+
+    if (slot != NJS_DECLINED) {
+        /* GC: release old value, retain new value. */
+        object->values[slot] = *value;
+        return NJS_OK;
+    }
+
+    return njs_shape_add(vm, object, lhq, name, value);
+}
+
+
+njs_int_t
+njs_shape_dictionary(njs_vm_t *vm, njs_object_t *object)
+{
+    uint32_t            n;
+    njs_int_t           ret;
+    njs_shape_key_t     *key;
+    njs_object_prop_t   *prop;
+    njs_lvlhsh_query_t  lhq;
+
+    lhq.replace = 0;
+    lhq.proto = &njs_object_hash_proto;
+    lhq.pool = vm->mem_pool;
+
+    for (n = 0; n < object->shape->nslots; n++) {
+        key = njs_shape_slot_key(object->shape, n);
+
+        prop = njs_object_prop_alloc(vm, &key->name, &object->values[n], 1);
+        if (njs_slow_path(prop == NULL)) {
+            return NJS_ERROR;
+        }
+
+        njs_object_property_key_set(&lhq, &key->name, key->key_hash);
+        lhq.value = prop;
+
+        ret = njs_lvlhsh_insert(&object->hash, &lhq);
+        if (njs_slow_path(ret != NJS_OK)) {
+            njs_internal_error(vm, "lvlhsh insert failed");
+            return NJS_ERROR;
+        }
+    }
+
+    if (object->shape->nslots != 0) {
+        njs_mp_free(vm->mem_pool, object->values);
+    }
+
+    object->shape = NULL;
+    object->values = NULL;
+
+    return NJS_OK;
+}
+
+
+static njs_object_shape_t *
+njs_shape_transition(njs_vm_t *vm, njs_object_shape_t *shape,
+    const njs_lvlhsh_query_t *lhq, const njs_value_t *name)
+{
+    uint32_t            n, size;
+    njs_shape_key_t     *key;
+    njs_shape_keys_t    *keys;
+    njs_object_shape_t  *next;
+
+    n = shape->nslots;
+
+    for (next = shape->child; next != NULL; next = next->next) {
+        if (njs_shape_key_eq(njs_shape_slot_key(next, n), lhq)) {
+            return next;
+        }
+    }
+
+    next = njs_mp_alloc(vm->mem_pool, sizeof(njs_object_shape_t));
+    if (njs_slow_path(next == NULL)) {
+        goto memory_error;
+    }
+
+    keys = shape->keys;
+
+    if (keys == NULL || keys->length != n || keys->length == keys->size) {
+        /* The first shape or a branch of the transition tree. */
+
+        size = njs_min(njs_max(2 * n, NJS_SHAPE_KEYS_MIN), NJS_SHAPE_MAX_SLOTS);
+
+        keys = njs_mp_align(vm->mem_pool, sizeof(njs_value_t),
+                            sizeof(njs_shape_keys_t)
+                            + size * sizeof(njs_shape_key_t));
+        if (njs_slow_path(keys == NULL)) {
+            goto memory_error;
+        }
+
+        if (n != 0) {
+            memcpy(keys->start, shape->keys->start,
+                   n * sizeof(njs_shape_key_t));
+        }
+
+        keys->length = n;
+        keys->size = size;
+    }
+
+    key = &keys->start[keys->length++];
+
+    /* GC: retain. */
+    key->name = *name;
+    key->key_hash = lhq->key_hash;
+
+    njs_string_atom(vm, &key->name);
+
+    next->child = NULL;
+    next->next = shape->child;
+    next->keys = keys;
+    next->nslots = n + 1;
+
+    shape->child = next;
+
+    return next;
+
+memory_error:
+
+    njs_memory_error(vm);
+
+    return NULL;
+}
@@ -0,0 +1,66 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_SHAPE_H_INCLUDED_
+#define _NJS_SHAPE_H_INCLUDED_
+
+
+/*
+ * A shape describes the layout of own properties of an ordinary object.
+ * Objects which got the same properties in the same order share a shape
+ * and keep property values in a flat array indexed by a shape slot.
+ *
+ * Shapes describe only writable, enumerable and configurable data
+ * properties with string keys.  Any other property, a property deletion
+ * or an attribute change switch the object to the dictionary mode, where
+ * object->shape is NULL and the properties are stored in object->hash.
+ */
+
+#define NJS_SHAPE_MAX_SLOTS  64
+
+
+typedef struct {
+    njs_value_t                name;
+    uint32_t                   key_hash;
+} njs_shape_key_t;
+
+
+typedef struct {
+    /* Keys are shared by a chain of transitions while it is linear. */
+    uint32_t                   length;
+    uint32_t                   size;
+    njs_shape_key_t            start[];
+} njs_shape_keys_t;
+
+
+struct njs_object_shape_s {
+    /* A list of transitions to the shapes with one more property. */
+    njs_object_shape_t         *child;
+    njs_object_shape_t         *next;
+
+    njs_shape_keys_t           *keys;
+    uint32_t                   nslots;
+};
+
+
+njs_int_t njs_shape_find(const njs_object_shape_t *shape,
+    const njs_lvlhsh_query_t *lhq);
+njs_int_t njs_shape_add(njs_vm_t *vm, njs_object_t *object,
+    njs_lvlhsh_query_t *lhq, const njs_value_t *name,
+    const njs_value_t *value);
+njs_int_t njs_shape_property_init(njs_vm_t *vm, njs_object_t *object,
+    njs_lvlhsh_query_t *lhq, const njs_value_t *name,
+    const njs_value_t *value);
+njs_int_t njs_shape_dictionary(njs_vm_t *vm, njs_object_t *object);
+
+
+njs_inline njs_shape_key_t *
+njs_shape_slot_key(const njs_object_shape_t *shape, uint32_t slot)
+{
+    return &shape->keys->start[slot];
+}
+
+
+#endif /* _NJS_SHAPE_H_INCLUDED_ */
@@ -29,6 +29,7 @@ typedef struct {
     uint8_t                 denormals;
     uint8_t                 interactive;
     uint8_t                 module;
+    uint8_t                 profile;
     uint8_t                 quiet;
     uint8_t                 silent;
     uint8_t                 sandbox;
@@ -80,6 +81,8 @@ typedef struct {
     njs_lvlhsh_t            labels;  /* njs_timelabel_t */
 
     njs_completion_t        completion;
+
+    njs_profiler_t          *profiler;
 } njs_console_t;
 
 
@@ -88,6 +91,9 @@ static njs_int_t njs_externals_init(njs_vm_t *vm, njs_console_t *console);
 static njs_vm_t *njs_create_vm(njs_opts_t *opts, njs_vm_opt_t *vm_options);
 static njs_int_t njs_process_script(njs_opts_t *opts,
     njs_console_t *console, const njs_str_t *script);
+static njs_int_t njs_profile_start(njs_vm_t *vm, njs_console_t *console);
+static void njs_profile_report(njs_console_t *console);
+static void njs_profile_handler(int signo);
 
 #ifndef NJS_FUZZER_TARGET
 
@@ -284,6 +290,10 @@ main(int argc, char **argv)
         ret = njs_process_file(&opts, &vm_options);
     }
 
+    if (njs_console.profiler != NULL) {
+        njs_profile_report(&njs_console);
+    }
+
 done:
 
     if (opts.paths != NULL) {
@@ -309,6 +319,7 @@ njs_get_options(njs_opts_t *opts, int argc, char **argv)
         "Options:\n"
         "  -c                specify the command to execute.\n"
         "  -d                print disassembled code.\n"
+        "  --profile         print sampled stacks of functions to stderr.\n"
         "  -f                disabled denormals mode.\n"
         "  -p                set path prefix for modules.\n"
         "  -q                disable interactive introduction prompt.\n"
@@ -415,6 +426,14 @@ njs_get_options(njs_opts_t *opts, int argc, char **argv)
             opts->safe = 1;
             break;
 
+        case '-':
+            if (strcmp(p, "-profile") == 0) {
+                opts->profile = 1;
+                break;
+            }
+
+            /* Fall through. */
+
         default:
             njs_stderror("Unknown argument: \"%s\" "
                          "try \"%s -h\" for available options\n", argv[i],
@@ -722,6 +741,13 @@ njs_create_vm(njs_opts_t *opts, njs_vm_opt_t *vm_options)
         return NULL;
     }
 
+    if (opts->profile) {
+        if (njs_profile_start(vm, vm_options->external) != NJS_OK) {
+            njs_stderror("failed to start profiler\n");
+            return NULL;
+        }
+    }
+
     for (i = 0; i < opts->n_paths; i++) {
         path.start = (u_char *) opts->paths[i];
         path.length = njs_strlen(opts->paths[i]);
@@ -761,6 +787,73 @@ njs_create_vm(njs_opts_t *opts, njs_vm_opt_t *vm_options)
 }
 
 
+static njs_int_t
+njs_profile_start(njs_vm_t *vm, njs_console_t *console)
+{
+    struct sigaction  sa;
+    struct itimerval  itv;
+
+    if (console->profiler == NULL) {
+        console->profiler = njs_profiler_create();
+        if (console->profiler == NULL) {
+            return NJS_ERROR;
+        }
+
+        njs_memzero(&sa, sizeof(struct sigaction));
+        sa.sa_handler = njs_profile_handler;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+
+        if (sigaction(SIGPROF, &sa, NULL) == -1) {
+            return NJS_ERROR;
+        }
+
+        /* 1000 samples per second of CPU time. */
+
+        itv.it_interval.tv_sec = 0;
+        itv.it_interval.tv_usec = 1000;
+        itv.it_value = itv.it_interval;
+
+        if (setitimer(ITIMER_PROF, &itv, NULL) == -1) {
+            return NJS_ERROR;
+        }
+    }
+
+    njs_vm_set_profiler(vm, console->profiler);
+
+    return NJS_OK;
+}
+
+
+static void
+njs_profile_report(njs_console_t *console)
+{
+    njs_str_t         report;
+    struct itimerval  itv;
+
+    njs_memzero(&itv, sizeof(struct itimerval));
+
+    (void) setitimer(ITIMER_PROF, &itv, NULL);
+
+    if (njs_profiler_report(console->profiler, &report) != NJS_OK) {
+        njs_stderror("failed to get profiler report\n");
+
+    } else {
+        (void) write(STDERR_FILENO, report.start, report.length);
+    }
+
+    njs_profiler_destroy(console->profiler);
+    console->profiler = NULL;
+}
+
+
+static void
+njs_profile_handler(int signo)
+{
+    njs_profiler_tick();
+}
+
+
 static void
 njs_output(njs_opts_t *opts, njs_vm_t *vm, njs_int_t ret)
 {
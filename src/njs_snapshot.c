@@ -0,0 +1,640 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+#define NJS_SNAPSHOT_MAX_DEPTH  512
+
+
+typedef struct {
+    njs_vm_t                  *vm;
+    njs_vm_t                  *snapshot;
+
+    /* Snapshot objects and closures to their copies. */
+    njs_lvlhsh_t              copies;
+
+    njs_uint_t                depth;
+} njs_snapshot_t;
+
+
+typedef struct {
+    void                      *orig;
+    void                      *copy;
+} njs_snapshot_copy_t;
+
+
+static njs_int_t njs_snapshot_value(njs_snapshot_t *ss, njs_value_t *dst,
+    const njs_value_t *src);
+static njs_int_t njs_snapshot_object(njs_snapshot_t *ss, njs_object_t **dst,
+    njs_object_t *object);
+static njs_int_t njs_snapshot_object_copy(njs_snapshot_t *ss,
+    njs_object_t *copy, njs_object_t *object);
+static njs_int_t njs_snapshot_builtin(njs_snapshot_t *ss, njs_object_t *dst,
+    njs_object_t *object);
+static njs_int_t njs_snapshot_hash(njs_snapshot_t *ss, njs_lvlhsh_t *dst,
+    const njs_lvlhsh_t *src);
+static njs_int_t njs_snapshot_shape(njs_snapshot_t *ss, njs_object_t *copy,
+    njs_object_t *object);
+static njs_int_t njs_snapshot_map(njs_snapshot_t *ss, njs_map_t *copy,
+    njs_map_t *map);
+static njs_int_t njs_snapshot_closure(njs_snapshot_t *ss, njs_closure_t **dst,
+    njs_closure_t *closure);
+static void *njs_snapshot_find(njs_snapshot_t *ss, void *orig);
+static njs_int_t njs_snapshot_insert(njs_snapshot_t *ss, void *orig,
+    void *copy);
+static njs_int_t njs_snapshot_copy_test(njs_lvlhsh_query_t *lhq, void *data);
+
+
+static const njs_lvlhsh_proto_t  njs_snapshot_copies_proto
+    njs_aligned(64) =
+{
+    NJS_LVLHSH_DEFAULT,
+    njs_snapshot_copy_test,
+    njs_lvlhsh_alloc,
+    njs_lvlhsh_free,
+};
+
+
+njs_int_t
+njs_snapshot_restore(njs_vm_t *vm, njs_vm_t *snapshot)
+{
+    njs_int_t       ret;
+    njs_uint_t      i, n;
+    njs_value_t     *src, *dst;
+    njs_snapshot_t  ss;
+
+    ss.vm = vm;
+    ss.snapshot = snapshot;
+    ss.depth = 0;
+
+    njs_lvlhsh_init(&ss.copies);
+
+    src = (njs_value_t *) ((u_char *) snapshot->scopes[NJS_SCOPE_GLOBAL]
+                           + NJS_INDEX_GLOBAL_OFFSET);
+    dst = (njs_value_t *) ((u_char *) vm->scopes[NJS_SCOPE_GLOBAL]
+                           + NJS_INDEX_GLOBAL_OFFSET);
+
+    n = snapshot->scope_size / sizeof(njs_value_t);
+
+    for (i = 0; i < n; i++) {
+        ret = njs_snapshot_value(&ss, &dst[i], &src[i]);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    ret = njs_snapshot_builtin(&ss, &vm->global_object,
+                               &snapshot->global_object);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    for (i = 0; i < NJS_OBJ_TYPE_MAX; i++) {
+        ret = njs_snapshot_builtin(&ss, &vm->prototypes[i].object,
+                                   &snapshot->prototypes[i].object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_snapshot_builtin(&ss, &vm->constructors[i].object,
+                                   &snapshot->constructors[i].object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    vm->symbol_generator = snapshot->symbol_generator;
+
+    return njs_snapshot_value(&ss, &vm->retval, &snapshot->retval);
+}
+
+
+static njs_int_t
+njs_snapshot_value(njs_snapshot_t *ss, njs_value_t *dst,
+    const njs_value_t *src)
+{
+    *dst = *src;
+
+    if (!njs_is_object(src)) {
+        /* Primitive values are immutable or refer to immutable data. */
+
+        return (src->type != NJS_DATA) ? NJS_OK : NJS_DECLINED;
+    }
+
+    return njs_snapshot_object(ss, &dst->data.u.object, njs_object(src));
+}
+
+
+static njs_int_t
+njs_snapshot_object(njs_snapshot_t *ss, njs_object_t **dst,
+    njs_object_t *object)
+{
+    size_t          size;
+    u_char          *p;
+    njs_int_t       ret;
+    njs_object_t    *copy;
+    njs_function_t  *function;
+
+    if (object == NULL || object->shared) {
+        *dst = object;
+        return NJS_OK;
+    }
+
+    p = (u_char *) object;
+
+    if (p >= (u_char *) ss->snapshot && p < (u_char *) (ss->snapshot + 1)) {
+        /* Built-in prototypes, constructors and the global object. */
+
+        *dst = (njs_object_t *) ((u_char *) ss->vm
+                                 + (p - (u_char *) ss->snapshot));
+        return NJS_OK;
+    }
+
+    copy = njs_snapshot_find(ss, object);
+
+    if (copy != NULL) {
+        *dst = copy;
+        return NJS_OK;
+    }
+
+    if (njs_slow_path(object->slots != NULL
+                      || ss->depth == NJS_SNAPSHOT_MAX_DEPTH))
+    {
+        return NJS_DECLINED;
+    }
+
+    switch (object->type) {
+    case NJS_OBJECT:
+        size = sizeof(njs_object_t);
+        break;
+
+    case NJS_ARRAY:
+        size = sizeof(njs_array_t);
+        break;
+
+    case NJS_OBJECT_BOOLEAN:
+    case NJS_OBJECT_NUMBER:
+    case NJS_OBJECT_SYMBOL:
+    case NJS_OBJECT_STRING:
+        size = sizeof(njs_object_value_t);
+        break;
+
+    case NJS_FUNCTION:
+        function = (njs_function_t *) object;
+
+        if (function->bound != NULL
+            || (!function->native && function->u.lambda->nesting != 0
+                && !function->closure))
+        {
+            return NJS_DECLINED;
+        }
+
+        size = sizeof(njs_function_t);
+
+        if (function->closure) {
+            size += function->u.lambda->nesting * sizeof(njs_closure_t *);
+        }
+
+        break;
+
+    case NJS_REGEXP:
+        size = sizeof(njs_regexp_t);
+        break;
+
+    case NJS_DATE:
+        size = sizeof(njs_date_t);
+        break;
+
+    case NJS_MAP:
+    case NJS_SET:
+        size = sizeof(njs_map_t);
+        break;
+
+    default:
+        return NJS_DECLINED;
+    }
+
+    copy = njs_mp_align(ss->vm->mem_pool, sizeof(njs_value_t), size);
+    if (njs_slow_path(copy == NULL)) {
+        njs_memory_error(ss->vm);
+        return NJS_ERROR;
+    }
+
+    memcpy(copy, object, size);
+
+    ret = njs_snapshot_insert(ss, object, copy);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    *dst = copy;
+
+    ss->depth++;
+
+    ret = njs_snapshot_object_copy(ss, copy, object);
+
+    ss->depth--;
+
+    return ret;
+}
+
+
+static njs_int_t
+njs_snapshot_object_copy(njs_snapshot_t *ss, njs_object_t *copy,
+    njs_object_t *object)
+{
+    uint32_t        i, size;
+    njs_int_t       ret;
+    njs_array_t     *array, *array_copy;
+    njs_value_t     *start;
+    njs_regexp_t    *regexp;
+    njs_closure_t   **closures;
+    njs_function_t  *function;
+
+    ret = njs_snapshot_object(ss, &copy->__proto__, object->__proto__);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    njs_lvlhsh_init(&copy->hash);
+
+    ret = njs_snapshot_hash(ss, &copy->hash, &object->hash);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    if (object->shape != NULL) {
+        ret = njs_snapshot_shape(ss, copy, object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    switch (object->type) {
+    case NJS_ARRAY:
+        array = (njs_array_t *) object;
+        array_copy = (njs_array_t *) copy;
+
+        if (!object->fast_array) {
+            array_copy->size = 0;
+            array_copy->start = NULL;
+            array_copy->data = NULL;
+            break;
+        }
+
+        size = njs_max(array->length, 1);
+
+        start = njs_mp_align(ss->vm->mem_pool, sizeof(njs_value_t),
+                             size * sizeof(njs_value_t));
+        if (njs_slow_path(start == NULL)) {
+            njs_memory_error(ss->vm);
+            return NJS_ERROR;
+        }
+
+        array_copy->size = size;
+        array_copy->start = start;
+        array_copy->data = start;
+
+        for (i = 0; i < array->length; i++) {
+            ret = njs_snapshot_value(ss, &start[i], &array->start[i]);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+        }
+
+        break;
+
+    case NJS_FUNCTION:
+        function = (njs_function_t *) object;
+
+        if (!function->closure) {
+            break;
+        }
+
+        closures = njs_function_closures((njs_function_t *) copy);
+
+        for (i = 0; i < function->u.lambda->nesting; i++) {
+            ret = njs_snapshot_closure(ss, &closures[i],
+                                       njs_function_closures(function)[i]);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+        }
+
+        break;
+
+    case NJS_REGEXP:
+        regexp = (njs_regexp_t *) object;
+
+        /* The pattern is shared. */
+
+        return njs_snapshot_value(ss, &((njs_regexp_t *) copy)->last_index,
+                                  &regexp->last_index);
+
+    case NJS_MAP:
+    case NJS_SET:
+        return njs_snapshot_map(ss, (njs_map_t *) copy, (njs_map_t *) object);
+
+    default:
+        break;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_snapshot_builtin(njs_snapshot_t *ss, njs_object_t *dst,
+    njs_object_t *object)
+{
+    njs_int_t  ret;
+
+    ret = njs_snapshot_object(ss, &dst->__proto__, object->__proto__);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    dst->extensible = object->extensible;
+
+    njs_lvlhsh_init(&dst->hash);
+
+    return njs_snapshot_hash(ss, &dst->hash, &object->hash);
+}
+
+
+static njs_int_t
+njs_snapshot_hash(njs_snapshot_t *ss, njs_lvlhsh_t *dst,
+    const njs_lvlhsh_t *src)
+{
+    njs_int_t           ret;
+    njs_object_prop_t   *prop, *copy;
+    njs_lvlhsh_each_t   lhe;
+    njs_lvlhsh_query_t  lhq;
+
+    njs_lvlhsh_each_init(&lhe, &njs_object_hash_proto);
+
+    lhq.replace = 0;
+    lhq.proto = &njs_object_hash_proto;
+    lhq.pool = ss->vm->mem_pool;
+
+    for ( ;; ) {
+        prop = njs_lvlhsh_each(src, &lhe);
+
+        if (prop == NULL) {
+            return NJS_OK;
+        }
+
+        if (prop->type == NJS_WHITEOUT) {
+            continue;
+        }
+
+        copy = njs_mp_align(ss->vm->mem_pool, sizeof(njs_value_t),
+                            sizeof(njs_object_prop_t));
+        if (njs_slow_path(copy == NULL)) {
+            njs_memory_error(ss->vm);
+            return NJS_ERROR;
+        }
+
+        *copy = *prop;
+
+        if (prop->type != NJS_PROPERTY_HANDLER) {
+            ret = njs_snapshot_value(ss, &copy->value, &prop->value);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return ret;
+            }
+        }
+
+        ret = njs_snapshot_value(ss, &copy->getter, &prop->getter);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_snapshot_value(ss, &copy->setter, &prop->setter);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_object_property_key_set(&lhq, &prop->name, 0);
+        lhq.value = copy;
+
+        ret = njs_lvlhsh_insert(dst, &lhq);
+        if (njs_slow_path(ret != NJS_OK)) {
+            njs_internal_error(ss->vm, "lvlhsh insert failed");
+            return NJS_ERROR;
+        }
+    }
+}
+
+
+static njs_int_t
+njs_snapshot_shape(njs_snapshot_t *ss, njs_object_t *copy,
+    njs_object_t *object)
+{
+    uint32_t            n;
+    njs_int_t           ret;
+    njs_value_t         value;
+    njs_shape_key_t     *key;
+    njs_lvlhsh_query_t  lhq;
+
+    /* The shape is rebuilt from the shape root of the VM. */
+
+    copy->shape = ss->vm->shape_root;
+    copy->values = NULL;
+
+    for (n = 0; n < object->shape->nslots; n++) {
+        key = njs_shape_slot_key(object->shape, n);
+
+        ret = njs_snapshot_value(ss, &value, &object->values[n]);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        njs_object_property_key_set(&lhq, &key->name, key->key_hash);
+
+        ret = njs_shape_add(ss->vm, copy, &lhq, &key->name, &value);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NJS_ERROR;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_snapshot_map(njs_snapshot_t *ss, njs_map_t *copy, njs_map_t *map)
+{
+    uint32_t         n;
+    njs_int_t        ret;
+    njs_value_t      key, value;
+    njs_map_table_t  *table;
+
+    /* The table is rebuilt because object keys are hashed by address. */
+
+    copy->table = NULL;
+    copy->walkers = 0;
+    copy->iterated = 0;
+
+    table = map->table;
+
+    if (table == NULL) {
+        return NJS_OK;
+    }
+
+    for (n = 0; n < table->used; n++) {
+        if (!njs_is_valid(&table->entries[n].key)) {
+            continue;
+        }
+
+        ret = njs_snapshot_value(ss, &key, &table->entries[n].key);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_snapshot_value(ss, &value, &table->entries[n].value);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_map_insert(ss->vm, copy, &key, &value);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_snapshot_closure(njs_snapshot_t *ss, njs_closure_t **dst,
+    njs_closure_t *closure)
+{
+    uint32_t       i, n;
+    njs_int_t      ret;
+    njs_closure_t  *copy;
+
+    if (closure == NULL) {
+        *dst = NULL;
+        return NJS_OK;
+    }
+
+    copy = njs_snapshot_find(ss, closure);
+
+    if (copy != NULL) {
+        *dst = copy;
+        return NJS_OK;
+    }
+
+    if (njs_slow_path(ss->depth == NJS_SNAPSHOT_MAX_DEPTH)) {
+        return NJS_DECLINED;
+    }
+
+    /* See njs_function_lambda_call(). */
+    n = closure->u.count;
+
+    copy = njs_mp_align(ss->vm->mem_pool, sizeof(njs_value_t),
+                        (1 + n) * sizeof(njs_value_t));
+    if (njs_slow_path(copy == NULL)) {
+        njs_memory_error(ss->vm);
+        return NJS_ERROR;
+    }
+
+    copy->u.count = n;
+
+    ret = njs_snapshot_insert(ss, closure, copy);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    *dst = copy;
+
+    ret = NJS_OK;
+
+    ss->depth++;
+
+    for (i = 0; i < n; i++) {
+        ret = njs_snapshot_value(ss, &copy->values[i], &closure->values[i]);
+        if (njs_slow_path(ret != NJS_OK)) {
+            break;
+        }
+    }
+
+    ss->depth--;
+
+    return ret;
+}
+
+
+static void *
+njs_snapshot_find(njs_snapshot_t *ss, void *orig)
+{
+    njs_snapshot_copy_t  *copy;
+    njs_lvlhsh_query_t   lhq;
+
+    lhq.key.length = sizeof(void *);
+    lhq.key.start = (u_char *) &orig;
+    lhq.key_hash = njs_djb_hash(&orig, sizeof(void *));
+    lhq.proto = &njs_snapshot_copies_proto;
+
+    if (njs_lvlhsh_find(&ss->copies, &lhq) != NJS_OK) {
+        return NULL;
+    }
+
+    copy = lhq.value;
+
+    return copy->copy;
+}
+
+
+static njs_int_t
+njs_snapshot_insert(njs_snapshot_t *ss, void *orig, void *copy)
+{
+    njs_int_t            ret;
+    njs_snapshot_copy_t  *entry;
+    njs_lvlhsh_query_t   lhq;
+
+    entry = njs_mp_alloc(ss->vm->mem_pool, sizeof(njs_snapshot_copy_t));
+    if (njs_slow_path(entry == NULL)) {
+        njs_memory_error(ss->vm);
+        return NJS_ERROR;
+    }
+
+    entry->orig = orig;
+    entry->copy = copy;
+
+    lhq.key.length = sizeof(void *);
+    lhq.key.start = (u_char *) &entry->orig;
+    lhq.key_hash = njs_djb_hash(&orig, sizeof(void *));
+    lhq.replace = 0;
+    lhq.value = entry;
+    lhq.proto = &njs_snapshot_copies_proto;
+    lhq.pool = ss->vm->mem_pool;
+
+    ret = njs_lvlhsh_insert(&ss->copies, &lhq);
+    if (njs_slow_path(ret != NJS_OK)) {
+        njs_internal_error(ss->vm, "lvlhsh insert failed");
+        return NJS_ERROR;
+    }
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_snapshot_copy_test(njs_lvlhsh_query_t *lhq, void *data)
+{
+    njs_snapshot_copy_t  *copy;
+
+    copy = data;
+
+    if (*(void **) lhq->key.start == copy->orig) {
+        return NJS_OK;
+    }
+
+    return NJS_DECLINED;
+}
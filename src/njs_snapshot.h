@@ -0,0 +1,28 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+#ifndef _NJS_SNAPSHOT_H_INCLUDED_
+#define _NJS_SNAPSHOT_H_INCLUDED_
+
+
+/*
+ * A snapshot is a VM which has already run the global code once.
+ * A clone of a VM with a snapshot does not run the global code again,
+ * instead the values of global variables and the own properties added to
+ * the built-in objects are copied from the snapshot VM heap to the clone
+ * heap.  The copy preserves object identity and cycles.
+ *
+ * Strings, regexp patterns and function lambdas are immutable and are
+ * shared with the snapshot.  Shared built-in objects are not copied.
+ * NJS_DECLINED is returned if the heap contains a value which cannot be
+ * copied: a promise, a Map or Set iterator, an external or a binary
+ * object, a closure not created by njs_function_lambda_call() or a too
+ * deep object graph.
+ */
+
+njs_int_t njs_snapshot_restore(njs_vm_t *vm, njs_vm_t *snapshot);
+
+
+#endif /* _NJS_SNAPSHOT_H_INCLUDED_ */
@@ -0,0 +1,179 @@
+
+/*
+ * Copyright (C) NGINX, Inc.
+ */
+
+
+#include <njs_main.h>
+
+
+/*
+ * Short needles are found with memchr() on the first byte, which is
+ * vectorized by libc, and memcmp() on the rest.  Longer needles in
+ * longer haystacks use Boyer-Moore-Horspool, the cost of the shift
+ * table is only paid when it can be amortized.
+ */
+
+#define NJS_STR_SEARCH_BMH_NEEDLE    8
+#define NJS_STR_SEARCH_BMH_HAYSTACK  256
+
+
+static u_char *njs_str_search_bmh(const u_char *start, const u_char *last,
+    const u_char *needle, size_t size);
+static u_char *njs_str_rsearch_bmh(const u_char *start, const u_char *last,
+    const u_char *needle, size_t size);
+
+
+u_char *
+njs_str_search(const u_char *start, const u_char *end, const u_char *needle,
+    size_t size)
+{
+    u_char        c;
+    const u_char  *p, *last;
+
+    if (size == 0) {
+        return (u_char *) start;
+    }
+
+    if ((size_t) (end - start) < size) {
+        return NULL;
+    }
+
+    last = end - size;
+
+    if (size >= NJS_STR_SEARCH_BMH_NEEDLE
+        && (size_t) (end - start) >= NJS_STR_SEARCH_BMH_HAYSTACK)
+    {
+        return njs_str_search_bmh(start, last, needle, size);
+    }
+
+    c = needle[0];
+    needle++;
+    size--;
+
+    p = start;
+
+    while (p <= last) {
+        p = memchr(p, c, last - p + 1);
+        if (p == NULL) {
+            return NULL;
+        }
+
+        if (memcmp(p + 1, needle, size) == 0) {
+            return (u_char *) p;
+        }
+
+        p++;
+    }
+
+    return NULL;
+}
+
+
+u_char *
+njs_str_rsearch(const u_char *start, const u_char *end, const u_char *needle,
+    size_t size)
+{
+    u_char        c;
+    const u_char  *p;
+
+    if (size == 0) {
+        return (u_char *) end;
+    }
+
+    if ((size_t) (end - start) < size) {
+        return NULL;
+    }
+
+    p = end - size;
+
+    if (size >= NJS_STR_SEARCH_BMH_NEEDLE
+        && (size_t) (end - start) >= NJS_STR_SEARCH_BMH_HAYSTACK)
+    {
+        return njs_str_rsearch_bmh(start, p, needle, size);
+    }
+
+    c = needle[0];
+
+    for ( ;; ) {
+        if (*p == c && memcmp(p + 1, needle + 1, size - 1) == 0) {
+            return (u_char *) p;
+        }
+
+        if (p == start) {
+            return NULL;
+        }
+
+        p--;
+    }
+}
+
+
+static u_char *
+njs_str_search_bmh(const u_char *start, const u_char *last,
+    const u_char *needle, size_t size)
+{
+    u_char        c, tail;
+    size_t        i, shift[256];
+    const u_char  *p;
+
+    for (i = 0; i < 256; i++) {
+        shift[i] = size;
+    }
+
+    for (i = 0; i < size - 1; i++) {
+        shift[needle[i]] = size - 1 - i;
+    }
+
+    tail = needle[size - 1];
+
+    p = start;
+
+    while (p <= last) {
+        c = p[size - 1];
+
+        if (c == tail && memcmp(p, needle, size - 1) == 0) {
+            return (u_char *) p;
+        }
+
+        p += shift[c];
+    }
+
+    return NULL;
+}
+
+
+static u_char *
+njs_str_rsearch_bmh(const u_char *start, const u_char *last,
+    const u_char *needle, size_t size)
+{
+    u_char        c, head;
+    size_t        i, shift[256];
+    const u_char  *p;
+
+    for (i = 0; i < 256; i++) {
+        shift[i] = size;
+    }
+
+    for (i = size - 1; i > 0; i--) {
+        shift[needle[i]] = i;
+    }
+
+    head = needle[0];
+
+    p = last;
+
+    for ( ;; ) {
+        c = *p;
+
+        if (c == head && memcmp(p + 1, needle + 1, size - 1) == 0) {
+            return (u_char *) p;
+        }
+
+        if ((size_t) (p - start) < shift[c]) {
+            return NULL;
+        }
+
+        p -= shift[c];
+    }
+}
@@ -134,4 +134,10 @@ njs_strstr_eq(s1, s2)                                                         \
      && (memcmp((s1)->start, (s2)->start, (s1)->length) == 0))
 
 
+u_char *njs_str_search(const u_char *start, const u_char *end,
+    const u_char *needle, size_t size);
+u_char *njs_str_rsearch(const u_char *start, const u_char *end,
+    const u_char *needle, size_t size);
+
+
 #endif /* _NJS_STR_H_INCLUDED_ */
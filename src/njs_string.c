@@ -54,6 +54,8 @@ static void njs_encode_base64_core(njs_str_t *dst, const njs_str_t *src,
     const u_char *basis, njs_uint_t padding);
 static njs_int_t njs_decode_base64_core(njs_vm_t *vm,
     njs_value_t *value, const njs_str_t *src, const u_char *basis);
+static u_char *njs_string_search(const u_char *start, const u_char *end,
+    const u_char *needle, size_t size);
 static njs_int_t njs_string_slice_prop(njs_vm_t *vm, njs_string_prop_t *string,
     njs_slice_prop_t *slice, njs_value_t *args, njs_uint_t nargs);
 static njs_int_t njs_string_slice_args(njs_vm_t *vm, njs_slice_prop_t *slice,
@@ -71,7 +73,7 @@ static njs_int_t njs_string_bytes_from_string(njs_vm_t *vm,
 static njs_int_t njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
     njs_regexp_pattern_t *pattern);
 static njs_int_t njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array,
-    njs_utf8_t utf8, const u_char *start, size_t size);
+    const njs_value_t *src, njs_utf8_t utf8, const u_char *start, size_t size);
 static njs_int_t njs_string_replace_regexp(njs_vm_t *vm, njs_value_t *this,
     njs_value_t *regex, njs_string_replace_t *r);
 static njs_int_t njs_string_replace_regexp_function(njs_vm_t *vm,
@@ -144,6 +146,10 @@ njs_string_set(njs_vm_t *vm, njs_value_t *value, const u_char *start,
         string->start = (u_char *) start;
         string->length = 0;
         string->retain = 1;
+        string->buffer = 0;
+        string->hashed = 0;
+        string->atom = 0;
+        string->view = 0;
     }
 
     return NJS_OK;
@@ -167,6 +173,157 @@ njs_string_new(njs_vm_t *vm, njs_value_t *value, const u_char *start,
 }
 
 
+/*
+ * Creates a substring of the src string, see njs_string_view_t.
+ * The start and size must be within the src string.
+ */
+
+njs_int_t
+njs_string_view(njs_vm_t *vm, njs_value_t *value, const njs_value_t *src,
+    const u_char *start, uint32_t size, uint32_t length)
+{
+    uint32_t           pinned;
+    njs_string_t       *parent;
+    njs_string_view_t  *view;
+
+    if (size < NJS_STRING_VIEW_MIN
+        || src->short_string.size != NJS_STRING_LONG
+        || (size != length && length > NJS_STRING_MAP_STRIDE))
+    {
+        return njs_string_new(vm, value, start, size, length);
+    }
+
+    parent = src->long_string.data;
+
+    if (size == src->long_string.size && length == parent->length) {
+        /* GC: retain. */
+        *value = *src;
+        return NJS_OK;
+    }
+
+    pinned = parent->view ? ((njs_string_view_t *) parent)->pinned
+                          : src->long_string.size;
+
+    if (pinned / NJS_STRING_VIEW_WASTE > size) {
+        return njs_string_new(vm, value, start, size, length);
+    }
+
+    view = njs_mp_alloc(vm->mem_pool, sizeof(njs_string_view_t));
+    if (njs_slow_path(view == NULL)) {
+        njs_memory_error(vm);
+        return NJS_ERROR;
+    }
+
+    view->string.start = (u_char *) start;
+    view->string.length = length;
+    view->string.retain = 1;
+    view->string.buffer = 0;
+    view->string.hashed = 0;
+    view->string.atom = 0;
+    view->string.view = 1;
+    view->pinned = pinned;
+
+    value->type = NJS_STRING;
+    njs_string_truth(value, size);
+
+    value->short_string.size = NJS_STRING_LONG;
+    value->short_string.length = 0;
+    value->long_string.external = 0;
+    value->long_string.size = size;
+    value->long_string.data = &view->string;
+
+    return NJS_OK;
+}
+
+
+/*
+ * Concatenates the src string and the append string, see
+ * njs_string_buffer_t.  The length is the UTF-8 length of the result,
+ * it should be either zero or equal to the result size.
+ */
+
+njs_int_t
+njs_string_append(njs_vm_t *vm, njs_value_t *value, const njs_value_t *src,
+    const njs_string_prop_t *append, size_t length)
+{
+    u_char               *p, *end;
+    uint64_t             size, total;
+    njs_string_t         *string;
+    njs_string_prop_t    prefix;
+    njs_string_buffer_t  *buffer;
+
+    (void) njs_string_prop(&prefix, src);
+
+    size = prefix.size + append->size;
+
+    if (njs_slow_path(size > NJS_STRING_MAX_LENGTH)) {
+        njs_range_error(vm, "invalid string length");
+        return NJS_ERROR;
+    }
+
+    total = size;
+
+    if (src->short_string.size == NJS_STRING_LONG
+        && src->long_string.data->buffer)
+    {
+        buffer = njs_string_buffer(src->long_string.data);
+        end = prefix.start + prefix.size;
+
+        if (buffer->end == end && append->size <= (size_t) (buffer->last - end))
+        {
+            string = njs_mp_alloc(vm->mem_pool, sizeof(njs_string_t));
+            if (njs_slow_path(string == NULL)) {
+                njs_memory_error(vm);
+                return NJS_ERROR;
+            }
+
+            buffer->end = njs_cpymem(end, append->start, append->size);
+
+            string->start = prefix.start;
+            goto done;
+        }
+
+        total = njs_min(size * 2, NJS_STRING_MAX_LENGTH);
+    }
+
+    string = njs_mp_alloc(vm->mem_pool, sizeof(njs_string_t)
+                                        + sizeof(njs_string_buffer_t) + total);
+    if (njs_slow_path(string == NULL)) {
+        njs_memory_error(vm);
+        return NJS_ERROR;
+    }
+
+    buffer = (njs_string_buffer_t *) ((u_char *) string + sizeof(njs_string_t));
+
+    string->start = (u_char *) buffer + sizeof(njs_string_buffer_t);
+
+    p = njs_cpymem(string->start, prefix.start, prefix.size);
+
+    buffer->end = njs_cpymem(p, append->start, append->size);
+    buffer->last = string->start + total;
+
+done:
+
+    string->length = length;
+    string->retain = 1;
+    string->buffer = 1;
+    string->hashed = 0;
+    string->atom = 0;
+    string->view = 0;
+
+    value->type = NJS_STRING;
+    njs_string_truth(value, size);
+
+    value->short_string.size = NJS_STRING_LONG;
+    value->short_string.length = 0;
+    value->long_string.external = 0;
+    value->long_string.size = size;
+    value->long_string.data = string;
+
+    return NJS_OK;
+}
+
+
 u_char *
 njs_string_alloc(njs_vm_t *vm, njs_value_t *value, uint64_t size,
     uint64_t length)
@@ -215,6 +372,10 @@ njs_string_alloc(njs_vm_t *vm, njs_value_t *value, uint64_t size,
         string->start = (u_char *) string + sizeof(njs_string_t);
         string->length = length;
         string->retain = 1;
+        string->buffer = 0;
+        string->hashed = 0;
+        string->atom = 0;
+        string->view = 0;
 
         if (map_offset != 0) {
             map = (uint32_t *) (string->start + map_offset);
@@ -255,6 +416,7 @@ njs_string_truncate(njs_value_t *value, uint32_t size)
 
     } else {
         value->long_string.size = size;
+        value->long_string.data->hashed = 0;
     }
 }
 
@@ -485,6 +647,8 @@ njs_string_validate(njs_vm_t *vm, njs_string_prop_t *string, njs_value_t *value)
                     memcpy(start, string->start, size);
                     string->start = start;
                     value->long_string.data->start = start;
+                    value->long_string.data->buffer = 0;
+                    value->long_string.data->view = 0;
 
                     map = (uint32_t *) (start + map_offset);
                     map[0] = 0;
@@ -722,6 +886,11 @@ njs_string_eq(const njs_value_t *v1, const njs_value_t *v2)
 
         start1 = v1->long_string.data->start;
         start2 = v2->long_string.data->start;
+
+        if (start1 == start2) {
+            /* The same string or atom. */
+            return 1;
+        }
     }
 
     return (memcmp(start1, start2, size) == 0);
@@ -964,7 +1133,8 @@ njs_string_prototype_from_utf8(njs_vm_t *vm, njs_value_t *args,
 
     if (string.length != 0) {
         /* ASCII or UTF8 string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                                &string, &slice);
     }
 
     string.start += slice.start;
@@ -1010,7 +1180,8 @@ njs_string_prototype_to_utf8(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
         return ret;
     }
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                            &string, &slice);
 }
 
 
@@ -1041,7 +1212,8 @@ njs_string_prototype_from_bytes(njs_vm_t *vm, njs_value_t *args,
 
     if (string.length != 0) {
         /* ASCII or UTF8 string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                                &string, &slice);
     }
 
     size = 0;
@@ -1106,7 +1278,8 @@ njs_string_prototype_to_bytes(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 
     if (string.length == 0) {
         /* Byte string. */
-        return njs_string_slice(vm, &vm->retval, &string, &slice);
+        return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                                &string, &slice);
     }
 
     p = njs_string_alloc(vm, &vm->retval, slice.length, 0);
@@ -1165,7 +1338,8 @@ njs_string_prototype_slice(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
         return ret;
     }
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                            &string, &slice);
 }
 
 
@@ -1243,7 +1417,8 @@ njs_string_prototype_substring(njs_vm_t *vm, njs_value_t *args,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                            &string, &slice);
 }
 
 
@@ -1321,7 +1496,8 @@ njs_string_prototype_substr(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                            &string, &slice);
 }
 
 
@@ -1357,7 +1533,8 @@ njs_string_prototype_char_at(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     slice.start = start;
     slice.length = length;
 
-    return njs_string_slice(vm, &vm->retval, &string, &slice);
+    return njs_string_slice(vm, &vm->retval, njs_argument(args, 0),
+                            &string, &slice);
 }
 
 
@@ -1499,7 +1676,7 @@ njs_string_slice_string_prop(njs_string_prop_t *dst,
 
 
 njs_int_t
-njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
+njs_string_slice(njs_vm_t *vm, njs_value_t *dst, const njs_value_t *src,
     const njs_string_prop_t *string, const njs_slice_prop_t *slice)
 {
     njs_string_prop_t  prop;
@@ -1507,7 +1684,8 @@ njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
     njs_string_slice_string_prop(&prop, string, slice);
 
     if (njs_fast_path(prop.size != 0)) {
-        return njs_string_new(vm, dst, prop.start, prop.size, prop.length);
+        return njs_string_view(vm, dst, src, prop.start, prop.size,
+                               prop.length);
     }
 
     *dst = njs_string_empty;
@@ -1981,6 +2159,29 @@ range_error:
 }
 
 
+/*
+ * Searches a valid UTF-8 string for a match starting at a character
+ * boundary.
+ */
+
+static u_char *
+njs_string_search(const u_char *start, const u_char *end,
+    const u_char *needle, size_t size)
+{
+    u_char  *p;
+
+    for ( ;; ) {
+        p = njs_str_search(start, end, needle, size);
+
+        if (p == NULL || size == 0 || !njs_utf8_is_continuation(*p)) {
+            return p;
+        }
+
+        start = p + 1;
+    }
+}
+
+
 static njs_int_t
 njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     njs_index_t unused)
@@ -2036,29 +2237,22 @@ njs_string_prototype_index_of(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
             if (string.size == (size_t) length) {
                 /* Byte or ASCII string. */
 
-                end -= (search.size - 1);
-
-                for (p = string.start + index; p < end; p++) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
-                    }
-
-                    index++;
+                p = njs_str_search(string.start + index, end, search.start,
+                                   search.size);
+                if (p != NULL) {
+                    index = p - string.start;
+                    goto done;
                 }
 
             } else {
                 /* UTF-8 string. */
 
                 p = njs_string_offset(string.start, end, index);
-                end -= search.size - 1;
-
-                while (p < end) {
-                    if (memcmp(p, search.start, search.size) == 0) {
-                        goto done;
-                    }
 
-                    index++;
-                    p = njs_utf8_next(p, end);
+                p = njs_string_search(p, end, search.start, search.size);
+                if (p != NULL) {
+                    index = njs_string_index(&string, p - string.start);
+                    goto done;
                 }
             }
 
@@ -2109,7 +2303,7 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
 
     search_length = njs_string_prop(&search, search_string);
 
-    if (length < search_length) {
+    if (length < search_length || string.size < search.size) {
         goto done;
     }
 
@@ -2145,6 +2339,8 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
         index = length - 1;
     }
 
+    end = string.start + string.size;
+
     if (string.size == (size_t) length) {
         /* Byte or ASCII string. */
 
@@ -2154,45 +2350,44 @@ njs_string_prototype_last_index_of(njs_vm_t *vm, njs_value_t *args,
             index = start;
         }
 
-        p = string.start + index;
-
-        do {
-            if (memcmp(p, search.start, search.size) == 0) {
-                goto done;
-            }
-
-            index--;
-            p--;
-
-        } while (p >= string.start);
+        p = njs_str_rsearch(string.start, string.start + index + search.size,
+                            search.start, search.size);
+        if (p != NULL) {
+            index = p - string.start;
+            goto done;
+        }
 
     } else {
         /* UTF-8 string. */
 
-        end = string.start + string.size;
         p = njs_string_offset(string.start, end, index);
-        end -= search.size;
 
-        while (p > end) {
-            index--;
-            p = njs_utf8_prev(p);
+        if (p > end - search.size) {
+            p = end - search.size;
         }
 
         for ( ;; ) {
-            if (memcmp(p, search.start, search.size) == 0) {
-                goto done;
+            p = njs_str_rsearch(string.start, p + search.size, search.start,
+                                search.size);
+            if (p == NULL) {
+                break;
             }
 
-            index--;
+            if (!njs_utf8_is_continuation(*p)) {
+                index = njs_string_index(&string, p - string.start);
+                goto done;
+            }
 
-            if (p <= string.start) {
+            if (p == string.start) {
                 break;
             }
 
-            p = njs_utf8_prev(p);
+            p--;
         }
     }
 
+    index = -1;
+
 done:
 
     njs_set_number(&vm->retval, index);
@@ -2270,14 +2465,8 @@ njs_string_prototype_includes(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
                 p = njs_string_offset(string.start, end, index);
             }
 
-            end -= search.size - 1;
-
-            while (p < end) {
-                if (memcmp(p, search.start, search.size) == 0) {
-                    goto done;
-                }
-
-                p++;
+            if (njs_str_search(p, end, search.start, search.size) != NULL) {
+                goto done;
             }
         }
     }
@@ -2757,7 +2946,8 @@ njs_string_prototype_trim(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 
     length = (string.length != 0) ? string.length - trim : 0;
 
-    return njs_string_new(vm, &vm->retval, start, end - start, length);
+    return njs_string_view(vm, &vm->retval, value, start, end - start,
+                           length);
 
 empty:
 
@@ -3174,8 +3364,8 @@ njs_string_match_multiple(njs_vm_t *vm, njs_value_t *args,
                 length = njs_string_calc_length(utf8, start, size);
             }
 
-            ret = njs_string_new(vm, &array->start[array->length],
-                                 start, size, length);
+            ret = njs_string_view(vm, &array->start[array->length],
+                                  &args[0], start, size, length);
             if (njs_slow_path(ret != NJS_OK)) {
                 return ret;
             }
@@ -3202,7 +3392,7 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
     njs_utf8_t            utf8;
     njs_value_t           *value;
     njs_array_t           *array;
-    const u_char          *p, *start, *next, *last, *end;
+    const u_char          *p, *start, *next, *end;
     njs_regexp_utf8_t     type;
     njs_string_prop_t     string, split;
     njs_regexp_pattern_t  *pattern;
@@ -3296,7 +3486,8 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 
                 size = p - start;
 
-                ret = njs_string_split_part_add(vm, array, utf8, start, size);
+                ret = njs_string_split_part_add(vm, array, &args[0], utf8,
+                                                start, size);
                 if (njs_slow_path(ret != NJS_OK)) {
                     return ret;
                 }
@@ -3327,19 +3518,13 @@ njs_string_prototype_split(njs_vm_t *vm, njs_value_t *args, njs_uint_t nargs,
 
             start = string.start;
             end = string.start + string.size;
-            last = end - split.size;
 
             do {
-                for (p = start; p <= last; p++) {
-                    if (memcmp(p, split.start, split.size) == 0) {
-                        goto found;
-                    }
+                p = njs_str_search(start, end, split.start, split.size);
+                if (p == NULL) {
+                    p = end;
                 }
 
-                p = end;
-
-found:
-
                 next = p + split.size;
 
                 /* Empty split string. */
@@ -3351,7 +3536,8 @@ found:
 
                 size = p - start;
 
-                ret = njs_string_split_part_add(vm, array, utf8, start, size);
+                ret = njs_string_split_part_add(vm, array, &args[0], utf8,
+                                                start, size);
                 if (njs_slow_path(ret != NJS_OK)) {
                     return ret;
                 }
@@ -3380,14 +3566,21 @@ done:
 
 
 static njs_int_t
-njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array, njs_utf8_t utf8,
-    const u_char *start, size_t size)
+njs_string_split_part_add(njs_vm_t *vm, njs_array_t *array,
+    const njs_value_t *src, njs_utf8_t utf8, const u_char *start, size_t size)
 {
-    ssize_t  length;
+    ssize_t    length;
+    njs_int_t  ret;
 
     length = njs_string_calc_length(utf8, start, size);
 
-    return njs_array_string_add(vm, array, start, size, length);
+    ret = njs_array_expand(vm, array, 0, 1);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    return njs_string_view(vm, &array->start[array->length++], src, start,
+                           size, length);
 }
 
 
@@ -3692,7 +3885,7 @@ njs_string_replace_regexp_function(njs_vm_t *vm, njs_value_t *this,
 
         length = njs_string_calc_length(r->utf8, start, size);
 
-        ret = njs_string_new(vm, &arguments[i], start, size, length);
+        ret = njs_string_view(vm, &arguments[i], this, start, size, length);
         if (njs_slow_path(ret != NJS_OK)) {
             return NJS_ERROR;
         }
@@ -3773,47 +3966,42 @@ njs_string_replace_search(njs_vm_t *vm, njs_value_t *this, njs_value_t *search,
     njs_string_get(search, &string);
 
     p = r->part[0].start;
-    end = (p + r->part[0].size) - (string.length - 1);
+    end = p + r->part[0].size;
 
-    while (p < end) {
-        if (memcmp(p, string.start, string.length) == 0) {
+    if (r->utf8 < 2) {
+        p = njs_str_search(p, end, string.start, string.length);
 
-            if (r->substitutions != NULL) {
-                captures[0] = p - r->part[0].start;
-                captures[1] = captures[0] + string.length;
+    } else {
+        p = njs_string_search(p, end, string.start, string.length);
+    }
 
-                ret = njs_string_replace_substitute(vm, r, captures);
-                if (njs_slow_path(ret != NJS_OK)) {
-                    return ret;
-                }
+    if (p == NULL) {
+        njs_string_copy(&vm->retval, this);
+        return NJS_OK;
+    }
 
-            } else {
-                r->part[2].start = p + string.length;
-                size = p - r->part[0].start;
-                r->part[2].size = r->part[0].size - size - string.length;
-                r->part[0].size = size;
-                njs_set_invalid(&r->part[2].value);
-
-                if (r->function != NULL) {
-                    return njs_string_replace_search_function(vm, this, search,
-                                                              r);
-                }
-            }
+    if (r->substitutions != NULL) {
+        captures[0] = p - r->part[0].start;
+        captures[1] = captures[0] + string.length;
 
-            return njs_string_replace_join(vm, r);
+        ret = njs_string_replace_substitute(vm, r, captures);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
         }
 
-        if (r->utf8 < 2) {
-            p++;
+    } else {
+        r->part[2].start = p + string.length;
+        size = p - r->part[0].start;
+        r->part[2].size = r->part[0].size - size - string.length;
+        r->part[0].size = size;
+        njs_set_invalid(&r->part[2].value);
 
-        } else {
-            p = (u_char *) njs_utf8_next(p, end);
+        if (r->function != NULL) {
+            return njs_string_replace_search_function(vm, this, search, r);
         }
     }
 
-    njs_string_copy(&vm->retval, this);
-
-    return NJS_OK;
+    return njs_string_replace_join(vm, r);
 }
 
 
@@ -5236,6 +5424,11 @@ njs_value_index(njs_vm_t *vm, const njs_value_t *src, njs_uint_t runtime)
             string->start = (u_char *) string + sizeof(njs_string_t);
             string->length = src->long_string.data->length;
             string->retain = 0xffff;
+            string->buffer = 0;
+            string->hashed = 1;
+            string->atom = 1;
+            string->view = 0;
+            string->hash = lhq.key_hash;
 
             memcpy(string->start, start, size);
         }
@@ -5266,6 +5459,47 @@ njs_value_index(njs_vm_t *vm, const njs_value_t *src, njs_uint_t runtime)
 }
 
 
+void
+njs_string_atom(njs_vm_t *vm, njs_value_t *value)
+{
+    njs_value_t         *atom;
+    njs_string_t        *string;
+    njs_lvlhsh_query_t  lhq;
+
+    if (!njs_is_string(value)
+        || value->short_string.size != NJS_STRING_LONG)
+    {
+        return;
+    }
+
+    string = value->long_string.data;
+
+    if (string->atom) {
+        return;
+    }
+
+    lhq.key_hash = njs_string_key_hash(value, &lhq.key);
+    lhq.proto = &njs_values_hash_proto;
+
+    if (njs_lvlhsh_find(&vm->shared->values_hash, &lhq) != NJS_OK
+        && njs_lvlhsh_find(&vm->values_hash, &lhq) != NJS_OK)
+    {
+        return;
+    }
+
+    atom = lhq.value;
+
+    /* A byte string and a non-string value can have the same bytes. */
+
+    if (njs_is_string(atom)
+        && atom->short_string.size == NJS_STRING_LONG
+        && atom->long_string.data->length == string->length)
+    {
+        *value = *atom;
+    }
+}
+
+
 const njs_object_type_init_t  njs_string_type_init = {
     .constructor = njs_native_ctor(njs_string_constructor, 1, 0),
     .constructor_props = &njs_string_constructor_init,
@@ -80,13 +80,66 @@
  * offset should be used and so on until start of the string.
  */
 
+/*
+ * The key hash of a long string is computed on the first use as
+ * a property key and is kept in the hash field.  Long strings interned
+ * by njs_value_index() are atoms, they get the hash at once.  Atoms are
+ * unique within the shared part of a VM which is also used by its clones,
+ * njs_string_atom() replaces a property name with an equal atom, so
+ * property names and constant keys compare by the start pointer.
+ */
+
 struct njs_string_s {
     u_char    *start;
-    uint32_t  length;   /* Length in UTF-8 characters. */
-    uint32_t  retain;   /* Link counter. */
+    uint32_t  length;      /* Length in UTF-8 characters. */
+    uint32_t  retain:16;   /* Link counter. */
+    uint32_t  buffer:1;    /* The start is in an append buffer. */
+    uint32_t  hashed:1;    /* The hash is set. */
+    uint32_t  atom:1;      /* The string is in values_hash. */
+    uint32_t  view:1;      /* The start is in another string. */
+    uint32_t  hash;
 };
 
 
+/*
+ * A substring of a long string which is not shorter than
+ * NJS_STRING_VIEW_MIN bytes and requires no offset map is created as
+ * a view, its start points to the bytes of the string it was taken from.
+ * A view keeps the whole parent string alive, so the bytes are copied
+ * instead if the parent is more than NJS_STRING_VIEW_WASTE times larger.
+ * A view of a view is checked against the size of the pinned string.
+ */
+
+#define NJS_STRING_VIEW_MIN    16
+#define NJS_STRING_VIEW_WASTE  8
+
+typedef struct {
+    njs_string_t  string;
+    uint32_t      pinned;  /* The size of the pinned string. */
+} njs_string_view_t;
+
+
+/*
+ * Concatenation results are stored in append buffers to make a loop of
+ * "s += chunk" linear.  The njs_string_buffer_t structure precedes the
+ * buffer start.  The first string stored in a buffer fills it completely.
+ * If a string ending at the end of the used part of its buffer is appended
+ * again, the bytes are copied to a new buffer twice as large as required.
+ * Then the following appends copy only the appended bytes and the results
+ * share the buffer with the previous strings.  Strings stored in append
+ * buffers have no UTF-8 offset map.
+ */
+
+typedef struct {
+    u_char    *end;     /* The end of the used part. */
+    u_char    *last;    /* The end of the buffer. */
+} njs_string_buffer_t;
+
+
+#define njs_string_buffer(string)                                             \
+    ((njs_string_buffer_t *) ((string)->start - sizeof(njs_string_buffer_t)))
+
+
 typedef struct {
     size_t    size;
     size_t    length;
@@ -155,12 +208,44 @@ njs_string_length(njs_value_t *string)
 }
 
 
+njs_inline uint32_t
+njs_string_key_hash(const njs_value_t *value, njs_str_t *key)
+{
+    njs_string_t  *string;
+
+    if (value->short_string.size != NJS_STRING_LONG) {
+        key->length = value->short_string.size;
+        key->start = (u_char *) value->short_string.start;
+
+        return njs_djb_hash(key->start, key->length);
+    }
+
+    string = value->long_string.data;
+
+    key->length = value->long_string.size;
+    key->start = string->start;
+
+    if (!string->hashed) {
+        string->hash = njs_djb_hash(key->start, key->length);
+        string->hashed = 1;
+    }
+
+    return string->hash;
+}
+
+
 njs_int_t njs_string_set(njs_vm_t *vm, njs_value_t *value, const u_char *start,
     uint32_t size);
+njs_int_t njs_string_append(njs_vm_t *vm, njs_value_t *value,
+    const njs_value_t *src, const njs_string_prop_t *append, size_t length);
 u_char *njs_string_alloc(njs_vm_t *vm, njs_value_t *value, uint64_t size,
     uint64_t length);
 njs_int_t njs_string_new(njs_vm_t *vm, njs_value_t *value, const u_char *start,
     uint32_t size, uint32_t length);
+njs_int_t njs_string_view(njs_vm_t *vm, njs_value_t *value,
+    const njs_value_t *src, const u_char *start, uint32_t size,
+    uint32_t length);
+void njs_string_atom(njs_vm_t *vm, njs_value_t *value);
 njs_int_t njs_string_hex(njs_vm_t *vm, njs_value_t *value,
     const njs_str_t *src);
 njs_int_t njs_string_base64(njs_vm_t *vm, njs_value_t *value,
@@ -182,7 +267,8 @@ njs_int_t njs_string_cmp(const njs_value_t *val1, const njs_value_t *val2);
 void njs_string_slice_string_prop(njs_string_prop_t *dst,
     const njs_string_prop_t *string, const njs_slice_prop_t *slice);
 njs_int_t njs_string_slice(njs_vm_t *vm, njs_value_t *dst,
-    const njs_string_prop_t *string, const njs_slice_prop_t *slice);
+    const njs_value_t *src, const njs_string_prop_t *string,
+    const njs_slice_prop_t *slice);
 const u_char *njs_string_offset(const u_char *start, const u_char *end,
     size_t index);
 uint32_t njs_string_index(njs_string_prop_t *string, uint32_t offset);
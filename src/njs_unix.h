@@ -32,6 +32,7 @@
 #include <limits.h>
 #include <time.h>
 #include <fcntl.h>
+#include <signal.h>
 
 /*
  * alloca() is defined in stdlib.h in Linux, FreeBSD and MacOSX
@@ -22,6 +22,52 @@
 #include <njs_unicode_lower_case.h>
 #include <njs_unicode_upper_case.h>
 
+#if (NJS_HAVE_AVX2)
+#include <immintrin.h>
+#elif (NJS_HAVE_SSE2)
+#include <emmintrin.h>
+#elif (NJS_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/*
+ * The vector code processes at most 32 bytes at once and the scalar
+ * code continues from the block where it has stopped.
+ */
+#define NJS_UTF8_SCAN_BLOCK  32
+
+
+typedef const u_char *(*njs_utf8_scan_t)(const u_char *p, const u_char *end,
+    size_t *length);
+
+
+static ssize_t njs_utf8_count(const u_char *p, size_t len, njs_bool_t safe,
+    ssize_t *out_size);
+static const u_char *njs_utf8_scan_init(const u_char *p, const u_char *end,
+    size_t *length);
+static const u_char *njs_utf8_scan_boundary(const u_char *start,
+    const u_char *p, size_t *length);
+#if (NJS_HAVE_AVX2)
+static const u_char *njs_utf8_scan_avx2(const u_char *p, const u_char *end,
+    size_t *length);
+#endif
+#if (NJS_HAVE_SSE2)
+static const u_char *njs_utf8_scan_sse2(const u_char *p, const u_char *end,
+    size_t *length);
+#endif
+#if (NJS_HAVE_NEON)
+static const u_char *njs_utf8_scan_neon(const u_char *p, const u_char *end,
+    size_t *length);
+#endif
+#if !(NJS_HAVE_AVX2 || NJS_HAVE_SSE2 || NJS_HAVE_NEON)
+static const u_char *njs_utf8_scan_none(const u_char *p, const u_char *end,
+    size_t *length);
+#endif
+
+
+static njs_utf8_scan_t  njs_utf8_scan = njs_utf8_scan_init;
+
 
 u_char *
 njs_utf8_encode(u_char *p, uint32_t u)
@@ -354,6 +400,32 @@ njs_utf8_upper_case(const u_char **start, const u_char *end)
 
 ssize_t
 njs_utf8_length(const u_char *p, size_t len)
+{
+    return njs_utf8_count(p, len, 0, NULL);
+}
+
+
+ssize_t
+njs_utf8_safe_length(const u_char *p, size_t len, ssize_t *out_size)
+{
+    return njs_utf8_count(p, len, 1, out_size);
+}
+
+
+njs_bool_t
+njs_utf8_is_valid(const u_char *p, size_t len)
+{
+    return (njs_utf8_count(p, len, 0, NULL) >= 0);
+}
+
+
+/*
+ * The scalar versions are the reference implementation, they are used
+ * by the unit test to verify the vector code.
+ */
+
+ssize_t
+njs_utf8_length_scalar(const u_char *p, size_t len)
 {
     ssize_t       length;
     const u_char  *end;
@@ -375,7 +447,8 @@ njs_utf8_length(const u_char *p, size_t len)
 
 
 ssize_t
-njs_utf8_safe_length(const u_char *p, size_t len, ssize_t *out_size)
+njs_utf8_safe_length_scalar(const u_char *p, size_t len,
+    ssize_t *out_size)
 {
     ssize_t       size, length;
     uint32_t      codepoint;
@@ -403,7 +476,7 @@ njs_utf8_safe_length(const u_char *p, size_t len, ssize_t *out_size)
 
 
 njs_bool_t
-njs_utf8_is_valid(const u_char *p, size_t len)
+njs_utf8_is_valid_scalar(const u_char *p, size_t len)
 {
     const u_char  *end;
 
@@ -417,3 +490,451 @@ njs_utf8_is_valid(const u_char *p, size_t len)
 
     return 1;
 }
+
+
+/*
+ * njs_utf8_count() lets njs_utf8_scan() skip the longest valid prefix
+ * it can verify and decodes the block which stopped the scan with
+ * the scalar code.  Invalid sequences are counted as U+FFFD if safe
+ * is set, otherwise -1 is returned.
+ */
+
+static ssize_t
+njs_utf8_count(const u_char *p, size_t len, njs_bool_t safe,
+    ssize_t *out_size)
+{
+    size_t        n;
+    ssize_t       size, length;
+    uint32_t      u;
+    const u_char  *end, *last;
+
+    size = 0;
+    length = 0;
+
+    end = p + len;
+
+    while (p < end) {
+
+        if ((size_t) (end - p) >= NJS_UTF8_SCAN_BLOCK) {
+            last = njs_utf8_scan(p, end, &n);
+
+            length += n;
+            size += last - p;
+            p = last;
+        }
+
+        last = ((size_t) (end - p) > NJS_UTF8_SCAN_BLOCK)
+               ? p + NJS_UTF8_SCAN_BLOCK : end;
+
+        while (p < last) {
+            if (safe) {
+                u = njs_utf8_safe_decode(&p, end);
+                size += njs_utf8_size(u);
+
+            } else if (njs_slow_path(njs_utf8_decode(&p, end) == 0xffffffff)) {
+                return -1;
+            }
+
+            length++;
+        }
+    }
+
+    if (out_size != NULL) {
+        *out_size = size;
+    }
+
+    return length;
+}
+
+
+static const u_char *
+njs_utf8_scan_init(const u_char *p, const u_char *end, size_t *length)
+{
+#if (NJS_HAVE_AVX2)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        njs_utf8_scan = njs_utf8_scan_avx2;
+
+    } else {
+        njs_utf8_scan = njs_utf8_scan_sse2;
+    }
+
+#elif (NJS_HAVE_SSE2)
+    njs_utf8_scan = njs_utf8_scan_sse2;
+
+#elif (NJS_HAVE_NEON)
+    njs_utf8_scan = njs_utf8_scan_neon;
+
+#else
+    njs_utf8_scan = njs_utf8_scan_none;
+#endif
+
+    return njs_utf8_scan(p, end, length);
+}
+
+
+/*
+ * The vector code validates the input in blocks and stops at a block
+ * with an error or at the last incomplete block.  A character started
+ * before the block is left to the scalar code too.
+ */
+
+static const u_char *
+njs_utf8_scan_boundary(const u_char *start, const u_char *p, size_t *length)
+{
+    u_char        c;
+    size_t        size;
+    const u_char  *q;
+
+    if (p == start) {
+        return p;
+    }
+
+    q = p;
+
+    do {
+        q--;
+        c = *q;
+
+    } while (njs_utf8_is_continuation(c) && q > start && p - q < 4);
+
+    if (c >= 0xC0) {
+        size = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2;
+
+        if (q + size > p) {
+            (*length)--;
+            return q;
+        }
+    }
+
+    return p;
+}
+
+
+#if !(NJS_HAVE_AVX2 || NJS_HAVE_SSE2 || NJS_HAVE_NEON)
+
+static const u_char *
+njs_utf8_scan_none(const u_char *p, const u_char *end, size_t *length)
+{
+    *length = 0;
+
+    return p;
+}
+
+#endif
+
+
+#if (NJS_HAVE_SSE2)
+
+/* All-ASCII blocks only. */
+
+static const u_char *
+njs_utf8_scan_sse2(const u_char *p, const u_char *end, size_t *length)
+{
+    __m128i       in;
+    const u_char  *start;
+
+    start = p;
+
+    while (end - p >= 16) {
+        in = _mm_loadu_si128((const __m128i *) p);
+
+        if (_mm_movemask_epi8(in) != 0) {
+            break;
+        }
+
+        p += 16;
+    }
+
+    *length = p - start;
+
+    return p;
+}
+
+#endif
+
+
+/*
+ * The vector validation looks up the high and low nibbles of a byte and
+ * the high nibble of the next byte in three tables, a pair of bytes is
+ * invalid if all three lookups have a common error bit.  The third and
+ * the fourth bytes of 3 and 4 bytes sequences are checked separately,
+ * they must be continuations, and no other byte may be a continuation
+ * if it does not follow a leading byte.  Surrogates are valid as in
+ * njs_utf8_decode().
+ *
+ *   J. Keiser, D. Lemire, "Validating UTF-8 In Less Than One Instruction
+ *   Per Byte", Software: Practice and Experience 51 (5), 2021.
+ */
+
+#define NJS_UTF8_TOO_SHORT       0x01
+#define NJS_UTF8_TOO_LONG        0x02
+#define NJS_UTF8_OVERLONG_3      0x04
+#define NJS_UTF8_TOO_LARGE       0x08
+#define NJS_UTF8_OVERLONG_2      0x20
+#define NJS_UTF8_TOO_LARGE_1000  0x40
+#define NJS_UTF8_OVERLONG_4      0x40
+#define NJS_UTF8_TWO_CONTS       0x80
+#define NJS_UTF8_CARRY                                                        \
+    (NJS_UTF8_TOO_SHORT | NJS_UTF8_TOO_LONG | NJS_UTF8_TWO_CONTS)
+
+
+#if (NJS_HAVE_AVX2 || NJS_HAVE_NEON)
+
+static const uint8_t  njs_utf8_byte1_high[16] njs_aligned(16) = {
+    /* 0xxxxxxx: ASCII. */
+    NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG,
+    NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG, NJS_UTF8_TOO_LONG,
+
+    /* 10xxxxxx: continuation. */
+    NJS_UTF8_TWO_CONTS, NJS_UTF8_TWO_CONTS,
+    NJS_UTF8_TWO_CONTS, NJS_UTF8_TWO_CONTS,
+
+    /* 1100xxxx. */
+    NJS_UTF8_TOO_SHORT | NJS_UTF8_OVERLONG_2,
+
+    /* 1101xxxx. */
+    NJS_UTF8_TOO_SHORT,
+
+    /* 1110xxxx. */
+    NJS_UTF8_TOO_SHORT | NJS_UTF8_OVERLONG_3,
+
+    /* 1111xxxx. */
+    NJS_UTF8_TOO_SHORT | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000
+    | NJS_UTF8_OVERLONG_4,
+};
+
+
+static const uint8_t  njs_utf8_byte1_low[16] njs_aligned(16) = {
+    /* xxxx0000. */
+    NJS_UTF8_CARRY | NJS_UTF8_OVERLONG_2 | NJS_UTF8_OVERLONG_3
+    | NJS_UTF8_OVERLONG_4,
+
+    /* xxxx0001. */
+    NJS_UTF8_CARRY | NJS_UTF8_OVERLONG_2,
+
+    /* xxxx001x. */
+    NJS_UTF8_CARRY,
+    NJS_UTF8_CARRY,
+
+    /* xxxx0100. */
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE,
+
+    /* xxxx0101 - xxxx1111. */
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+    NJS_UTF8_CARRY | NJS_UTF8_TOO_LARGE | NJS_UTF8_TOO_LARGE_1000,
+};
+
+
+static const uint8_t  njs_utf8_byte2_high[16] njs_aligned(16) = {
+    /* 0xxxxxxx: ASCII. */
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+
+    /* 1000xxxx. */
+    NJS_UTF8_TOO_LONG | NJS_UTF8_OVERLONG_2 | NJS_UTF8_TWO_CONTS
+    | NJS_UTF8_OVERLONG_3 | NJS_UTF8_TOO_LARGE_1000 | NJS_UTF8_OVERLONG_4,
+
+    /* 1001xxxx. */
+    NJS_UTF8_TOO_LONG | NJS_UTF8_OVERLONG_2 | NJS_UTF8_TWO_CONTS
+    | NJS_UTF8_OVERLONG_3 | NJS_UTF8_TOO_LARGE,
+
+    /* 101xxxxx. */
+    NJS_UTF8_TOO_LONG | NJS_UTF8_OVERLONG_2 | NJS_UTF8_TWO_CONTS
+    | NJS_UTF8_TOO_LARGE,
+    NJS_UTF8_TOO_LONG | NJS_UTF8_OVERLONG_2 | NJS_UTF8_TWO_CONTS
+    | NJS_UTF8_TOO_LARGE,
+
+    /* 11xxxxxx. */
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+    NJS_UTF8_TOO_SHORT, NJS_UTF8_TOO_SHORT,
+};
+
+
+/* The last bytes which do not start an incomplete sequence. */
+
+static const uint8_t  njs_utf8_complete[32] njs_aligned(32) = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+#endif
+
+
+#if (NJS_HAVE_AVX2)
+
+__attribute__ ((target("avx2,popcnt")))
+static const u_char *
+njs_utf8_scan_avx2(const u_char *p, const u_char *end, size_t *length)
+{
+    size_t        n;
+    __m256i       in, prev, prev1, prev2, prev3, shifted, err, complete,
+                  incomplete, byte1_high, byte1_low, byte2_high, low_nibble;
+    const u_char  *start;
+
+    start = p;
+    n = 0;
+
+    byte1_high = _mm256_broadcastsi128_si256(
+                      _mm_loadu_si128((const __m128i *) njs_utf8_byte1_high));
+    byte1_low = _mm256_broadcastsi128_si256(
+                      _mm_loadu_si128((const __m128i *) njs_utf8_byte1_low));
+    byte2_high = _mm256_broadcastsi128_si256(
+                      _mm_loadu_si128((const __m128i *) njs_utf8_byte2_high));
+    complete = _mm256_loadu_si256((const __m256i *) njs_utf8_complete);
+    low_nibble = _mm256_set1_epi8(0x0F);
+
+    prev = _mm256_setzero_si256();
+    incomplete = _mm256_setzero_si256();
+
+    while (end - p >= 32) {
+        in = _mm256_loadu_si256((const __m256i *) p);
+
+        if (_mm256_movemask_epi8(in) == 0) {
+            if (!_mm256_testz_si256(incomplete, incomplete)) {
+                break;
+            }
+
+            prev = in;
+            n += 32;
+            p += 32;
+
+            continue;
+        }
+
+        shifted = _mm256_permute2x128_si256(prev, in, 0x21);
+        prev1 = _mm256_alignr_epi8(in, shifted, 15);
+        prev2 = _mm256_alignr_epi8(in, shifted, 14);
+        prev3 = _mm256_alignr_epi8(in, shifted, 13);
+
+        err = _mm256_and_si256(
+                  _mm256_and_si256(
+                      _mm256_shuffle_epi8(byte1_high, _mm256_and_si256(
+                                    _mm256_srli_epi16(prev1, 4), low_nibble)),
+                      _mm256_shuffle_epi8(byte1_low,
+                                    _mm256_and_si256(prev1, low_nibble))),
+                  _mm256_shuffle_epi8(byte2_high, _mm256_and_si256(
+                                    _mm256_srli_epi16(in, 4), low_nibble)));
+
+        /* Only 111xxxxx and 1111xxxx become 0x80 and greater. */
+
+        prev2 = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+        prev3 = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+
+        err = _mm256_xor_si256(err,
+                  _mm256_and_si256(_mm256_or_si256(prev2, prev3),
+                                   _mm256_set1_epi8((char) 0x80)));
+
+        if (!_mm256_testz_si256(err, err)) {
+            break;
+        }
+
+        /* Characters are counted as not continuation bytes. */
+
+        n += __builtin_popcount((unsigned) _mm256_movemask_epi8(
+                 _mm256_cmpgt_epi8(in, _mm256_set1_epi8((char) 0xBF))));
+
+        incomplete = _mm256_subs_epu8(in, complete);
+
+        prev = in;
+        p += 32;
+    }
+
+    *length = n;
+
+    return njs_utf8_scan_boundary(start, p, length);
+}
+
+#endif
+
+
+#if (NJS_HAVE_NEON)
+
+static const u_char *
+njs_utf8_scan_neon(const u_char *p, const u_char *end, size_t *length)
+{
+    size_t        n;
+    uint8x16_t    in, prev, prev1, prev2, prev3, err, complete, incomplete,
+                  byte1_high, byte1_low, byte2_high, low_nibble;
+    const u_char  *start;
+
+    start = p;
+    n = 0;
+
+    byte1_high = vld1q_u8(njs_utf8_byte1_high);
+    byte1_low = vld1q_u8(njs_utf8_byte1_low);
+    byte2_high = vld1q_u8(njs_utf8_byte2_high);
+    complete = vld1q_u8(&njs_utf8_complete[16]);
+    low_nibble = vdupq_n_u8(0x0F);
+
+    prev = vdupq_n_u8(0);
+    incomplete = vdupq_n_u8(0);
+
+    while (end - p >= 16) {
+        in = vld1q_u8(p);
+
+        if (vmaxvq_u8(in) < 0x80) {
+            if (vmaxvq_u8(incomplete) != 0) {
+                break;
+            }
+
+            prev = in;
+            n += 16;
+            p += 16;
+
+            continue;
+        }
+
+        prev1 = vextq_u8(prev, in, 15);
+        prev2 = vextq_u8(prev, in, 14);
+        prev3 = vextq_u8(prev, in, 13);
+
+        err = vandq_u8(vandq_u8(vqtbl1q_u8(byte1_high, vshrq_n_u8(prev1, 4)),
+                                vqtbl1q_u8(byte1_low,
+                                           vandq_u8(prev1, low_nibble))),
+                       vqtbl1q_u8(byte2_high, vshrq_n_u8(in, 4)));
+
+        /* Only 111xxxxx and 1111xxxx become 0x80 and greater. */
+
+        prev2 = vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80));
+        prev3 = vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80));
+
+        err = veorq_u8(err, vandq_u8(vorrq_u8(prev2, prev3),
+                                     vdupq_n_u8(0x80)));
+
+        if (vmaxvq_u8(err) != 0) {
+            break;
+        }
+
+        /* Characters are counted as not continuation bytes. */
+
+        n += vaddvq_u8(vandq_u8(vcgtq_s8(vreinterpretq_s8_u8(in),
+                                         vdupq_n_s8((int8_t) 0xBF)),
+                                vdupq_n_u8(1)));
+
+        incomplete = vqsubq_u8(in, complete);
+
+        prev = in;
+        p += 16;
+    }
+
+    *length = n;
+
+    return njs_utf8_scan_boundary(start, p, length);
+}
+
+#endif
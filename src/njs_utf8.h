@@ -35,6 +35,10 @@ NJS_EXPORT ssize_t njs_utf8_length(const u_char *p, size_t len);
 NJS_EXPORT ssize_t njs_utf8_safe_length(const u_char *p, size_t len,
     ssize_t *out_size);
 NJS_EXPORT njs_bool_t njs_utf8_is_valid(const u_char *p, size_t len);
+NJS_EXPORT ssize_t njs_utf8_length_scalar(const u_char *p, size_t len);
+NJS_EXPORT ssize_t njs_utf8_safe_length_scalar(const u_char *p, size_t len,
+    ssize_t *out_size);
+NJS_EXPORT njs_bool_t njs_utf8_is_valid_scalar(const u_char *p, size_t len);
 
 
 /*
@@ -122,6 +126,10 @@ njs_utf8_copy(u_char *dst, const u_char **src, const u_char *end)
     ((u < 0x80) ? 1 : ((u < 0x0800) ? 2 : 3))
 
 
+#define njs_utf8_is_continuation(c)                                           \
+    (((c) & 0xC0) == 0x80)
+
+
 njs_inline njs_bool_t
 njs_utf8_is_whitespace(uint32_t c)
 {
@@ -11,6 +11,8 @@
 static njs_int_t njs_object_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_object_t *object,
     const njs_value_t *key);
+static njs_int_t njs_shape_property_query(njs_vm_t *vm,
+    njs_property_query_t *pq, njs_object_t *object);
 static njs_int_t njs_array_property_query(njs_vm_t *vm,
     njs_property_query_t *pq, njs_array_t *array, uint32_t index);
 static njs_int_t njs_typed_array_property_query(njs_vm_t *vm,
@@ -344,6 +346,15 @@ njs_type_string(njs_value_type_t type)
     case NJS_PROMISE:
         return "promise";
 
+    case NJS_MAP:
+        return "map";
+
+    case NJS_SET:
+        return "set";
+
+    case NJS_MAP_ITERATOR:
+        return "map iterator";
+
     default:
         return NULL;
     }
@@ -547,6 +558,9 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *value,
     case NJS_DATE:
     case NJS_PROMISE:
     case NJS_OBJECT_VALUE:
+    case NJS_MAP:
+    case NJS_SET:
+    case NJS_MAP_ITERATOR:
         obj = njs_object(value);
         break;
 
@@ -584,9 +598,7 @@ njs_property_query(njs_vm_t *vm, njs_property_query_t *pq, njs_value_t *value,
             pq->lhq.key_hash = njs_symbol_key(key);
 
         } else {
-            njs_string_get(&pq->key, &pq->lhq.key);
-            pq->lhq.key_hash = njs_djb_hash(pq->lhq.key.start,
-                                            pq->lhq.key.length);
+            pq->lhq.key_hash = njs_string_key_hash(&pq->key, &pq->lhq.key);
         }
 
         ret = njs_object_property_query(vm, pq, obj, key);
@@ -666,6 +678,13 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
             }
         }
 
+        if (proto->shape != NULL) {
+            ret = njs_shape_property_query(vm, pq, proto);
+            if (ret != NJS_DECLINED) {
+                return ret;
+            }
+        }
+
         ret = njs_lvlhsh_find(&proto->hash, &pq->lhq);
 
         if (ret == NJS_OK) {
@@ -700,6 +719,53 @@ njs_object_property_query(njs_vm_t *vm, njs_property_query_t *pq,
 }
 
 
+static njs_int_t
+njs_shape_property_query(njs_vm_t *vm, njs_property_query_t *pq,
+    njs_object_t *object)
+{
+    njs_int_t          slot, ret;
+    njs_object_prop_t  *prop;
+
+    slot = njs_shape_find(object->shape, &pq->lhq);
+    if (slot == NJS_DECLINED) {
+        return NJS_DECLINED;
+    }
+
+    if (pq->query == NJS_PROPERTY_QUERY_DELETE) {
+        /* Shapes never have holes, the property is deleted from the hash. */
+
+        ret = njs_shape_dictionary(vm, object);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        return NJS_DECLINED;
+    }
+
+    prop = &pq->scratch;
+
+    if (pq->query == NJS_PROPERTY_QUERY_GET) {
+        prop->value = object->values[slot];
+        prop->type = NJS_PROPERTY;
+
+    } else {
+        prop->value.data.u.value = &object->values[slot];
+        prop->type = NJS_PROPERTY_REF;
+    }
+
+    njs_set_null(&prop->getter);
+    njs_set_null(&prop->setter);
+
+    prop->writable = 1;
+    prop->enumerable = 1;
+    prop->configurable = 1;
+
+    pq->lhq.value = prop;
+
+    return NJS_OK;
+}
+
+
 static njs_int_t
 njs_array_property_query(njs_vm_t *vm, njs_property_query_t *pq,
     njs_array_t *array, uint32_t index)
@@ -863,7 +929,7 @@ njs_string_property_query(njs_vm_t *vm, njs_property_query_t *pq,
          * A single codepoint string fits in retval
          * so the function cannot fail.
          */
-        (void) njs_string_slice(vm, &prop->value, &string, &slice);
+        (void) njs_string_slice(vm, &prop->value, object, &string, &slice);
 
         prop->type = NJS_PROPERTY;
         prop->writable = 0;
@@ -1244,6 +1310,13 @@ slow_path:
         return NJS_ERROR;
     }
 
+    if (njs_object(value)->shape != NULL) {
+        ret = njs_shape_add(vm, njs_object(value), &pq.lhq, &pq.key, setval);
+        if (ret != NJS_DECLINED) {
+            return ret;
+        }
+    }
+
     prop = njs_object_prop_alloc(vm, &pq.key, &njs_value_undefined, 1);
     if (njs_slow_path(prop == NULL)) {
         return NJS_ERROR;
@@ -72,6 +72,9 @@ typedef enum {
     NJS_PROMISE,
     NJS_OBJECT_VALUE,
     NJS_ARRAY_BUFFER,
+    NJS_MAP,
+    NJS_SET,
+    NJS_MAP_ITERATOR,
     NJS_VALUE_TYPE_MAX
 } njs_value_type_t;
 
@@ -87,8 +90,11 @@ typedef struct njs_typed_array_s      njs_typed_array_t;
 typedef struct njs_regexp_s           njs_regexp_t;
 typedef struct njs_date_s             njs_date_t;
 typedef struct njs_object_value_s     njs_promise_t;
+typedef struct njs_map_s              njs_map_t;
+typedef struct njs_map_iterator_s     njs_map_iterator_t;
 typedef struct njs_property_next_s    njs_property_next_t;
 typedef struct njs_object_init_s      njs_object_init_t;
+typedef struct njs_object_shape_s     njs_object_shape_t;
 
 
 #if (!NJS_HAVE_GCC_ATTRIBUTE_ALIGNED)
@@ -136,6 +142,8 @@ union njs_value_s {
             njs_regexp_t              *regexp;
             njs_date_t                *date;
             njs_promise_t             *promise;
+            njs_map_t                 *map;
+            njs_map_iterator_t        *map_iterator;
             njs_prop_handler_t        prop_handler;
             njs_value_t               *value;
             njs_property_next_t       *next;
@@ -195,6 +203,13 @@ struct njs_object_s {
     njs_object_t                      *__proto__;
     njs_exotic_slots_t                *slots;
 
+    /*
+     * A shared layout of own properties and their values,
+     * the shape is NULL in the dictionary mode, see njs_shape.h.
+     */
+    njs_object_shape_t                *shape;
+    njs_value_t                       *values;
+
     /* The type is used in constructor prototypes. */
     njs_value_type_t                  type:8;
     uint8_t                           shared;     /* 1 bit */
@@ -380,6 +395,12 @@ struct njs_object_prop_s {
     njs_object_attribute_t      writable:8;      /* 2 bits */
     njs_object_attribute_t      enumerable:8;    /* 2 bits */
     njs_object_attribute_t      configurable:8;  /* 2 bits */
+
+    /*
+     * The function value is the same function object as the value of
+     * another property of the shared hash, see njs_prop_private_copy().
+     */
+    uint8_t                     alias:1;
 };
 
 
@@ -473,6 +494,20 @@ typedef struct {
     _njs_native_function(_function, _args_count, 0, _magic)
 
 
+/*
+ * A value of a native function declared once and shared by several
+ * properties, the properties except one are marked with "alias".
+ */
+
+#define njs_shared_function(_function) {                                      \
+    .data = {                                                                 \
+        .type = NJS_FUNCTION,                                                 \
+        .truth = 1,                                                           \
+        .u.function = _function                                               \
+    }                                                                         \
+}
+
+
 #define njs_native_ctor(_function, _args_count, _magic)                       \
     _njs_function(_function, _args_count, 1, _magic)
 
@@ -660,6 +695,18 @@ typedef struct {
     ((value)->type == NJS_PROMISE)
 
 
+#define njs_is_map(value)                                                     \
+    ((value)->type == NJS_MAP)
+
+
+#define njs_is_set(value)                                                     \
+    ((value)->type == NJS_SET)
+
+
+#define njs_is_map_iterator(value)                                            \
+    ((value)->type == NJS_MAP_ITERATOR)
+
+
 #define njs_is_error(value)                                                   \
     ((value)->type == NJS_OBJECT && njs_object(value)->error_data)
 
@@ -736,6 +783,14 @@ typedef struct {
     ((value)->data.u.promise)
 
 
+#define njs_map(value)                                                        \
+    ((value)->data.u.map)
+
+
+#define njs_map_iterator(value)                                               \
+    ((value)->data.u.map_iterator)
+
+
 #define njs_regexp(value)                                                     \
     ((value)->data.u.regexp)
 
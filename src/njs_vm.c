@@ -8,8 +8,19 @@
 #include <njs_main.h>
 
 
+struct njs_function_handle_s {
+    njs_index_t               index;
+    njs_uint_t                nkeys;
+    njs_value_t               keys[];
+};
+
+
+static void njs_vm_release_events(njs_vm_t *vm);
+static njs_int_t njs_vm_clone_init(njs_vm_t *nvm, njs_vm_t *vm, njs_mp_t *mp,
+    njs_external_ptr_t external);
 static njs_int_t njs_vm_init(njs_vm_t *vm);
 static njs_int_t njs_vm_handle_events(njs_vm_t *vm);
+static njs_index_t njs_vm_global_index(njs_vm_t *vm, const njs_str_t *name);
 
 
 const njs_str_t  njs_entry_main =           njs_str("main");
@@ -19,6 +30,9 @@ const njs_str_t  njs_entry_unknown =        njs_str("unknown");
 const njs_str_t  njs_entry_anonymous =      njs_str("anonymous");
 
 
+static uintptr_t  njs_vm_cache_epoch;
+
+
 void
 njs_vm_opt_init(njs_vm_opt_t *options)
 {
@@ -39,12 +53,18 @@ njs_vm_create(njs_vm_opt_t *options)
         return NULL;
     }
 
+    if (options->gc_threshold != 0) {
+        njs_mp_gc_enable(mp);
+    }
+
     vm = njs_mp_zalign(mp, sizeof(njs_value_t), sizeof(njs_vm_t));
     if (njs_slow_path(vm == NULL)) {
         return NULL;
     }
 
     vm->mem_pool = mp;
+    vm->cache_epoch = ++njs_vm_cache_epoch;
+    njs_vm_global_changed(vm);
 
     ret = njs_regexp_init(vm);
     if (njs_slow_path(ret != NJS_OK)) {
@@ -54,6 +74,7 @@ njs_vm_create(njs_vm_opt_t *options)
     njs_lvlhsh_init(&vm->values_hash);
 
     vm->options = *options;
+    vm->gc_limit = options->gc_threshold;
 
     if (options->shared != NULL) {
         vm->shared = options->shared;
@@ -99,6 +120,15 @@ njs_vm_create(njs_vm_opt_t *options)
 
 void
 njs_vm_destroy(njs_vm_t *vm)
+{
+    njs_vm_release_events(vm);
+
+    njs_mp_destroy(vm->mem_pool);
+}
+
+
+static void
+njs_vm_release_events(njs_vm_t *vm)
 {
     njs_event_t        *event;
     njs_lvlhsh_each_t  lhe;
@@ -116,8 +146,6 @@ njs_vm_destroy(njs_vm_t *vm)
             njs_del_event(vm, event, NJS_EVENT_RELEASE);
         }
     }
-
-    njs_mp_destroy(vm->mem_pool);
 }
 
 
@@ -211,6 +239,63 @@ fail:
 }
 
 
+njs_int_t
+njs_vm_compile_save(njs_vm_t *vm, u_char **start, u_char *end,
+    njs_str_t *bytecode)
+{
+    njs_int_t  ret;
+    njs_str_t  source;
+
+    source.start = *start;
+    source.length = end - *start;
+
+    ret = njs_vm_compile(vm, start, end);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    return njs_bytecode_save(vm, &source, bytecode);
+}
+
+
+njs_int_t
+njs_vm_compile_load(njs_vm_t *vm, u_char **start, u_char *end,
+    const njs_str_t *bytecode)
+{
+    njs_int_t  ret;
+    njs_str_t  source;
+
+    if (vm->start != NULL || vm->parser != NULL) {
+        return NJS_DECLINED;
+    }
+
+    source.start = *start;
+    source.length = end - *start;
+
+    ret = njs_bytecode_load(vm, &source, bytecode);
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
+    *start = end;
+
+    njs_set_undefined(&vm->retval);
+
+    if (vm->options.init) {
+        ret = njs_vm_init(vm);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+    }
+
+    if (vm->options.disassemble) {
+        njs_disassembler(vm);
+    }
+
+    return NJS_OK;
+}
+
+
 njs_vm_t *
 njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
 {
@@ -224,34 +309,166 @@ njs_vm_clone(njs_vm_t *vm, njs_external_ptr_t external)
         return NULL;
     }
 
-    nmp = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (vm->options.arena) {
+        nmp = njs_mp_arena_create(8 * njs_pagesize());
+
+    } else {
+        nmp = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    }
+
     if (njs_slow_path(nmp == NULL)) {
         return NULL;
     }
 
+    if (vm->options.gc_threshold != 0) {
+        njs_mp_gc_enable(nmp);
+    }
+
     nvm = njs_mp_align(nmp, sizeof(njs_value_t), sizeof(njs_vm_t));
     if (njs_slow_path(nvm == NULL)) {
         goto fail;
     }
 
+    ret = njs_vm_clone_init(nvm, vm, nmp, external);
+    if (njs_slow_path(ret != NJS_OK)) {
+        goto fail;
+    }
+
+    return nvm;
+
+fail:
+
+    njs_mp_destroy(nmp);
+
+    return NULL;
+}
+
+
+njs_int_t
+njs_vm_reset(njs_vm_t *vm, njs_external_ptr_t external)
+{
+    size_t    size;
+    njs_mp_t  *mp;
+
+    njs_thread_log_debug("RESET:");
+
+    if (vm->parent == NULL) {
+        return NJS_ERROR;
+    }
+
+    njs_vm_release_events(vm);
+
+    /* Everything but the VM structure itself is freed. */
+
+    mp = vm->mem_pool;
+
+    if (vm->options.arena) {
+        /* The VM structure is the first allocation of the arena. */
+        njs_mp_rewind(mp, vm + 1);
+
+    } else {
+        (void) njs_mp_mark(mp, vm, &size);
+        njs_mp_reset(mp);
+    }
+
+    return njs_vm_clone_init(vm, vm->parent, mp, external);
+}
+
+
+static njs_int_t
+njs_vm_clone_init(njs_vm_t *nvm, njs_vm_t *vm, njs_mp_t *mp,
+    njs_external_ptr_t external)
+{
+    njs_int_t  ret;
+
     *nvm = *vm;
 
-    nvm->mem_pool = nmp;
+    nvm->parent = vm;
+    nvm->mem_pool = mp;
     nvm->trace.data = nvm;
     nvm->external = external;
 
+    nvm->cache_epoch = ++njs_vm_cache_epoch;
+    njs_vm_global_changed(nvm);
+    njs_memzero(&nvm->stat, sizeof(njs_vm_stat_t));
+    nvm->gc_limit = vm->options.gc_threshold;
+
     ret = njs_vm_init(nvm);
     if (njs_slow_path(ret != NJS_OK)) {
-        goto fail;
+        return NJS_ERROR;
     }
 
-    return nvm;
+    if (vm->snapshot != NULL) {
+        return njs_snapshot_restore(nvm, vm->snapshot);
+    }
 
-fail:
+    return NJS_OK;
+}
 
-    njs_mp_destroy(nmp);
 
-    return NULL;
+njs_int_t
+njs_vm_snapshot(njs_vm_t *vm)
+{
+    njs_vm_t   *svm, *nvm;
+    njs_int_t  ret;
+
+    if (vm->options.accumulative || vm->snapshot != NULL) {
+        return NJS_ERROR;
+    }
+
+    if (!njs_lvlhsh_is_empty(&vm->global_object.hash)) {
+        /* The snapshot VM would share the hash with the VM. */
+        return NJS_DECLINED;
+    }
+
+    /*
+     * The snapshot VM is allocated from the VM memory pool, so its heap
+     * lives as long as the VM and is never changed after the global code
+     * has been run.
+     */
+
+    svm = njs_mp_align(vm->mem_pool, sizeof(njs_value_t), sizeof(njs_vm_t));
+    if (njs_slow_path(svm == NULL)) {
+        return NJS_ERROR;
+    }
+
+    *svm = *vm;
+
+    svm->trace.data = svm;
+    svm->cache_epoch = ++njs_vm_cache_epoch;
+    njs_vm_global_changed(svm);
+
+    ret = njs_vm_init(svm);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_vm_start(svm);
+    if (njs_slow_path(ret != NJS_OK)) {
+        vm->retval = svm->retval;
+        return NJS_ERROR;
+    }
+
+    if (njs_waiting_events(svm)
+        || njs_posted_events(svm)
+        || njs_promise_events(svm))
+    {
+        return NJS_DECLINED;
+    }
+
+    vm->snapshot = svm;
+
+    /* A trial clone checks that the snapshot heap can be copied. */
+
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        vm->snapshot = NULL;
+        return NJS_DECLINED;
+    }
+
+    njs_vm_destroy(nvm);
+
+    return NJS_OK;
 }
 
 
@@ -302,6 +519,11 @@ njs_vm_init(njs_vm_t *vm)
         return NJS_ERROR;
     }
 
+    vm->shape_root = njs_mp_zalloc(vm->mem_pool, sizeof(njs_object_shape_t));
+    if (njs_slow_path(vm->shape_root == NULL)) {
+        return NJS_ERROR;
+    }
+
     njs_lvlhsh_init(&vm->modules_hash);
 
     njs_lvlhsh_init(&vm->events_hash);
@@ -442,6 +664,49 @@ njs_vm_posted(njs_vm_t *vm)
 }
 
 
+void
+njs_vm_stat(njs_vm_t *vm, njs_vm_stat_t *stat)
+{
+    *stat = vm->stat;
+    stat->heap_size = njs_mp_size(vm->mem_pool);
+}
+
+
+njs_int_t
+njs_vm_gc(njs_vm_t *vm, const njs_value_t *roots, njs_uint_t nroots)
+{
+    size_t     freed;
+    njs_int_t  ret;
+
+    if (vm->options.gc_threshold == 0
+        || (vm->options.arena && vm->parent != NULL)
+        || njs_mp_size(vm->mem_pool) < vm->gc_limit)
+    {
+        return NJS_DECLINED;
+    }
+
+    ret = njs_gc(vm, roots, nroots, &freed);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    /*
+     * The property caches in the bytecode are not scanned, freed objects
+     * and shapes may be reallocated at the same addresses.
+     */
+    vm->cache_epoch = ++njs_vm_cache_epoch;
+    njs_vm_global_changed(vm);
+
+    vm->stat.gc_runs++;
+    vm->stat.gc_freed += freed;
+
+    vm->gc_limit = njs_max(vm->options.gc_threshold,
+                           2 * njs_mp_size(vm->mem_pool));
+
+    return NJS_OK;
+}
+
+
 njs_int_t
 njs_vm_post_event(njs_vm_t *vm, njs_vm_event_t vm_event,
     const njs_value_t *args, njs_uint_t nargs)
@@ -481,6 +746,11 @@ njs_vm_start(njs_vm_t *vm)
 {
     njs_int_t  ret;
 
+    if (vm->snapshot != NULL) {
+        /* The global code has been run by njs_vm_snapshot(). */
+        return NJS_OK;
+    }
+
     ret = njs_module_load(vm);
     if (njs_slow_path(ret != NJS_OK)) {
         return ret;
@@ -666,10 +936,24 @@ njs_vm_bind(njs_vm_t *vm, const njs_str_t *var_name, const njs_value_t *value,
         return ret;
     }
 
+    njs_vm_global_changed(vm);
+
     return NJS_OK;
 }
 
 
+/*
+ * The global epoch is drawn from the same counter as the cache epoch,
+ * so it is unique among all VMs and changes of the global object.
+ */
+
+void
+njs_vm_global_changed(njs_vm_t *vm)
+{
+    vm->global_epoch = ++njs_vm_cache_epoch;
+}
+
+
 void
 njs_value_string_get(njs_value_t *value, njs_str_t *dst)
 {
@@ -692,6 +976,41 @@ njs_vm_value_string_alloc(njs_vm_t *vm, njs_value_t *value, uint32_t size)
 }
 
 
+njs_int_t
+njs_vm_value_string_create(njs_vm_t *vm, njs_value_t *value,
+    const u_char *start, uint32_t size)
+{
+    ssize_t  length;
+
+    length = njs_utf8_length(start, size);
+    if (length < 0) {
+        length = 0;
+    }
+
+    return njs_string_new(vm, value, start, size, length);
+}
+
+
+njs_int_t
+njs_vm_value_array_buffer_set(njs_vm_t *vm, njs_value_t *value,
+    const u_char *start, uint32_t size)
+{
+    njs_array_buffer_t  *array;
+
+    array = njs_array_buffer_alloc(vm, 0);
+    if (njs_slow_path(array == NULL)) {
+        return NJS_ERROR;
+    }
+
+    array->u.data = (u_char *) start;
+    array->size = size;
+
+    njs_set_array_buffer(value, array);
+
+    return NJS_OK;
+}
+
+
 njs_function_t *
 njs_vm_function(njs_vm_t *vm, const njs_str_t *path)
 {
@@ -707,6 +1026,137 @@ njs_vm_function(njs_vm_t *vm, const njs_str_t *path)
 }
 
 
+njs_function_handle_t *
+njs_vm_function_handle(njs_vm_t *vm, const njs_str_t *path)
+{
+    u_char                 *start, *p, *end;
+    size_t                 size;
+    njs_int_t              ret;
+    njs_str_t              name;
+    njs_uint_t             n;
+    njs_function_handle_t  *handle;
+
+    start = path->start;
+    end = start + path->length;
+
+    n = 1;
+
+    for (p = start; p < end; p++) {
+        if (*p == '.') {
+            n++;
+        }
+    }
+
+    handle = njs_mp_alloc(vm->mem_pool, sizeof(njs_function_handle_t)
+                                        + n * sizeof(njs_value_t));
+    if (njs_slow_path(handle == NULL)) {
+        njs_memory_error(vm);
+        return NULL;
+    }
+
+    handle->nkeys = n;
+
+    for (n = 0; n < handle->nkeys; n++) {
+        p = njs_strlchr(start, end, '.');
+
+        size = ((p != NULL) ? p : end) - start;
+        if (njs_slow_path(size == 0)) {
+            njs_type_error(vm, "empty path element");
+            return NULL;
+        }
+
+        ret = njs_string_new(vm, &handle->keys[n], start, size, 0);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NULL;
+        }
+
+        start = p + 1;
+    }
+
+    njs_string_get(&handle->keys[0], &name);
+
+    handle->index = njs_vm_global_index(vm, &name);
+
+    return handle;
+}
+
+
+njs_function_t *
+njs_vm_handle_function(njs_vm_t *vm, const njs_function_handle_t *handle)
+{
+    njs_int_t    ret;
+    njs_uint_t   n;
+    njs_value_t  value, retval;
+
+    if (handle->index != NJS_INDEX_NONE) {
+        value = *njs_vmcode_operand(vm, handle->index);
+        n = 1;
+
+    } else {
+        njs_set_object(&value, &vm->global_object);
+        n = 0;
+    }
+
+    for ( /* void */ ; n < handle->nkeys; n++) {
+        if (njs_slow_path(!njs_is_valid(&value))) {
+            return NULL;
+        }
+
+        ret = njs_value_property(vm, &value,
+                                 njs_value_arg(&handle->keys[n]), &retval);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NULL;
+        }
+
+        value = retval;
+    }
+
+    if (njs_slow_path(!njs_is_function(&value))) {
+        return NULL;
+    }
+
+    return njs_function(&value);
+}
+
+
+/*
+ * The global variables of a script are not properties of the global
+ * object, they are looked up by the name as njs_global_this_prop_handler()
+ * does.  NJS_INDEX_NONE is returned for an undeclared name.
+ */
+
+static njs_index_t
+njs_vm_global_index(njs_vm_t *vm, const njs_str_t *name)
+{
+    njs_int_t            ret;
+    njs_rbtree_node_t    *rb_node;
+    njs_lvlhsh_query_t   lhq;
+    njs_variable_node_t  var_node;
+
+    if (vm->variables_hash == NULL) {
+        return NJS_INDEX_NONE;
+    }
+
+    lhq.key = *name;
+    lhq.key_hash = njs_djb_hash(lhq.key.start, lhq.key.length);
+    lhq.proto = &njs_lexer_hash_proto;
+
+    ret = njs_lvlhsh_find(&vm->shared->keywords_hash, &lhq);
+    if (ret != NJS_OK || lhq.value == NULL) {
+        return NJS_INDEX_NONE;
+    }
+
+    var_node.key = (uintptr_t) lhq.value;
+
+    rb_node = njs_rbtree_find(vm->variables_hash, &var_node.node);
+    if (rb_node == NULL) {
+        return NJS_INDEX_NONE;
+    }
+
+    return ((njs_variable_node_t *) rb_node)->variable->index;
+}
+
+
 uint16_t
 njs_vm_prop_magic16(njs_object_prop_t *prop)
 {
@@ -91,9 +91,13 @@ typedef enum {
     NJS_OBJ_TYPE_DATE,
     NJS_OBJ_TYPE_PROMISE,
     NJS_OBJ_TYPE_ARRAY_BUFFER,
+    NJS_OBJ_TYPE_MAP,
+    NJS_OBJ_TYPE_SET,
 
+    NJS_OBJ_TYPE_MAP_ITERATOR,
+#define NJS_OBJ_TYPE_HIDDEN_MIN    (NJS_OBJ_TYPE_MAP_ITERATOR)
+    NJS_OBJ_TYPE_SET_ITERATOR,
     NJS_OBJ_TYPE_CRYPTO_HASH,
-#define NJS_OBJ_TYPE_HIDDEN_MIN    (NJS_OBJ_TYPE_CRYPTO_HASH)
     NJS_OBJ_TYPE_CRYPTO_HMAC,
     NJS_OBJ_TYPE_TYPED_ARRAY,
 #define NJS_OBJ_TYPE_HIDDEN_MAX    (NJS_OBJ_TYPE_TYPED_ARRAY + 1)
@@ -243,6 +247,32 @@ struct njs_vm_s {
     njs_arr_t                *debug;
 
     uint64_t                 symbol_generator;
+
+    /* A unique VM instance id, see njs_property_cache_t. */
+    uintptr_t                cache_epoch;
+
+    /*
+     * Changes when a property of the global object may be replaced,
+     * validates global references cached by NJS_VMCODE_GLOBAL_GET.
+     */
+    uintptr_t                global_epoch;
+
+    njs_vm_stat_t            stat;
+
+    /* The empty shape of ordinary objects, see njs_shape.h. */
+    njs_object_shape_t       *shape_root;
+
+    /* The VM which has been cloned, see njs_vm_reset(). */
+    njs_vm_t                 *parent;
+
+    /* The VM which has run the global code, see njs_snapshot.h. */
+    njs_vm_t                 *snapshot;
+
+    /* The sampling profiler, inherited by clones, see njs_profiler.h. */
+    njs_profiler_t           *profiler;
+
+    /* The heap size which triggers the next collection, see njs_gc.h. */
+    size_t                   gc_limit;
 };
 
 
@@ -251,6 +281,8 @@ typedef struct {
     u_char                   *end;
     njs_str_t                file;
     njs_str_t                name;
+    /* The number of generated instructions, 0 if the code is loaded. */
+    njs_uint_t               generated;
 } njs_vm_code_t;
 
 
@@ -292,6 +324,8 @@ njs_int_t njs_vm_add_backtrace_entry(njs_vm_t *vm, njs_arr_t *stack,
 njs_int_t njs_vm_backtrace_to_string(njs_vm_t *vm, njs_arr_t *stack,
     njs_str_t *dst);
 
+void njs_vm_global_changed(njs_vm_t *vm);
+
 njs_int_t njs_builtin_objects_create(njs_vm_t *vm);
 njs_int_t njs_builtin_objects_clone(njs_vm_t *vm, njs_value_t *global);
 njs_int_t njs_builtin_match_native_function(njs_vm_t *vm,
@@ -51,6 +51,12 @@ static njs_jump_off_t njs_vmcode_finally(njs_vm_t *vm, njs_value_t *invld,
     njs_value_t *retval, u_char *pc);
 static void njs_vmcode_reference_error(njs_vm_t *vm, u_char *pc);
 
+static njs_value_t *njs_property_cache_update(njs_vm_t *vm,
+    njs_property_cache_t *cache, njs_value_t *value, njs_value_t *key,
+    njs_uint_t query);
+static njs_value_t *njs_global_cache_update(njs_vm_t *vm,
+    njs_property_cache_t *cache, njs_value_t *global, njs_value_t *key);
+
 /*
  * These functions are forbidden to inline to minimize JavaScript VM
  * interpreter memory footprint.  The size is less than 8K on AMD64
@@ -67,23 +73,148 @@ static njs_jump_off_t njs_function_frame_create(njs_vm_t *vm,
     njs_value_t *value, const njs_value_t *this, uintptr_t nargs,
     njs_bool_t ctor);
 
+njs_inline njs_value_t *
+njs_property_cache_find(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_value_t *value, njs_uint_t query)
+{
+    void               *owner;
+    njs_uint_t         i;
+    njs_object_t       *object;
+    njs_object_prop_t  *prop;
+
+    if (value->type != NJS_OBJECT) {
+        return NULL;
+    }
+
+    object = njs_object(value);
+    owner = (object->shape != NULL) ? (void *) object->shape : object;
+
+    for (i = 0; i < NJS_PROPERTY_CACHE_SIZE; i++) {
+        if (cache[i].owner == owner && cache[i].epoch == vm->cache_epoch) {
+            if (object->shape != NULL) {
+                return &object->values[cache[i].u.slot];
+            }
+
+            prop = cache[i].u.prop;
+
+            /* A deleted property or a redefined accessor. */
+
+            if (njs_fast_path(prop->type == NJS_PROPERTY
+                              && njs_is_data_descriptor(prop)
+                              && (query == NJS_PROPERTY_QUERY_GET
+                                  || prop->writable)))
+            {
+                return &prop->value;
+            }
+
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+njs_inline njs_value_t *
+njs_global_cache_find(njs_vm_t *vm, njs_property_cache_t *cache)
+{
+    njs_object_prop_t  *prop;
+
+    if (cache[0].epoch != vm->global_epoch) {
+        return NULL;
+    }
+
+    prop = cache[0].u.prop;
+
+    /* A deleted global or a redefined accessor. */
+
+    if (njs_fast_path(prop->type == NJS_PROPERTY
+                      && njs_is_data_descriptor(prop)))
+    {
+        return &prop->value;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Elements of fast arrays at integer number keys are accessed
+ * directly bypassing the property cache and the generic lookup.
+ */
+
+njs_inline njs_value_t *
+njs_vmcode_fast_element(njs_value_t *value, njs_value_t *key)
+{
+    double       num;
+    uint32_t     index;
+    njs_array_t  *array;
+
+    if (!njs_is_number(key) || !njs_is_fast_array(value)) {
+        return NULL;
+    }
+
+    num = njs_number(key);
+
+    if (njs_slow_path(!njs_number_is_integer_index(num))) {
+        return NULL;
+    }
+
+    index = (uint32_t) num;
+    array = njs_array(value);
+
+    if (njs_slow_path(index >= array->length)) {
+        return NULL;
+    }
+
+    return &array->start[index];
+}
+
+
 /*
  * The nJSVM is optimized for an ABIs where the first several arguments
  * are passed in registers (AMD64, ARM32/64): two pointers to the operand
  * values is passed as arguments although they are not always used.
+ *
+ * Each operation decodes only the operands it uses and dispatches to
+ * the next operation itself.  If the compiler supports labels as values
+ * every operation ends with its own indirect jump through the dispatch
+ * table ("direct threading"), this gives the CPU branch predictor a
+ * separate history for each operation.  Otherwise a single "switch"
+ * statement is used.
  */
 
+#if (NJS_HAVE_COMPUTED_GOTO)
+
+#define SWITCH(op)      goto *switch_tbl[(uint8_t) op];
+#define CASE(op)        case_ ## op
+#define NJS_GOTO_ROW(op)  [ op ] = &&case_ ## op
+
+#define NEXT                                                                  \
+    vmcode = (njs_vmcode_generic_t *) pc;                                     \
+    op = vmcode->code.operation;                                              \
+    SWITCH (op)
+
+#else
+
+#define SWITCH(op)      switch (op)
+#define CASE(op)        case op
+#define NEXT            goto next
+
+#endif
+
+
 njs_int_t
 njs_vmcode_interpreter(njs_vm_t *vm, u_char *pc)
 {
     u_char                       *catch;
-    double                       num, exponent;
+    double                       num, num2, exponent;
     int32_t                      i32;
     uint32_t                     u32;
     njs_str_t                    string;
     njs_uint_t                   hint;
     njs_bool_t                   valid, lambda_call;
-    njs_value_t                  *retval, *value1, *value2;
+    njs_value_t                  *retval, *value1, *value2, *cached;
     njs_value_t                  *src, *s1, *s2, dst;
     njs_value_t                  *function, name;
     njs_value_t                  numeric1, numeric2, primitive1, primitive2;
@@ -98,807 +229,1173 @@ njs_vmcode_interpreter(njs_vm_t *vm, u_char *pc)
     njs_vmcode_operation_t       op;
     njs_vmcode_prop_next_t       *pnext;
     njs_vmcode_test_jump_t       *test_jump;
+    njs_vmcode_cond_jump_t       *cond_jump;
     njs_vmcode_equal_jump_t      *equal;
     njs_vmcode_try_return_t      *try_return;
     njs_vmcode_method_frame_t    *method_frame;
     njs_vmcode_prop_accessor_t   *accessor;
     njs_vmcode_function_frame_t  *function_frame;
 
+#if (NJS_HAVE_COMPUTED_GOTO)
+    static const void * const  switch_tbl[256] = {
+
+        NJS_GOTO_ROW(NJS_VMCODE_STOP),
+        NJS_GOTO_ROW(NJS_VMCODE_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_SET),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_ACCESSOR),
+        NJS_GOTO_ROW(NJS_VMCODE_IF_TRUE_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_IF_FALSE_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_IF_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_INIT),
+        NJS_GOTO_ROW(NJS_VMCODE_RETURN),
+        NJS_GOTO_ROW(NJS_VMCODE_FUNCTION_FRAME),
+        NJS_GOTO_ROW(NJS_VMCODE_METHOD_FRAME),
+        NJS_GOTO_ROW(NJS_VMCODE_FUNCTION_CALL),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_NEXT),
+        NJS_GOTO_ROW(NJS_VMCODE_THIS),
+        NJS_GOTO_ROW(NJS_VMCODE_ARGUMENTS),
+        NJS_GOTO_ROW(NJS_VMCODE_PROTO_INIT),
+        NJS_GOTO_ROW(NJS_VMCODE_TRY_START),
+        NJS_GOTO_ROW(NJS_VMCODE_THROW),
+        NJS_GOTO_ROW(NJS_VMCODE_TRY_BREAK),
+        NJS_GOTO_ROW(NJS_VMCODE_TRY_CONTINUE),
+        NJS_GOTO_ROW(NJS_VMCODE_TRY_END),
+        NJS_GOTO_ROW(NJS_VMCODE_CATCH),
+        NJS_GOTO_ROW(NJS_VMCODE_FINALLY),
+        NJS_GOTO_ROW(NJS_VMCODE_REFERENCE_ERROR),
+
+        NJS_GOTO_ROW(NJS_VMCODE_MOVE),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_GET),
+        NJS_GOTO_ROW(NJS_VMCODE_INCREMENT),
+        NJS_GOTO_ROW(NJS_VMCODE_POST_INCREMENT),
+        NJS_GOTO_ROW(NJS_VMCODE_DECREMENT),
+        NJS_GOTO_ROW(NJS_VMCODE_POST_DECREMENT),
+        NJS_GOTO_ROW(NJS_VMCODE_TRY_RETURN),
+        NJS_GOTO_ROW(NJS_VMCODE_GLOBAL_GET),
+        NJS_GOTO_ROW(NJS_VMCODE_LESS),
+        NJS_GOTO_ROW(NJS_VMCODE_GREATER),
+        NJS_GOTO_ROW(NJS_VMCODE_LESS_OR_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_GREATER_OR_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_ADDITION),
+        NJS_GOTO_ROW(NJS_VMCODE_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_NOT_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_SUBSTRACTION),
+        NJS_GOTO_ROW(NJS_VMCODE_MULTIPLICATION),
+        NJS_GOTO_ROW(NJS_VMCODE_EXPONENTIATION),
+        NJS_GOTO_ROW(NJS_VMCODE_DIVISION),
+        NJS_GOTO_ROW(NJS_VMCODE_REMAINDER),
+        NJS_GOTO_ROW(NJS_VMCODE_BITWISE_AND),
+        NJS_GOTO_ROW(NJS_VMCODE_BITWISE_OR),
+        NJS_GOTO_ROW(NJS_VMCODE_BITWISE_XOR),
+        NJS_GOTO_ROW(NJS_VMCODE_LEFT_SHIFT),
+        NJS_GOTO_ROW(NJS_VMCODE_RIGHT_SHIFT),
+        NJS_GOTO_ROW(NJS_VMCODE_UNSIGNED_RIGHT_SHIFT),
+        NJS_GOTO_ROW(NJS_VMCODE_OBJECT_COPY),
+        NJS_GOTO_ROW(NJS_VMCODE_TEMPLATE_LITERAL),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_IN),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_DELETE),
+        NJS_GOTO_ROW(NJS_VMCODE_PROPERTY_FOREACH),
+        NJS_GOTO_ROW(NJS_VMCODE_STRICT_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_STRICT_NOT_EQUAL),
+        NJS_GOTO_ROW(NJS_VMCODE_TEST_IF_TRUE),
+        NJS_GOTO_ROW(NJS_VMCODE_TEST_IF_FALSE),
+        NJS_GOTO_ROW(NJS_VMCODE_COALESCE),
+        NJS_GOTO_ROW(NJS_VMCODE_UNARY_PLUS),
+        NJS_GOTO_ROW(NJS_VMCODE_UNARY_NEGATION),
+        NJS_GOTO_ROW(NJS_VMCODE_BITWISE_NOT),
+        NJS_GOTO_ROW(NJS_VMCODE_LOGICAL_NOT),
+        NJS_GOTO_ROW(NJS_VMCODE_OBJECT),
+        NJS_GOTO_ROW(NJS_VMCODE_ARRAY),
+        NJS_GOTO_ROW(NJS_VMCODE_FUNCTION),
+        NJS_GOTO_ROW(NJS_VMCODE_REGEXP),
+        NJS_GOTO_ROW(NJS_VMCODE_INSTANCE_OF),
+        NJS_GOTO_ROW(NJS_VMCODE_TYPEOF),
+        NJS_GOTO_ROW(NJS_VMCODE_VOID),
+        NJS_GOTO_ROW(NJS_VMCODE_DELETE),
+        NJS_GOTO_ROW(NJS_VMCODE_LESS_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_GREATER_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_LESS_OR_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_GREATER_OR_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_NOT_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_STRICT_EQUAL_JUMP),
+        NJS_GOTO_ROW(NJS_VMCODE_STRICT_NOT_EQUAL_JUMP),
+    };
+#endif
+
+#if !(NJS_HAVE_COMPUTED_GOTO)
 next:
+#endif
 
-    for ( ;; ) {
+    vmcode = (njs_vmcode_generic_t *) pc;
+    op = vmcode->code.operation;
+
+    /*
+     * On success an operation returns size of the bytecode,
+     * a jump offset or zero after the call or return operations.
+     * Jumps can return a negative offset.  Compilers can generate
+     *    (ret < 0 && ret >= NJS_PREEMPT)
+     * as a single unsigned comparision.
+     */
 
-        vmcode = (njs_vmcode_generic_t *) pc;
+    SWITCH (op) {
 
-        /*
-         * The first operand is passed as is in value2 to
-         *   NJS_VMCODE_JUMP,
-         *   NJS_VMCODE_IF_TRUE_JUMP,
-         *   NJS_VMCODE_IF_FALSE_JUMP,
-         *   NJS_VMCODE_FUNCTION_FRAME,
-         *   NJS_VMCODE_FUNCTION_CALL,
-         *   NJS_VMCODE_RETURN,
-         *   NJS_VMCODE_TRY_START,
-         *   NJS_VMCODE_TRY_CONTINUE,
-         *   NJS_VMCODE_TRY_BREAK,
-         *   NJS_VMCODE_TRY_END,
-         *   NJS_VMCODE_CATCH,
-         *   NJS_VMCODE_THROW,
-         *   NJS_VMCODE_STOP.
-         */
-        value2 = (njs_value_t *) vmcode->operand1;
-        value1 = NULL;
+    CASE (NJS_VMCODE_MOVE):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = *value1;
 
-        switch (vmcode->code.operands) {
+        pc += sizeof(njs_vmcode_move_t);
+        NEXT;
 
-        case NJS_VMCODE_3OPERANDS:
-            value2 = njs_vmcode_operand(vm, vmcode->operand3);
+    CASE (NJS_VMCODE_PROPERTY_GET):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-            /* Fall through. */
+        get = (njs_vmcode_prop_get_t *) pc;
+        retval = njs_vmcode_operand(vm, get->value);
+
+        cached = njs_vmcode_fast_element(value1, value2);
 
-        case NJS_VMCODE_2OPERANDS:
-            value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        if (cached != NULL && njs_is_valid(cached)) {
+            *retval = *cached;
+
+            pc += sizeof(njs_vmcode_prop_get_t);
+            NEXT;
         }
 
-        op = vmcode->code.operation;
+        cached = njs_property_cache_find(vm, get->cache, value1,
+                                         NJS_PROPERTY_QUERY_GET);
 
-        /*
-         * On success an operation returns size of the bytecode,
-         * a jump offset or zero after the call or return operations.
-         * Jumps can return a negative offset.  Compilers can generate
-         *    (ret < 0 && ret >= NJS_PREEMPT)
-         * as a single unsigned comparision.
-         */
+        if (njs_fast_path(cached != NULL)) {
+            vm->stat.property_cache_hits++;
+
+            *retval = *cached;
+
+            pc += sizeof(njs_vmcode_prop_get_t);
+            NEXT;
+        }
 
-        if (op > NJS_VMCODE_NORET) {
+        vm->stat.property_cache_misses++;
 
-            if (op == NJS_VMCODE_MOVE) {
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                *retval = *value1;
+        if (njs_scope_type(get->property) == NJS_SCOPE_ABSOLUTE) {
+            cached = njs_property_cache_update(vm, get->cache, value1, value2,
+                                               NJS_PROPERTY_QUERY_GET);
+            if (cached != NULL) {
+                *retval = *cached;
 
-                pc += sizeof(njs_vmcode_move_t);
-                goto next;
+                pc += sizeof(njs_vmcode_prop_get_t);
+                NEXT;
             }
+        }
 
-            if (op == NJS_VMCODE_PROPERTY_GET) {
-                get = (njs_vmcode_prop_get_t *) pc;
-                retval = njs_vmcode_operand(vm, get->value);
+        ret = njs_value_property(vm, value1, value2, retval);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-                ret = njs_value_property(vm, value1, value2, retval);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        pc += sizeof(njs_vmcode_prop_get_t);
+        NEXT;
 
-                pc += sizeof(njs_vmcode_prop_get_t);
-                goto next;
+    CASE (NJS_VMCODE_INCREMENT):
+    CASE (NJS_VMCODE_POST_INCREMENT):
+    CASE (NJS_VMCODE_DECREMENT):
+    CASE (NJS_VMCODE_POST_DECREMENT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        if (njs_slow_path(!njs_is_numeric(value2))) {
+            ret = njs_value_to_numeric(vm, value2, &numeric1);
+            if (njs_slow_path(ret != NJS_OK)) {
+                goto error;
             }
 
-            switch (op) {
-            case NJS_VMCODE_INCREMENT:
-            case NJS_VMCODE_POST_INCREMENT:
-            case NJS_VMCODE_DECREMENT:
-            case NJS_VMCODE_POST_DECREMENT:
-                if (njs_slow_path(!njs_is_numeric(value2))) {
-                    ret = njs_value_to_numeric(vm, value2, &numeric1);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        goto error;
-                    }
-
-                    num = njs_number(&numeric1);
+            num = njs_number(&numeric1);
 
-                } else {
-                    num = njs_number(value2);
-                }
+        } else {
+            num = njs_number(value2);
+        }
 
-                njs_set_number(value1,
-                           num + (1 - 2 * ((op - NJS_VMCODE_INCREMENT) >> 1)));
+        njs_set_number(value1,
+                       num + (1 - 2 * ((op - NJS_VMCODE_INCREMENT) >> 1)));
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
 
-                if (op & 1) {
-                    njs_set_number(retval, num);
+        if (op & 1) {
+            njs_set_number(retval, num);
 
-                } else {
-                    *retval = *value1;
-                }
+        } else {
+            *retval = *value1;
+        }
 
-                pc += sizeof(njs_vmcode_3addr_t);
-                goto next;
+        pc += sizeof(njs_vmcode_3addr_t);
+        NEXT;
 
-            case NJS_VMCODE_GLOBAL_GET:
-                get = (njs_vmcode_prop_get_t *) pc;
-                retval = njs_vmcode_operand(vm, get->value);
+    CASE (NJS_VMCODE_GLOBAL_GET):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                ret = njs_value_property(vm, value1, value2, retval);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        get = (njs_vmcode_prop_get_t *) pc;
+        retval = njs_vmcode_operand(vm, get->value);
 
-                pc += sizeof(njs_vmcode_prop_get_t);
+        cached = njs_global_cache_find(vm, get->cache);
 
-                if (ret == NJS_OK) {
-                    pc += sizeof(njs_vmcode_reference_error_t);
-                }
+        if (njs_slow_path(cached == NULL)) {
+            cached = njs_global_cache_update(vm, get->cache, value1, value2);
+        }
 
-                goto next;
+        if (njs_fast_path(cached != NULL)) {
+            *retval = *cached;
 
-            /*
-             * njs_vmcode_try_return() saves a return value to use it later by
-             * njs_vmcode_finally(), and jumps to the nearest try_break block.
-             */
-            case NJS_VMCODE_TRY_RETURN:
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                *retval = *value1;
+            pc += sizeof(njs_vmcode_prop_get_t)
+                  + sizeof(njs_vmcode_reference_error_t);
+            NEXT;
+        }
+
+        ret = njs_value_property(vm, value1, value2, retval);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
+
+        pc += sizeof(njs_vmcode_prop_get_t);
 
-                try_return = (njs_vmcode_try_return_t *) pc;
-                pc += try_return->offset;
-                goto next;
+        if (ret == NJS_OK) {
+            pc += sizeof(njs_vmcode_reference_error_t);
+        }
+
+        NEXT;
+
+    /*
+     * njs_vmcode_try_return() saves a return value to use it later by
+     * njs_vmcode_finally(), and jumps to the nearest try_break block.
+     */
+    CASE (NJS_VMCODE_TRY_RETURN):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = *value1;
+
+        try_return = (njs_vmcode_try_return_t *) pc;
+        pc += try_return->offset;
+        NEXT;
+
+    CASE (NJS_VMCODE_LESS):
+    CASE (NJS_VMCODE_GREATER):
+    CASE (NJS_VMCODE_LESS_OR_EQUAL):
+    CASE (NJS_VMCODE_GREATER_OR_EQUAL):
+    CASE (NJS_VMCODE_ADDITION):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        if (njs_fast_path(njs_is_numeric(value1) && njs_is_numeric(value2))) {
+            num = njs_number(value1);
+            num2 = njs_number(value2);
+
+            retval = njs_vmcode_operand(vm, vmcode->operand1);
+            pc += sizeof(njs_vmcode_3addr_t);
 
+            switch (op) {
             case NJS_VMCODE_LESS:
+                njs_set_boolean(retval, num < num2);
+                break;
+
             case NJS_VMCODE_GREATER:
+                njs_set_boolean(retval, num > num2);
+                break;
+
             case NJS_VMCODE_LESS_OR_EQUAL:
+                njs_set_boolean(retval, num <= num2);
+                break;
+
             case NJS_VMCODE_GREATER_OR_EQUAL:
-            case NJS_VMCODE_ADDITION:
-                if (njs_slow_path(!njs_is_primitive(value1))) {
-                    hint = (op == NJS_VMCODE_ADDITION) && njs_is_date(value1);
-                    ret = njs_value_to_primitive(vm, &primitive1, value1, hint);
-                    if (ret != NJS_OK) {
-                        goto error;
-                    }
-
-                    value1 = &primitive1;
-                }
+                njs_set_boolean(retval, num >= num2);
+                break;
 
-                if (njs_slow_path(!njs_is_primitive(value2))) {
-                    hint = (op == NJS_VMCODE_ADDITION) && njs_is_date(value2);
-                    ret = njs_value_to_primitive(vm, &primitive2, value2, hint);
-                    if (ret != NJS_OK) {
-                        goto error;
-                    }
+            default: /* NJS_VMCODE_ADDITION */
+                njs_set_number(retval, num + num2);
+            }
 
-                    value2 = &primitive2;
-                }
+            NEXT;
+        }
 
-                if (njs_slow_path(njs_is_symbol(value1)
-                                  || njs_is_symbol(value2)))
-                {
-                    njs_symbol_conversion_failed(vm,
-                        (op == NJS_VMCODE_ADDITION) &&
-                        (njs_is_string(value1) || njs_is_string(value2)));
+    relational:
 
-                    goto error;
-                }
+        if (njs_slow_path(!njs_is_primitive(value1))) {
+            hint = (op == NJS_VMCODE_ADDITION) && njs_is_date(value1);
+            ret = njs_value_to_primitive(vm, &primitive1, value1, hint);
+            if (ret != NJS_OK) {
+                goto error;
+            }
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-
-                if (op == NJS_VMCODE_ADDITION) {
-                    if (njs_fast_path(njs_is_numeric(value1)
-                                      && njs_is_numeric(value2)))
-                    {
-                        njs_set_number(retval, njs_number(value1)
-                                               + njs_number(value2));
-                        pc += sizeof(njs_vmcode_3addr_t);
-                        goto next;
-                    }
-
-                    if (njs_is_string(value1)) {
-                        s1 = value1;
-                        s2 = &dst;
-                        src = value2;
-
-                    } else {
-                        s1 = &dst;
-                        s2 = value2;
-                        src = value1;
-                    }
-
-                    ret = njs_primitive_value_to_string(vm, &dst, src);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        goto error;
-                    }
-
-                    ret = njs_string_concat(vm, s1, s2);
-                    if (njs_slow_path(ret == NJS_ERROR)) {
-                        goto error;
-                    }
-
-                    *retval = vm->retval;
-
-                    pc += ret;
-                    goto next;
-                }
+            value1 = &primitive1;
+        }
 
-                if ((uint8_t) (op - NJS_VMCODE_GREATER) < 2) {
-                    /* NJS_VMCODE_GREATER, NJS_VMCODE_LESS_OR_EQUAL */
-                    src = value1;
-                    value1 = value2;
-                    value2 = src;
-                }
+        if (njs_slow_path(!njs_is_primitive(value2))) {
+            hint = (op == NJS_VMCODE_ADDITION) && njs_is_date(value2);
+            ret = njs_value_to_primitive(vm, &primitive2, value2, hint);
+            if (ret != NJS_OK) {
+                goto error;
+            }
 
-                ret = njs_primitive_values_compare(vm, value1, value2);
+            value2 = &primitive2;
+        }
 
-                if (op < NJS_VMCODE_LESS_OR_EQUAL) {
-                    ret = ret > 0;
+        if (njs_slow_path(njs_is_symbol(value1)
+                          || njs_is_symbol(value2)))
+        {
+            njs_symbol_conversion_failed(vm,
+                (op == NJS_VMCODE_ADDITION) &&
+                (njs_is_string(value1) || njs_is_string(value2)));
 
-                } else {
-                    ret = ret == 0;
-                }
+            goto error;
+        }
 
-                njs_set_boolean(retval, ret);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
 
+        if (op == NJS_VMCODE_ADDITION) {
+            if (njs_fast_path(njs_is_numeric(value1)
+                              && njs_is_numeric(value2)))
+            {
+                njs_set_number(retval, njs_number(value1)
+                                       + njs_number(value2));
                 pc += sizeof(njs_vmcode_3addr_t);
-                goto next;
+                NEXT;
+            }
 
-            case NJS_VMCODE_EQUAL:
-            case NJS_VMCODE_NOT_EQUAL:
-                ret = njs_values_equal(vm, value1, value2);
-                if (njs_slow_path(ret < 0)) {
-                    goto error;
-                }
+            if (njs_is_string(value1)) {
+                s1 = value1;
+                s2 = &dst;
+                src = value2;
 
-                ret ^= op - NJS_VMCODE_EQUAL;
+            } else {
+                s1 = &dst;
+                s2 = value2;
+                src = value1;
+            }
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                njs_set_boolean(retval, ret);
+            ret = njs_primitive_value_to_string(vm, &dst, src);
+            if (njs_slow_path(ret != NJS_OK)) {
+                goto error;
+            }
 
-                pc += sizeof(njs_vmcode_3addr_t);
-                goto next;
+            ret = njs_string_concat(vm, s1, s2);
+            if (njs_slow_path(ret == NJS_ERROR)) {
+                goto error;
+            }
 
-            case NJS_VMCODE_SUBSTRACTION:
-            case NJS_VMCODE_MULTIPLICATION:
-            case NJS_VMCODE_EXPONENTIATION:
-            case NJS_VMCODE_DIVISION:
-            case NJS_VMCODE_REMAINDER:
-            case NJS_VMCODE_BITWISE_AND:
-            case NJS_VMCODE_BITWISE_OR:
-            case NJS_VMCODE_BITWISE_XOR:
-            case NJS_VMCODE_LEFT_SHIFT:
-            case NJS_VMCODE_RIGHT_SHIFT:
-            case NJS_VMCODE_UNSIGNED_RIGHT_SHIFT:
-                if (njs_slow_path(!njs_is_numeric(value1))) {
-                    ret = njs_value_to_numeric(vm, value1, &numeric1);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        goto error;
-                    }
-
-                    value1 = &numeric1;
-                }
+            *retval = vm->retval;
 
-                if (njs_slow_path(!njs_is_numeric(value2))) {
-                    ret = njs_value_to_numeric(vm, value2, &numeric2);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        goto error;
-                    }
+            pc += ret;
+            NEXT;
+        }
 
-                    value2 = &numeric2;
-                }
+        if ((uint8_t) (op - NJS_VMCODE_GREATER) < 2) {
+            /* NJS_VMCODE_GREATER, NJS_VMCODE_LESS_OR_EQUAL */
+            src = value1;
+            value1 = value2;
+            value2 = src;
+        }
 
-                num = njs_number(value1);
+        ret = njs_primitive_values_compare(vm, value1, value2);
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                pc += sizeof(njs_vmcode_3addr_t);
+        if (op < NJS_VMCODE_LESS_OR_EQUAL) {
+            ret = ret > 0;
 
-                switch (op) {
-                case NJS_VMCODE_SUBSTRACTION:
-                    num -= njs_number(value2);
-                    break;
+        } else {
+            ret = ret == 0;
+        }
 
-                case NJS_VMCODE_MULTIPLICATION:
-                    num *= njs_number(value2);
-                    break;
+        njs_set_boolean(retval, ret);
 
-                case NJS_VMCODE_EXPONENTIATION:
-                    exponent = njs_number(value2);
+        pc += sizeof(njs_vmcode_3addr_t);
+        NEXT;
 
-                    /*
-                     * According to ES7:
-                     *  1. If exponent is NaN, the result should be NaN;
-                     *  2. The result of +/-1 ** +/-Infinity should be NaN.
-                     */
-                    valid = njs_expect(1, fabs(num) != 1
-                                          || (!isnan(exponent)
-                                              && !isinf(exponent)));
+    CASE (NJS_VMCODE_EQUAL):
+    CASE (NJS_VMCODE_NOT_EQUAL):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                    num = valid ? pow(num, exponent) : NAN;
-                    break;
+        if (njs_fast_path(njs_is_number(value1) && njs_is_number(value2))) {
+            ret = (njs_number(value1) == njs_number(value2));
 
-                case NJS_VMCODE_DIVISION:
-                    num /= njs_number(value2);
-                    break;
+        } else {
+            ret = njs_values_equal(vm, value1, value2);
+            if (njs_slow_path(ret < 0)) {
+                goto error;
+            }
+        }
 
-                case NJS_VMCODE_REMAINDER:
-                    num = fmod(num, njs_number(value2));
-                    break;
+        ret ^= op - NJS_VMCODE_EQUAL;
 
-                case NJS_VMCODE_BITWISE_AND:
-                case NJS_VMCODE_BITWISE_OR:
-                case NJS_VMCODE_BITWISE_XOR:
-                    i32 = njs_number_to_int32(njs_number(value2));
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_set_boolean(retval, ret);
 
-                    switch (op) {
-                    case NJS_VMCODE_BITWISE_AND:
-                        i32 &= njs_number_to_int32(num);
-                        break;
+        pc += sizeof(njs_vmcode_3addr_t);
+        NEXT;
 
-                    case NJS_VMCODE_BITWISE_OR:
-                        i32 |= njs_number_to_int32(num);
-                        break;
+    /*
+     * A compare-and-branch superinstruction stores the result and makes
+     * the jump of the conditional jump instruction following it.
+     * The relational comparisons of non-numeric values are made by
+     * the compare instruction, the jump instruction is executed then.
+     */
 
-                    case NJS_VMCODE_BITWISE_XOR:
-                        i32 ^= njs_number_to_int32(num);
-                        break;
-                    }
+    CASE (NJS_VMCODE_LESS_JUMP):
+    CASE (NJS_VMCODE_GREATER_JUMP):
+    CASE (NJS_VMCODE_LESS_OR_EQUAL_JUMP):
+    CASE (NJS_VMCODE_GREATER_OR_EQUAL_JUMP):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        if (njs_slow_path(!njs_is_numeric(value1)
+                          || !njs_is_numeric(value2)))
+        {
+            op -= NJS_VMCODE_LESS_JUMP - NJS_VMCODE_LESS;
+            goto relational;
+        }
 
-                    njs_set_int32(retval, i32);
-                    goto next;
+        num = njs_number(value1);
+        num2 = njs_number(value2);
 
-                default:
-                    u32 = njs_number_to_uint32(njs_number(value2)) & 0x1f;
+        switch (op) {
+        case NJS_VMCODE_LESS_JUMP:
+            ret = num < num2;
+            break;
 
-                    switch (op) {
-                    case NJS_VMCODE_LEFT_SHIFT:
-                    case NJS_VMCODE_RIGHT_SHIFT:
-                        i32 = njs_number_to_int32(num);
+        case NJS_VMCODE_GREATER_JUMP:
+            ret = num > num2;
+            break;
 
-                        if (op == NJS_VMCODE_LEFT_SHIFT) {
-                            /* Shifting of negative numbers is undefined. */
-                            i32 = (uint32_t) i32 << u32;
-                        } else {
-                            i32 >>= u32;
-                        }
+        case NJS_VMCODE_LESS_OR_EQUAL_JUMP:
+            ret = num <= num2;
+            break;
 
-                        njs_set_int32(retval, i32);
-                        break;
+        default: /* NJS_VMCODE_GREATER_OR_EQUAL_JUMP */
+            ret = num >= num2;
+        }
 
-                    default: /* NJS_VMCODE_UNSIGNED_RIGHT_SHIFT */
-                        njs_set_uint32(retval,
-                                       njs_number_to_uint32(num) >> u32);
-                    }
+        goto compare_jump;
 
-                    goto next;
-                }
+    CASE (NJS_VMCODE_EQUAL_JUMP):
+    CASE (NJS_VMCODE_NOT_EQUAL_JUMP):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                njs_set_number(retval, num);
-                goto next;
+        if (njs_fast_path(njs_is_number(value1) && njs_is_number(value2))) {
+            ret = (njs_number(value1) == njs_number(value2));
 
-            case NJS_VMCODE_OBJECT_COPY:
-                ret = njs_vmcode_object_copy(vm, value1, value2);
-                break;
+        } else {
+            ret = njs_values_equal(vm, value1, value2);
+            if (njs_slow_path(ret < 0)) {
+                goto error;
+            }
+        }
 
-            case NJS_VMCODE_TEMPLATE_LITERAL:
-                ret = njs_vmcode_template_literal(vm, value1, value2);
-                break;
+        ret ^= op - NJS_VMCODE_EQUAL_JUMP;
 
-            case NJS_VMCODE_PROPERTY_IN:
-                ret = njs_vmcode_property_in(vm, value1, value2);
-                break;
+        goto compare_jump;
 
-            case NJS_VMCODE_PROPERTY_DELETE:
-                ret = njs_value_property_delete(vm, value1, value2, NULL);
-                if (njs_fast_path(ret != NJS_ERROR)) {
-                    vm->retval = njs_value_true;
+    CASE (NJS_VMCODE_STRICT_EQUAL_JUMP):
+    CASE (NJS_VMCODE_STRICT_NOT_EQUAL_JUMP):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                    ret = sizeof(njs_vmcode_3addr_t);
-                }
+        ret = njs_values_strict_equal(value1, value2);
 
-                break;
+        ret ^= op - NJS_VMCODE_STRICT_EQUAL_JUMP;
 
-            case NJS_VMCODE_PROPERTY_FOREACH:
-                ret = njs_vmcode_property_foreach(vm, value1, value2, pc);
-                break;
+    compare_jump:
 
-            case NJS_VMCODE_STRICT_EQUAL:
-            case NJS_VMCODE_STRICT_NOT_EQUAL:
-                ret = njs_values_strict_equal(value1, value2);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_set_boolean(retval, ret);
 
-                ret ^= op - NJS_VMCODE_STRICT_EQUAL;
+        pc += sizeof(njs_vmcode_3addr_t);
+        cond_jump = (njs_vmcode_cond_jump_t *) pc;
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                njs_set_boolean(retval, ret);
+        ret ^= cond_jump->code.operation - NJS_VMCODE_IF_TRUE_JUMP;
 
-                pc += sizeof(njs_vmcode_3addr_t);
-                goto next;
+        ret = ret ? cond_jump->offset
+                  : (njs_jump_off_t) sizeof(njs_vmcode_cond_jump_t);
 
-            case NJS_VMCODE_TEST_IF_TRUE:
-            case NJS_VMCODE_TEST_IF_FALSE:
-            case NJS_VMCODE_COALESCE:
-                if (op == NJS_VMCODE_COALESCE) {
-                    ret = !njs_is_null_or_undefined(value1);
+        njs_profiler_poll_jump(vm, ret);
 
-                } else {
-                    ret = njs_is_true(value1);
-                    ret ^= op - NJS_VMCODE_TEST_IF_TRUE;
-                }
+        pc += ret;
+        NEXT;
+
+    CASE (NJS_VMCODE_SUBSTRACTION):
+    CASE (NJS_VMCODE_MULTIPLICATION):
+    CASE (NJS_VMCODE_EXPONENTIATION):
+    CASE (NJS_VMCODE_DIVISION):
+    CASE (NJS_VMCODE_REMAINDER):
+    CASE (NJS_VMCODE_BITWISE_AND):
+    CASE (NJS_VMCODE_BITWISE_OR):
+    CASE (NJS_VMCODE_BITWISE_XOR):
+    CASE (NJS_VMCODE_LEFT_SHIFT):
+    CASE (NJS_VMCODE_RIGHT_SHIFT):
+    CASE (NJS_VMCODE_UNSIGNED_RIGHT_SHIFT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        if (njs_slow_path(!njs_is_numeric(value1))) {
+            ret = njs_value_to_numeric(vm, value1, &numeric1);
+            if (njs_slow_path(ret != NJS_OK)) {
+                goto error;
+            }
 
-                if (ret) {
-                    test_jump = (njs_vmcode_test_jump_t *) pc;
-                    ret = test_jump->offset;
+            value1 = &numeric1;
+        }
 
-                } else {
-                    ret = sizeof(njs_vmcode_3addr_t);
-                }
+        if (njs_slow_path(!njs_is_numeric(value2))) {
+            ret = njs_value_to_numeric(vm, value2, &numeric2);
+            if (njs_slow_path(ret != NJS_OK)) {
+                goto error;
+            }
 
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                *retval = *value1;
+            value2 = &numeric2;
+        }
 
-                pc += ret;
-                goto next;
+        num = njs_number(value1);
 
-            case NJS_VMCODE_UNARY_PLUS:
-            case NJS_VMCODE_UNARY_NEGATION:
-            case NJS_VMCODE_BITWISE_NOT:
-                if (njs_slow_path(!njs_is_numeric(value1))) {
-                    ret = njs_value_to_numeric(vm, value1, &numeric1);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        goto error;
-                    }
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        pc += sizeof(njs_vmcode_3addr_t);
 
-                    value1 = &numeric1;
-                }
+        switch (op) {
+        case NJS_VMCODE_SUBSTRACTION:
+            num -= njs_number(value2);
+            break;
 
-                num = njs_number(value1);
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
+        case NJS_VMCODE_MULTIPLICATION:
+            num *= njs_number(value2);
+            break;
 
-                switch (op) {
-                case NJS_VMCODE_UNARY_NEGATION:
-                    num = -num;
+        case NJS_VMCODE_EXPONENTIATION:
+            exponent = njs_number(value2);
 
-                    /* Fall through. */
-                case NJS_VMCODE_UNARY_PLUS:
-                    njs_set_number(retval, num);
-                    break;
+            /*
+             * According to ES7:
+             *  1. If exponent is NaN, the result should be NaN;
+             *  2. The result of +/-1 ** +/-Infinity should be NaN.
+             */
+            valid = njs_expect(1, fabs(num) != 1
+                                  || (!isnan(exponent)
+                                      && !isinf(exponent)));
 
-                case NJS_VMCODE_BITWISE_NOT:
-                    njs_set_int32(retval, ~njs_number_to_uint32(num));
-                }
+            num = valid ? pow(num, exponent) : NAN;
+            break;
 
-                pc += sizeof(njs_vmcode_2addr_t);
-                goto next;
+        case NJS_VMCODE_DIVISION:
+            num /= njs_number(value2);
+            break;
 
-            case NJS_VMCODE_LOGICAL_NOT:
-                retval = njs_vmcode_operand(vm, vmcode->operand1);
-                njs_set_boolean(retval, !njs_is_true(value1));
+        case NJS_VMCODE_REMAINDER:
+            num = fmod(num, njs_number(value2));
+            break;
 
-                pc += sizeof(njs_vmcode_2addr_t);
-                goto next;
+        case NJS_VMCODE_BITWISE_AND:
+        case NJS_VMCODE_BITWISE_OR:
+        case NJS_VMCODE_BITWISE_XOR:
+            i32 = njs_number_to_int32(njs_number(value2));
 
-            case NJS_VMCODE_OBJECT:
-                ret = njs_vmcode_object(vm);
+            switch (op) {
+            case NJS_VMCODE_BITWISE_AND:
+                i32 &= njs_number_to_int32(num);
                 break;
 
-            case NJS_VMCODE_ARRAY:
-                ret = njs_vmcode_array(vm, pc);
+            case NJS_VMCODE_BITWISE_OR:
+                i32 |= njs_number_to_int32(num);
                 break;
 
-            case NJS_VMCODE_FUNCTION:
-                ret = njs_vmcode_function(vm, pc);
+            case NJS_VMCODE_BITWISE_XOR:
+                i32 ^= njs_number_to_int32(num);
                 break;
+            }
 
-            case NJS_VMCODE_REGEXP:
-                ret = njs_vmcode_regexp(vm, pc);
-                break;
+            njs_set_int32(retval, i32);
+            NEXT;
 
-            case NJS_VMCODE_INSTANCE_OF:
-                ret = njs_vmcode_instance_of(vm, value1, value2);
-                break;
+        default:
+            u32 = njs_number_to_uint32(njs_number(value2)) & 0x1f;
 
-            case NJS_VMCODE_TYPEOF:
-                ret = njs_vmcode_typeof(vm, value1, value2);
-                break;
+            switch (op) {
+            case NJS_VMCODE_LEFT_SHIFT:
+            case NJS_VMCODE_RIGHT_SHIFT:
+                i32 = njs_number_to_int32(num);
 
-            case NJS_VMCODE_VOID:
-                njs_set_undefined(&vm->retval);
+                if (op == NJS_VMCODE_LEFT_SHIFT) {
+                    /* Shifting of negative numbers is undefined. */
+                    i32 = (uint32_t) i32 << u32;
+                } else {
+                    i32 >>= u32;
+                }
 
-                ret = sizeof(njs_vmcode_2addr_t);
+                njs_set_int32(retval, i32);
                 break;
 
-            case NJS_VMCODE_DELETE:
-                njs_release(vm, value1);
-                vm->retval = njs_value_true;
+            default: /* NJS_VMCODE_UNSIGNED_RIGHT_SHIFT */
+                njs_set_uint32(retval,
+                               njs_number_to_uint32(num) >> u32);
+            }
 
-                ret = sizeof(njs_vmcode_2addr_t);
-                break;
+            NEXT;
+        }
+
+        njs_set_number(retval, num);
+        NEXT;
+
+    CASE (NJS_VMCODE_OBJECT_COPY):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
+
+        ret = njs_vmcode_object_copy(vm, value1, value2);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_TEMPLATE_LITERAL):
+        ret = njs_vmcode_template_literal(vm, NULL,
+                                          (njs_value_t *) vmcode->operand1);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_PROPERTY_IN):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        ret = njs_vmcode_property_in(vm, value1, value2);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_PROPERTY_DELETE):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        ret = njs_value_property_delete(vm, value1, value2, NULL);
+        if (njs_fast_path(ret != NJS_ERROR)) {
+            vm->retval = njs_value_true;
+
+            ret = sizeof(njs_vmcode_3addr_t);
+        }
+
+        goto set_retval;
 
-            default:
-                njs_internal_error(vm, "%d has retval", op);
+    CASE (NJS_VMCODE_PROPERTY_FOREACH):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
+
+        ret = njs_vmcode_property_foreach(vm, value1, value2, pc);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_STRICT_EQUAL):
+    CASE (NJS_VMCODE_STRICT_NOT_EQUAL):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        ret = njs_values_strict_equal(value1, value2);
+
+        ret ^= op - NJS_VMCODE_STRICT_EQUAL;
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_set_boolean(retval, ret);
+
+        pc += sizeof(njs_vmcode_3addr_t);
+        NEXT;
+
+    CASE (NJS_VMCODE_TEST_IF_TRUE):
+    CASE (NJS_VMCODE_TEST_IF_FALSE):
+    CASE (NJS_VMCODE_COALESCE):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+
+        if (op == NJS_VMCODE_COALESCE) {
+            ret = !njs_is_null_or_undefined(value1);
+
+        } else {
+            ret = njs_is_true(value1);
+            ret ^= op - NJS_VMCODE_TEST_IF_TRUE;
+        }
+
+        if (ret) {
+            test_jump = (njs_vmcode_test_jump_t *) pc;
+            ret = test_jump->offset;
+
+        } else {
+            ret = sizeof(njs_vmcode_3addr_t);
+        }
+
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        *retval = *value1;
+
+        pc += ret;
+        NEXT;
+
+    CASE (NJS_VMCODE_UNARY_PLUS):
+    CASE (NJS_VMCODE_UNARY_NEGATION):
+    CASE (NJS_VMCODE_BITWISE_NOT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+
+        if (njs_slow_path(!njs_is_numeric(value1))) {
+            ret = njs_value_to_numeric(vm, value1, &numeric1);
+            if (njs_slow_path(ret != NJS_OK)) {
                 goto error;
             }
 
-            if (njs_slow_path(ret < 0 && ret >= NJS_PREEMPT)) {
-                break;
+            value1 = &numeric1;
+        }
+
+        num = njs_number(value1);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+
+        switch (op) {
+        case NJS_VMCODE_UNARY_NEGATION:
+            num = -num;
+
+            /* Fall through. */
+        case NJS_VMCODE_UNARY_PLUS:
+            njs_set_number(retval, num);
+            break;
+
+        case NJS_VMCODE_BITWISE_NOT:
+            njs_set_int32(retval, ~njs_number_to_uint32(num));
+        }
+
+        pc += sizeof(njs_vmcode_2addr_t);
+        NEXT;
+
+    CASE (NJS_VMCODE_LOGICAL_NOT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        retval = njs_vmcode_operand(vm, vmcode->operand1);
+        njs_set_boolean(retval, !njs_is_true(value1));
+
+        pc += sizeof(njs_vmcode_2addr_t);
+        NEXT;
+
+    CASE (NJS_VMCODE_OBJECT):
+        ret = njs_vmcode_object(vm);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_ARRAY):
+        ret = njs_vmcode_array(vm, pc);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_FUNCTION):
+        ret = njs_vmcode_function(vm, pc);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_REGEXP):
+        ret = njs_vmcode_regexp(vm, pc);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_INSTANCE_OF):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        ret = njs_vmcode_instance_of(vm, value1, value2);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_TYPEOF):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
+
+        ret = njs_vmcode_typeof(vm, value1, value2);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_VOID):
+        njs_set_undefined(&vm->retval);
+
+        ret = sizeof(njs_vmcode_2addr_t);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_DELETE):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+
+        njs_release(vm, value1);
+        vm->retval = njs_value_true;
+
+        ret = sizeof(njs_vmcode_2addr_t);
+        goto set_retval;
+
+    CASE (NJS_VMCODE_STOP):
+        njs_profiler_poll(vm);
+
+        value2 = njs_vmcode_operand(vm, vmcode->operand1);
+        vm->retval = *value2;
+
+        return NJS_OK;
+
+    CASE (NJS_VMCODE_JUMP):
+        njs_profiler_poll_jump(vm, vmcode->operand1);
+
+        pc += (njs_jump_off_t) vmcode->operand1;
+        NEXT;
+
+    CASE (NJS_VMCODE_PROPERTY_SET):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        set = (njs_vmcode_prop_set_t *) pc;
+        retval = njs_vmcode_operand(vm, set->value);
+
+        cached = njs_vmcode_fast_element(value1, value2);
+
+        if (cached != NULL) {
+            *cached = *retval;
+
+            pc += sizeof(njs_vmcode_prop_set_t);
+            NEXT;
+        }
+
+        cached = njs_property_cache_find(vm, set->cache, value1,
+                                         NJS_PROPERTY_QUERY_SET);
+
+        if (njs_fast_path(cached != NULL)) {
+            vm->stat.property_cache_hits++;
+
+            *cached = *retval;
+
+            pc += sizeof(njs_vmcode_prop_set_t);
+            NEXT;
+        }
+
+        vm->stat.property_cache_misses++;
+
+        if (njs_scope_type(set->property) == NJS_SCOPE_ABSOLUTE) {
+            cached = njs_property_cache_update(vm, set->cache, value1, value2,
+                                               NJS_PROPERTY_QUERY_SET);
+            if (cached != NULL) {
+                *cached = *retval;
+
+                pc += sizeof(njs_vmcode_prop_set_t);
+                NEXT;
             }
+        }
 
-            retval = njs_vmcode_operand(vm, vmcode->operand1);
-            njs_release(vm, retval);
-            *retval = vm->retval;
+        ret = njs_value_property_set(vm, value1, value2, retval);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-        } else {
-            switch (op) {
-            case NJS_VMCODE_STOP:
-                value2 = njs_vmcode_operand(vm, value2);
-                vm->retval = *value2;
+        pc += sizeof(njs_vmcode_prop_set_t);
+        NEXT;
 
-                return NJS_OK;
+    CASE (NJS_VMCODE_PROPERTY_ACCESSOR):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-            case NJS_VMCODE_JUMP:
-                ret = (njs_jump_off_t) value2;
-                break;
+        accessor = (njs_vmcode_prop_accessor_t *) pc;
+        function = njs_vmcode_operand(vm, accessor->value);
 
-            case NJS_VMCODE_PROPERTY_SET:
-                set = (njs_vmcode_prop_set_t *) pc;
-                retval = njs_vmcode_operand(vm, set->value);
+        ret = njs_value_to_key(vm, &name, value2);
+        if (njs_slow_path(ret != NJS_OK)) {
+            njs_internal_error(vm, "failed conversion of type \"%s\" "
+                               "to string while property define",
+                               njs_type_string(value2->type));
+            return NJS_ERROR;
+        }
 
-                ret = njs_value_property_set(vm, value1, value2, retval);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        ret = njs_object_prop_define(vm, value1, &name, function,
+                                     accessor->type);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NJS_ERROR;
+        }
 
-                ret = sizeof(njs_vmcode_prop_set_t);
-                break;
+        pc += sizeof(njs_vmcode_prop_accessor_t);
+        NEXT;
 
-            case NJS_VMCODE_PROPERTY_ACCESSOR:
-                accessor = (njs_vmcode_prop_accessor_t *) pc;
-                function = njs_vmcode_operand(vm, accessor->value);
+    CASE (NJS_VMCODE_IF_TRUE_JUMP):
+    CASE (NJS_VMCODE_IF_FALSE_JUMP):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
 
-                ret = njs_value_to_key(vm, &name, value2);
-                if (njs_slow_path(ret != NJS_OK)) {
-                    njs_internal_error(vm, "failed conversion of type \"%s\" "
-                                       "to string while property define",
-                                       njs_type_string(value2->type));
-                    return NJS_ERROR;
-                }
+        ret = njs_is_true(value1);
 
-                ret = njs_object_prop_define(vm, value1, &name, function,
-                                             accessor->type);
-                if (njs_slow_path(ret != NJS_OK)) {
-                    return NJS_ERROR;
-                }
+        ret ^= op - NJS_VMCODE_IF_TRUE_JUMP;
 
-                ret = sizeof(njs_vmcode_prop_accessor_t);
-                break;
+        ret = ret ? (njs_jump_off_t) vmcode->operand1
+                  : (njs_jump_off_t) sizeof(njs_vmcode_cond_jump_t);
 
-            case NJS_VMCODE_IF_TRUE_JUMP:
-            case NJS_VMCODE_IF_FALSE_JUMP:
-                ret = njs_is_true(value1);
+        njs_profiler_poll_jump(vm, ret);
 
-                ret ^= op - NJS_VMCODE_IF_TRUE_JUMP;
+        pc += ret;
+        NEXT;
 
-                ret = ret ? (njs_jump_off_t) value2
-                          : (njs_jump_off_t) sizeof(njs_vmcode_cond_jump_t);
+    CASE (NJS_VMCODE_IF_EQUAL_JUMP):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                break;
+        if (njs_values_strict_equal(value1, value2)) {
+            equal = (njs_vmcode_equal_jump_t *) pc;
+            ret = equal->offset;
 
-            case NJS_VMCODE_IF_EQUAL_JUMP:
-                if (njs_values_strict_equal(value1, value2)) {
-                    equal = (njs_vmcode_equal_jump_t *) pc;
-                    ret = equal->offset;
+        } else {
+            ret = sizeof(njs_vmcode_3addr_t);
+        }
 
-                } else {
-                    ret = sizeof(njs_vmcode_3addr_t);
-                }
+        pc += ret;
+        NEXT;
 
-                break;
+    CASE (NJS_VMCODE_PROPERTY_INIT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-            case NJS_VMCODE_PROPERTY_INIT:
-                set = (njs_vmcode_prop_set_t *) pc;
-                retval = njs_vmcode_operand(vm, set->value);
-                ret = njs_vmcode_property_init(vm, value1, value2, retval);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        set = (njs_vmcode_prop_set_t *) pc;
+        retval = njs_vmcode_operand(vm, set->value);
+        ret = njs_vmcode_property_init(vm, value1, value2, retval);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-                break;
+        pc += ret;
+        NEXT;
 
-            case NJS_VMCODE_RETURN:
-                value2 = njs_vmcode_operand(vm, value2);
+    CASE (NJS_VMCODE_RETURN):
+        njs_profiler_poll(vm);
 
-                frame = (njs_frame_t *) vm->top_frame;
+        value2 = njs_vmcode_operand(vm, vmcode->operand1);
 
-                if (frame->native.ctor) {
-                    if (njs_is_object(value2)) {
-                        njs_release(vm, vm->scopes[NJS_SCOPE_ARGUMENTS]);
+        frame = (njs_frame_t *) vm->top_frame;
 
-                    } else {
-                        value2 = vm->scopes[NJS_SCOPE_ARGUMENTS];
-                    }
-                }
+        if (frame->native.ctor) {
+            if (njs_is_object(value2)) {
+                njs_release(vm, vm->scopes[NJS_SCOPE_ARGUMENTS]);
 
-                previous = njs_function_previous_frame(&frame->native);
+            } else {
+                value2 = vm->scopes[NJS_SCOPE_ARGUMENTS];
+            }
+        }
 
-                njs_vm_scopes_restore(vm, frame, previous);
+        previous = njs_function_previous_frame(&frame->native);
 
-                /*
-                 * If a retval is in a callee arguments scope it
-                 * must be in the previous callee arguments scope.
-                 */
-                retval = njs_vmcode_operand(vm, frame->retval);
+        njs_vm_scopes_restore(vm, frame, previous);
 
-                /*
-                 * GC: value external/internal++ depending on
-                 * value and retval type
-                 */
-                *retval = *value2;
+        /*
+         * If a retval is in a callee arguments scope it
+         * must be in the previous callee arguments scope.
+         */
+        retval = njs_vmcode_operand(vm, frame->retval);
 
-                njs_function_frame_free(vm, &frame->native);
+        /*
+         * GC: value external/internal++ depending on
+         * value and retval type
+         */
+        *retval = *value2;
 
-                return NJS_OK;
+        njs_function_frame_free(vm, &frame->native);
 
-            case NJS_VMCODE_FUNCTION_FRAME:
-                function_frame = (njs_vmcode_function_frame_t *) pc;
+        return NJS_OK;
 
-                /* TODO: external object instead of void this. */
+    CASE (NJS_VMCODE_FUNCTION_FRAME):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
 
-                ret = njs_function_frame_create(vm, value1,
-                                                &njs_value_undefined,
-                                                (uintptr_t) value2,
-                                                function_frame->ctor);
+        function_frame = (njs_vmcode_function_frame_t *) pc;
 
-                if (njs_slow_path(ret != NJS_OK)) {
-                    goto error;
-                }
+        /* TODO: external object instead of void this. */
 
-                ret = sizeof(njs_vmcode_function_frame_t);
-                break;
+        ret = njs_function_frame_create(vm, value1, &njs_value_undefined,
+                                        (uintptr_t) vmcode->operand1,
+                                        function_frame->ctor);
 
-            case NJS_VMCODE_METHOD_FRAME:
-                method_frame = (njs_vmcode_method_frame_t *) pc;
+        if (njs_slow_path(ret != NJS_OK)) {
+            goto error;
+        }
 
-                ret = njs_value_property(vm, value1, value2, &dst);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        pc += sizeof(njs_vmcode_function_frame_t);
+        NEXT;
 
-                if (njs_slow_path(!njs_is_function(&dst))) {
-                    ret = njs_value_to_key(vm, value2, value2);
-                    if (njs_slow_path(ret != NJS_OK)) {
-                        return NJS_ERROR;
-                    }
-
-                    njs_key_string_get(vm, value2, &string);
-                    njs_type_error(vm,
-                               "(intermediate value)[\"%V\"] is not a function",
-                               &string);
-                    goto error;
-                }
+    CASE (NJS_VMCODE_METHOD_FRAME):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                ret = njs_function_frame_create(vm, &dst, value1,
-                                                method_frame->nargs,
-                                                method_frame->ctor);
+        method_frame = (njs_vmcode_method_frame_t *) pc;
 
-                if (njs_slow_path(ret != NJS_OK)) {
-                    goto error;
-                }
+        ret = njs_value_property(vm, value1, value2, &dst);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-                ret = sizeof(njs_vmcode_method_frame_t);
-                break;
+        if (njs_slow_path(!njs_is_function(&dst))) {
+            ret = njs_value_to_key(vm, value2, value2);
+            if (njs_slow_path(ret != NJS_OK)) {
+                return NJS_ERROR;
+            }
+
+            njs_key_string_get(vm, value2, &string);
+            njs_type_error(vm,
+                           "(intermediate value)[\"%V\"] is not a function",
+                           &string);
+            goto error;
+        }
+
+        ret = njs_function_frame_create(vm, &dst, value1, method_frame->nargs,
+                                        method_frame->ctor);
+
+        if (njs_slow_path(ret != NJS_OK)) {
+            goto error;
+        }
+
+        pc += sizeof(njs_vmcode_method_frame_t);
+        NEXT;
+
+    CASE (NJS_VMCODE_FUNCTION_CALL):
+        njs_profiler_poll(vm);
+
+        ret = njs_function_frame_invoke(vm, (njs_index_t) vmcode->operand1);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
+
+        pc += sizeof(njs_vmcode_function_call_t);
+        NEXT;
+
+    CASE (NJS_VMCODE_PROPERTY_NEXT):
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
+
+        pnext = (njs_vmcode_prop_next_t *) pc;
+        retval = njs_vmcode_operand(vm, pnext->retval);
+
+        next = value2->data.u.next;
+
+        if (next->index < next->array->length) {
+            *retval = next->array->start[next->index++];
 
-            case NJS_VMCODE_FUNCTION_CALL:
-                ret = njs_function_frame_invoke(vm, (njs_index_t) value2);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+            njs_profiler_poll_jump(vm, pnext->offset);
 
-                ret = sizeof(njs_vmcode_function_call_t);
-                break;
+            pc += pnext->offset;
+            NEXT;
+        }
 
-            case NJS_VMCODE_PROPERTY_NEXT:
-                pnext = (njs_vmcode_prop_next_t *) pc;
-                retval = njs_vmcode_operand(vm, pnext->retval);
+        njs_mp_free(vm->mem_pool, next);
 
-                next = value2->data.u.next;
+        pc += sizeof(njs_vmcode_prop_next_t);
+        NEXT;
 
-                if (next->index < next->array->length) {
-                    *retval = next->array->start[next->index++];
+    CASE (NJS_VMCODE_THIS):
+        frame = vm->active_frame;
+        this = (njs_vmcode_this_t *) pc;
 
-                    ret = pnext->offset;
-                    break;
-                }
+        retval = njs_vmcode_operand(vm, this->dst);
+        *retval = frame->native.arguments[0];
 
-                njs_mp_free(vm->mem_pool, next);
+        pc += sizeof(njs_vmcode_this_t);
+        NEXT;
 
-                ret = sizeof(njs_vmcode_prop_next_t);
-                break;
+    CASE (NJS_VMCODE_ARGUMENTS):
+        ret = njs_vmcode_arguments(vm, pc);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-            case NJS_VMCODE_THIS:
-                frame = vm->active_frame;
-                this = (njs_vmcode_this_t *) pc;
+        pc += ret;
+        NEXT;
 
-                retval = njs_vmcode_operand(vm, this->dst);
-                *retval = frame->native.arguments[0];
+    CASE (NJS_VMCODE_PROTO_INIT):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = njs_vmcode_operand(vm, vmcode->operand3);
 
-                ret = sizeof(njs_vmcode_this_t);
-                break;
+        set = (njs_vmcode_prop_set_t *) pc;
+        retval = njs_vmcode_operand(vm, set->value);
+        ret = njs_vmcode_proto_init(vm, value1, value2, retval);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-            case NJS_VMCODE_ARGUMENTS:
-                ret = njs_vmcode_arguments(vm, pc);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        pc += ret;
+        NEXT;
 
-                break;
+    CASE (NJS_VMCODE_TRY_START):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
 
-            case NJS_VMCODE_PROTO_INIT:
-                set = (njs_vmcode_prop_set_t *) pc;
-                retval = njs_vmcode_operand(vm, set->value);
-                ret = njs_vmcode_proto_init(vm, value1, value2, retval);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+        ret = njs_vmcode_try_start(vm, value1, value2, pc);
+        if (njs_slow_path(ret == NJS_ERROR)) {
+            goto error;
+        }
 
-                break;
+        pc += ret;
+        NEXT;
 
-            case NJS_VMCODE_TRY_START:
-                ret = njs_vmcode_try_start(vm, value1, value2, pc);
-                if (njs_slow_path(ret == NJS_ERROR)) {
-                    goto error;
-                }
+    CASE (NJS_VMCODE_THROW):
+        value2 = njs_vmcode_operand(vm, vmcode->operand1);
+        vm->retval = *value2;
+        goto error;
 
-                break;
+    CASE (NJS_VMCODE_TRY_BREAK):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
 
-            case NJS_VMCODE_THROW:
-                value2 = njs_vmcode_operand(vm, value2);
-                vm->retval = *value2;
-                goto error;
+        pc += njs_vmcode_try_break(vm, value1, value2);
+        NEXT;
 
-            case NJS_VMCODE_TRY_BREAK:
-                ret = njs_vmcode_try_break(vm, value1, value2);
-                break;
+    CASE (NJS_VMCODE_TRY_CONTINUE):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
 
-            case NJS_VMCODE_TRY_CONTINUE:
-                ret = njs_vmcode_try_continue(vm, value1, value2);
-                break;
+        pc += njs_vmcode_try_continue(vm, value1, value2);
+        NEXT;
 
-            case NJS_VMCODE_TRY_END:
-                ret = njs_vmcode_try_end(vm, value1, value2);
-                break;
+    CASE (NJS_VMCODE_TRY_END):
+        value2 = (njs_value_t *) vmcode->operand1;
 
-            /*
-             * njs_vmcode_catch() is set on the start of a "catch" block to
-             * store exception and to remove a "try" block if there is no
-             * "finally" block or to update a catch address to the start of
-             * a "finally" block.
-             * njs_vmcode_catch() is set on the start of a "finally" block
-             * to store uncaught exception and to remove a "try" block.
-             */
-            case NJS_VMCODE_CATCH:
-                *value1 = vm->retval;
+        pc += njs_vmcode_try_end(vm, NULL, value2);
+        NEXT;
 
-                if ((njs_jump_off_t) value2 == sizeof(njs_vmcode_catch_t)) {
-                    ret = njs_vmcode_try_end(vm, value1, value2);
+    /*
+     * njs_vmcode_catch() is set on the start of a "catch" block to
+     * store exception and to remove a "try" block if there is no
+     * "finally" block or to update a catch address to the start of
+     * a "finally" block.
+     * njs_vmcode_catch() is set on the start of a "finally" block
+     * to store uncaught exception and to remove a "try" block.
+     */
+    CASE (NJS_VMCODE_CATCH):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
 
-                } else {
-                    vm->top_frame->exception.catch =
-                                                  pc + (njs_jump_off_t) value2;
-                    ret = sizeof(njs_vmcode_catch_t);
-                }
+        *value1 = vm->retval;
 
-                break;
+        if ((njs_jump_off_t) value2 == sizeof(njs_vmcode_catch_t)) {
+            ret = njs_vmcode_try_end(vm, value1, value2);
 
-            case NJS_VMCODE_FINALLY:
-                ret = njs_vmcode_finally(vm, value1, value2, pc);
+        } else {
+            vm->top_frame->exception.catch = pc + (njs_jump_off_t) value2;
+            ret = sizeof(njs_vmcode_catch_t);
+        }
 
-                switch (ret) {
-                case NJS_OK:
-                    return NJS_OK;
-                case NJS_ERROR:
-                    goto error;
-                }
+        pc += ret;
+        NEXT;
 
-                break;
+    CASE (NJS_VMCODE_FINALLY):
+        value1 = njs_vmcode_operand(vm, vmcode->operand2);
+        value2 = (njs_value_t *) vmcode->operand1;
 
-            case NJS_VMCODE_REFERENCE_ERROR:
-                njs_vmcode_reference_error(vm, pc);
-                goto error;
+        ret = njs_vmcode_finally(vm, value1, value2, pc);
 
-            default:
-                njs_internal_error(vm, "%d has NO retval", op);
-                goto error;
-            }
+        switch (ret) {
+        case NJS_OK:
+            return NJS_OK;
+        case NJS_ERROR:
+            goto error;
         }
 
         pc += ret;
+        NEXT;
+
+    CASE (NJS_VMCODE_REFERENCE_ERROR):
+        njs_vmcode_reference_error(vm, pc);
+        goto error;
+
+#if !(NJS_HAVE_COMPUTED_GOTO)
+    default:
+        njs_internal_error(vm, "%d is not a valid operation", op);
+        goto error;
+#endif
+    }
+
+set_retval:
+
+    if (njs_slow_path(ret < 0 && ret >= NJS_PREEMPT)) {
+        goto error;
     }
 
+    retval = njs_vmcode_operand(vm, vmcode->operand1);
+    njs_release(vm, retval);
+    *retval = vm->retval;
+
+    pc += ret;
+    NEXT;
+
 error:
 
     if (njs_is_error(&vm->retval)) {
@@ -913,7 +1410,7 @@ error:
         if (catch != NULL) {
             pc = catch;
 
-            goto next;
+            NEXT;
         }
 
         previous = frame->native.previous;
@@ -939,12 +1436,155 @@ error:
 }
 
 
+njs_inline void
+njs_property_cache_insert(njs_property_cache_t *cache)
+{
+    njs_uint_t  i;
+
+    /* The least recently inserted entry is evicted. */
+
+    for (i = NJS_PROPERTY_CACHE_SIZE - 1; i != 0; i--) {
+        cache[i] = cache[i - 1];
+    }
+}
+
+
+/*
+ * Only own data properties of ordinary objects are cached.  A cached
+ * property is never removed from the object hash, a deleted property
+ * becomes NJS_WHITEOUT and njs_property_cache_find() rejects it.
+ * A shaped object which loses a property is switched to the dictionary
+ * mode and does not match the shape entries anymore.
+ */
+
+static njs_value_t *
+njs_property_cache_update(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_value_t *value, njs_value_t *key, njs_uint_t query)
+{
+    njs_int_t             ret, slot;
+    njs_object_t          *object;
+    njs_object_prop_t     *prop;
+    njs_lvlhsh_query_t    lhq;
+    njs_property_query_t  pq;
+
+    if (value->type != NJS_OBJECT || !njs_is_string(key)) {
+        return NULL;
+    }
+
+    object = njs_object(value);
+
+    if (object->slots != NULL) {
+        return NULL;
+    }
+
+    if (object->shape != NULL) {
+        lhq.key_hash = njs_string_key_hash(key, &lhq.key);
+
+        slot = njs_shape_find(object->shape, &lhq);
+        if (slot == NJS_DECLINED) {
+            return NULL;
+        }
+
+        njs_property_cache_insert(cache);
+
+        cache[0].epoch = vm->cache_epoch;
+        cache[0].owner = object->shape;
+        cache[0].u.slot = slot;
+
+        return &object->values[slot];
+    }
+
+    njs_property_query_init(&pq, query, 1);
+
+    ret = njs_property_query(vm, &pq, value, key);
+    if (ret != NJS_OK) {
+        return NULL;
+    }
+
+    prop = pq.lhq.value;
+
+    if (prop->type != NJS_PROPERTY || !njs_is_data_descriptor(prop)) {
+        return NULL;
+    }
+
+    if (query == NJS_PROPERTY_QUERY_SET) {
+        if (!prop->writable) {
+            return NULL;
+        }
+
+        if (pq.lhq.key_hash == NJS_LENGTH_HASH) {
+            /* The "length" may be handled by an array in the prototype. */
+            return NULL;
+        }
+    }
+
+    njs_property_cache_insert(cache);
+
+    cache[0].epoch = vm->cache_epoch;
+    cache[0].owner = object;
+    cache[0].u.prop = prop;
+
+    return &prop->value;
+}
+
+
+/*
+ * A reference to a global, which is not a declared variable, is cached
+ * only when it is resolved to an own data property of the global object.
+ * Builtins are added to the own properties on the first access, so they
+ * are cached starting from the second execution of the instruction.
+ * The cache is validated by vm->global_epoch, the same way as
+ * in njs_property_cache_update() a deleted or redefined property is
+ * kept in the object hash and is rejected by njs_global_cache_find().
+ */
+
+static njs_value_t *
+njs_global_cache_update(njs_vm_t *vm, njs_property_cache_t *cache,
+    njs_value_t *global, njs_value_t *key)
+{
+    njs_int_t           ret;
+    njs_object_t        *object;
+    njs_object_prop_t   *prop;
+    njs_lvlhsh_query_t  lhq;
+
+    if (!njs_is_object(global) || !njs_is_string(key)) {
+        return NULL;
+    }
+
+    object = njs_object(global);
+
+    if (object->shape != NULL) {
+        return NULL;
+    }
+
+    lhq.key_hash = njs_string_key_hash(key, &lhq.key);
+    lhq.proto = &njs_object_hash_proto;
+
+    ret = njs_lvlhsh_find(&object->hash, &lhq);
+    if (ret != NJS_OK) {
+        return NULL;
+    }
+
+    prop = lhq.value;
+
+    if (prop->type != NJS_PROPERTY || !njs_is_data_descriptor(prop)) {
+        return NULL;
+    }
+
+    cache[0].epoch = vm->global_epoch;
+    cache[0].owner = object;
+    cache[0].u.prop = prop;
+
+    return &prop->value;
+}
+
+
 static njs_jump_off_t
 njs_vmcode_object(njs_vm_t *vm)
 {
     njs_object_t  *object;
 
-    object = njs_object_alloc(vm);
+    object = njs_object_shaped_alloc(vm);
 
     if (njs_fast_path(object != NULL)) {
         njs_set_object(&vm->retval, object);
@@ -1195,6 +1835,18 @@ njs_vmcode_property_init(njs_vm_t *vm, njs_value_t *value, njs_value_t *key,
         lhq.proto = &njs_object_hash_proto;
         lhq.pool = vm->mem_pool;
 
+        if (njs_object(value)->shape != NULL) {
+            ret = njs_shape_property_init(vm, njs_object(value), &lhq, &name,
+                                          init);
+            if (ret != NJS_DECLINED) {
+                if (njs_slow_path(ret != NJS_OK)) {
+                    return NJS_ERROR;
+                }
+
+                break;
+            }
+        }
+
         prop = njs_object_prop_alloc(vm, &name, init, 1);
         if (njs_slow_path(prop == NULL)) {
             return NJS_ERROR;
@@ -1424,6 +2076,9 @@ njs_vmcode_typeof(njs_vm_t *vm, njs_value_t *value, njs_value_t *invld)
         &njs_string_object,
         &njs_string_object,
         &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
+        &njs_string_object,
     };
 
     vm->retval = *types[value->type];
@@ -1437,6 +2092,7 @@ njs_string_concat(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 {
     u_char             *start;
     size_t             size, length;
+    njs_int_t          ret;
     njs_string_prop_t  string1, string2;
 
     (void) njs_string_prop(&string1, val1);
@@ -1457,6 +2113,15 @@ njs_string_concat(njs_vm_t *vm, njs_value_t *val1, njs_value_t *val2)
 
     size = string1.size + string2.size;
 
+    if (size > NJS_STRING_SHORT && (length == 0 || length == size)) {
+        ret = njs_string_append(vm, &vm->retval, val1, &string2, length);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return NJS_ERROR;
+        }
+
+        return sizeof(njs_vmcode_3addr_t);
+    }
+
     start = njs_string_alloc(vm, &vm->retval, size, length);
 
     if (njs_slow_path(start == NULL)) {
@@ -1637,7 +2302,7 @@ njs_function_new_object(njs_vm_t *vm, njs_value_t *constructor)
 
     const njs_value_t prototype_string = njs_string("prototype");
 
-    object = njs_object_alloc(vm);
+    object = njs_object_shaped_alloc(vm);
     if (njs_slow_path(object == NULL)) {
         return NULL;
     }
@@ -1665,6 +2330,250 @@ njs_function_new_object(njs_vm_t *vm, njs_value_t *constructor)
 }
 
 
+/*
+ * njs_vmcode_fold() evaluates an operation on primitive values other than
+ * symbols at compile time.  The result is the same as the interpreter gives,
+ * the values do not have side effects on conversion.  NJS_DECLINED is
+ * returned for operations which are not evaluated.
+ */
+
+njs_int_t
+njs_vmcode_fold(njs_vm_t *vm, njs_vmcode_operation_t op, njs_value_t *retval,
+    njs_value_t *value1, njs_value_t *value2)
+{
+    double             num, exponent;
+    u_char             *start;
+    size_t             size, length;
+    int32_t            i32;
+    uint32_t           u32;
+    njs_int_t          ret;
+    njs_bool_t         valid;
+    njs_value_t        numeric1, numeric2, string1, string2, saved, *src;
+    njs_string_prop_t  prop1, prop2;
+
+    switch (op) {
+    case NJS_VMCODE_UNARY_PLUS:
+    case NJS_VMCODE_UNARY_NEGATION:
+    case NJS_VMCODE_BITWISE_NOT:
+        ret = njs_value_to_numeric(vm, value1, &numeric1);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        num = njs_number(&numeric1);
+
+        if (op == NJS_VMCODE_BITWISE_NOT) {
+            njs_set_int32(retval, ~njs_number_to_uint32(num));
+
+        } else {
+            njs_set_number(retval, (op == NJS_VMCODE_UNARY_NEGATION) ? -num
+                                                                     : num);
+        }
+
+        return NJS_OK;
+
+    case NJS_VMCODE_LOGICAL_NOT:
+        njs_set_boolean(retval, !njs_is_true(value1));
+        return NJS_OK;
+
+    case NJS_VMCODE_TYPEOF:
+        saved = vm->retval;
+
+        (void) njs_vmcode_typeof(vm, value1, NULL);
+
+        *retval = vm->retval;
+        vm->retval = saved;
+
+        return NJS_OK;
+
+    case NJS_VMCODE_ADDITION:
+        if (njs_is_numeric(value1) && njs_is_numeric(value2)) {
+            njs_set_number(retval, njs_number(value1) + njs_number(value2));
+            return NJS_OK;
+        }
+
+        ret = njs_primitive_value_to_string(vm, &string1, value1);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        ret = njs_primitive_value_to_string(vm, &string2, value2);
+        if (njs_slow_path(ret != NJS_OK)) {
+            return ret;
+        }
+
+        /* The same as njs_string_concat() but without a growable buffer. */
+
+        (void) njs_string_prop(&prop1, &string1);
+        (void) njs_string_prop(&prop2, &string2);
+
+        if ((prop1.length != 0 || prop1.size == 0)
+            && (prop2.length != 0 || prop2.size == 0))
+        {
+            length = prop1.length + prop2.length;
+
+        } else {
+            length = 0;
+        }
+
+        size = prop1.size + prop2.size;
+
+        if (njs_slow_path(size > NJS_STRING_MAX_LENGTH)) {
+            njs_range_error(vm, "invalid string length");
+            return NJS_ERROR;
+        }
+
+        start = njs_string_alloc(vm, retval, size, length);
+        if (njs_slow_path(start == NULL)) {
+            return NJS_ERROR;
+        }
+
+        start = njs_cpymem(start, prop1.start, prop1.size);
+        (void) memcpy(start, prop2.start, prop2.size);
+
+        return NJS_OK;
+
+    case NJS_VMCODE_LESS:
+    case NJS_VMCODE_GREATER:
+    case NJS_VMCODE_LESS_OR_EQUAL:
+    case NJS_VMCODE_GREATER_OR_EQUAL:
+        if ((uint8_t) (op - NJS_VMCODE_GREATER) < 2) {
+            /* NJS_VMCODE_GREATER, NJS_VMCODE_LESS_OR_EQUAL */
+            src = value1;
+            value1 = value2;
+            value2 = src;
+        }
+
+        ret = njs_primitive_values_compare(vm, value1, value2);
+
+        if (op < NJS_VMCODE_LESS_OR_EQUAL) {
+            ret = ret > 0;
+
+        } else {
+            ret = ret == 0;
+        }
+
+        njs_set_boolean(retval, ret);
+        return NJS_OK;
+
+    case NJS_VMCODE_EQUAL:
+    case NJS_VMCODE_NOT_EQUAL:
+        ret = njs_values_equal(vm, value1, value2);
+        if (njs_slow_path(ret < 0)) {
+            return NJS_ERROR;
+        }
+
+        njs_set_boolean(retval, ret ^ (op - NJS_VMCODE_EQUAL));
+        return NJS_OK;
+
+    case NJS_VMCODE_STRICT_EQUAL:
+    case NJS_VMCODE_STRICT_NOT_EQUAL:
+        ret = njs_values_strict_equal(value1, value2);
+
+        njs_set_boolean(retval, ret ^ (op - NJS_VMCODE_STRICT_EQUAL));
+        return NJS_OK;
+
+    case NJS_VMCODE_SUBSTRACTION:
+    case NJS_VMCODE_MULTIPLICATION:
+    case NJS_VMCODE_EXPONENTIATION:
+    case NJS_VMCODE_DIVISION:
+    case NJS_VMCODE_REMAINDER:
+    case NJS_VMCODE_BITWISE_AND:
+    case NJS_VMCODE_BITWISE_OR:
+    case NJS_VMCODE_BITWISE_XOR:
+    case NJS_VMCODE_LEFT_SHIFT:
+    case NJS_VMCODE_RIGHT_SHIFT:
+    case NJS_VMCODE_UNSIGNED_RIGHT_SHIFT:
+        break;
+
+    default:
+        return NJS_DECLINED;
+    }
+
+    ret = njs_value_to_numeric(vm, value1, &numeric1);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    ret = njs_value_to_numeric(vm, value2, &numeric2);
+    if (njs_slow_path(ret != NJS_OK)) {
+        return ret;
+    }
+
+    num = njs_number(&numeric1);
+
+    switch (op) {
+    case NJS_VMCODE_SUBSTRACTION:
+        num -= njs_number(&numeric2);
+        break;
+
+    case NJS_VMCODE_MULTIPLICATION:
+        num *= njs_number(&numeric2);
+        break;
+
+    case NJS_VMCODE_EXPONENTIATION:
+        exponent = njs_number(&numeric2);
+
+        valid = fabs(num) != 1 || (!isnan(exponent) && !isinf(exponent));
+
+        num = valid ? pow(num, exponent) : NAN;
+        break;
+
+    case NJS_VMCODE_DIVISION:
+        num /= njs_number(&numeric2);
+        break;
+
+    case NJS_VMCODE_REMAINDER:
+        num = fmod(num, njs_number(&numeric2));
+        break;
+
+    case NJS_VMCODE_BITWISE_AND:
+    case NJS_VMCODE_BITWISE_OR:
+    case NJS_VMCODE_BITWISE_XOR:
+        i32 = njs_number_to_int32(njs_number(&numeric2));
+
+        switch (op) {
+        case NJS_VMCODE_BITWISE_AND:
+            i32 &= njs_number_to_int32(num);
+            break;
+
+        case NJS_VMCODE_BITWISE_OR:
+            i32 |= njs_number_to_int32(num);
+            break;
+
+        default: /* NJS_VMCODE_BITWISE_XOR */
+            i32 ^= njs_number_to_int32(num);
+        }
+
+        njs_set_int32(retval, i32);
+        return NJS_OK;
+
+    default:
+        u32 = njs_number_to_uint32(njs_number(&numeric2)) & 0x1f;
+
+        switch (op) {
+        case NJS_VMCODE_LEFT_SHIFT:
+            i32 = (uint32_t) njs_number_to_int32(num) << u32;
+            njs_set_int32(retval, i32);
+            break;
+
+        case NJS_VMCODE_RIGHT_SHIFT:
+            njs_set_int32(retval, njs_number_to_int32(num) >> u32);
+            break;
+
+        default: /* NJS_VMCODE_UNSIGNED_RIGHT_SHIFT */
+            njs_set_uint32(retval, njs_number_to_uint32(num) >> u32);
+        }
+
+        return NJS_OK;
+    }
+
+    njs_set_number(retval, num);
+
+    return NJS_OK;
+}
+
+
 static njs_jump_off_t
 njs_vmcode_return(njs_vm_t *vm, njs_value_t *invld, njs_value_t *retval)
 {
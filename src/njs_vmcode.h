@@ -121,6 +121,23 @@ typedef uint8_t                         njs_vmcode_operation_t;
 #define NJS_VMCODE_VOID                 VMCODE1(47)
 #define NJS_VMCODE_DELETE               VMCODE1(48)
 
+/*
+ * Compare-and-branch superinstructions are set by njs_optimizer() on
+ * a compare instruction followed by a conditional jump on its result.
+ * The layout of the pair is kept: the superinstruction stores the result
+ * as the compare instruction does and makes the jump itself, the jump
+ * instruction is still there for the slow path and for jumps to it.
+ */
+
+#define NJS_VMCODE_LESS_JUMP            VMCODE1(49)
+#define NJS_VMCODE_GREATER_JUMP         VMCODE1(50)
+#define NJS_VMCODE_LESS_OR_EQUAL_JUMP   VMCODE1(51)
+#define NJS_VMCODE_GREATER_OR_EQUAL_JUMP VMCODE1(52)
+#define NJS_VMCODE_EQUAL_JUMP           VMCODE1(53)
+#define NJS_VMCODE_NOT_EQUAL_JUMP       VMCODE1(54)
+#define NJS_VMCODE_STRICT_EQUAL_JUMP    VMCODE1(55)
+#define NJS_VMCODE_STRICT_NOT_EQUAL_JUMP VMCODE1(56)
+
 #define NJS_VMCODE_NOP                  255
 
 
@@ -248,11 +265,37 @@ typedef struct {
 } njs_vmcode_test_jump_t;
 
 
+/*
+ * An inline property cache entry remembers an own data property of an
+ * ordinary object found by a property instruction with a constant key.
+ * A property of a shaped object is remembered as a shape slot and is
+ * shared by all objects with the shape, a property of an object in the
+ * dictionary mode is remembered for the object only.  The entry is valid
+ * only for the VM with the same cache epoch, because the bytecode is
+ * shared between a parent VM and its clones.
+ */
+
+#define NJS_PROPERTY_CACHE_SIZE         2
+
+typedef struct {
+    uintptr_t                  epoch;
+
+    /* An object shape or an object in the dictionary mode. */
+    void                       *owner;
+
+    union {
+        njs_object_prop_t      *prop;
+        uintptr_t              slot;
+    } u;
+} njs_property_cache_t;
+
+
 typedef struct {
     njs_vmcode_t               code;
     njs_index_t                value;
     njs_index_t                object;
     njs_index_t                property;
+    njs_property_cache_t       cache[NJS_PROPERTY_CACHE_SIZE];
 } njs_vmcode_prop_get_t;
 
 
@@ -261,6 +304,7 @@ typedef struct {
     njs_index_t                value;
     njs_index_t                object;
     njs_index_t                property;
+    njs_property_cache_t       cache[NJS_PROPERTY_CACHE_SIZE];
 } njs_vmcode_prop_set_t;
 
 
@@ -395,6 +439,8 @@ typedef struct {
 njs_int_t njs_vmcode_interpreter(njs_vm_t *vm, u_char *pc);
 
 njs_object_t *njs_function_new_object(njs_vm_t *vm, njs_value_t *constructor);
+njs_int_t njs_vmcode_fold(njs_vm_t *vm, njs_vmcode_operation_t op,
+    njs_value_t *retval, njs_value_t *value1, njs_value_t *value2);
 
 
 #endif /* _NJS_VMCODE_H_INCLUDED_ */
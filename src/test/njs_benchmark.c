@@ -19,9 +19,21 @@ typedef struct {
     njs_str_t   script;
     njs_str_t   result;
     njs_uint_t  repeat;
+    njs_bool_t  snapshot;
+    njs_bool_t  reset;
+    njs_bool_t  arena;
 } njs_benchmark_test_t;
 
 
+typedef struct {
+    const char  *name;
+    size_t      min_size;
+    size_t      max_size;
+    njs_uint_t  live;
+    njs_uint_t  repeat;
+} njs_mp_benchmark_test_t;
+
+
 typedef struct {
     uint8_t     dump_report;
     const char  *prefix;
@@ -29,6 +41,57 @@ typedef struct {
 } njs_opts_t;
 
 
+static njs_int_t
+njs_benchmark_report(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
+    const char *test_name, njs_uint_t n, uint64_t us)
+{
+    njs_int_t    ret;
+    njs_value_t  *result, name, usec, times;
+
+    static const njs_value_t  name_key = njs_string("name");
+    static const njs_value_t  usec_key = njs_string("usec");
+    static const njs_value_t  times_key = njs_string("times");
+
+    if (!opts->dump_report) {
+        if (n == 1) {
+            njs_printf("%s%s: %.3fs\n", opts->previous ? "    " : "",
+                       test_name, (double) us / 1000000);
+
+        } else {
+            njs_printf("%s%s: %.3fµs, %d times/s\n",
+                       opts->previous ? "    " : "",
+                       test_name, (double) us / n,
+                       (int) ((uint64_t) n * 1000000 / us));
+        }
+    }
+
+    result = njs_vm_array_push(parent, report);
+    if (result == NULL) {
+        njs_printf("njs_vm_array_push() failed\n");
+        return NJS_ERROR;
+    }
+
+    ret = njs_vm_value_string_set(parent, &name, (u_char *) test_name,
+                                  njs_strlen(test_name));
+    if (ret != NJS_OK) {
+        njs_printf("njs_vm_value_string_set() failed\n");
+        return NJS_ERROR;
+    }
+
+    njs_value_number_set(&usec, us);
+    njs_value_number_set(&times, n);
+
+    ret = njs_vm_object_alloc(parent, result, &name_key, &name,
+                              &usec_key, &usec, &times_key, &times, NULL);
+    if (ret != NJS_OK) {
+        njs_printf("njs_vm_object_alloc() failed\n");
+        return NJS_ERROR;
+    }
+
+    return NJS_OK;
+}
+
+
 static njs_int_t
 njs_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
     njs_benchmark_test_t *test)
@@ -40,16 +103,13 @@ njs_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
     njs_str_t             s, *expected;
     njs_uint_t            i, n;
     njs_bool_t            success;
-    njs_value_t           *result, name, usec, times;
     njs_vm_opt_t          options;
     njs_external_proto_t  proto;
 
-    static const njs_value_t  name_key = njs_string("name");
-    static const njs_value_t  usec_key = njs_string("usec");
-    static const njs_value_t  times_key = njs_string("times");
-
     njs_vm_opt_init(&options);
 
+    options.arena = test->arena;
+
     vm = NULL;
     nvm = NULL;
     ret = NJS_ERROR;
@@ -73,6 +133,15 @@ njs_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
         goto done;
     }
 
+    if (test->snapshot) {
+        ret = njs_vm_snapshot(vm);
+        if (ret != NJS_OK) {
+            njs_printf("njs_vm_snapshot() failed\n");
+            ret = NJS_ERROR;
+            goto done;
+        }
+    }
+
     n = test->repeat;
     expected = &test->result;
 
@@ -80,10 +149,19 @@ njs_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
 
     for (i = 0; i < n; i++) {
 
-        nvm = njs_vm_clone(vm, NULL);
-        if (nvm == NULL) {
-            njs_printf("njs_vm_clone() failed\n");
-            goto done;
+        if (nvm != NULL) {
+            ret = njs_vm_reset(nvm, NULL);
+            if (ret != NJS_OK) {
+                njs_printf("njs_vm_reset() failed\n");
+                goto done;
+            }
+
+        } else {
+            nvm = njs_vm_clone(vm, NULL);
+            if (nvm == NULL) {
+                njs_printf("njs_vm_clone() failed\n");
+                goto done;
+            }
         }
 
         (void) njs_vm_start(nvm);
@@ -100,84 +178,250 @@ njs_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
             goto done;
         }
 
-        njs_vm_destroy(nvm);
-        nvm = NULL;
+        if (!test->reset) {
+            njs_vm_destroy(nvm);
+            nvm = NULL;
+        }
     }
 
     us = njs_time() / 1000 - us;
 
-    if (!opts->dump_report) {
-        if (n == 1) {
-            njs_printf("%s%s: %.3fs\n", opts->previous ? "    " : "",
-                       test->name, (double) us / 1000000);
+    ret = njs_benchmark_report(parent, opts, report, test->name, n, us);
 
-        } else {
-            njs_printf("%s%s: %.3fµs, %d times/s\n",
-                       opts->previous ? "    " : "",
-                       test->name, (double) us / n,
-                       (int) ((uint64_t) n * 1000000 / us));
-        }
-    }
+done:
 
-    result = njs_vm_array_push(parent, report);
-    if (result == NULL) {
-        njs_printf("njs_vm_array_push() failed\n");
-        goto done;
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
     }
 
-    ret = njs_vm_value_string_set(parent, &name, (u_char *) test->name,
-                                  njs_strlen(test->name));
-    if (ret != NJS_OK) {
-        njs_printf("njs_vm_value_string_set() failed\n");
-        goto done;
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
     }
 
-    njs_value_number_set(&usec, us);
-    njs_value_number_set(&times, n);
+    return ret;
+}
 
-    ret = njs_vm_object_alloc(parent, result, &name_key, &name,
-                              &usec_key, &usec, &times_key, &times, NULL);
-    if (ret != NJS_OK) {
-        njs_printf("njs_vm_object_alloc() failed\n");
+
+static njs_int_t
+njs_mp_benchmark_test(njs_vm_t *parent, njs_opts_t *opts, njs_value_t *report,
+    njs_mp_benchmark_test_t *test)
+{
+    void        **live;
+    size_t      size;
+    uint32_t    rnd;
+    uint64_t    us;
+    njs_mp_t    *mp;
+    njs_int_t   ret;
+    njs_uint_t  i, k, n;
+
+    ret = NJS_ERROR;
+
+    mp = njs_mp_fast_create(2 * njs_pagesize(), 128, 512, 16);
+    if (mp == NULL) {
+        njs_printf("njs_mp_fast_create() failed\n");
+        return NJS_ERROR;
+    }
+
+    live = njs_mp_zalloc(mp, test->live * sizeof(void *));
+    if (live == NULL) {
         goto done;
     }
 
-    ret = NJS_OK;
+    size = test->max_size - test->min_size + 1;
+    rnd = 1;
 
-done:
+    /*
+     * Each iteration frees a random allocation of the live set
+     * and replaces it with an allocation of a random size.
+     */
 
-    if (nvm != NULL) {
-        njs_vm_destroy(nvm);
+    for (i = 0; i < test->live; i++) {
+        rnd = rnd * 1103515245 + 12345;
+
+        live[i] = njs_mp_alloc(mp, test->min_size + (rnd >> 8) % size);
+        if (live[i] == NULL) {
+            goto done;
+        }
     }
 
-    if (vm != NULL) {
-        njs_vm_destroy(vm);
+    n = test->repeat;
+
+    us = njs_time() / 1000;
+
+    for (i = 0; i < n; i++) {
+        rnd = rnd * 1103515245 + 12345;
+        k = (rnd >> 8) % test->live;
+
+        njs_mp_free(mp, live[k]);
+
+        rnd = rnd * 1103515245 + 12345;
+
+        live[k] = njs_mp_alloc(mp, test->min_size + (rnd >> 8) % size);
+        if (live[k] == NULL) {
+            njs_printf("njs_mp_alloc() failed\n");
+            goto done;
+        }
     }
 
+    us = njs_time() / 1000 - us;
+
+    ret = njs_benchmark_report(parent, opts, report, test->name, n, us);
+
+done:
+
+    njs_mp_destroy(mp);
+
     return ret;
 }
 
+
 static njs_benchmark_test_t  njs_test[] =
 {
     { "nJSVM clone/destroy",
       njs_str("null"),
       njs_str("null"),
-      1000000 },
+      1000000, 0, 0, 0 },
+
+    { "nJSVM reset",
+      njs_str("null"),
+      njs_str("null"),
+      1000000, 0, 1, 0 },
+
+    { "nJSVM clone/destroy arena",
+      njs_str("null"),
+      njs_str("null"),
+      1000000, 0, 0, 1 },
+
+    { "nJSVM reset arena",
+      njs_str("null"),
+      njs_str("null"),
+      1000000, 0, 1, 1 },
+
+    { "global code",
+      njs_str("var codes = {};"
+              "for (var i = 0; i < 100; i++) {"
+              "    codes['c' + i] = {code: i, text: 'status ' + i,"
+              "                      retry: i % 3 == 0};"
+              "}"
+              "var routes = ['/api', '/static', '/health'].map("
+              "    function(p, i) { return {prefix: p, weight: i} });"
+              "var re = /^\\/api\\/(v[0-9]+)\\//;"
+              "function handler(r) { return codes.c42.text }"
+              "codes.c42.text"),
+      njs_str("status 42"),
+      10000, 0, 0, 0 },
+
+    { "global code arena",
+      njs_str("var codes = {};"
+              "for (var i = 0; i < 100; i++) {"
+              "    codes['c' + i] = {code: i, text: 'status ' + i,"
+              "                      retry: i % 3 == 0};"
+              "}"
+              "var routes = ['/api', '/static', '/health'].map("
+              "    function(p, i) { return {prefix: p, weight: i} });"
+              "var re = /^\\/api\\/(v[0-9]+)\\//;"
+              "function handler(r) { return codes.c42.text }"
+              "codes.c42.text"),
+      njs_str("status 42"),
+      10000, 0, 0, 1 },
+
+    { "global code snapshot",
+      njs_str("var codes = {};"
+              "for (var i = 0; i < 100; i++) {"
+              "    codes['c' + i] = {code: i, text: 'status ' + i,"
+              "                      retry: i % 3 == 0};"
+              "}"
+              "var routes = ['/api', '/static', '/health'].map("
+              "    function(p, i) { return {prefix: p, weight: i} });"
+              "var re = /^\\/api\\/(v[0-9]+)\\//;"
+              "function handler(r) { return codes.c42.text }"
+              "codes.c42.text"),
+      njs_str("status 42"),
+      10000, 1, 0, 0 },
+
+    { "global code snapshot reset",
+      njs_str("var codes = {};"
+              "for (var i = 0; i < 100; i++) {"
+              "    codes['c' + i] = {code: i, text: 'status ' + i,"
+              "                      retry: i % 3 == 0};"
+              "}"
+              "var routes = ['/api', '/static', '/health'].map("
+              "    function(p, i) { return {prefix: p, weight: i} });"
+              "var re = /^\\/api\\/(v[0-9]+)\\//;"
+              "function handler(r) { return codes.c42.text }"
+              "codes.c42.text"),
+      njs_str("status 42"),
+      10000, 1, 1, 0 },
 
     { "JSON.parse",
       njs_str("JSON.parse('{\"a\":123, \"XXX\":[3,4,null]}').a"),
       njs_str("123"),
-      1000000 },
+      1000000, 0, 0, 0 },
+
+    { "JSON.parse 1k records x 100",
+      njs_str("var r = [], n = 0;"
+              "for (var i = 0; i < 1000; i++) {"
+              "    r.push({id: i, tags: ['a', 'b'], pos: [i, 2 * i, 3.5],"
+              "            meta: {ok: true, v: []}});"
+              "}"
+              "var text = JSON.stringify(r);"
+              "for (var k = 0; k < 100; k++) {"
+              "    n += JSON.parse(text)[k].pos[1];"
+              "}"
+              "n"),
+      njs_str("9900"),
+      1, 0, 0, 0 },
 
     { "for loop 100M",
       njs_str("var i; for (i = 0; i < 100000000; i++); i"),
       njs_str("100000000"),
-      1 },
+      1, 0, 0, 0 },
 
     { "while loop 100M",
       njs_str("var i = 0; while (i < 100000000) { i++ }; i"),
       njs_str("100000000"),
-      1 },
+      1, 0, 0, 0 },
+
+    { "integer arithmetic 10M",
+      njs_str("var s = 0;"
+              "for (var i = 0; i < 10000000; i++) {"
+              "    if (i < s || i >= 0) { s = ((s + (i & 0xff)) ^ (i << 1)) | 0 }"
+              "}"
+              "s"),
+      njs_str("1077258560"),
+      1, 0, 0, 0 },
+
+    { "array index get/set 10M",
+      njs_str("var a = new Array(1024).fill(1), s = 0;"
+              "for (var i = 0; i < 10000000; i++) {"
+              "    s += a[i & 1023]; a[i & 1023] = i & 7;"
+              "}"
+              "s"),
+      njs_str("34997440"),
+      1, 0, 0, 0 },
+
+    { "property get/set 10M",
+      njs_str("var o = {a:1, b:2, c:3}, s = 0;"
+              "for (var i = 0; i < 10000000; i++) { s += o.a + o.b; o.c = i; }"
+              "s"),
+      njs_str("30000000"),
+      1, 0, 0, 0 },
+
+    { "object literals 1M",
+      njs_str("var s = 0;"
+              "for (var i = 0; i < 1000000; i++) {"
+              "    var o = {id:i, name:'n', tags:null, ok:true}; s += o.id;"
+              "}"
+              "s"),
+      njs_str("499999500000"),
+      1, 0, 0, 0 },
+
+    { "string concat 1MB",
+      njs_str("var s = '', chunk = 'x'.repeat(100);"
+              "for (var i = 0; i < 10000; i++) { s += chunk; }"
+              "s.length"),
+      njs_str("1000000"),
+      1, 0, 0, 0 },
 
     { "fibobench numbers",
       njs_str("function fibo(n) {"
@@ -187,7 +431,7 @@ static njs_benchmark_test_t  njs_test[] =
               "}"
               "fibo(32)"),
       njs_str("3524578"),
-      1 },
+      1, 0, 0, 0 },
 
     { "fibobench ascii strings",
       njs_str("function fibo(n) {"
@@ -197,7 +441,7 @@ static njs_benchmark_test_t  njs_test[] =
               "}"
               "fibo(32).length"),
       njs_str("3524578"),
-      1 },
+      1, 0, 0, 0 },
 
     { "fibobench byte strings",
       njs_str("var a = '\\x80'.toBytes();"
@@ -208,7 +452,7 @@ static njs_benchmark_test_t  njs_test[] =
               "}"
               "fibo(32).length"),
       njs_str("3524578"),
-      1 },
+      1, 0, 0, 0 },
 
     { "fibobench utf8 strings",
       njs_str("function fibo(n) {"
@@ -218,28 +462,28 @@ static njs_benchmark_test_t  njs_test[] =
               "}"
               "fibo(32).length"),
       njs_str("3524578"),
-      1 },
+      1, 0, 0, 0 },
 
     { "array 64k keys",
       njs_str("var arr = new Array(2**16);"
               "arr.fill(1);"
               "Object.keys(arr)[0]"),
       njs_str("0"),
-      10 },
+      10, 0, 0, 0 },
 
     { "array 64k values",
       njs_str("var arr = new Array(2**16);"
               "arr.fill(1);"
               "Object.values(arr)[0]"),
       njs_str("1"),
-      10 },
+      10, 0, 0, 0 },
 
     { "array 64k entries",
       njs_str("var arr = new Array(2**16);"
               "arr.fill(1);"
               "Object.entries(arr)[0][0]"),
       njs_str("0"),
-      10 },
+      10, 0, 0, 0 },
 
     { "array 1M",
       njs_str("var arr = new Array(1000000);"
@@ -248,7 +492,88 @@ static njs_benchmark_test_t  njs_test[] =
               "for (var i = 0; i < length; i++) { count += arr[i]; }"
               "count"),
       njs_str("2000000"),
-      1 },
+      1, 0, 0, 0 },
+
+    { "array sort 100k",
+      njs_str("var arr = [];"
+              "for (var i = 0; i < 100000; i++) { arr.push(i * 7919 % 100000) }"
+              "arr.sort()[99999]"),
+      njs_str("99999"),
+      1, 0, 0, 0 },
+
+    { "array sort 100k comparator",
+      njs_str("var arr = [];"
+              "for (var i = 0; i < 100000; i++) { arr.push(i * 7919 % 100000) }"
+              "arr.sort((a, b) => a - b)[99999]"),
+      njs_str("99999"),
+      1, 0, 0, 0 },
+
+    { "object 100k insert/lookup",
+      njs_str("var o = {}, n = 0;"
+              "for (var i = 0; i < 100000; i++) { o['k' + i] = i }"
+              "for (var i = 0; i < 100000; i++) { n += o['k' + i] }"
+              "n"),
+      njs_str("4999950000"),
+      1, 0, 0, 0 },
+
+    { "object long keys 1M lookup",
+      njs_str("var o = {}, keys = [], n = 0;"
+              "for (var i = 0; i < 32; i++) {"
+              "    keys.push('x-forwarded-header-' + i); o[keys[i]] = i }"
+              "for (var i = 0; i < 1000000; i++) { n += o[keys[i & 31]] }"
+              "n"),
+      njs_str("15500000"),
+      1, 0, 0, 0 },
+
+    { "Map 100k insert/lookup",
+      njs_str("var m = new Map(), n = 0;"
+              "for (var i = 0; i < 100000; i++) { m.set('k' + i, i) }"
+              "for (var i = 0; i < 100000; i++) { n += m.get('k' + i) }"
+              "n"),
+      njs_str("4999950000"),
+      1, 0, 0, 0 },
+
+    { "Map 100k number keys",
+      njs_str("var m = new Map(), n = 0;"
+              "for (var i = 0; i < 100000; i++) { m.set(i * 1.5, i) }"
+              "for (var i = 0; i < 100000; i++) { n += m.get(i * 1.5) }"
+              "n"),
+      njs_str("4999950000"),
+      1, 0, 0, 0 },
+
+    { "string indexOf 4k x 100k",
+      njs_str("var s = 'Cookie: ' + 'a=b; '.repeat(800) + 'session=1', n = 0;"
+              "for (var i = 0; i < 100000; i++) { n += s.indexOf('session=') }"
+              "n"),
+      njs_str("400800000"),
+      1, 0, 0, 0 },
+
+    { "string indexOf utf8 4k x 100k",
+      njs_str("var s = 'Cookie: ' + 'я=б; '.repeat(800) + 'session=1', n = 0;"
+              "for (var i = 0; i < 100000; i++) { n += s.indexOf('session=') }"
+              "n"),
+      njs_str("400800000"),
+      1, 0, 0, 0 },
+
+    { "string path parsing 200k",
+      njs_str("var uri = '/api/v1/tenants/0f8fad5b-d9cb-469f-a165-70867728950e'"
+              "          + '/objects/photos/IMG_20230715_184512.jpeg'"
+              "          + '?X-Amz-Algorithm=AWS4-HMAC-SHA256'"
+              "          + '&X-Amz-Date=20230715T184512Z'"
+              "          + '&X-Amz-Expires=86400&X-Amz-SignedHeaders=host';"
+              "var n = 0;"
+              "for (var i = 0; i < 200000; i++) {"
+              "    var q = uri.indexOf('?');"
+              "    var path = uri.slice(0, q), args = uri.substring(q + 1);"
+              "    var parts = path.split('/');"
+              "    var tenant = parts[4], file = parts.slice(-1)[0];"
+              "    var pairs = args.split('&');"
+              "    n += tenant.length + file.length + pairs.length"
+              "         + pairs[0].substr(pairs[0].indexOf('=') + 1).length;"
+              "}"
+              "n"),
+      njs_str("16000000"),
+      1, 0, 0, 0 },
 
     { "typed array 10M",
       njs_str("var arr = new Uint8Array(10000000);"
@@ -257,27 +582,49 @@ static njs_benchmark_test_t  njs_test[] =
               "for (var i = 0; i < length; i++) { count += arr[i]; }"
               "count"),
       njs_str("20000000"),
-      1 },
+      1, 0, 0, 0 },
+
+    { "global references 10M",
+      njs_str("var n = 0;"
+              "for (var i = 0; i < 10000000; i++) {"
+              "    if (Math && JSON && String) { n++; }"
+              "}"
+              "n"),
+      njs_str("10000000"),
+      1, 0, 0, 0 },
 
     { "external property ($shared.uri)",
       njs_str("$shared.uri"),
       njs_str("shared"),
-      1000 },
+      1000, 0, 0, 0 },
 
     { "external object property ($shared.props.a)",
       njs_str("$shared.props.a"),
       njs_str("4294967295"),
-      1000 },
+      1000, 0, 0, 0 },
 
     { "external dump (JSON.stringify($shared.header))",
       njs_str("JSON.stringify($shared.header)"),
       njs_str("{\"01\":\"01|АБВ\",\"02\":\"02|АБВ\",\"03\":\"03|АБВ\"}"),
-      1000 },
+      1000, 0, 0, 0 },
 
     { "external method ($shared.method('YES'))",
       njs_str("$shared.method('YES')"),
       njs_str("shared"),
-      1000 },
+      1000, 0, 0, 0 },
+};
+
+
+static njs_mp_benchmark_test_t  njs_mp_test[] =
+{
+    { "mp alloc/free 16-128",
+      16, 128, 64, 10000000 },
+
+    { "mp alloc/free 16-256 64K live",
+      16, 256, 65536, 10000000 },
+
+    { "mp alloc/free 16-2048 64K live",
+      16, 2048, 65536, 5000000 },
 };
 
 
@@ -306,16 +653,17 @@ static njs_str_t  code = njs_str(
 int njs_cdecl
 main(int argc, char **argv)
 {
-    char                  *p;
-    u_char                *start;
-    njs_vm_t              *vm;
-    njs_int_t             ret, k;
-    njs_str_t             out;
-    njs_uint_t            i;
-    njs_opts_t            opts;
-    njs_value_t           args[2], report;
-    njs_vm_opt_t          options;
-    njs_benchmark_test_t  *test;
+    char                     *p;
+    u_char                   *start;
+    njs_vm_t                 *vm;
+    njs_int_t                ret, k;
+    njs_str_t                out;
+    njs_uint_t               i;
+    njs_opts_t               opts;
+    njs_value_t              args[2], report;
+    njs_vm_opt_t             options;
+    njs_benchmark_test_t     *test;
+    njs_mp_benchmark_test_t  *mp_test;
 
     static const char  help[] =
         "njs benchmark.\n"
@@ -421,6 +769,20 @@ main(int argc, char **argv)
         }
     }
 
+    for (i = 0; i < njs_nitems(njs_mp_test); i++) {
+        mp_test = &njs_mp_test[i];
+
+        if (strncmp(mp_test->name, opts.prefix,
+                    njs_min(strlen(mp_test->name), strlen(opts.prefix))) == 0)
+        {
+            ret = njs_mp_benchmark_test(vm, &opts, &report, mp_test);
+
+            if (ret != NJS_OK) {
+                goto done;
+            }
+        }
+    }
+
     if (opts.previous) {
         ret = njs_vm_value_string_set(vm, &args[0], (u_char *) opts.previous,
                                       njs_strlen(opts.previous));
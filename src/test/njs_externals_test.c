@@ -137,6 +137,23 @@ njs_unit_test_r_uri(njs_vm_t *vm, njs_object_prop_t *prop,
 }
 
 
+static njs_int_t
+njs_unit_test_r_buffer(njs_vm_t *vm, njs_object_prop_t *prop,
+    njs_value_t *value, njs_value_t *unused, njs_value_t *retval)
+{
+    njs_unit_test_req_t  *r;
+
+    r = njs_vm_external(vm, value);
+    if (r == NULL) {
+        njs_value_undefined_set(retval);
+        return NJS_DECLINED;
+    }
+
+    return njs_vm_value_array_buffer_set(vm, retval, r->uri.start,
+                                         r->uri.length);
+}
+
+
 static njs_int_t
 njs_unit_test_r_a(njs_vm_t *vm, njs_object_prop_t *prop,
     njs_value_t *value, njs_value_t *unused, njs_value_t *retval)
@@ -544,6 +561,15 @@ static njs_external_t  njs_unit_test_r_external[] = {
         }
     },
 
+    {
+        .flags = NJS_EXTERN_PROPERTY,
+        .name.string = njs_str("buffer"),
+        .enumerable = 1,
+        .u.property = {
+            .handler = njs_unit_test_r_buffer,
+        }
+    },
+
     {
         .flags = NJS_EXTERN_PROPERTY,
         .name.string = njs_str("host"),
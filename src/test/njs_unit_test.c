@@ -2830,6 +2830,161 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("var i; for (i in [1,2,3]) {Object.seal({});}"),
       njs_str("undefined") },
 
+    /* Global references. */
+
+    { njs_str("function f() { return Math.abs(-1) }"
+              "[f(), f(), f()]"),
+      njs_str("1,1,1") },
+
+    { njs_str("function f() { return typeof Math == 'object' ? 1 : Math }"
+              "var r = [f(), f()]; globalThis.Math = 5; r.push(f()); r"),
+      njs_str("1,1,5") },
+
+    { njs_str("function f() { return JSON }"
+              "var r; f(); f(); delete globalThis.JSON;"
+              "try { f() } catch (e) { r = e.name } r"),
+      njs_str("ReferenceError") },
+
+    { njs_str("function f() { return typeof JSON }"
+              "var r = [f(), f()]; delete globalThis.JSON; r.push(f()); r"),
+      njs_str("object,object,undefined") },
+
+    { njs_str("globalThis.a = 1; function f() { return a }"
+              "var r = [f(), f()];"
+              "Object.defineProperty(globalThis, 'a', {get() { return 2 },"
+              "                                        configurable: true});"
+              "r.push(f()); delete globalThis.a;"
+              "try { f() } catch (e) { r.push(e.name) }"
+              "globalThis.a = 3; r.push(f()); r"),
+      njs_str("1,1,2,ReferenceError,3") },
+
+    { njs_str("var r = [];"
+              "for (var i = 0; i < 3; i++) {"
+              "    try { r.push(b) } catch (e) { r.push(e.name) }"
+              "    globalThis.b = i;"
+              "} r"),
+      njs_str("ReferenceError,0,1") },
+
+    /* Constant folding. */
+
+    { njs_str("1024 * 1024"),
+      njs_str("1048576") },
+
+    { njs_str("'prefix' + 'suffix'"),
+      njs_str("prefixsuffix") },
+
+    { njs_str("[-0 === 0, 1/-0, 1/(0 * -1), 1/(-0 + 0), 1/(-0 - 0), 1/-(-0)]"),
+      njs_str("true,-Infinity,-Infinity,Infinity,-Infinity,Infinity") },
+
+    { njs_str("['1' - 1, '0x10' * 1, '' * 1, ' 12 ' / 2, 'a' * 1, '1' + 1,"
+              " 1 + '1', true + 1, null + 1, null + 'x', 1 + true + 'a']"),
+      njs_str("0,16,0,6,NaN,11,11,2,1,nullx,2a") },
+
+    { njs_str("[!0, !'', !'0', !null, ~'5', +'', +' 1e3 ', 1/-'-0', 1/-'']"),
+      njs_str("true,true,false,true,-6,0,1000,Infinity,-Infinity") },
+
+    { njs_str("['10' < '9', '10' < 9, 'a' < 1, 'a' >= 1, null >= 0,"
+              " null == 0, '1' == 1, '' == 0, true == '1', null === null,"
+              " 0/0 == 0/0, 0/0 !== 0/0, 'b' > 'a']"),
+      njs_str("true,false,false,false,true,false,true,true,true,true,"
+              "false,true,true") },
+
+    { njs_str("[1 << 31, -1 >>> 0, -16 >> 2, 2 ** 10, (-8) % 3, 5.5 % 2,"
+              " 2 ** -1, 1 | 0x100000000, 1 ** (0/0), (-1) ** (1/0)]"),
+      njs_str("-2147483648,4294967295,-4,1024,-2,1.5,0.5,1,NaN,NaN") },
+
+    { njs_str("[typeof 1, typeof '', typeof null, typeof !0, typeof (1 + '')]"),
+      njs_str("number,string,object,boolean,string") },
+
+    { njs_str("`a${1 + 1}b${null}${true}${-0}${1e21}${'α'}`"),
+      njs_str("a2bnulltrue01e+21α") },
+
+    { njs_str("[('α' + 'β').length, ('α' + 1).length, `${'α'}${2}`.length]"),
+      njs_str("2,2,2") },
+
+    { njs_str("[0 ? 'a' : 'b', 1 && 'c', 0 || 'd', null ?? 'e', 0 ?? 'f',"
+              " '' && 'g']"),
+      njs_str("b,c,d,e,0,") },
+
+    { njs_str("var o = {f: function() { return this === o }};"
+              "[(1 && o.f)(), (0 ? 0 : o.f)(), o.f()]"),
+      njs_str("false,false,true") },
+
+    { njs_str("typeof (1 && undeclared)"),
+      njs_str("ReferenceError: \"undeclared\" is not defined in 1") },
+
+    { njs_str("var x = 1; (1 && x) = 2"),
+      njs_str("ReferenceError: Invalid left-hand side in assignment in 1") },
+
+    { njs_str("1 || 2 ?? 3"),
+      njs_str("SyntaxError: Either \"??\" or \"||\" expression "
+              "must be parenthesized in 1") },
+
+    { njs_str("var r = [];"
+              "if (0) { r.push(1) } else { r.push(2) }"
+              "if ('0') r.push(3); if (null) r.push(4);"
+              "if (!1) { var x = 5 } r.push(typeof x); r"),
+      njs_str("2,3,undefined") },
+
+    /* Optimized jumps and compare-and-branch instructions. */
+
+    { njs_str("var c = 0, o = {valueOf: function() {c++; return 5}};"
+              "for (var i = 0; i < o; i++) {} [i, c]"),
+      njs_str("5,6") },
+
+    { njs_str("function f(a, b) {"
+              "    if (a < b) return 1; if (a >= b) return 2; return 3 }"
+              "[f(1, 2), f(2, 1), f(NaN, 1), f('a', 'b'), f(undefined, 0),"
+              " f('10', 9)]"),
+      njs_str("1,2,3,1,3,2") },
+
+    { njs_str("function f(a, b) {"
+              "    if (a == b) return 'eq'; if (a != b) return 'ne' }"
+              "[f(1, '1'), f(null, undefined), f(0, null),"
+              " f({}, '[object Object]')]"),
+      njs_str("eq,eq,ne,eq") },
+
+    { njs_str("function f(x) {"
+              "    if (x === -0) return 'z'; if (x !== x) return 'nan';"
+              "    return 'o' }"
+              "[f(0), f(NaN), f(1), f('0')]"),
+      njs_str("z,nan,o,o") },
+
+    { njs_str("function f() {"
+              "    return g(); function g() { return 7 } var x = 1 }"
+              "f()"),
+      njs_str("7") },
+
+    { njs_str("var s = '';"
+              "for (var i = 0; i < 5; i++) {"
+              "    try { if (i == 1) continue; if (i == 3) break; s += i }"
+              "    catch (e) {} finally { s += 'f' } } s"),
+      njs_str("0ff2ff") },
+
+    { njs_str("var r; try { if ({valueOf: function() {throw 'x'}} <= 1) {} }"
+              "catch (e) { r = e } r"),
+      njs_str("x") },
+
+    { njs_str("function f(a, b) { var t; t = a - b; var r = t; return r }"
+              "f(5, 3)"),
+      njs_str("2") },
+
+    { njs_str("var r = [];"
+              "outer: for (var i = 0; i < 3; i++) {"
+              "    for (var j = 0; j < 3; j++) {"
+              "        if (j > i) continue outer;"
+              "        if (i == 2 && j == 1) break outer;"
+              "        r.push(i + '' + j) } } r"),
+      njs_str("00,10,11,20") },
+
+    { njs_str("var n = 0, i = 10; do { n++ } while (--i > 0 && n != 5);"
+              "[n, i]"),
+      njs_str("5,5") },
+
+    { njs_str("function f(x) { while (true) { if (x > 3) { return x } x++ } }"
+              "f(0)"),
+      njs_str("4") },
+
     /* break. */
 
     { njs_str("break"),
@@ -4329,6 +4484,26 @@ static njs_unit_test_t  njs_test[] =
                  "b[0] +' '+ b[1] +' '+ b[2]"),
       njs_str("4 5 undefined") },
 
+    { njs_str("var a = [0,,2], r; Array.prototype[1] = 'p';"
+              "r = [a[1], a[2], a[3], a[-1], a[1.5]];"
+              "delete Array.prototype[1]; r"),
+      njs_str("p,2,,,") },
+
+    { njs_str("var a = [1,2,3]; a[1.5] = 'x'; a[-0] = 'z'; a[3] = 4;"
+              "[a.length, a[1.5], a[0], a[3], a[4294967295] = 5, a.length]"),
+      njs_str("4,x,z,4,5,4") },
+
+    { njs_str("var r = [], x = [1, 0.5, -0, NaN, null, undefined, true, '1'];"
+              "x.forEach(a => x.forEach(b => {"
+              "    r.push(+(a < b), +(a <= b), +(a > b), +(a >= b), +(a == b))"
+              "})); r.join('')"),
+      njs_str("010110011000110000000011000000010110101111000010110011000000"
+              "001100000011000110001100011000010110000001010000001100011000"
+              "000000000000000000000000000000000000000011000110000101000000"
+              "010110000111000110000000000000000000000000001000010000000000"
+              "010110011000110000000011000000010110101101011001100011000000"
+              "00110000000101101011") },
+
     { njs_str("var a = [1,2]; a.pop() +' '+ a.length +' '+ a"),
       njs_str("2 1 1") },
 
@@ -6010,6 +6185,42 @@ static njs_unit_test_t  njs_test[] =
                  "a.sort(function(x, y) { return x - y })"),
       njs_str("1,") },
 
+    { njs_str("[10,9,1,undefined,,'b','a'].sort()"),
+      njs_str("1,10,9,a,b,,") },
+
+    { njs_str("[3,1,2].sort(1)"),
+      njs_str("TypeError: comparefn must be callable or undefined") },
+
+    { njs_str("[3,1,2].sort((a, b) => { throw 'x' + a })"),
+      njs_str("x3") },
+
+    { njs_str("var a = []; for (var i = 0; i < 100; i++) { a.push({k: i % 3, i}) }"
+              "a.sort((x, y) => x.k - y.k)"
+              ".every((v, i, a) => i == 0 || a[i - 1].k < v.k"
+              "                    || a[i - 1].i < v.i)"),
+      njs_str("true") },
+
+    { njs_str("var a = []; for (var i = 0; i < 1000; i++) { a.push(i * 7919 % 1000) }"
+              "a.sort((x, y) => x - y).every((v, i) => v == i)"),
+      njs_str("true") },
+
+    { njs_str("var a = []; for (var i = 0; i < 1000; i++) { a.push(999 - i) }"
+              "a.sort().slice(0, 4)"),
+      njs_str("0,1,10,100") },
+
+    { njs_str("var o = {0:'c', 1:undefined, 3:'a', 4:'b', length:5};"
+              "Array.prototype.sort.call(o);"
+              "njs.dump(o)"),
+      njs_str("{0:'a',1:'b',3:undefined,length:5,2:'c'}") },
+
+    { njs_str("var a = [3,2,1];"
+              "a.sort((x, y) => { a.length = 0; return x - y })"),
+      njs_str("1,2,3") },
+
+    { njs_str("var a = [5,4,3,2,1];"
+              "a.sort((x, y) => [y, x].sort((p, q) => p - q)[0] == x ? -1 : 1)"),
+      njs_str("1,2,3,4,5") },
+
     /* Template literal. */
 
     { njs_str("`"),
@@ -6634,6 +6845,39 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("'abcdefgh'.slice(100, 120)"),
       njs_str("") },
 
+    { njs_str("var s = 'abcdefghijklmnopqrstuvwxyz'.repeat(2);"
+              "var t = s.slice(3, 40), u = t.substring(10, 30);"
+              "[t, t.length, u, u.substr(4, 16), s.slice(0) === s]"),
+      njs_str("defghijklmnopqrstuvwxyzabcdefghijklmn,37,"
+              "nopqrstuvwxyzabcdefg,rstuvwxyzabcdefg,true") },
+
+    { njs_str("var s = 'αβγδεζηθικλμνξοπρστυφχψω'.repeat(3);"
+              "var t = s.slice(2, 30), u = s.slice(1, 60);"
+              "[t.length, t[27], t.indexOf('π'), u.length, u[40], u.slice(-3)]"),
+      njs_str("28,ζ,13,59,σ,κλμ") },
+
+    { njs_str("var s = 'x'.repeat(50) + 'y'.repeat(50);"
+              "var t = s.slice(40, 70); t += 'z';"
+              "[t, s.length, s.slice(40, 70).length]"),
+      njs_str("xxxxxxxxxxyyyyyyyyyyyyyyyyyyyyz,100,30") },
+
+    { njs_str("var s = 'k'.repeat(20) + '=' + 'v'.repeat(20) + ';';"
+              "var o = {}; o[s.slice(0, 20)] = 1; o[s.slice(21, 41)] = 2;"
+              "[o['k'.repeat(20)], o['v'.repeat(20)], s.slice(0, 20) == 'k'.repeat(20)]"),
+      njs_str("1,2,true") },
+
+    { njs_str("var p = '/' + 'a'.repeat(16) + '/' + 'β'.repeat(20) + '/c';"
+              "p.split('/').map(v => v.length)"),
+      njs_str("0,16,20,1") },
+
+    { njs_str("var m = /(\\w+)=(\\w+)/.exec('&' + 'k'.repeat(20) + '=' + 'v'.repeat(30));"
+              "[m[0].length, m[1], m[2].length]"),
+      njs_str("51,kkkkkkkkkkkkkkkkkkkk,30") },
+
+    { njs_str("var s = 'a'.repeat(1000) + 'b'.repeat(20);"
+              "var t = s.slice(995); [t, t.trim() === t]"),
+      njs_str("aaaaabbbbbbbbbbbbbbbbbbbb,true") },
+
     { njs_str("String.prototype.substring(1, 5)"),
       njs_str("") },
 
@@ -6987,6 +7231,34 @@ static njs_unit_test_t  njs_test[] =
                  "== JSON.stringify([].concat(Array(4).fill(0), Array(7).fill(4), Array(13).fill(11)))"),
       njs_str("true") },
 
+    { njs_str("var s = 'x'.repeat(1000) + 'Set-Cookie: sid' + 'x'.repeat(1000);"
+              "[s.indexOf('Set-Cookie: sid'), s.indexOf('Set-Cookie: sid', 1001),"
+              " s.lastIndexOf('Set-Cookie: sid'), s.includes('Set-Cookie: sid')]"),
+      njs_str("1000,-1,1000,true") },
+
+    { njs_str("var s = 'ж'.repeat(500) + 'session=abcdef' + 'ж'.repeat(500);"
+              "[s.indexOf('session=abcdef'), s.lastIndexOf('session=abcdef'),"
+              " s.includes('session=abcdef', 501)]"),
+      njs_str("500,500,false") },
+
+    { njs_str("var s = 'ж'.repeat(300) + 'абвгдежзий' + 'ж'.repeat(300);"
+              "[s.indexOf('абвгдежзий'), s.lastIndexOf('жабвгдежзий')]"),
+      njs_str("300,299") },
+
+    { njs_str("var s = 'ab'.repeat(200) + 'abababac';"
+              "[s.indexOf('abababac'), s.lastIndexOf('abababab')]"),
+      njs_str("400,398") },
+
+    { njs_str("var s = ('q'.repeat(300) + 'needle-needle').repeat(2);"
+              "[s.lastIndexOf('needle-needle'), s.lastIndexOf('needle-needle', 612),"
+              " s.lastIndexOf('needle-needle', 299)]"),
+      njs_str("613,300,-1") },
+
+    { njs_str("var s = ('ё'.repeat(300) + 'needle-needle').repeat(2);"
+              "[s.indexOf('needle-needle', 301), s.lastIndexOf('needle-needle', 612),"
+              " s.lastIndexOf('needle-needle', 299)]"),
+      njs_str("613,300,-1") },
+
     { njs_str("''.includes('')"),
       njs_str("true") },
 
@@ -7212,6 +7484,10 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("'абвгдежгийклм'.replace('г', 'Г')"),
       njs_str("абвГдежгийклм") },
 
+    { njs_str("('я'.repeat(300) + 'token=secret;').replace('token=secret', 'token=***')"
+              ".slice(299)"),
+      njs_str("яtoken=***;") },
+
     { njs_str("'abcdefghdijklm'.replace('d',"
                  "   function(m, o, s) { return '|'+s+'|'+o+'|'+m+'|' })"),
       njs_str("abc|abcdefghdijklm|3|d|efghdijklm") },
@@ -7557,6 +7833,10 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("('α'+'β'.repeat(33)).repeat(2).split('α')[1][32]"),
       njs_str("β") },
 
+    { njs_str("('x'.repeat(300) + '--boundary--').repeat(3).split('--boundary--')"
+              ".map(v=>v.length)"),
+      njs_str("300,300,300,0") },
+
     { njs_str("'abc'.split('abc')"),
       njs_str(",") },
 
@@ -10890,6 +11170,123 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("Number.isNaN(Infinity)"),
       njs_str("false") },
 
+    /* Map and Set */
+
+    { njs_str("var m = new Map([[1, 'a'], ['1', 'b'], [-0, 'z'], [NaN, 'n']]);"
+              "[m.size, m.get(1), m.get('1'), m.get(0), m.get(NaN), m.has(+0)]"),
+      njs_str("4,a,b,z,n,true") },
+
+    { njs_str("var o = {}, m = new Map().set(o, 1).set(Symbol.iterator, 2)"
+              "                         .set(null, 3).set(undefined, 4);"
+              "[m.get(o), m.get({}), m.get(Symbol.iterator), m.get(null),"
+              " m.get(undefined), m.get(false)]"),
+      njs_str("1,,2,3,4,") },
+
+    { njs_str("var m = new Map([[1, 1], [2, 2]]); m.set(1, 3);"
+              "[m.size, m.get(1), m.delete(1), m.delete(1), m.size]"),
+      njs_str("2,3,true,false,1") },
+
+    { njs_str("var m = new Map([[-0, 1]]); Object.is(m.keys().next().value, 0)"),
+      njs_str("true") },
+
+    { njs_str("var s = new Set([1, 2, 2, '2', 3]); s.add(1).add(4);"
+              "[s.size, s.has(2), s.has('3')]"),
+      njs_str("5,true,false") },
+
+    { njs_str("new Set('hello').size"),
+      njs_str("4") },
+
+    { njs_str("var m = new Map([['a', 1], ['b', 2]]), r = [];"
+              "m.forEach(function(v, k, map) { r.push(k + v, map === m) }); r"),
+      njs_str("a1,true,b2,true") },
+
+    { njs_str("var s = new Set([1, 2, 3]), r = [];"
+              "s.forEach((v, k) => {r.push(v + k);"
+              "                     if (v == 1) { s.delete(2); s.add(4) }}); r"),
+      njs_str("2,6,8") },
+
+    { njs_str("var m = new Map([['a', 1], ['b', 2], ['c', 3]]), r = [];"
+              "m.forEach((v, k) => {r.push(k); if (k == 'a') {m.clear(); m.set('d', 4)}});"
+              "r"),
+      njs_str("a,d") },
+
+    { njs_str("var m = new Map([[1, 'a'], [2, 'b']]), it = m.entries();"
+              "JSON.stringify([it.next(), it.next(), it.next(), it.next()])"),
+      njs_str("[{\"value\":[1,\"a\"],\"done\":false},"
+              "{\"value\":[2,\"b\"],\"done\":false},"
+              "{\"done\":true},{\"done\":true}]") },
+
+    { njs_str("var m = new Map(), it = m.keys(), r = [], x;"
+              "for (var i = 0; i < 100; i++) { m.set(i, i) }"
+              "it.next();"
+              "for (var i = 0; i < 95; i++) { m.delete(i) }"
+              "while (!(x = it.next()).done) { r.push(x.value) } r"),
+      njs_str("95,96,97,98,99") },
+
+    { njs_str("var s = new Set([1, 2]), it = s.values(); it.next(); s.clear();"
+              "s.add(3); it.next().value"),
+      njs_str("3") },
+
+    { njs_str("var s = new Set(['a']), it = s.entries();"
+              "[it.next().value, it[Symbol.iterator]() === it]"),
+      njs_str("a,a,true") },
+
+    { njs_str("var iter = {}; iter[Symbol.iterator] = function() {"
+              "    var i = 0;"
+              "    return {next() { i++; return (i <= 3) ? {value: [i, i * i]} : {done: true}}}};"
+              "var m = new Map(iter); [m.size, m.get(2)]"),
+      njs_str("3,4") },
+
+    { njs_str("var closed = 0, iter = {}; iter[Symbol.iterator] = function() {"
+              "    return {next() { return {value: 1} }, return() { closed++ }}};"
+              "var r; try { new Map(iter) } catch (e) { r = [e, closed] } r"),
+      njs_str("TypeError: Iterator value number is not an entry object,1") },
+
+    { njs_str("new Map(new Map([[1, 2], [3, 4]])).get(3)"),
+      njs_str("4") },
+
+    { njs_str("Map()"),
+      njs_str("TypeError: Constructor Map requires 'new'") },
+
+    { njs_str("new Set(1)"),
+      njs_str("TypeError: number is not iterable") },
+
+    { njs_str("Map.prototype.get.call(new Set(), 1)"),
+      njs_str("TypeError: Method Map.prototype.get called on incompatible receiver") },
+
+    { njs_str("new Map().keys().next.call(new Set().keys())"),
+      njs_str("TypeError: Method Map Iterator.prototype.next called on incompatible receiver") },
+
+    { njs_str("Map.prototype.size"),
+      njs_str("TypeError: Method Map.prototype.size called on incompatible receiver") },
+
+    { njs_str("[Object.prototype.toString.call(new Map()),"
+              " Object.prototype.toString.call(new Set().values()),"
+              " typeof new Set(), Map.name, Set.length]"),
+      njs_str("[object Map],[object Set Iterator],object,Map,0") },
+
+    { njs_str("njs.dump(new Map([[1, 2]]))"),
+      njs_str("Map {}") },
+
+    { njs_str("[Map.prototype[Symbol.iterator] === Map.prototype.entries,"
+              " Set.prototype.keys === Set.prototype.values,"
+              " Set.prototype[Symbol.iterator] === Set.prototype.values]"),
+      njs_str("true,true,true") },
+
+    { njs_str("[Set.prototype[Symbol.iterator].name,"
+              " Set.prototype.keys.name, Map.prototype[Symbol.iterator].name]"),
+      njs_str("values,values,entries") },
+
+    { njs_str("var f = Map.prototype.entries; delete Map.prototype.entries;"
+              "[Map.prototype[Symbol.iterator] !== f,"
+              " Map.prototype[Symbol.iterator].name,"
+              " new Map([[1, 2]])[Symbol.iterator]().next().value]"),
+      njs_str("true,entries,1,2") },
+
+    { njs_str("var it = new Set([1, 2]).keys(); it.next();"
+              "njs.dump(it.next())"),
+      njs_str("{value:2,done:false}") },
+
 #if 0
     { njs_str("parseFloat === Number.parseFloat"),
       njs_str("true") },
@@ -11352,6 +11749,31 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("'XUBAAAB' + 'XGYXKY'"),
       njs_str("XUBAAABXGYXKY") },
 
+    /* Append buffers. */
+
+    { njs_str("var a = 'x'.repeat(15), b = a + 'y', c = b + 'z', d = b + 'w';"
+              "var e = c + '1', f = d + '2', g = c + '3';"
+              "[b, c, d, e, f, g].map(v => v.slice(14)).join()"),
+      njs_str("xy,xyz,xyw,xyz1,xyw2,xyz3") },
+
+    { njs_str("var s = ''; for (var i = 0; i < 1000; i++) { s += i % 10 }"
+              "[s.length, s.slice(-5), s.indexOf('90'), s[999]]"),
+      njs_str("1000,56789,9,9") },
+
+    { njs_str("var s = 'α'.repeat(20); s += 'x'.repeat(20); s += 'β';"
+              "[s.length, s[39], s[40]]"),
+      njs_str("41,x,β") },
+
+    { njs_str("var s = String.bytesFrom(Array(16).fill(0x9d));"
+              "var t = s + 'x'.repeat(16); t += 'y';"
+              "[t.length, t.toString('hex').slice(-6)]"),
+      njs_str("33,787879") },
+
+    { njs_str("var s = 'x'.repeat(16), o = {};"
+              "for (var i = 0; i < 3; i++) { s += i; o[s] = i }"
+              "Object.keys(o).map(k => k.slice(16) + o[k])"),
+      njs_str("00,011,0122") },
+
     { njs_str("String.__proto__ === Function.prototype"),
       njs_str("true") },
 
@@ -12044,6 +12466,96 @@ static njs_unit_test_t  njs_test[] =
                  "Object.defineProperty(o, 'a', { value: 1, writable:1 }); o.a = 2; o.a"),
       njs_str("2") },
 
+    { njs_str("function get(o) { return o.a }"
+                 "var o = {a:1}; var r = [get(o)];"
+                 "delete o.a; r.push(get(o));"
+                 "o.a = 3; r.push(get(o)); njs.dump(r)"),
+      njs_str("[1,undefined,3]") },
+
+    { njs_str("function get(o) { return o.a }"
+                 "var o = {a:1}; var r = get(o);"
+                 "Object.defineProperty(o, 'a', {get() {return 2}});"
+                 "r + get(o)"),
+      njs_str("3") },
+
+    { njs_str("function set(o, v) { o.a = v }"
+                 "var o = {a:1}; set(o, 2); Object.freeze(o); set(o, 3)"),
+      njs_str("TypeError: Cannot assign to read-only property \"a\" of object") },
+
+    { njs_str("function get(o) { return o.x }"
+                 "var objs = [{x:1}, {x:2}, {x:3}, {y:0, x:4}];"
+                 "var s = 0; for (var i = 0; i < 12; i++) { s += get(objs[i % 4]) }; s"),
+      njs_str("30") },
+
+    { njs_str("function get(o) { return o.a }"
+                 "var p = {a:1}; var o = Object.create(p); var r = get(o);"
+                 "o.a = 2; p.a = 5; r + get(o)"),
+      njs_str("3") },
+
+    { njs_str("var o = {b:1, a:2}; o.c = 3; Object.keys(o)"),
+      njs_str("b,a,c") },
+
+    { njs_str("var o = {a:1, b:2}; delete o.a; o.a = 3; njs.dump(Object.entries(o))"),
+      njs_str("[['a',3],['b',2]]") },
+
+    { njs_str("var o = {a:1}; Object.defineProperty(o, 'a', {writable:false});"
+                 "o.a = 2"),
+      njs_str("TypeError: Cannot assign to read-only property \"a\" of object") },
+
+    { njs_str("function P(x, y) { this.x = x; this.y = y }; var a = [];"
+                 "for (var i = 0; i < 3; i++) { a.push(new P(i, i * 2)) }"
+                 "a.map(p => p.x + p.y)"),
+      njs_str("0,3,6") },
+
+    { njs_str("var o = {}; for (var i = 0; i < 100; i++) { o['k' + i] = i }"
+                 "var s = 0; for (var k in o) { s += o[k] };"
+                 "[s, Object.keys(o).length, o.k0, o.k99]"),
+      njs_str("4950,100,0,99") },
+
+    { njs_str("[Object.isFrozen(Object.freeze({a:1})),"
+                 " Object.isFrozen(Object.preventExtensions({a:1})),"
+                 " Object.isSealed(Object.preventExtensions({}))]"),
+      njs_str("true,false,true") },
+
+    { njs_str("var o = {a:1}; Object.preventExtensions(o); o.a = 2;"
+                 "try { o.b = 3 } catch (e) { o.a += 1 }; njs.dump(o)"),
+      njs_str("{a:3}") },
+
+    { njs_str("function F() { this.b = 2 }; F.prototype = {a:1, b:1};"
+                 "var r = []; for (var k in new F()) { r.push(k) }; r"),
+      njs_str("b,a") },
+
+    { njs_str("var s = Symbol('s'); var o = {a:1}; o[s] = 2;"
+                 "[o[s] + o.a, Object.keys(o)]"),
+      njs_str("3,a") },
+
+    { njs_str("var o = {a:1}; o[1] = 2; o.b = 3; Object.keys(o)"),
+      njs_str("a,1,b") },
+
+    { njs_str("function g(o) { return o.x }; var s = 0;"
+                 "for (var i = 0; i < 4; i++) { s += g({x:i}); s += g({y:1, x:i}) }; s"),
+      njs_str("12") },
+
+    { njs_str("var o = {x:1, y:2};"
+                 "[o.hasOwnProperty('y'), 'x' in o,"
+                 " Object.getOwnPropertyDescriptor(o, 'x').configurable]"),
+      njs_str("true,true,true") },
+
+    { njs_str("var o = JSON.parse('{\"content-security-policy\":1}');"
+                 "var k = 'content-security-' + 'policy'; o[k] += 1;"
+                 "[o['content-security-policy'], k in o, Object.keys(o)[0] === k]"),
+      njs_str("2,true,true") },
+
+    { njs_str("var o = {}, k = 'x-forwarded-for-' + 'client';"
+                 "o[k] = 1; o['x-forwarded-for-client'] += 1;"
+                 "delete o['x-forwarded-for-client']; [k in o, o[k]]"),
+      njs_str("false,") },
+
+    { njs_str("var k = 'x-forwarded-for-' + 'client', o = {};"
+                 "o[k.slice(0, 15)] = 1; o[k] = 2;"
+                 "njs.dump(o)"),
+      njs_str("{x-forwarded-for:1,x-forwarded-for-client:2}") },
+
     { njs_str("var o = {};"
                  "Object.defineProperty(o, new String('a'), { value: 1}); o.a"),
       njs_str("1") },
@@ -15106,6 +15618,18 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("JSON.parse('[{}, true ,1.1e2, {\"a\":[3,\"b\"]}]')[3].a[1]"),
       njs_str("b") },
 
+    { njs_str("var a = JSON.parse('[[], [1, [2, []], 3], []]');"
+              "a[0].push(4); a[1].unshift(0); a[2][5] = 6;"
+              "JSON.stringify(a)"),
+      njs_str("[[4],[0,1,[2,[]],3],[null,null,null,null,null,6]]") },
+
+    { njs_str("var n = [], i; for (i = 0; i < 200; i++) { n.push(i) }"
+              "var s = '[' + n.join(',') + ',[' + n.join(',') + '],' + n.join(',') + ']';"
+              "var a = JSON.parse(s);"
+              "[a.length, a[200].length, a[200][199], a[400],"
+              " a.filter(v => typeof v == 'number').reduce((s, v) => s + v)]"),
+      njs_str("401,200,199,199,39800") },
+
     { njs_str("var o = JSON.parse('{\"a\":2}');"
                  "Object.getOwnPropertyDescriptor(o, 'a').configurable"),
       njs_str("true") },
@@ -15150,6 +15674,9 @@ static njs_unit_test_t  njs_test[] =
     { njs_str("JSON.parse('null') || 10"),
       njs_str("10") },
 
+    { njs_str("JSON.stringify(JSON.parse('{\"a\":1, \"b\":{\"c\":2}, \"a\":3}'))"),
+      njs_str("{\"a\":3,\"b\":{\"c\":2}}") },
+
     { njs_str("var o = JSON.parse('{}', function(k, v) {return v;}); o"),
       njs_str("[object Object]") },
 
@@ -16727,6 +17254,12 @@ static njs_unit_test_t  njs_externals_test[] =
     { njs_str("delete $r3.vars.p; $r3.vars.p"),
       njs_str("undefined") },
 
+    { njs_str("var b = $r.buffer; [b.byteLength, new Uint8Array(b)]"),
+      njs_str("6,208,144,208,145,208,146") },
+
+    { njs_str("new Uint8Array($r2.buffer.slice(2)).length"),
+      njs_str("4") },
+
     { njs_str("var a = $r.host; a +' '+ a.length +' '+ a"),
       njs_str("АБВГДЕЁЖЗИЙ 22 АБВГДЕЁЖЗИЙ") },
 
@@ -17109,6 +17642,7 @@ typedef struct {
     njs_bool_t  verbose;
     njs_bool_t  unsafe;
     njs_bool_t  module;
+    njs_bool_t  arena;
     njs_uint_t  repeat;
     njs_uint_t  externals;
 } njs_opts_t;
@@ -17165,6 +17699,7 @@ njs_unit_test(njs_unit_test_t tests[], size_t num, const char *name,
 
         options.module = opts->module;
         options.unsafe = opts->unsafe;
+        options.arena = opts->arena;
 
         vm = njs_vm_create(&options);
         if (vm == NULL) {
@@ -17997,105 +18532,1088 @@ njs_string_to_index_test(njs_vm_t *vm, njs_opts_t *opts, njs_stat_t *stat)
 
 
 static njs_int_t
-njs_api_test(njs_opts_t *opts, njs_stat_t *stat)
+njs_shape_property_query_test(njs_vm_t *vm, njs_opts_t *opts,
+    njs_stat_t *stat)
 {
-    njs_vm_t      *vm;
-    njs_int_t     ret;
-    njs_uint_t    i;
-    njs_stat_t    prev;
-    njs_vm_opt_t  options;
+    u_char                *start;
+    njs_vm_t              *nvm;
+    njs_int_t             ret;
+    njs_value_t           object, key;
+    njs_object_prop_t     *prop;
+    njs_property_query_t  pq;
 
-    static const struct {
-        njs_int_t  (*test)(njs_vm_t *, njs_opts_t *, njs_stat_t *stat);
-        njs_str_t  name;
-    } tests[] = {
-        { njs_vm_object_alloc_test,
-          njs_str("njs_vm_object_alloc_test") },
-        { njs_file_basename_test,
-          njs_str("njs_file_basename_test") },
-        { njs_file_dirname_test,
-          njs_str("njs_file_dirname_test") },
-        { njs_chb_test,
-          njs_str("njs_chb_test") },
-        { njs_string_to_index_test,
-          njs_str("njs_string_to_index_test") },
-    };
+    static const njs_str_t  script = njs_str("var o = {a:1, b:2}");
+    static const njs_str_t  path = njs_str("o");
 
-    vm = NULL;
-    njs_vm_opt_init(&options);
+    start = script.start;
 
-    prev = *stat;
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NJS_OK) {
+        return NJS_ERROR;
+    }
 
-    ret = NJS_ERROR;
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        return NJS_ERROR;
+    }
 
-    for (i = 0; i < njs_nitems(tests); i++) {
-        vm = njs_vm_create(&options);
-        if (vm == NULL) {
-            njs_printf("njs_vm_create() failed\n");
-            goto done;
-        }
+    ret = njs_vm_start(nvm);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
 
-        ret = tests[i].test(vm, opts, stat);
-        if (njs_slow_path(ret != NJS_OK)) {
-            njs_printf("njs_api_test: \"%V\" test failed\n", &tests[i].name);
-            goto done;
-        }
+    ret = njs_vm_value(nvm, &path, &object);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
 
-        njs_vm_destroy(vm);
-        vm = NULL;
+    ret = njs_vm_value_string_set(nvm, &key, (u_char *) "b", 1);
+    if (ret != NJS_OK) {
+        goto fail;
     }
 
-    ret = NJS_OK;
+    /* The scratch property is left by a query of an accessor property. */
 
-done:
+    njs_property_query_init(&pq, NJS_PROPERTY_QUERY_GET, 1);
 
-    njs_unit_test_report("API tests", &prev, stat);
+    njs_set_undefined(&pq.scratch.getter);
+    njs_set_undefined(&pq.scratch.setter);
 
-    if (vm != NULL) {
-        njs_vm_destroy(vm);
+    ret = njs_property_query(nvm, &pq, &object, &key);
+    if (ret != NJS_OK) {
+        goto fail;
     }
 
-    return ret;
+    prop = pq.lhq.value;
+
+    if (njs_is_accessor_descriptor(prop)
+        || !njs_is_number(&prop->value)
+        || njs_number(&prop->value) != 2)
+    {
+        njs_printf("njs_shape_property_query_test: "
+                   "accessor or wrong value of a data property\n");
+
+        stat->failed++;
+
+    } else {
+        stat->passed++;
+    }
+
+    njs_vm_destroy(nvm);
+
+    return NJS_OK;
+
+fail:
+
+    njs_vm_destroy(nvm);
+
+    return NJS_ERROR;
 }
 
 
-int njs_cdecl
-main(int argc, char **argv)
+static njs_int_t
+njs_vm_value_string_create_test(njs_vm_t *vm, njs_opts_t *opts,
+    njs_stat_t *stat)
 {
-    njs_int_t   ret;
-    njs_opts_t  opts;
-    njs_stat_t  stat;
+    u_char             buf[64];
+    njs_int_t          ret;
+    njs_uint_t         i;
+    njs_value_t        value;
+    njs_string_prop_t  string;
 
-    njs_memzero(&opts, sizeof(njs_opts_t));
+    static const struct {
+        njs_str_t  data;
+        uint32_t   length;
+    } tests[] = {
+        { njs_str("abc"), 3 },
+        { njs_str("0123456789abcdefghij"), 20 },
+        { njs_str("\xce\xb1\xce\xb2\xce\xb3\xce\xb4\xce\xb5"
+                  "\xce\xb6\xce\xb7\xce\xb8"), 8 },
+        { njs_str("\xce\xb1\xce"), 0 },
+        { njs_str("\xff\xfe 0123456789abcdefghij"), 0 },
+    };
 
-    if (argc > 1) {
-        switch (argv[1][0]) {
+    for (i = 0; i < njs_nitems(tests); i++) {
+        memcpy(buf, tests[i].data.start, tests[i].data.length);
 
-        case 'd':
-            opts.disassemble = 1;
-            break;
+        ret = njs_vm_value_string_create(vm, &value, buf,
+                                         tests[i].data.length);
+        if (ret != NJS_OK) {
+            njs_printf("njs_vm_value_string_create_test: "
+                       "njs_vm_value_string_create() failed\n");
+            return NJS_ERROR;
+        }
 
-        case 'v':
-            opts.verbose = 1;
-            break;
+        /* The data must be copied. */
 
-        default:
-            break;
+        njs_memzero(buf, sizeof(buf));
+
+        (void) njs_string_prop(&string, &value);
+
+        if (string.size != tests[i].data.length
+            || string.length != tests[i].length
+            || memcmp(string.start, tests[i].data.start, string.size) != 0)
+        {
+            njs_printf("njs_vm_value_string_create_test(\"%V\"):\n"
+                       "expected length: %uD\n     got: %uD, size: %uz\n",
+                       &tests[i].data, tests[i].length,
+                       (uint32_t) string.length, string.size);
+
+            stat->failed++;
+            continue;
         }
+
+        stat->passed++;
     }
 
-    (void) putenv((char *) "TZ=UTC");
-    tzset();
+    return NJS_OK;
+}
 
-    njs_memzero(&stat, sizeof(njs_stat_t));
 
-    opts.repeat = 1;
-    opts.unsafe = 1;
+static njs_int_t
+njs_vm_stat_test(njs_vm_t *vm, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char         *start;
+    njs_vm_t       *nvm;
+    njs_int_t      ret;
+    njs_vm_stat_t  vm_stat;
 
-    njs_mm_denormals(1);
+    static const njs_str_t  script = njs_str("var o = {a:1}; var s = 0;"
+                                             "for (var i = 0; i < 10; i++) {"
+                                             "    s += o.a; o.b = s;"
+                                             "}");
 
-    ret = njs_unit_test(njs_test, njs_nitems(njs_test), "script tests",
-                        &opts, &stat);
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NJS_OK) {
+        return NJS_ERROR;
+    }
+
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        return NJS_ERROR;
+    }
+
+    ret = njs_vm_start(nvm);
+    if (ret != NJS_OK) {
+        njs_vm_destroy(nvm);
+        return NJS_ERROR;
+    }
+
+    njs_vm_stat(nvm, &vm_stat);
+
+    njs_vm_destroy(nvm);
+
+    if (vm_stat.property_cache_hits != 16
+        || vm_stat.property_cache_misses != 4)
+    {
+        njs_printf("njs_vm_stat_test: hits: %uL, misses: %uL\n",
+                   vm_stat.property_cache_hits,
+                   vm_stat.property_cache_misses);
+
+        stat->failed++;
+        return NJS_OK;
+    }
+
+    stat->passed++;
+
+    return NJS_OK;
+}
+
+
+static njs_int_t
+njs_vm_snapshot_test(njs_vm_t *unused, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char          *start;
+    njs_vm_t        *vm, *nvm;
+    njs_int_t       ret;
+    njs_str_t       s, prev;
+    njs_uint_t      i, n;
+    njs_bool_t      success;
+    njs_vm_opt_t    options;
+    njs_function_t  *f;
+
+    static const njs_str_t  fname = njs_str("f");
+
+    static const struct {
+        njs_str_t  script;
+        njs_int_t  snapshot;
+        njs_str_t  ret;
+    } tests[] = {
+        { njs_str("var r = Math.random();"
+                  "function f() { return r }"),
+          NJS_OK, njs_str("") },
+
+        { njs_str("var t = {n:0, a:[1,2], s:'x'};"
+                  "function f() { t.n++; t.a.push(t.n);"
+                  "               return JSON.stringify(t) }"),
+          NJS_OK, njs_str("{\"n\":1,\"a\":[1,2,1],\"s\":\"x\"}") },
+
+        { njs_str("var m = (function() { var c = 0;"
+                  "                      return {inc: function() {"
+                  "                                       return ++c }}})();"
+                  "m.inc();"
+                  "function f() { return m.inc() }"),
+          NJS_OK, njs_str("2") },
+
+        { njs_str("var a = {}; var b = {a:a}; a.b = b; var arr = [a, a];"
+                  "function f() { return [a.b === b, b.a === a,"
+                  "                       arr[0] === arr[1],"
+                  "                       Object.getPrototypeOf(a)"
+                  "                       === Object.prototype] }"),
+          NJS_OK, njs_str("true,true,true,true") },
+
+        { njs_str("Array.prototype.last = function() {"
+                  "    return this[this.length - 1] };"
+                  "var re = /a(b)/g; re.exec('ab');"
+                  "function F(x) { this.x = x }"
+                  "F.prototype.get = function() { return this.x };"
+                  "var o = new F(7); var d = new Date(0);"
+                  "function f() { var l = [1,2,3].last();"
+                  "               Array.prototype.last = null;"
+                  "               return [l, re.lastIndex, o.get(),"
+                  "                       o instanceof F, d.getTime()] }"),
+          NJS_OK, njs_str("3,2,7,true,0") },
+
+        { njs_str("var k = {}; var m = new Map([[k, 'o'], ['s', k]]);"
+                  "m.set(1, 1); m.delete(1); var s = new Set([k, m]);"
+                  "function f() { m.set(2, 2);"
+                  "               return [m.get(k), m.get('s') === k,"
+                  "                       s.has(k), s.has(m), m.size] }"),
+          NJS_OK, njs_str("o,true,true,true,3") },
+
+        { njs_str("var it = new Set([1]).values();"
+                  "function f() { return 1 }"),
+          NJS_DECLINED, njs_str("1") },
+
+        { njs_str("var p = Promise.resolve(1);"
+                  "function f() { return 1 }"),
+          NJS_DECLINED, njs_str("1") },
+
+        { njs_str("var b = new Uint8Array(2);"
+                  "function f() { return b[0]++ }"),
+          NJS_DECLINED, njs_str("0") },
+    };
+
+    vm = NULL;
+    nvm = NULL;
+
+    njs_vm_opt_init(&options);
+
+    for (i = 0; i < njs_nitems(tests); i++) {
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            return NJS_ERROR;
+        }
+
+        start = tests[i].script.start;
+
+        ret = njs_vm_compile(vm, &start, start + tests[i].script.length);
+        if (ret != NJS_OK) {
+            goto fail;
+        }
+
+        ret = njs_vm_snapshot(vm);
+
+        if (ret != tests[i].snapshot) {
+            njs_printf("njs_vm_snapshot_test(\"%V\"): snapshot: %d\n",
+                       &tests[i].script, (int) ret);
+            stat->failed++;
+            njs_vm_destroy(vm);
+            continue;
+        }
+
+        success = 1;
+        prev = njs_str_value("");
+
+        /* Each clone gets its own copy of the heap. */
+
+        for (n = 0; n < 2; n++) {
+            nvm = njs_vm_clone(vm, NULL);
+            if (nvm == NULL) {
+                goto fail;
+            }
+
+            ret = njs_vm_start(nvm);
+            if (ret != NJS_OK) {
+                goto fail;
+            }
+
+            f = njs_vm_function(nvm, &fname);
+            if (f == NULL) {
+                goto fail;
+            }
+
+            ret = njs_vm_call(nvm, f, NULL, 0);
+            if (ret != NJS_OK) {
+                goto fail;
+            }
+
+            if (njs_vm_retval_string(nvm, &s) != NJS_OK) {
+                goto fail;
+            }
+
+            if (tests[i].ret.length != 0) {
+                success = success && njs_strstr_eq(&tests[i].ret, &s);
+
+            } else if (n == 0) {
+                prev.length = s.length;
+                prev.start = njs_mp_alloc(vm->mem_pool, s.length);
+                if (prev.start == NULL) {
+                    goto fail;
+                }
+
+                memcpy(prev.start, s.start, s.length);
+
+            } else {
+                /* The global code has been run only once. */
+                success = njs_strstr_eq(&prev, &s);
+            }
+
+            if (!success) {
+                njs_printf("njs_vm_snapshot_test(\"%V\"): got \"%V\"\n",
+                           &tests[i].script, &s);
+            }
+
+            njs_vm_destroy(nvm);
+            nvm = NULL;
+        }
+
+        if (success) {
+            stat->passed++;
+
+        } else {
+            stat->failed++;
+        }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_snapshot_test(\"%V\") failed\n", &tests[i].script);
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    njs_vm_destroy(vm);
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_vm_gc_test(njs_vm_t *unused, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char              *start;
+    njs_vm_t            *vm, *nvm;
+    njs_int_t           ret;
+    njs_str_t           s;
+    njs_vm_opt_t        options;
+    njs_vm_stat_t       before, after;
+    njs_function_t      *f;
+    njs_opaque_value_t  held;
+
+    static const njs_str_t  garbage = njs_str("garbage");
+    static const njs_str_t  check = njs_str("check");
+    static const njs_str_t  expected = njs_str("3,64,104,3");
+
+    static const njs_str_t  script =
+        njs_str("var keep = {a:[1,2,3], s:'x'.repeat(64)};"
+                "function garbage() {"
+                "    var t = [];"
+                "    for (var i = 0; i < 10000; i++) {"
+                "        t.push({i:i, s:'y'.repeat(100) + i});"
+                "    }"
+                "    return {held:'z'.repeat(100) + 'held'};"
+                "}"
+                "function check(h) {"
+                "    return [keep.a.length, keep.s.length, h.held.length,"
+                "            keep.a[2]].join();"
+                "}");
+
+    nvm = NULL;
+
+    njs_vm_opt_init(&options);
+
+    options.gc_threshold = 64 * 1024;
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        return NJS_ERROR;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        goto fail;
+    }
+
+    ret = njs_vm_start(nvm);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    f = njs_vm_function(nvm, &garbage);
+    if (f == NULL || njs_vm_call(nvm, f, NULL, 0) != NJS_OK) {
+        goto fail;
+    }
+
+    /* The returned object is referenced only by the host. */
+
+    njs_value_assign(&held, njs_vm_retval(nvm));
+    njs_value_undefined_set(njs_vm_retval(nvm));
+
+    njs_vm_stat(nvm, &before);
+
+    ret = njs_vm_gc(nvm, njs_value_arg(&held), 1);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    njs_vm_stat(nvm, &after);
+
+    f = njs_vm_function(nvm, &check);
+    if (f == NULL || njs_vm_call(nvm, f, njs_value_arg(&held), 1) != NJS_OK) {
+        goto fail;
+    }
+
+    if (njs_vm_retval_string(nvm, &s) != NJS_OK) {
+        goto fail;
+    }
+
+    if (!njs_strstr_eq(&expected, &s)
+        || after.heap_size >= before.heap_size
+        || after.gc_runs != 1
+        || after.gc_freed == 0
+        || njs_vm_gc(nvm, NULL, 0) != NJS_DECLINED)
+    {
+        njs_printf("njs_vm_gc_test: got \"%V\", heap: %uL -> %uL\n",
+                   &s, before.heap_size, after.heap_size);
+
+        stat->failed++;
+
+    } else {
+        stat->passed++;
+    }
+
+    njs_vm_destroy(nvm);
+    njs_vm_destroy(vm);
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_gc_test failed\n");
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    njs_vm_destroy(vm);
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_vm_bytecode_test(njs_vm_t *unused, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char        *start;
+    njs_vm_t      *vm, *lvm, *nvm;
+    njs_int_t     ret;
+    njs_str_t     s, bytecode, truncated;
+    njs_vm_opt_t  options;
+
+    static const njs_str_t  run = njs_str("run");
+    static const njs_str_t  expected =
+        njs_str("6,120,ab,true,aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa,"
+                "ReferenceError,2");
+
+    static const njs_str_t  script =
+        njs_str("var long = 'a'.repeat(40);"
+                "function fact(n) { return n < 2 ? 1 : n * fact(n - 1); }"
+                "function counter() { var c = 0; return () => ++c; }"
+                "function run() {"
+                "    var c = counter(), e;"
+                "    c();"
+                "    try { undeclared; } catch (ex) { e = ex.name; }"
+                "    return [[1, 2, 3].reduce((a, b) => a + b), fact(5),"
+                "            `${'a'}b`, /^A+$/i.test(long),"
+                "            'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa', e, c()]"
+                "           .join();"
+                "}");
+
+    static const njs_str_t  changed =
+        njs_str("var long = 'b'.repeat(40);");
+
+    lvm = NULL;
+    nvm = NULL;
+
+    njs_vm_opt_init(&options);
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        return NJS_ERROR;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile_save(vm, &start, start + script.length, &bytecode);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    lvm = njs_vm_create(&options);
+    if (lvm == NULL) {
+        goto fail;
+    }
+
+    /* A different script or a damaged bytecode are not loaded. */
+
+    start = changed.start;
+
+    ret = njs_vm_compile_load(lvm, &start, start + changed.length, &bytecode);
+    if (ret != NJS_DECLINED) {
+        goto fail;
+    }
+
+    truncated.start = bytecode.start;
+    truncated.length = bytecode.length - 1;
+
+    start = script.start;
+
+    ret = njs_vm_compile_load(lvm, &start, start + script.length, &truncated);
+    if (ret != NJS_DECLINED) {
+        goto fail;
+    }
+
+    ret = njs_vm_compile_load(lvm, &start, start + script.length, &bytecode);
+    if (ret != NJS_OK || start != script.start + script.length) {
+        goto fail;
+    }
+
+    nvm = njs_vm_clone(lvm, NULL);
+    if (nvm == NULL) {
+        goto fail;
+    }
+
+    ret = njs_vm_start(nvm);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    ret = njs_vm_call(nvm, njs_vm_function(nvm, &run), NULL, 0);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    if (njs_vm_retval_string(nvm, &s) != NJS_OK) {
+        goto fail;
+    }
+
+    if (!njs_strstr_eq(&expected, &s)) {
+        njs_printf("njs_vm_bytecode_test: got \"%V\"\n", &s);
+
+        stat->failed++;
+
+    } else {
+        stat->passed++;
+    }
+
+    njs_vm_destroy(nvm);
+    njs_vm_destroy(lvm);
+    njs_vm_destroy(vm);
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_bytecode_test failed\n");
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (lvm != NULL) {
+        njs_vm_destroy(lvm);
+    }
+
+    njs_vm_destroy(vm);
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_vm_function_handle_test(njs_vm_t *unused, njs_opts_t *opts,
+    njs_stat_t *stat)
+{
+    u_char                 *start;
+    njs_vm_t               *vm, *nvm;
+    njs_int_t              ret;
+    njs_str_t              s;
+    njs_uint_t             i;
+    njs_function_t         *f;
+    njs_vm_opt_t           options;
+    njs_function_handle_t  *global, *nested, *builtin, *missing;
+
+    static const njs_str_t  main_name = njs_str("main");
+    static const njs_str_t  nested_name = njs_str("o.handlers.run");
+    static const njs_str_t  builtin_name = njs_str("JSON.stringify");
+    static const njs_str_t  missing_name = njs_str("o.missing");
+    static const njs_str_t  empty_name = njs_str("o..run");
+    static const njs_str_t  expected = njs_str("run:2");
+
+    static const njs_str_t  script =
+        njs_str("var n = 0;"
+                "var o = {handlers: {run() { return 'run:' + ++n; }}};"
+                "function main() { return 'main:' + ++n; }");
+
+    nvm = NULL;
+
+    njs_vm_opt_init(&options);
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        return NJS_ERROR;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    global = njs_vm_function_handle(vm, &main_name);
+    nested = njs_vm_function_handle(vm, &nested_name);
+    builtin = njs_vm_function_handle(vm, &builtin_name);
+    missing = njs_vm_function_handle(vm, &missing_name);
+
+    if (global == NULL || nested == NULL || builtin == NULL || missing == NULL
+        || njs_vm_function_handle(vm, &empty_name) != NULL)
+    {
+        goto fail;
+    }
+
+    /* The handles are resolved in each clone with its own values. */
+
+    for (i = 0; i < 2; i++) {
+        nvm = njs_vm_clone(vm, NULL);
+        if (nvm == NULL) {
+            goto fail;
+        }
+
+        ret = njs_vm_start(nvm);
+        if (ret != NJS_OK) {
+            goto fail;
+        }
+
+        f = njs_vm_handle_function(nvm, global);
+        if (f == NULL || njs_vm_call(nvm, f, NULL, 0) != NJS_OK) {
+            goto fail;
+        }
+
+        f = njs_vm_handle_function(nvm, nested);
+        if (f == NULL || njs_vm_call(nvm, f, NULL, 0) != NJS_OK) {
+            goto fail;
+        }
+
+        if (njs_vm_retval_string(nvm, &s) != NJS_OK) {
+            goto fail;
+        }
+
+        if (njs_vm_handle_function(nvm, builtin) == NULL
+            || njs_vm_handle_function(nvm, missing) != NULL)
+        {
+            goto fail;
+        }
+
+        if (!njs_strstr_eq(&expected, &s)) {
+            njs_printf("njs_vm_function_handle_test: got \"%V\"\n", &s);
+
+            stat->failed++;
+
+        } else {
+            stat->passed++;
+        }
+
+        njs_vm_destroy(nvm);
+        nvm = NULL;
+    }
+
+    njs_vm_destroy(vm);
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_function_handle_test failed\n");
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    njs_vm_destroy(vm);
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_vm_reset_test(njs_vm_t *unused, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char                 *start;
+    njs_vm_t               *vm, *nvm;
+    njs_int_t              ret;
+    njs_str_t              s;
+    njs_uint_t             i, n;
+    njs_function_t         *f;
+    njs_vm_opt_t           options;
+    njs_function_handle_t  *handle;
+
+    static const njs_str_t  main_name = njs_str("main");
+    static const njs_str_t  expected = njs_str("1:1000");
+
+    static const njs_str_t  script =
+        njs_str("var n = 0; var a = [];"
+                "function main() {"
+                "    for (var i = 0; i < 1000; i++) {"
+                "        a.push({i, s: 'x'.repeat(i)});"
+                "    }"
+                "    return ++n + ':' + a.length;"
+                "}");
+
+    /* The snapshot and arena modes are tested in all combinations. */
+
+    for (n = 0; n < 4; n++) {
+        vm = NULL;
+        nvm = NULL;
+
+        njs_vm_opt_init(&options);
+
+        options.arena = n >> 1;
+
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            goto fail;
+        }
+
+        start = script.start;
+
+        ret = njs_vm_compile(vm, &start, start + script.length);
+        if (ret != NJS_OK) {
+            goto fail;
+        }
+
+        if ((n & 1) && njs_vm_snapshot(vm) != NJS_OK) {
+            goto fail;
+        }
+
+        handle = njs_vm_function_handle(vm, &main_name);
+        if (handle == NULL) {
+            goto fail;
+        }
+
+        /* Only clones can be reset. */
+
+        if (njs_vm_reset(vm, NULL) != NJS_ERROR) {
+            goto fail;
+        }
+
+        nvm = njs_vm_clone(vm, NULL);
+        if (nvm == NULL) {
+            goto fail;
+        }
+
+        /* Each run starts with the global variables of a new clone. */
+
+        for (i = 0; i < 3; i++) {
+            if (i != 0 && njs_vm_reset(nvm, NULL) != NJS_OK) {
+                goto fail;
+            }
+
+            ret = njs_vm_start(nvm);
+            if (ret != NJS_OK) {
+                goto fail;
+            }
+
+            f = njs_vm_handle_function(nvm, handle);
+            if (f == NULL || njs_vm_call(nvm, f, NULL, 0) != NJS_OK) {
+                goto fail;
+            }
+
+            if (njs_vm_retval_string(nvm, &s) != NJS_OK) {
+                goto fail;
+            }
+
+            if (!njs_strstr_eq(&expected, &s)) {
+                njs_printf("njs_vm_reset_test: got \"%V\"\n", &s);
+
+                stat->failed++;
+
+            } else {
+                stat->passed++;
+            }
+        }
+
+        njs_vm_destroy(nvm);
+        njs_vm_destroy(vm);
+    }
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_reset_test failed\n");
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_vm_profiler_test(njs_vm_t *unused, njs_opts_t *opts, njs_stat_t *stat)
+{
+    u_char          *start;
+    njs_vm_t        *vm, *nvm;
+    njs_int_t       ret;
+    njs_str_t       report;
+    njs_vm_opt_t    options;
+    njs_profiler_t  *profiler;
+
+    static const njs_str_t  g = njs_str("g");
+    static const njs_str_t  expected =
+        njs_str("main 2\n"
+                "main;g (profiler.js:2) 1\n");
+
+    static const njs_str_t  script =
+        njs_str("function f() { return 1 }\n"
+                "function g() { return f() }\n");
+
+    nvm = NULL;
+
+    profiler = njs_profiler_create();
+    if (profiler == NULL) {
+        return NJS_ERROR;
+    }
+
+    njs_vm_opt_init(&options);
+
+    options.backtrace = 1;
+    options.file = njs_str_value("profiler.js");
+
+    vm = njs_vm_create(&options);
+    if (vm == NULL) {
+        njs_profiler_destroy(profiler);
+        return NJS_ERROR;
+    }
+
+    start = script.start;
+
+    ret = njs_vm_compile(vm, &start, start + script.length);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    njs_vm_set_profiler(vm, profiler);
+
+    nvm = njs_vm_clone(vm, NULL);
+    if (nvm == NULL) {
+        goto fail;
+    }
+
+    /*
+     * The ticks are accounted on the next function call, return
+     * or backward jump.
+     */
+
+    njs_profiler_tick();
+    njs_profiler_tick();
+
+    ret = njs_vm_start(nvm);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    njs_profiler_tick();
+
+    ret = njs_vm_call(nvm, njs_vm_function(nvm, &g), NULL, 0);
+    if (ret != NJS_OK) {
+        goto fail;
+    }
+
+    if (njs_profiler_report(profiler, &report) != NJS_OK) {
+        goto fail;
+    }
+
+    if (!njs_strstr_eq(&expected, &report)) {
+        njs_printf("njs_vm_profiler_test: got \"%V\"\n", &report);
+
+        stat->failed++;
+
+    } else {
+        stat->passed++;
+    }
+
+    njs_vm_destroy(nvm);
+    njs_vm_destroy(vm);
+    njs_profiler_destroy(profiler);
+
+    return NJS_OK;
+
+fail:
+
+    njs_printf("njs_vm_profiler_test failed\n");
+
+    if (nvm != NULL) {
+        njs_vm_destroy(nvm);
+    }
+
+    njs_vm_destroy(vm);
+    njs_profiler_destroy(profiler);
+
+    return NJS_ERROR;
+}
+
+
+static njs_int_t
+njs_api_test(njs_opts_t *opts, njs_stat_t *stat)
+{
+    njs_vm_t      *vm;
+    njs_int_t     ret;
+    njs_uint_t    i;
+    njs_stat_t    prev;
+    njs_vm_opt_t  options;
+
+    static const struct {
+        njs_int_t  (*test)(njs_vm_t *, njs_opts_t *, njs_stat_t *stat);
+        njs_str_t  name;
+    } tests[] = {
+        { njs_vm_object_alloc_test,
+          njs_str("njs_vm_object_alloc_test") },
+        { njs_file_basename_test,
+          njs_str("njs_file_basename_test") },
+        { njs_file_dirname_test,
+          njs_str("njs_file_dirname_test") },
+        { njs_chb_test,
+          njs_str("njs_chb_test") },
+        { njs_shape_property_query_test,
+          njs_str("njs_shape_property_query_test") },
+        { njs_string_to_index_test,
+          njs_str("njs_string_to_index_test") },
+        { njs_vm_value_string_create_test,
+          njs_str("njs_vm_value_string_create_test") },
+        { njs_vm_stat_test,
+          njs_str("njs_vm_stat_test") },
+        { njs_vm_snapshot_test,
+          njs_str("njs_vm_snapshot_test") },
+        { njs_vm_gc_test,
+          njs_str("njs_vm_gc_test") },
+        { njs_vm_bytecode_test,
+          njs_str("njs_vm_bytecode_test") },
+        { njs_vm_function_handle_test,
+          njs_str("njs_vm_function_handle_test") },
+        { njs_vm_reset_test,
+          njs_str("njs_vm_reset_test") },
+        { njs_vm_profiler_test,
+          njs_str("njs_vm_profiler_test") },
+    };
+
+    vm = NULL;
+    njs_vm_opt_init(&options);
+
+    prev = *stat;
+
+    ret = NJS_ERROR;
+
+    for (i = 0; i < njs_nitems(tests); i++) {
+        vm = njs_vm_create(&options);
+        if (vm == NULL) {
+            njs_printf("njs_vm_create() failed\n");
+            goto done;
+        }
+
+        ret = tests[i].test(vm, opts, stat);
+        if (njs_slow_path(ret != NJS_OK)) {
+            njs_printf("njs_api_test: \"%V\" test failed\n", &tests[i].name);
+            goto done;
+        }
+
+        njs_vm_destroy(vm);
+        vm = NULL;
+    }
+
+    ret = NJS_OK;
+
+done:
+
+    njs_unit_test_report("API tests", &prev, stat);
+
+    if (vm != NULL) {
+        njs_vm_destroy(vm);
+    }
+
+    return ret;
+}
+
+
+int njs_cdecl
+main(int argc, char **argv)
+{
+    njs_int_t   ret;
+    njs_opts_t  opts;
+    njs_stat_t  stat;
+
+    njs_memzero(&opts, sizeof(njs_opts_t));
+
+    if (argc > 1) {
+        switch (argv[1][0]) {
+
+        case 'd':
+            opts.disassemble = 1;
+            break;
+
+        case 'v':
+            opts.verbose = 1;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    (void) putenv((char *) "TZ=UTC");
+    tzset();
+
+    njs_memzero(&stat, sizeof(njs_stat_t));
+
+    opts.repeat = 1;
+    opts.unsafe = 1;
+
+    njs_mm_denormals(1);
+
+    ret = njs_unit_test(njs_test, njs_nitems(njs_test), "script tests",
+                        &opts, &stat);
     if (ret != NJS_OK) {
         return ret;
     }
@@ -18175,6 +19693,14 @@ main(int argc, char **argv)
         return ret;
     }
 
+    opts.arena = 1;
+
+    ret = njs_unit_test(njs_shared_test, njs_nitems(njs_shared_test),
+                        "shared arena tests", &opts, &stat);
+    if (ret != NJS_OK) {
+        return ret;
+    }
+
     njs_printf("TOTAL: %s [%ui/%ui]\n", stat.failed ? "FAILED" : "PASSED",
                stat.passed, stat.passed + stat.failed);
 
@@ -77,6 +77,146 @@ utf8_overlong(u_char *overlong, size_t len)
 }
 
 
+static uint32_t
+utf8_random(uint32_t *state)
+{
+    uint32_t  x;
+
+    x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    *state = x;
+
+    return x;
+}
+
+
+static size_t
+utf8_random_string(u_char *buf, size_t size, uint32_t *state)
+{
+    u_char    *p, *end;
+    uint32_t  r, u;
+
+    p = buf;
+    end = buf + size - 4;
+
+    while (p < end) {
+        r = utf8_random(state);
+
+        switch (r % 8) {
+        case 0:
+        case 1:
+        case 2:
+            u = (r >> 8) % 0x80;
+            break;
+
+        case 3:
+            u = 0x80 + (r >> 8) % (0x800 - 0x80);
+            break;
+
+        case 4:
+            u = 0x800 + (r >> 8) % (0x10000 - 0x800);
+            break;
+
+        case 5:
+            /* Surrogates are valid in njs_utf8_decode(). */
+            u = 0xD800 + (r >> 8) % 0x800;
+            break;
+
+        case 6:
+            u = 0x10000 + (r >> 8) % (0x110000 - 0x10000);
+            break;
+
+        default:
+            /* A run of ASCII characters to reach the all-ASCII paths. */
+            r = 16 + (r >> 8) % 64;
+
+            while (r-- != 0 && p < end) {
+                *p++ = 'a';
+            }
+
+            continue;
+        }
+
+        p = njs_utf8_encode(p, u);
+    }
+
+    return p - buf;
+}
+
+
+static njs_int_t
+utf8_simd_test(void)
+{
+    u_char      *p, buf[512];
+    size_t      len;
+    ssize_t     length, size, expected_length, expected_size;
+    uint32_t    state, r;
+    njs_bool_t  valid, expected_valid;
+    njs_uint_t  i, n, k;
+
+    state = 0x2545F491;
+
+    for (i = 0; i < 200000; i++) {
+        r = utf8_random(&state);
+
+        len = utf8_random_string(buf, 4 + r % (sizeof(buf) - 4), &state);
+
+        /* Corrupts, truncates or leaves the string intact. */
+
+        n = (r >> 16) % 4;
+
+        for (k = 0; k < n && len != 0; k++) {
+            r = utf8_random(&state);
+
+            switch (r % 3) {
+            case 0:
+                buf[(r >> 8) % len] = (u_char) (r >> 24);
+                break;
+
+            case 1:
+                buf[(r >> 8) % len] ^= 0x40;
+                break;
+
+            default:
+                len = (r >> 8) % len;
+                break;
+            }
+        }
+
+        p = buf + (i % 7);
+        len = (len > (size_t) (i % 7)) ? len - (i % 7) : 0;
+
+        length = njs_utf8_length(p, len);
+        expected_length = njs_utf8_length_scalar(p, len);
+
+        valid = njs_utf8_is_valid(p, len);
+        expected_valid = njs_utf8_is_valid_scalar(p, len);
+
+        size = -1;
+        expected_size = -2;
+
+        if (length != expected_length
+            || valid != expected_valid
+            || njs_utf8_safe_length(p, len, &size)
+               != njs_utf8_safe_length_scalar(p, len, &expected_size)
+            || size != expected_size)
+        {
+            njs_printf("njs_utf8_length(%uz bytes) failed: %z, %z, "
+                       "valid: %d, %d, size: %z, %z\n", len, length,
+                       expected_length, valid, expected_valid, size,
+                       expected_size);
+            return NJS_ERROR;
+        }
+    }
+
+    return NJS_OK;
+}
+
+
 static njs_int_t
 utf8_unit_test(njs_uint_t start)
 {
@@ -171,6 +311,12 @@ utf8_unit_test(njs_uint_t start)
         }
     }
 
+    /* Compare the vector and the scalar code. */
+
+    if (utf8_simd_test() != NJS_OK) {
+        return NJS_ERROR;
+    }
+
     n = njs_utf8_casecmp((u_char *) "ABC АБВ ΑΒΓ",
                          (u_char *) "abc абв αβγ",
                          njs_length("ABC АБВ ΑΒΓ"),